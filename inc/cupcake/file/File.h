@@ -0,0 +1,59 @@
+
+#ifndef CUPCAKE_FILE_H
+#define CUPCAKE_FILE_H
+
+#include "cupcake/file/FileError.h"
+#include "cupcake/text/StringRef.h"
+
+#include <tuple>
+
+namespace Cupcake {
+
+/*
+ * Read only handle to a file on disk, along with the metadata captured when
+ * it was opened.
+ *
+ * Mostly exists so that file content can be handed down to the socket layer
+ * and sent without being copied through user memory.
+ */
+class File {
+public:
+#ifdef _WIN32
+    typedef void* NativeHandle;
+#else
+    typedef int NativeHandle;
+#endif
+
+    File();
+    ~File();
+    File(File&& other);
+    File& operator=(File&& other);
+
+    FileError open(const StringRef path);
+    FileError close();
+
+    bool isOpen() const;
+    bool isRegular() const;
+    uint64_t getSize() const;
+
+    // Seconds since the unix epoch
+    uint64_t getModifiedTime() const;
+
+    // Positional read. Does not affect any shared file offset.
+    std::tuple<uint32_t, FileError> read(uint64_t offset, char* buffer, uint32_t bufferLen) const;
+
+    NativeHandle getNativeHandle() const;
+
+private:
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    NativeHandle handle;
+    bool regular;
+    uint64_t size;
+    uint64_t modifiedTime;
+};
+
+}
+
+#endif // CUPCAKE_FILE_H
@@ -0,0 +1,33 @@
+
+#ifndef CUPCAKE_FILE_ERROR_H
+#define CUPCAKE_FILE_ERROR_H
+
+#include <cstdint>
+
+namespace Cupcake {
+
+/*
+ * Error enum for dealing with files on disk.
+ */
+enum class FileError : uint32_t {
+    Ok = 0,
+
+    // Generic errors
+    InvalidArgument, // EINVAL, ENAMETOOLONG, ERROR_INVALID_NAME
+    InvalidState,
+    InvalidText, // ERROR_NO_UNICODE_TRANSLATION
+    IoError, // EIO
+    TooManyHandles, // ENFILE, EMFILE
+    OutOfMemory, // ENOMEM
+
+    // Lookup errors
+    NotFound, // ENOENT, ENOTDIR, ERROR_FILE_NOT_FOUND, ERROR_PATH_NOT_FOUND
+    AccessDenied, // EACCES, EPERM, ERROR_ACCESS_DENIED, ERROR_SHARING_VIOLATION
+
+    // Generic error for unmapped error code
+    Unknown
+};
+
+}
+
+#endif // CUPCAKE_FILE_ERROR_H
@@ -2,7 +2,9 @@
 #ifndef CUPCAKE_HTTP_H
 #define CUPCAKE_HTTP_H
 
+#include "cupcake/file/File.h"
 #include "cupcake/http/HttpError.h"
+#include "cupcake/http/HttpHeader.h"
 #include "cupcake/text/StringRef.h"
 
 #include <tuple>
@@ -34,6 +36,19 @@ enum class HttpVersion {
 class HttpInputStream {
 public:
     virtual std::tuple<uint32_t, HttpError> read(char* buffer, uint32_t bufferLen) = 0;
+    // Fills the whole buffer, unless the body ends first. Meant for taking in
+    // large uploads: with a buffer of 64KB or more, most of the body is read
+    // from the connection straight into it.
+    virtual std::tuple<uint32_t, HttpError> readFully(char* buffer, uint32_t bufferLen) = 0;
+
+    // Lends up to maxLen bytes of the body without copying them out of the
+    // connection's buffer. Nothing is taken until consume() is called, and the
+    // view is only good until the next call on the stream. An empty view with
+    // Eof at the end of the body.
+    virtual std::tuple<StringRef, HttpError> readView(uint32_t maxLen) = 0;
+    // Marks the first byteCount bytes of the last view as read
+    virtual void consume(uint32_t byteCount) = 0;
+
     virtual HttpError close() = 0;
 };
 
@@ -47,22 +62,50 @@ public:
 class HttpRequest {
 public:
     virtual const HttpMethod getMethod() const = 0;
+    // The request target as sent
     virtual const StringRef getUrl() const = 0;
+    // Percent decoded, without "." or ".." segments. Handlers are matched on this.
+    virtual const StringRef getPath() const = 0;
+    // As sent, without the '?'
+    virtual const StringRef getQuery() const = 0;
+
+    // Decoded name=value pairs from the query
+    virtual uint32_t getQueryParamCount() const = 0;
+    virtual std::tuple<StringRef, StringRef> getQueryParam(uint32_t index) const = 0;
+    virtual std::tuple<StringRef, bool> getQueryParam(const StringRef name) const = 0;
 
     virtual uint32_t getHeaderCount() const = 0;
     virtual std::tuple<StringRef, StringRef> getHeader(uint32_t index) const = 0;
     virtual std::tuple<StringRef, bool> getHeader(const StringRef headerName) const = 0;
+    virtual std::tuple<StringRef, bool> getHeader(HttpHeader header) const = 0;
+
+    // Index of the first header with the name, for getHeader(index), or -1.
+    // Repeats of the same header follow on through findNextHeader().
+    virtual ptrdiff_t findHeader(const StringRef headerName) const = 0;
+    virtual ptrdiff_t findHeader(HttpHeader header) const = 0;
+    virtual ptrdiff_t findNextHeader(uint32_t index) const = 0;
+
+    // Values matched by {name} segments in the handler's path, pointing into
+    // the path
+    virtual uint32_t getPathParamCount() const = 0;
+    virtual std::tuple<StringRef, StringRef> getPathParam(uint32_t index) const = 0;
+    virtual std::tuple<StringRef, bool> getPathParam(const StringRef name) const = 0;
 
     virtual HttpInputStream& getInputStream() = 0;
 };
 
 class HttpResponse {
 public:
+    // Both are ignored once the output stream has been taken or a file sent
     virtual void setStatus(uint32_t code, StringRef statusText) = 0;
     virtual void addHeader(StringRef headerName, StringRef headerValue) = 0;
 
     virtual std::tuple<HttpOutputStream*, HttpError> getOutputStream() = 0;
 
+    // Sends the headers and a range of the file as the entire body, then closes the
+    // response. Content-Length is added if not already set, and must match if it is.
+    virtual HttpError sendFile(const File& file, uint64_t offset, uint64_t length) = 0;
+
     virtual HttpError close() = 0;
 };
 
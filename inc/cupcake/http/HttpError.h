@@ -15,6 +15,7 @@ enum class HttpError : uint32_t {
     // Generic errors
     InvalidState,
     InvalidHeader,
+    OutOfMemory,
 
     // IO errors
     StreamClosed,
@@ -0,0 +1,98 @@
+
+#ifndef CUPCAKE_HTTP_HEADER_H
+#define CUPCAKE_HTTP_HEADER_H
+
+#include <cstdint>
+
+namespace Cupcake {
+
+/*
+ * Header names the parser recognizes, so they can be looked up without
+ * comparing strings. Anything else is Unknown.
+ */
+enum class HttpHeader : uint8_t {
+    Unknown = 0,
+
+    Accept,
+    AcceptCharset,
+    AcceptEncoding,
+    AcceptLanguage,
+    AcceptRanges,
+    AccessControlAllowCredentials,
+    AccessControlAllowHeaders,
+    AccessControlAllowMethods,
+    AccessControlAllowOrigin,
+    AccessControlExposeHeaders,
+    AccessControlMaxAge,
+    AccessControlRequestHeaders,
+    AccessControlRequestMethod,
+    Age,
+    Allow,
+    Authorization,
+    CacheControl,
+    Connection,
+    ContentDisposition,
+    ContentEncoding,
+    ContentLanguage,
+    ContentLength,
+    ContentLocation,
+    ContentRange,
+    ContentSecurityPolicy,
+    ContentType,
+    Cookie,
+    Date,
+    Dnt,
+    ETag,
+    Expect,
+    Expires,
+    Forwarded,
+    From,
+    Host,
+    IfMatch,
+    IfModifiedSince,
+    IfNoneMatch,
+    IfRange,
+    IfUnmodifiedSince,
+    KeepAlive,
+    LastModified,
+    Link,
+    Location,
+    MaxForwards,
+    Origin,
+    Pragma,
+    ProxyAuthenticate,
+    ProxyAuthorization,
+    Range,
+    Referer,
+    RetryAfter,
+    SecWebSocketAccept,
+    SecWebSocketExtensions,
+    SecWebSocketKey,
+    SecWebSocketProtocol,
+    SecWebSocketVersion,
+    Server,
+    SetCookie,
+    StrictTransportSecurity,
+    Te,
+    Trailer,
+    TransferEncoding,
+    Upgrade,
+    UpgradeInsecureRequests,
+    UserAgent,
+    Vary,
+    Via,
+    WwwAuthenticate,
+    XContentTypeOptions,
+    XForwardedFor,
+    XForwardedHost,
+    XForwardedProto,
+    XFrameOptions,
+    XRequestedWith,
+
+    // Number of values, not a header
+    Count
+};
+
+}
+
+#endif // CUPCAKE_HTTP_HEADER_H
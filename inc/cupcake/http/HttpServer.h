@@ -9,7 +9,8 @@
 
 #include "cupcake/internal/http/StreamSource.h"
 
-#include "cupcake/internal/http/HandlerMap.h"
+#include "cupcake/internal/http/CompressionConfig.h"
+#include "cupcake/internal/http/RouteTable.h"
 
 #include <memory>
 
@@ -19,13 +20,35 @@ namespace Cupcake {
  * An HTTP server implementation.
  *
  * Paths can be specified exactly "/images/default.gif", or end with a wildcard "/images/(asterix)".
+ * A path with handlers for only some methods answers the others with 405, and
+ * OPTIONS with the methods it allows.
+ *
+ * Handlers can be added and removed at any time, including while serving.
+ * Requests already in flight finish with the routes they started with.
  */
 class HttpServer {
 public:
     HttpServer();
     ~HttpServer();
 
+    // Without a method the handler is used for all of them
     bool addHandler(const StringRef path, HttpHandler handler);
+    bool addHandler(HttpMethod method, const StringRef path, HttpHandler handler);
+
+    // Serves the files under rootDir, e.g. ("/static/(asterix)", "/var/www") maps
+    // "/static/css/site.css" to "/var/www/css/site.css"
+    bool addStaticHandler(const StringRef path, const StringRef rootDir);
+
+    // The path must be spelled as it was added
+    bool removeHandler(const StringRef path);
+    bool removeHandler(HttpMethod method, const StringRef path);
+
+    // Compresses handler output of at least minSize bytes when the client accepts gzip
+    // or zstd. Only applies to compressible content types, see addCompressibleType.
+    void enableCompression(uint32_t minSize);
+
+    // e.g. "application/json" or "text/(asterix)". Replaces the default set of text types.
+    void addCompressibleType(const StringRef contentType);
 
     // Note: Delete ownership of the socket is NOT taken
     HttpError start(StreamSource* streamSource);
@@ -39,7 +62,8 @@ private:
     HttpError acceptLoop();
 
     StreamSource* streamSource;
-    HandlerMap handlerMap;
+    RouteTable routeTable;
+    CompressionConfig compressionConfig;
     bool started;
 };
 
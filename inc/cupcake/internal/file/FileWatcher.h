@@ -0,0 +1,62 @@
+
+#ifndef CUPCAKE_FILE_WATCHER_H
+#define CUPCAKE_FILE_WATCHER_H
+
+#include "cupcake/file/FileError.h"
+#include "cupcake/text/StringRef.h"
+
+#include "cupcake/internal/text/String.h"
+
+#include <functional>
+
+#ifdef __linux__
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#endif
+
+namespace Cupcake {
+
+/*
+ * Watches directories for changes to the files in them, reporting the path of
+ * whatever changed from a background thread.
+ *
+ * Only implemented with inotify on Linux. Elsewhere init() fails with
+ * InvalidState and users are expected to fall back to revalidating.
+ */
+class FileWatcher {
+public:
+    // Called with dir + '/' + name. An empty path means events were lost and
+    // anything may have changed.
+    typedef std::function<void(const StringRef path)> ChangeCallback;
+
+    FileWatcher();
+    ~FileWatcher();
+
+    FileError init(ChangeCallback callback);
+    void close();
+
+    // Adding a directory that's already watched is a no-op
+    FileError watchDirectory(const StringRef dirPath);
+
+private:
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+#ifdef __linux__
+    void watchLoop();
+
+    int inotifyFd;
+    int wakeFds[2];
+    std::thread watchThread;
+    ChangeCallback callback;
+
+    std::mutex watchMutex;
+    std::unordered_map<int, String> watchDirs;
+    std::unordered_map<String, int> watchDescriptors;
+#endif
+};
+
+}
+
+#endif // CUPCAKE_FILE_WATCHER_H
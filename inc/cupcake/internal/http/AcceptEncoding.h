@@ -0,0 +1,22 @@
+
+#ifndef CUPCAKE_ACCEPT_ENCODING_H
+#define CUPCAKE_ACCEPT_ENCODING_H
+
+#include "cupcake/text/StringRef.h"
+
+#include <cstdint>
+
+namespace Cupcake {
+
+/*
+ * Helpers for content coding negotiation with Accept-Encoding.
+ */
+namespace AcceptEncoding {
+    // Quality in thousandths the Accept-Encoding value gives the coding, 0 meaning not acceptable.
+    // "identity" is acceptable unless explicitly excluded, and "x-gzip" counts as "gzip".
+    uint32_t getQuality(const StringRef acceptEncoding, const StringRef coding);
+}
+
+}
+
+#endif // CUPCAKE_ACCEPT_ENCODING_H
@@ -4,6 +4,9 @@
 
 #include "cupcake/http/Http.h"
 
+#include "cupcake/internal/http/StreamSource.h"
+#include "cupcake/internal/util/BufferPool.h"
+
 #include <vector>
 
 namespace Cupcake {
@@ -15,6 +18,11 @@ class HttpResponseImpl;
  * specified on the response. This will buffer the entire response, append
  * that header, and then write out everything in one go.
  *
+ * Content is kept in a list of pooled blocks which are handed to a single
+ * writev, so it is never copied into one contiguous buffer. Once more than
+ * spillThreshold bytes are written the response switches to streaming without
+ * a length, ending the body by closing the connection.
+ *
  * This requires some special support from HttpResponseImpl.
  */
 class BufferedContentLengthWriter : public HttpOutputStream {
@@ -23,8 +31,12 @@ public:
     ~BufferedContentLengthWriter();
 
     void init(HttpResponseImpl* responseImpl);
+    void init(HttpResponseImpl* responseImpl, uint32_t spillThreshold);
 
     HttpError write(const char* buffer, uint32_t bufferLen) override;
+
+    // Nothing can be sent before the length is known, so this does nothing
+    // until the response has spilled
     HttpError flush() override;
     HttpError close() override;
 
@@ -32,8 +44,15 @@ private:
     BufferedContentLengthWriter(const BufferedContentLengthWriter&) = delete;
     BufferedContentLengthWriter& operator=(const BufferedContentLengthWriter&) = delete;
 
+    HttpError spill(const char* buffer, uint32_t bufferLen);
+    uint32_t fillIoBuffers(INet::IoBuffer* ioBufs);
+
     HttpResponseImpl* responseImpl;
-    std::vector<char> contentBuffer;
+    StreamSource* spillSource;
+    std::vector<PooledBuffer> blocks;
+    uint32_t lastBlockUsed;
+    uint64_t bufferedLen;
+    uint32_t spillThreshold;
     bool closed;
 };
 
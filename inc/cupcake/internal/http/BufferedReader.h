@@ -5,8 +5,8 @@
 #include "cupcake/text/StringRef.h"
 
 #include "cupcake/internal/http/StreamSource.h"
+#include "cupcake/internal/util/BufferPool.h"
 
-#include <memory>
 #include <tuple>
 
 namespace Cupcake {
@@ -17,26 +17,69 @@ namespace Cupcake {
  * through the HTTP upgrade will have to do both.
  *
  * Holds a reference to a StreamSource, so it needs to be destroyed before it.
+ *
+ * The buffer comes from the BufferPool, and is only taken once there is
+ * something to read. It can be handed back while nothing is buffered so idle
+ * connections don't hold on to one.
  */
 class BufferedReader {
 public:
+    // What bodies at least this long are read into with readView(), and the
+    // smallest read readFixedLength() makes straight into its destination
+    enum {largeBufferLen = 64 * 1024};
+
     BufferedReader();
     ~BufferedReader() = default;
 
     void init(StreamSource* socket, size_t initialBuffer);
 
     std::tuple<uint32_t, HttpError> read(char* buffer, uint32_t bufferLen);
+    // Reads exactly byteCount bytes. After what's buffered, anything over
+    // largeBufferLen is read from the socket straight into buffer, only the
+    // tail comes through the internal buffer.
     HttpError readFixedLength(char* buffer, uint32_t byteCount);
+    // As readFixedLength(), but also gives how many bytes made it into buffer
+    // before an error
+    std::tuple<uint32_t, HttpError> readFixedLengthCounted(char* buffer, uint32_t byteCount);
     std::tuple<bool, HttpError> peekMatch(char* expectedData, uint32_t expectedDataLen);
     std::tuple<StringRef, HttpError> readLine(uint32_t maxLength);
     HttpError discard(uint32_t discardBytes);
 
+    // Unread data currently in the buffer. Invalidated by anything that reads.
+    StringRef getBuffered() const;
+
+    // Reads at least one more byte in behind the buffered data, moving it to
+    // the front or to a larger buffer if there is no room. Fails with
+    // LineTooLong if maxBuffered bytes are already buffered.
+    HttpError fill(uint32_t maxBuffered);
+
+    // Up to maxLen bytes of what's buffered, reading some in first if there's
+    // nothing. The buffer is swapped for one of preferredBufferLen while it's
+    // empty, so large bodies come through in fewer, larger pieces. Marked as
+    // read with consume().
+    std::tuple<StringRef, HttpError> readView(uint32_t maxLen, uint32_t preferredBufferLen);
+
+    // Marks bytes returned by getBuffered() or readView() as read
+    void consume(uint32_t byteCount);
+
+    // Returns the buffer to the pool if it holds no unread data. The next
+    // read takes a new one.
+    void releaseBuffer();
+    bool hasBuffer() const;
+
+    // Waits for data without holding a buffer, unless some is already buffered
+    HttpError waitForData();
+
 private:
     BufferedReader(const BufferedReader&) = delete;
     BufferedReader& operator=(const BufferedReader&) = delete;
 
+    void ensureBuffer();
+    void growBuffer(uint32_t newBufferLen);
+
     StreamSource* socket;
-    std::unique_ptr<char[]> buffer;
+    PooledBuffer buffer;
+    uint32_t initialBufferLen;
     uint32_t bufferLen;
     uint32_t startIndex;
     uint32_t endIndex;
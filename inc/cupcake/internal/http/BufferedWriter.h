@@ -5,8 +5,8 @@
 #include "cupcake/text/StringRef.h"
 
 #include "cupcake/internal/http/StreamSource.h"
+#include "cupcake/internal/util/BufferPool.h"
 
-#include <memory>
 #include <tuple>
 
 namespace Cupcake {
@@ -29,7 +29,7 @@ private:
     BufferedWriter& operator=(const BufferedWriter&) = delete;
 
     StreamSource* streamSource;
-    std::unique_ptr<char[]> buffer;
+    PooledBuffer buffer;
     uint32_t index;
     uint32_t bufferLen;
 };
@@ -20,6 +20,9 @@ public:
     ~ChunkedReader() = default;
 
     std::tuple<uint32_t, HttpError> read(char* buffer, uint32_t bufferLen) override;
+    std::tuple<uint32_t, HttpError> readFully(char* buffer, uint32_t bufferLen) override;
+    std::tuple<StringRef, HttpError> readView(uint32_t maxLen) override;
+    void consume(uint32_t byteCount) override;
     HttpError close() override;
 
 private:
@@ -28,6 +31,8 @@ private:
 
     enum class ChunkedState;
 
+    HttpError nextData();
+
     BufferedReader& bufReader;
     uint64_t curLength;
     ChunkedState chunkedState;
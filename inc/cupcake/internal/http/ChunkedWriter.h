@@ -5,15 +5,24 @@
 #include "cupcake/http/Http.h"
 
 #include "cupcake/internal/http/BufferedReader.h"
+#include "cupcake/internal/util/BufferPool.h"
 
 namespace Cupcake {
 
+/*
+ * Writes the chunked transfer encoding.
+ *
+ * Small writes are gathered into a single chunk, which goes out when the
+ * buffer would overflow or on flush(). A bufferSize of 0 makes every write
+ * its own chunk.
+ */
 class ChunkedWriter : public HttpOutputStream {
 public:
     ChunkedWriter();
     ~ChunkedWriter();
 
     void init(StreamSource* streamSource);
+    void init(StreamSource* streamSource, uint32_t bufferSize);
 
     HttpError write(const char* buffer, uint32_t bufferLen) override;
     HttpError flush() override;
@@ -23,7 +32,12 @@ private:
     ChunkedWriter(const ChunkedWriter&) = delete;
     ChunkedWriter& operator=(const ChunkedWriter&) = delete;
 
+    HttpError writeChunk(const char* extra, uint32_t extraLen, bool last);
+
     StreamSource* streamSource;
+    PooledBuffer buffer;
+    uint32_t bufferSize;
+    uint32_t bufferUsed;
     bool closed;
 };
 
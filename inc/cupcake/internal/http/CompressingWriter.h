@@ -0,0 +1,55 @@
+
+#ifndef CUPCAKE_COMPRESSING_WRITER
+#define CUPCAKE_COMPRESSING_WRITER
+
+#include "cupcake/http/Http.h"
+
+#include "cupcake/internal/http/Compressor.h"
+#include "cupcake/internal/util/BufferPool.h"
+
+#include <vector>
+
+namespace Cupcake {
+
+class HttpResponseImpl;
+
+/*
+ * Compresses the response body on its way to the chunked writer.
+ *
+ * Headers aren't written until the minimum size is reached, as a response
+ * that ends before then is sent uncompressed with a Content-Length instead.
+ * This requires some special support from HttpResponseImpl.
+ */
+class CompressingWriter : public HttpOutputStream {
+public:
+    CompressingWriter();
+    ~CompressingWriter();
+
+    void init(HttpResponseImpl* responseImpl, CompressionType type, uint32_t minSize);
+
+    HttpError write(const char* buffer, uint32_t bufferLen) override;
+    HttpError flush() override;
+    HttpError close() override;
+
+private:
+    CompressingWriter(const CompressingWriter&) = delete;
+    CompressingWriter& operator=(const CompressingWriter&) = delete;
+
+    HttpError startBody();
+    HttpError compressAndWrite(const char* buffer, size_t bufferLen, Compressor::Flush flush);
+
+    HttpResponseImpl* responseImpl;
+    HttpOutputStream* outputStream;
+    CompressionType type;
+    uint32_t minSize;
+    std::vector<char> pendingContent;
+
+    Compressor compressor;
+    PooledBuffer compressBuffer;
+    size_t compressBufferUsed;
+    bool closed;
+};
+
+}
+
+#endif // CUPCAKE_COMPRESSING_WRITER
@@ -0,0 +1,42 @@
+
+#ifndef CUPCAKE_COMPRESSION_CONFIG_H
+#define CUPCAKE_COMPRESSION_CONFIG_H
+
+#include "cupcake/text/StringRef.h"
+
+#include "cupcake/internal/http/Compressor.h"
+#include "cupcake/internal/text/String.h"
+
+#include <vector>
+
+namespace Cupcake {
+
+/*
+ * Settings for compressing dynamic responses.
+ *
+ * Content types are matched ignoring parameters, and "type/(asterix)" matches
+ * the whole type. With no types added, common text formats are used.
+ */
+class CompressionConfig {
+public:
+    CompressionConfig();
+
+    void enable(uint32_t minSize);
+    void addContentType(const StringRef contentType);
+
+    bool isEnabled() const;
+    uint32_t getMinSize() const;
+    bool isCompressible(const StringRef contentType) const;
+
+    // Picks the supported coding the client weighs highest, or None
+    CompressionType chooseType(const StringRef acceptEncoding) const;
+
+private:
+    bool enabled;
+    uint32_t minSize;
+    std::vector<String> contentTypes;
+};
+
+}
+
+#endif // CUPCAKE_COMPRESSION_CONFIG_H
@@ -0,0 +1,63 @@
+
+#ifndef CUPCAKE_COMPRESSOR_H
+#define CUPCAKE_COMPRESSOR_H
+
+#include "cupcake/http/HttpError.h"
+#include "cupcake/text/StringRef.h"
+
+#include <cstddef>
+#include <tuple>
+
+namespace Cupcake {
+
+enum class CompressionType {
+    None,
+    Gzip,
+    Zstd
+};
+
+/*
+ * Streaming compressor for response bodies, backed by zlib or zstd depending
+ * on what the library was built with.
+ *
+ * Compression contexts are expensive to set up, so they're kept in a small
+ * per-thread cache and only reset between uses.
+ */
+class Compressor {
+public:
+    enum class Flush {
+        None,
+        Sync, // Everything so far is made decodable by the client
+        Finish
+    };
+
+    Compressor();
+    ~Compressor();
+
+    static bool isSupported(CompressionType type);
+
+    // The Content-Encoding token for the type
+    static StringRef getCoding(CompressionType type);
+
+    HttpError init(CompressionType type);
+
+    // Compresses from the input into the output, advancing both. Returns true once
+    // all input is consumed and, for Sync or Finish, everything has been output.
+    // Otherwise it should be called again with more output space.
+    std::tuple<bool, HttpError> compress(const char** input, size_t* inputLen,
+        char** output, size_t* outputLen, Flush flush);
+
+    // Gives the context back to the thread's cache
+    void release();
+
+private:
+    Compressor(const Compressor&) = delete;
+    Compressor& operator=(const Compressor&) = delete;
+
+    CompressionType type;
+    void* context;
+};
+
+}
+
+#endif // CUPCAKE_COMPRESSOR_H
@@ -14,6 +14,9 @@ public:
     ~ContentLengthReader() = default;
 
     std::tuple<uint32_t, HttpError> read(char* buffer, uint32_t bufferLen) override;
+    std::tuple<uint32_t, HttpError> readFully(char* buffer, uint32_t bufferLen) override;
+    std::tuple<StringRef, HttpError> readView(uint32_t maxLen) override;
+    void consume(uint32_t byteCount) override;
     HttpError close() override;
 
 private:
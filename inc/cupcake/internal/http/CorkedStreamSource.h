@@ -0,0 +1,56 @@
+
+#ifndef CUPCAKE_CORKED_STREAM_SOURCE_H
+#define CUPCAKE_CORKED_STREAM_SOURCE_H
+
+#include "cupcake/internal/http/StreamSource.h"
+
+#include <memory>
+
+namespace Cupcake {
+
+/*
+ * Holds back a set of buffers, usually the response headers, so they go out
+ * in the same write as whatever follows them instead of costing a write and
+ * a packet of their own. flush() sends them if nothing else has.
+ *
+ * Everything else passes straight through to the wrapped stream.
+ */
+class CorkedStreamSource : public StreamSource {
+public:
+    CorkedStreamSource(StreamSource* streamSource);
+
+    // The buffers must stay valid until they're written. Slots past bufferCount,
+    // up to bufferCapacity, are used to gather the following write without
+    // allocating.
+    void cork(INet::IoBuffer* buffers, uint32_t bufferCount, uint32_t bufferCapacity);
+    bool isCorked() const;
+
+    std::tuple<StreamSource*, HttpError> accept() override;
+    std::tuple<uint32_t, HttpError> read(char* buffer, uint32_t bufferLen) override;
+    std::tuple<uint32_t, HttpError> readv(INet::IoBuffer* buffers, uint32_t bufferCount) override;
+    HttpError waitReadable() override;
+    HttpError write(const char* buffer, uint32_t bufferLen) override;
+    HttpError writev(const INet::IoBuffer* buffers, uint32_t bufferCount) override;
+    HttpError flush() override;
+    HttpError close() override;
+
+    HttpError sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+        const File& file, uint64_t offset, uint64_t length) override;
+
+private:
+    CorkedStreamSource(const CorkedStreamSource&) = delete;
+    CorkedStreamSource& operator=(const CorkedStreamSource&) = delete;
+
+    // Appends the buffers to the corked ones, returning the combined list
+    const INet::IoBuffer* gather(const INet::IoBuffer* buffers, uint32_t bufferCount,
+        std::unique_ptr<INet::IoBuffer[]>* overflow);
+
+    StreamSource* streamSource;
+    INet::IoBuffer* corkedBuffers;
+    uint32_t corkedCount;
+    uint32_t corkedCapacity;
+};
+
+}
+
+#endif // CUPCAKE_CORKED_STREAM_SOURCE_H
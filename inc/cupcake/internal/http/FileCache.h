@@ -0,0 +1,90 @@
+
+#ifndef CUPCAKE_FILE_CACHE_H
+#define CUPCAKE_FILE_CACHE_H
+
+#include "cupcake/file/File.h"
+#include "cupcake/file/FileError.h"
+#include "cupcake/text/StringRef.h"
+
+#include "cupcake/internal/file/FileWatcher.h"
+#include "cupcake/internal/text/String.h"
+
+#include <memory>
+#include <tuple>
+
+namespace Cupcake {
+
+/*
+ * Cache of open files under a root directory, along with their precomputed
+ * response headers, for serving static content without an open and stat per
+ * request.
+ *
+ * Bounded both in entries and in bytes held in memory, and split into shards
+ * so lookups from different connections rarely contend on the same lock.
+ * Files no larger than the small file limit are read fully into memory and
+ * their handle closed.
+ *
+ * Lookups of missing files are cached as well. Entries are invalidated by a
+ * FileWatcher where one is available, otherwise they're reopened once they're
+ * more than a second old.
+ */
+class FileCache {
+public:
+    class Entry {
+    public:
+        Entry() = default;
+
+        File file; // Not open when the content is held in memory
+        uint64_t size;
+        std::unique_ptr<char[]> content;
+
+        String contentLength;
+        String lastModified;
+        String etag;
+        StringRef contentType;
+
+    private:
+        friend class FileCache;
+
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        bool found;
+        uint64_t loadedAt;
+    };
+
+    FileCache();
+    ~FileCache();
+
+    FileError init(const StringRef rootDir);
+    FileError init(const StringRef rootDir, uint32_t maxEntries, uint32_t smallFileLimit, uint64_t maxMemory);
+
+    // The path is relative to the root, and must already be checked to not escape it.
+    // Anything other than a regular file is reported as NotFound.
+    std::tuple<std::shared_ptr<const Entry>, FileError> get(const StringRef relativePath);
+
+    void invalidate(const StringRef relativePath);
+    void invalidateAll();
+
+private:
+    class Shard;
+
+    FileCache(const FileCache&) = delete;
+    FileCache& operator=(const FileCache&) = delete;
+
+    Shard& getShard(const StringRef relativePath);
+    void onFileChanged(const StringRef path);
+    std::tuple<std::shared_ptr<Entry>, FileError> loadEntry(const StringRef fullPath);
+
+    String rootDir;
+    uint32_t smallFileLimit;
+    uint32_t shardCount;
+    std::unique_ptr<Shard[]> shards;
+
+    FileWatcher fileWatcher;
+    bool watching;
+};
+
+}
+
+#endif // CUPCAKE_FILE_CACHE_H
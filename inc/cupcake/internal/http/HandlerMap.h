@@ -12,18 +12,51 @@
 namespace Cupcake {
 
 /*
- * Mapping of URL paths to handlers.
+ * Mapping of URL paths to handlers, per method.
+ *
+ * Each path holds a handler slot per HttpMethod, so finding the handler for
+ * a request is one trie lookup and an array index. When the path matches but
+ * the method doesn't, the methods the path does handle are returned instead
+ * for a 405 or OPTIONS response.
+ *
+ * Not safe to change while it's being read, see RouteTable for that.
  */
 class HandlerMap {
 public:
+    static const size_t METHOD_COUNT = (size_t)HttpMethod::Connect + 1;
+    static const uint32_t ALL_METHODS = (1u << METHOD_COUNT) - 1;
+
     HandlerMap() = default;
 
+    // Segments of the path can be parameters, see PathTrie. Without a method
+    // the handler takes every method.
     bool addHandler(const StringRef path, HttpHandler handler);
+    bool addHandler(HttpMethod method, const StringRef path, HttpHandler handler);
+    // For each (1 << HttpMethod) bit set. Fails if any of them is already handled.
+    bool addHandler(uint32_t methodMask, const StringRef path, HttpHandler handler);
+
+    // Compacts the map for faster lookups. No handlers can be added after.
+    void freeze();
 
-    std::tuple<HttpHandler, bool> getHandler(const StringRef path) const;
+    // Null if there is no handler for the method. The mask has a (1 << HttpMethod)
+    // bit set for each method the path has a handler for, so it's 0 when
+    // nothing matched the path at all.
+    std::tuple<const HttpHandler*, uint32_t> getHandler(HttpMethod method, const StringRef path,
+                                                        PathParams& pathParams) const;
 
 private:
-    PathTrie<HttpHandler> handlers;
+    class Route {
+    public:
+        Route() :
+            handlers(),
+            methodMask(0)
+        {}
+
+        HttpHandler handlers[METHOD_COUNT];
+        uint32_t methodMask;
+    };
+
+    PathTrie<Route> routes;
 };
 
 }
@@ -7,9 +7,12 @@
 
 #include "cupcake/http/Http.h"
 #include "cupcake/internal/http/BufferedReader.h"
-#include "cupcake/internal/http/HandlerMap.h"
+#include "cupcake/internal/http/CompressionConfig.h"
+#include "cupcake/internal/http/RouteTable.h"
 #include "cupcake/internal/http/RequestData.h"
+#include "cupcake/internal/http/RequestParser.h"
 #include "cupcake/internal/http/StreamSource.h"
+#include "cupcake/internal/util/Arena.h"
 
 #include <tuple>
 #include <vector>
@@ -26,7 +29,8 @@ public:
         H2C_Upgrade
     };
 public:
-    HttpConnection(StreamSource* streamSource, BufferedReader& bufReader, const HandlerMap* handlerMap);
+    HttpConnection(StreamSource* streamSource, BufferedReader& bufReader, const RouteTable* routeTable,
+                   const CompressionConfig* compressionConfig);
     ~HttpConnection();
 
     UpgradeType run();
@@ -49,26 +53,40 @@ private:
         bool ok() {return code == 0;}
     };
 
+    // A header the connection itself acts on, by index into requestData
+    class SpecialHeader {
+    public:
+        HttpHeader header;
+        size_t index;
+    };
+
     std::tuple<UpgradeType, HttpError> innerRun();
 
     std::tuple<bool, HttpError> checkPreface();
-    Status parseRequestLine(const StringRef line);
-    Status parseHeaderLine(const StringRef line);
+    Status parseResultStatus(RequestParser::Result parseResult);
+    Status copyRequestHead();
     Status parseSpecialHeaders();
     Status checkAndFixupHeaders();
     HttpError sendStatus(uint32_t code, const StringRef reasonPhrase);
+    HttpError sendAllowedMethods(uint32_t code, const StringRef reasonPhrase, uint32_t allowedMethods);
 
-    const HandlerMap* handlerMap;
+    const RouteTable* routeTable;
+    const CompressionConfig* compressionConfig;
     BufferedReader& bufReader;
     StreamSource* streamSource;
     HttpState state;
 
+    // Holds the strings of the current request and response
+    Arena arena;
     RequestData requestData;
     bool keepAlive;
     bool hasContentLength;
     uint64_t contentLength;
     bool isChunked;
     bool hasHost;
+
+    RequestParser requestParser;
+    std::vector<SpecialHeader> specialHeaders;
 };
 
 }
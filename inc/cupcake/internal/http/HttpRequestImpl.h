@@ -7,6 +7,7 @@
 
 #include "cupcake/internal/http/ContentLengthReader.h"
 #include "cupcake/internal/http/RequestData.h"
+#include "cupcake/internal/util/PathTrie.h"
 
 #include <memory>
 #include <vector>
@@ -16,19 +17,36 @@ namespace Cupcake {
 class HttpRequestImpl : public HttpRequest {
 public:
     HttpRequestImpl(RequestData& requestData,
+        const PathParams& pathParams,
         HttpInputStream& inputStream);
 
     const HttpMethod getMethod() const override;
     const StringRef getUrl() const override;
+    const StringRef getPath() const override;
+    const StringRef getQuery() const override;
+
+    uint32_t getQueryParamCount() const override;
+    std::tuple<StringRef, StringRef> getQueryParam(uint32_t index) const override;
+    std::tuple<StringRef, bool> getQueryParam(const StringRef name) const override;
 
     uint32_t getHeaderCount() const override;
     std::tuple<StringRef, StringRef> getHeader(uint32_t index) const override;
     std::tuple<StringRef, bool> getHeader(const StringRef headerName) const override;
+    std::tuple<StringRef, bool> getHeader(HttpHeader header) const override;
+
+    ptrdiff_t findHeader(const StringRef headerName) const override;
+    ptrdiff_t findHeader(HttpHeader header) const override;
+    ptrdiff_t findNextHeader(uint32_t index) const override;
+
+    uint32_t getPathParamCount() const override;
+    std::tuple<StringRef, StringRef> getPathParam(uint32_t index) const override;
+    std::tuple<StringRef, bool> getPathParam(const StringRef name) const override;
 
     HttpInputStream& getInputStream() override;
 
 private:
     RequestData& requestData;
+    const PathParams& pathParams;
     HttpInputStream& inputStream;
 };
 
@@ -7,9 +7,14 @@
 
 #include "cupcake/internal/http/BufferedContentLengthWriter.h"
 #include "cupcake/internal/http/ChunkedWriter.h"
+#include "cupcake/internal/http/CompressingWriter.h"
+#include "cupcake/internal/http/CompressionConfig.h"
 #include "cupcake/internal/http/ContentLengthWriter.h"
+#include "cupcake/internal/http/CorkedStreamSource.h"
 #include "cupcake/internal/http/StreamSource.h"
+#include "cupcake/internal/util/Arena.h"
 
+#include <memory>
 #include <vector>
 
 namespace Cupcake {
@@ -18,15 +23,34 @@ class HttpResponseImpl : public HttpResponse {
 public:
     // TODO: Probably need more parameters to support 100 Continue properly
     HttpResponseImpl(HttpVersion version, StreamSource* streamSource);
+    // Header strings go in the arena, which has to outlive the response
+    HttpResponseImpl(HttpVersion version, StreamSource* streamSource, Arena* arena);
+
+    // Allows the body to be compressed based on the request's Accept-Encoding.
+    // Both must outlive the response.
+    void setCompression(const CompressionConfig* compressionConfig, const StringRef acceptEncoding);
+
     void setStatus(uint32_t code, StringRef statusText) override;
     void addHeader(StringRef headerName, StringRef headerValue) override;
 
     std::tuple<HttpOutputStream*, HttpError> getOutputStream() override;
 
+    HttpError sendFile(const File& file, uint64_t offset, uint64_t length) override;
+
+    // Finishes the body if the handler didn't, and sends anything held back
     HttpError close() override;
 
+    // Whether the body ends at connection close, so the connection can't be reused
+    bool isCloseDelimited() const;
+
     // For special case of buffering data for unknown Content-Length
     HttpError writeHeadersAndBody(const char* content, size_t contentLen);
+    HttpError writeHeadersAndBody(const INet::IoBuffer* content, uint32_t contentCount, uint64_t contentLen);
+    std::tuple<StreamSource*, HttpError> startCloseDelimitedBody();
+
+    // For the compressing writer deciding whether the body ended up big enough to compress
+    std::tuple<HttpOutputStream*, HttpError> startCompressedBody(CompressionType type);
+    HttpError writeUncompressedBody(const char* content, size_t contentLen);
 
 private:
     enum class ResponseStatus;
@@ -36,17 +60,31 @@ private:
 
     HttpError parseHeaders();
     HttpError writeHeaders();
+    CompressionType chooseCompression();
+    void removeHeader(const StringRef headerName);
+    void addVary(const StringRef fieldName);
+    size_t fillHeaderBuffers(INet::IoBuffer* ioBufs, char* codeBuffer, size_t codeBufferLen);
 
     HttpVersion version;
     StreamSource* streamSource;
     ResponseStatus respStatus;
 
+    // Headers are held here until the first body write, so both go out together.
+    // Declared before the writers since they write through it.
+    CorkedStreamSource corkedSource;
+    std::unique_ptr<INet::IoBuffer[]> headerBuffers;
+    char codeBuffer[12];
+
     HttpOutputStream* httpOutputStream;
     BufferedContentLengthWriter bufferedContentLengthWriter;
     ContentLengthWriter contentLengthWriter;
     ChunkedWriter chunkedWriter;
+    CompressingWriter compressingWriter; // After the writers it may write to, so it's destroyed first
+
+    const CompressionConfig* compressionConfig;
+    StringRef acceptEncoding;
 
-    // TODO: Avoid allocations for strings
+    Arena* arena;
     uint32_t statusCode;
     String statusText;
     std::vector<String> headerNames;
@@ -55,6 +93,7 @@ private:
     bool setContentLength;
     uint64_t contentLength;
     bool setTeChunked;
+    bool closeDelimited;
 };
 
 }
@@ -0,0 +1,80 @@
+
+#ifndef CUPCAKE_HTTP_TOKENS_H
+#define CUPCAKE_HTTP_TOKENS_H
+
+#include "cupcake/http/Http.h"
+#include "cupcake/http/HttpHeader.h"
+#include "cupcake/text/StringRef.h"
+
+#include <tuple>
+
+namespace Cupcake {
+
+/*
+ * Recognition of request methods and well known header names.
+ *
+ * Header names go through a perfect hash built at compile time, so a lookup
+ * is one hash, one table load and one compare. The hash can be fed a byte at
+ * a time while the name is being scanned, and ignores ASCII case.
+ *
+ * Names are kept lowercase once they've been parsed, as HTTP2 sends them.
+ * Each well known header has a single lowercase copy of its name, so two
+ * names of known headers are the same header exactly when they point to the
+ * same chars.
+ */
+namespace HttpTokens {
+    std::tuple<HttpMethod, bool> lookupMethod(const StringRef str);
+    StringRef getMethodName(HttpMethod method);
+
+    class CharTable {
+    public:
+        char chars[256];
+    };
+
+    // tchar from https://tools.ietf.org/html/rfc7230#section-3.2.6, which
+    // is all a header name can be made of
+    constexpr CharTable buildHeaderNameChars() {
+        CharTable table = {};
+        const char* symbols = "!#$%&'*+-.^_`|~";
+        for (size_t i = 0; symbols[i] != '\0'; i++) {
+            table.chars[(uint8_t)symbols[i]] = symbols[i];
+        }
+        for (char c = '0'; c <= '9'; c++) {
+            table.chars[(uint8_t)c] = c;
+        }
+        for (char c = 'a'; c <= 'z'; c++) {
+            table.chars[(uint8_t)c] = c;
+            table.chars[(uint8_t)(c - 'a' + 'A')] = c;
+        }
+        return table;
+    }
+
+    constexpr CharTable HEADER_NAME_CHARS = buildHeaderNameChars();
+
+    // The char lowercased, or 0 if it can't be in a header name
+    constexpr char canonicalHeaderChar(char c) {
+        return HEADER_NAME_CHARS.chars[(uint8_t)c];
+    }
+
+    constexpr uint32_t HEADER_HASH_SEED = 0x116;
+
+    constexpr uint32_t hashHeaderChar(uint32_t hash, char c) {
+        // Only folds case correctly for letters, but anything that comes out
+        // equal is compared properly afterwards
+        return (hash ^ (uint8_t)(c | 0x20)) * 0x01000193;
+    }
+
+    uint32_t hashHeaderName(const StringRef name);
+
+    HttpHeader lookupHeader(const StringRef name);
+    HttpHeader lookupHeader(const StringRef name, uint32_t nameHash);
+
+    // Canonical spelling of a known header, empty for Unknown
+    StringRef getHeaderName(HttpHeader header);
+    // The one lowercase copy of a known header's name, empty for Unknown
+    StringRef getLowercaseHeaderName(HttpHeader header);
+}
+
+}
+
+#endif // CUPCAKE_HTTP_TOKENS_H
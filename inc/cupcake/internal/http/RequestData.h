@@ -3,9 +3,11 @@
 #define CUPCAKE_REQUEST_DATA
 
 #include "cupcake/http/Http.h"
+#include "cupcake/http/HttpHeader.h"
 #include "cupcake/text/StringRef.h"
 
 #include "cupcake/internal/text/String.h"
+#include "cupcake/internal/util/Arena.h"
 
 #include <vector>
 
@@ -15,11 +17,20 @@ namespace Cupcake {
  * The HTTP parser needs to be able to pass information about the initial
  * request to the HTTP2 parser, so we need a wrapper for request information.
  *
- * TODO: Generally improve allocations
+ * Headers are indexed by name as they are added, so lookups don't scan the
+ * whole list. Headers that share a name are chained together in the order
+ * they were added.
+ *
+ * Names are lowercased as they're added. Well known ones aren't copied at
+ * all, their name is HttpTokens::getLowercaseHeaderName().
+ *
+ * The URL and headers can be kept in an arena, which has to be reset after
+ * this is, not before.
  */
 class RequestData {
 public:
-    RequestData() = default;
+    RequestData();
+    explicit RequestData(Arena* arena);
 
     void setVersion(HttpVersion version);
     HttpVersion getVersion() const;
@@ -27,10 +38,24 @@ public:
     void setMethod(HttpMethod method);
     HttpMethod getMethod() const;
 
-    void setUrl(const StringRef url);
+    // Splits the request target up. False if the path doesn't decode.
+    bool setUrl(const StringRef url);
     const StringRef getUrl() const;
+    // Percent decoded, and without "." or ".." segments
+    const StringRef getPath() const;
+    // As sent, without the '?'
+    const StringRef getQuery() const;
+
+    // The query's name=value pairs, decoded. Only split up on first use.
+    size_t getQueryParamCount() const;
+    const StringRef getQueryParamName(size_t paramIndex) const;
+    const StringRef getQueryParamValue(size_t paramIndex) const;
+    // Index of the first param with the name, or -1
+    ptrdiff_t findQueryParam(const StringRef paramName) const;
 
     void addHeaderName(const StringRef headerName);
+    // For callers that already know the header and its HttpTokens name hash
+    void addHeaderName(const StringRef headerName, HttpHeader header, uint32_t nameHash);
     void addStaticHeaderName(const StringRef headerName);
     void addHeaderValue(const StringRef headerValue);
     void addStaticHeaderValue(const StringRef headerValue);
@@ -39,19 +64,59 @@ public:
     const StringRef getHeaderName(size_t headerIndex) const;
     const StringRef getHeaderValue(size_t headerIndex) const;
 
+    // Index of the first header with the name, or -1
+    ptrdiff_t findHeader(const StringRef headerName) const;
+    ptrdiff_t findHeader(HttpHeader header) const;
+    // Index of the next header with the same name as headerIndex, or -1
+    ptrdiff_t findNextHeader(size_t headerIndex) const;
+
     void reset();
 
 private:
     RequestData(const RequestData&) = delete;
     RequestData& operator=(const RequestData&) = delete;
 
-    // TODO: Probably want to allocate URL and header values our of a single buffer
-    // and remember offset/length
+    class HeaderEntry {
+    public:
+        uint32_t nameHash;
+        int32_t nextIndex;
+        HttpHeader header;
+    };
+
+    class QueryParam {
+    public:
+        StringRef name;
+        StringRef value;
+    };
+
+    void indexHeader(size_t headerIndex);
+    void appendToChain(size_t chainIndex, size_t headerIndex);
+    void growIndex();
+    void parseQuery() const;
+
+    Arena* arena;
     HttpVersion version;
     HttpMethod method;
     String url;
+    StringRef path; // Into url, or pathBuffer if it had to change
+    StringRef query;
+    std::vector<char> pathBuffer;
+
+    mutable bool queryParsed;
+    mutable std::vector<char> queryBuffer;
+    mutable std::vector<QueryParam> queryParams;
+
+    // Empty for well known headers
     std::vector<String> headerNames;
     std::vector<String> headerValues;
+
+    // Open addressed on the name hash. Slots hold 1 + the index of the first
+    // header with a name, 0 when empty. Only for names that aren't well
+    // known, those are found through knownHeaders.
+    std::vector<HeaderEntry> headerEntries;
+    std::vector<uint32_t> nameIndex;
+    size_t distinctNames;
+    int32_t knownHeaders[(size_t)HttpHeader::Count];
 };
 
 }
@@ -0,0 +1,108 @@
+
+#ifndef CUPCAKE_REQUEST_PARSER_H
+#define CUPCAKE_REQUEST_PARSER_H
+
+#include "cupcake/http/Http.h"
+#include "cupcake/http/HttpHeader.h"
+#include "cupcake/text/StringRef.h"
+
+#include <vector>
+
+namespace Cupcake {
+
+/*
+ * Resumable parser for the head of an HTTP1 request, the request line and
+ * headers up to the empty line.
+ *
+ * parse() is called with everything received since reset(), each time more
+ * arrives. It picks up at the byte it stopped at, so nothing is scanned
+ * twice. The data may move between calls, as long as it's still contiguous
+ * and in the same order, so everything parsed is kept as offsets.
+ *
+ * Header names are left as sent, but have to be tokens, so they can be
+ * lowercased a byte at a time with HttpTokens::canonicalHeaderChar().
+ */
+class RequestParser {
+public:
+    enum class Result {
+        Incomplete,
+        Complete,
+        BadRequest,
+        UnknownMethod,
+        UnsupportedVersion,
+        UriTooLong,
+        HeadTooLarge
+    };
+
+    RequestParser(uint32_t maxUrlLength, uint32_t maxHeadLength);
+
+    void reset();
+    Result parse(const char* data, size_t dataLen);
+
+    // Only valid once parse() returns Complete. Spans are looked up in the data
+    // last passed to parse().
+    HttpMethod getMethod() const;
+    HttpVersion getVersion() const;
+    StringRef getUrl(const char* data) const;
+    size_t getHeaderCount() const;
+    StringRef getHeaderName(const char* data, size_t headerIndex) const;
+    StringRef getHeaderValue(const char* data, size_t headerIndex) const;
+
+    // Which well known header this is, recognized while the name was scanned
+    HttpHeader getHeader(size_t headerIndex) const;
+    // HttpTokens::hashHeaderName() of the name
+    uint32_t getHeaderHash(size_t headerIndex) const;
+
+    // A continuation line (obs-fold), to be appended to the previous header's
+    // value. Has no name of its own.
+    bool isContinuation(size_t headerIndex) const;
+
+    // Bytes making up the head, including the empty line that ends it
+    size_t getHeadLength() const;
+
+private:
+    enum class ParseState;
+
+    class Span {
+    public:
+        uint32_t offset;
+        uint32_t length;
+
+        StringRef get(const char* data) const { return StringRef(data + offset, length); }
+    };
+
+    class HeaderSpan {
+    public:
+        Span name;
+        Span value;
+        uint32_t nameHash;
+        HttpHeader header;
+        bool continuation;
+    };
+
+    RequestParser(const RequestParser&) = delete;
+    RequestParser& operator=(const RequestParser&) = delete;
+
+    Result finishMethod(const char* data);
+    Result finishVersion(const char* data);
+    void finishName(const char* data);
+    void finishValue();
+
+    uint32_t maxUrlLength;
+    uint32_t maxHeadLength;
+
+    ParseState state;
+    uint32_t index;
+    uint32_t tokenStart;
+    uint32_t tokenEnd;
+    uint32_t nameHash;
+
+    HttpMethod method;
+    HttpVersion version;
+    Span url;
+    std::vector<HeaderSpan> headers;
+};
+
+}
+
+#endif // CUPCAKE_REQUEST_PARSER_H
@@ -0,0 +1,68 @@
+
+#ifndef CUPCAKE_ROUTE_TABLE_H
+#define CUPCAKE_ROUTE_TABLE_H
+
+#include "cupcake/http/Http.h"
+#include "cupcake/internal/text/String.h"
+#include "cupcake/text/StringRef.h"
+
+#include "cupcake/internal/http/HandlerMap.h"
+#include "cupcake/internal/util/RcuPointer.h"
+
+#include <mutex>
+#include <vector>
+
+namespace Cupcake {
+
+/*
+ * The server's routes, changeable while requests are being served.
+ *
+ * Requests look up handlers in a frozen HandlerMap snapshot that is never
+ * modified. Every change builds a new snapshot from the registered routes and
+ * swaps it in, so a request sees either all of a change or none of it, and
+ * the handler it found stays valid until its Snapshot is dropped.
+ */
+class RouteTable {
+public:
+    typedef RcuPointer<HandlerMap>::ReadGuard Snapshot;
+
+    RouteTable();
+
+    // Segments of the path can be parameters, see PathTrie. Without a method
+    // the handler takes every method.
+    bool addHandler(const StringRef path, HttpHandler handler);
+    bool addHandler(HttpMethod method, const StringRef path, HttpHandler handler);
+
+    // Serves files under rootDir for any URL under the path, which must end in '*'
+    bool addStaticHandler(const StringRef path, const StringRef rootDir);
+
+    // The path must be spelled as it was added. False if nothing was removed.
+    bool removeHandler(const StringRef path);
+    bool removeHandler(HttpMethod method, const StringRef path);
+
+    // Never blocks, and can be held across the whole request
+    Snapshot getSnapshot() const;
+
+private:
+    RouteTable(const RouteTable&) = delete;
+    RouteTable& operator=(const RouteTable&) = delete;
+
+    class RouteDefinition {
+    public:
+        String path;
+        uint32_t methodMask;
+        HttpHandler handler;
+    };
+
+    bool addRoute(uint32_t methodMask, const StringRef path, HttpHandler handler);
+    bool removeRoute(uint32_t methodMask, const StringRef path);
+    bool publish(const std::vector<RouteDefinition>& newDefinitions);
+
+    std::mutex writeMutex; // Held while changing routes
+    std::vector<RouteDefinition> definitions;
+    RcuPointer<HandlerMap> handlerMap;
+};
+
+}
+
+#endif // CUPCAKE_ROUTE_TABLE_H
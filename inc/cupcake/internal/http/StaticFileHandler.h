@@ -0,0 +1,41 @@
+
+#ifndef CUPCAKE_STATIC_FILE_HANDLER_H
+#define CUPCAKE_STATIC_FILE_HANDLER_H
+
+#include "cupcake/http/Http.h"
+#include "cupcake/text/StringRef.h"
+
+#include "cupcake/internal/http/FileCache.h"
+#include "cupcake/internal/text/String.h"
+
+#include <memory>
+
+namespace Cupcake {
+
+/*
+ * Handler that serves files from a directory on disk. The part of the URL after
+ * the prefix is treated as a path relative to the root directory.
+ *
+ * Responses carry Content-Length, Last-Modified, ETag and Content-Type, and the
+ * body is handed to the stream source as a file so it never passes through user
+ * memory when the OS supports that.
+ *
+ * Precompressed siblings ("app.js.br", "app.js.zst", "app.js.gz") are sent in
+ * place of the file when the client's Accept-Encoding prefers them.
+ *
+ * Files and their headers come from a FileCache which copies of the handler share.
+ */
+class StaticFileHandler {
+public:
+    StaticFileHandler(const StringRef urlPrefix, std::shared_ptr<FileCache> fileCache);
+
+    void operator()(HttpRequest& request, HttpResponse& response) const;
+
+private:
+    String urlPrefix;
+    std::shared_ptr<FileCache> fileCache;
+};
+
+}
+
+#endif // CUPCAKE_STATIC_FILE_HANDLER_H
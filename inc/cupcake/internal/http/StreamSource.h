@@ -2,6 +2,7 @@
 #ifndef CUPCAKE_STREAM_SOURCE_H
 #define CUPCAKE_STREAM_SOURCE_H
 
+#include "cupcake/file/File.h"
 #include "cupcake/http/HttpError.h"
 #include "cupcake/net/INet.h"
 
@@ -24,6 +25,20 @@ public:
     virtual HttpError write(const char* buffer, uint32_t bufferLen) = 0;
     virtual HttpError writev(const INet::IoBuffer* buffers, uint32_t bufferCount) = 0;
     virtual HttpError close() = 0;
+
+    // Waits until there is something to read, so a reader can put off needing
+    // a buffer. Streams that can't tell return straight away, and the read
+    // that follows waits instead.
+    virtual HttpError waitReadable();
+
+    // Pushes out anything a stream has held back. Most streams don't, so the
+    // default does nothing.
+    virtual HttpError flush();
+
+    // Writes the head buffers followed by a range of a file. Streams that can hand
+    // the file to the OS should override this, the default copies through a buffer.
+    virtual HttpError sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+        const File& file, uint64_t offset, uint64_t length);
 };
 
 }
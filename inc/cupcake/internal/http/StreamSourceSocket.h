@@ -18,10 +18,14 @@ public:
     std::tuple<StreamSource*, HttpError> accept() override;
     std::tuple<uint32_t, HttpError> read(char* buffer, uint32_t bufferLen) override;
     std::tuple<uint32_t, HttpError> readv(INet::IoBuffer* buffers, uint32_t bufferCount) override;
+    HttpError waitReadable() override;
     HttpError write(const char* buffer, uint32_t bufferLen) override;
     HttpError writev(const INet::IoBuffer* buffers, uint32_t bufferCount) override;
     HttpError close() override;
 
+    HttpError sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+        const File& file, uint64_t offset, uint64_t length) override;
+
 private:
     StreamSourceSocket(const StreamSourceSocket&) = delete;
     StreamSourceSocket& operator=(const StreamSourceSocket&) = delete;
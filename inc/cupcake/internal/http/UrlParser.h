@@ -0,0 +1,46 @@
+
+#ifndef CUPCAKE_URL_PARSER_H
+#define CUPCAKE_URL_PARSER_H
+
+#include "cupcake/text/StringRef.h"
+
+#include <tuple>
+
+namespace Cupcake {
+
+/*
+ * Splitting and cleaning up request targets.
+ *
+ * split() finds the parts in one pass, looking at 8 bytes at a time for the
+ * characters that end the path or mean it needs more work. Most paths need
+ * none, so they are used where they are without copying.
+ */
+namespace UrlParser {
+    class UrlParts {
+    public:
+        StringRef path;
+        StringRef query; // Without the '?'
+        StringRef fragment; // Without the '#'
+        bool hasEscapes; // The path has a '%'
+        bool hasDotSegments; // The path has "." or ".." segments
+    };
+
+    // Origin form "/a/b?q", absolute form "http://host/a/b?q", or "*". Anything
+    // else is treated as a path that doesn't start with '/'.
+    UrlParts split(const StringRef target);
+
+    // Decodes %XX escapes, and '+' as a space if plusIsSpace. The output needs
+    // room for input.length() bytes. Fails on a bad escape or one that decodes
+    // to NUL.
+    std::tuple<size_t, bool> percentDecode(const StringRef input, bool plusIsSpace, char* output);
+
+    bool hasDotSegments(const StringRef path);
+
+    // RFC 3986 section 5.2.4, in place. Returns the new length. ".." never
+    // goes above the root.
+    size_t removeDotSegments(char* path, size_t pathLen);
+}
+
+}
+
+#endif // CUPCAKE_URL_PARSER_H
@@ -7,7 +7,7 @@
 
 #include "cupcake/http/Http.h"
 #include "cupcake/internal/http/BufferedReader.h"
-#include "cupcake/internal/http/HandlerMap.h"
+#include "cupcake/internal/http/RouteTable.h"
 #include "cupcake/internal/http/StreamSource.h"
 
 #include <condition_variable>
@@ -27,7 +27,7 @@ class Http2Connection {
 public:
     Http2Connection(StreamSource* streamSource,
         BufferedReader& bufReader,
-        const HandlerMap* handlerMap,
+        const RouteTable* routeTable,
         bool skipPreface);
     ~Http2Connection();
 
@@ -97,7 +97,7 @@ private:
     StreamSource* streamSource;
 
     // Data for the reader
-    const HandlerMap* handlerMap;
+    const RouteTable* routeTable;
     BufferedReader& bufReader;
     char frameHeader[9];
     std::unordered_map<uint32_t, Stream> streams;
@@ -33,8 +33,11 @@ public:
     
     std::tuple<uint32_t, SocketError> read(char* buffer, uint32_t bufferLen);
     std::tuple<uint32_t, SocketError> readv(INet::IoBuffer* buffers, uint32_t bufferCount);
+    SocketError waitReadable();
     SocketError write(const char* buffer, uint32_t bufferLen);
     SocketError writev(const INet::IoBuffer* buffers, uint32_t bufferCount);
+    SocketError sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+                         const File& file, uint64_t offset, uint64_t length);
     
     SocketError shutdownRead();
     SocketError shutdownWrite();
@@ -45,13 +48,17 @@ private:
     class AcceptAwaiter;
     class ConnectAwaiter;
     class ReadAwaiter;
+    class ReadableAwaiter;
     class WriteAwaiter;
+    class SendFileAwaiter;
 
     SocketError setSocket(int newSocket, int family);
     std::tuple<SocketImpl*, SocketError> tryAccept();
     std::tuple<bool, SocketError> tryConnect(const sockaddr_storage& storage);
     std::tuple<ssize_t, SocketError> tryRead(iovec *iov, int iovcnt);
+    std::tuple<bool, SocketError> tryReadable();
     std::tuple<ssize_t, SocketError> tryWrite(iovec *iov, int iovcnt);
+    std::tuple<off_t, SocketError> trySendFile(int fileFd, off_t offset, off_t length, iovec* headers, int headerCount);
 
     int fd;
     dispatch_source_t readSource;
@@ -56,8 +56,11 @@ public:
 
     std::tuple<uint32_t, SocketError> read(char* buffer, uint32_t bufferLen);
     std::tuple<uint32_t, SocketError> readv(INet::IoBuffer* buffers, uint32_t bufferCount);
+    SocketError waitReadable();
     SocketError write(const char* buffer, uint32_t bufferLen);
     SocketError writev(const INet::IoBuffer* buffers, uint32_t bufferCount);
+    SocketError sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+                         const File& file, uint64_t offset, uint64_t length);
 
     SocketError shutdownRead();
     SocketError shutdownWrite();
@@ -69,6 +72,7 @@ private:
     class ConnectAwaiter;
     class ReadAwaiter;
     class WriteAwaiter;
+    class TransmitFileAwaiter;
 
     SocketImpl(const SocketImpl&) = delete;
     SocketImpl(SocketImpl&&) = delete;
@@ -79,6 +83,7 @@ private:
     std::future<void> connect_co(const SockAddr& sockAddr, SocketError* res);
     std::future<void> read_co(INet::IoBuffer* buffers, uint32_t bufferCount, std::tuple<uint32_t, SocketError>* res);
     std::future<void> write_co(const INet::IoBuffer* buffers, uint32_t bufferCount, SocketError* res);
+    std::future<void> transmitFile_co(char* head, uint32_t headLen, HANDLE fileHandle, uint64_t offset, uint32_t length, SocketError* res);
 
     SOCKET socket;
     PTP_IO ptpIo;
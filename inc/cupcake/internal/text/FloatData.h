@@ -0,0 +1,24 @@
+
+#ifndef CUPCAKE_FLOAT_DATA_H
+#define CUPCAKE_FLOAT_DATA_H
+
+#include <cstdint>
+
+namespace Cupcake {
+
+namespace FloatData {
+
+// 5^q for q in [-342, 308], normalized so the top bit of the high word is
+// set. {high, low} of 128 bits. Used to turn decimal into binary.
+extern const uint64_t powersOfFive[651][2];
+
+// g for k in [-324, 292], where 10^-k = beta 2^r for 2^125 <= beta < 2^126
+// and g = floor(beta) + 1. {g1, g0} with g = g1 2^63 + g0. Used to turn
+// binary into decimal.
+extern const uint64_t powersOfTen[617][2];
+
+}
+
+}
+
+#endif // CUPCAKE_FLOAT_DATA_H
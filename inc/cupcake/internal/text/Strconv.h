@@ -24,6 +24,12 @@ namespace Strconv {
     size_t uint32ToStr(uint32_t value, uint32_t radix, char* buffer, size_t bufferLen);
     size_t uint64ToStr(uint64_t value, uint32_t radix, char* buffer, size_t bufferLen);
 
+    // The shortest string that parses back to the same value, laid out the
+    // way JavaScript does: "1500", "0.015", "1.5e+300", "-Infinity", "NaN".
+    // At most 25 chars for a double and 22 for a float.
+    size_t doubleToStr(double value, char* buffer, size_t bufferLen);
+    size_t floatToStr(float value, char* buffer, size_t bufferLen);
+
     std::tuple<int32_t, bool> parseInt32(const StringRef str);
     std::tuple<int64_t, bool> parseInt64(const StringRef str);
     std::tuple<uint32_t, bool> parseUint32(const StringRef str);
@@ -33,6 +39,11 @@ namespace Strconv {
     std::tuple<int64_t, bool> parseInt64(const StringRef str, uint32_t radix);
     std::tuple<uint32_t, bool> parseUint32(const StringRef str, uint32_t radix);
     std::tuple<uint64_t, bool> parseUint64(const StringRef str, uint32_t radix);
+
+    // Correctly rounded. Takes what strtod does other than hex, a leading
+    // plus sign and surrounding whitespace, plus "Infinity" and "NaN".
+    std::tuple<double, bool> parseDouble(const StringRef str);
+    std::tuple<float, bool> parseFloat(const StringRef str);
 }
 
 }
@@ -6,16 +6,29 @@
 
 #include <functional>
 
+namespace Cupcake {
+class Arena;
+}
+
 // Usual custom c++ string class. Should avoid exposing. Designed to play nice with StringRef.
+//
+// Text too long for the short form goes on the heap, or in an Arena if the
+// String was created with one. The arena must outlive the String, and a
+// String keeps its arena for good: assigning to it copies into the arena, and
+// only moves between Strings on the same arena take the other's memory.
+// Copies are made on the heap, as they may well outlive the arena.
 class String
 {
 public:
     String();
+    explicit String(Cupcake::Arena* arena);
     String(const String& str);
     String(String&& str) noexcept;
     String(const StringRef strRef);
+    String(const StringRef strRef, Cupcake::Arena* arena);
     String(const char* cstr);
     String(const char* data, size_t dataLen);
+    ~String();
 
     String& operator=(const String& str);
     String& operator=(String&& str) noexcept;
@@ -30,6 +43,7 @@ public:
     const char* data() const;
 
     size_t hash() const;
+    size_t engHashIgnoreCase() const;
 
     const char charAt(size_t pos) const;
     const char operator[](size_t pos) const;
@@ -59,6 +73,9 @@ public:
     void trimToSize(size_t size);
     void reserve(size_t size);
 
+    // Null if on the heap
+    Cupcake::Arena* getArena() const;
+
     String& operator+=(const String& str);
     String& operator+=(const StringRef strRef);
     String& operator+=(const char* cstr);
@@ -68,6 +85,10 @@ private:
     void append_raw(const char* data, size_t dataLen);
     void append_cstr(const char* cstr, size_t cstrLen);
 
+    char* allocateData(size_t capacity);
+    // Doesn't change the form, the caller has to set it up again
+    void freeData();
+
     inline bool isLong() const;
 
     inline size_t getShortSize() const;
@@ -99,6 +120,7 @@ private:
         shortForm _short;
         longForm _long;
     };
+    Cupcake::Arena* arena;
 };
 
 const String operator+(const String& str1, const String& str2);
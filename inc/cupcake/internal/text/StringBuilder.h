@@ -0,0 +1,55 @@
+
+#ifndef CUPCAKE_STRING_BUILDER_H
+#define CUPCAKE_STRING_BUILDER_H
+
+#include "cupcake/internal/text/String.h"
+#include "cupcake/text/StringRef.h"
+
+#include <vector>
+
+namespace Cupcake {
+class Arena;
+}
+
+// Puts a String together from pieces with a single allocation, sized from
+// their total length, rather than growing it append by append.
+//
+// Pieces aren't copied until build(), so what they point to has to stay
+// around until then.
+class StringBuilder
+{
+public:
+    StringBuilder();
+
+    StringBuilder& append(const StringRef strRef);
+    StringBuilder& append(char c);
+
+    size_t length() const;
+
+    String build() const;
+    String build(Cupcake::Arena* arena) const;
+
+    void clear();
+
+private:
+    StringBuilder(const StringBuilder&) = delete;
+    StringBuilder& operator=(const StringBuilder&) = delete;
+
+    class Piece {
+    public:
+        const char* data; // Null for a single char
+        size_t dataLen;
+        char c;
+    };
+
+    void addPiece(const char* data, size_t dataLen, char c);
+
+    enum {inlinePieceCount = 8};
+
+    Piece inlinePieces[inlinePieceCount];
+    std::vector<Piece> morePieces;
+    size_t pieceCount;
+    size_t totalLength;
+};
+
+#endif // CUPCAKE_STRING_BUILDER_H
@@ -0,0 +1,30 @@
+
+#ifndef CUPCAKE_STRING_HASH_H
+#define CUPCAKE_STRING_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Cupcake {
+
+/*
+ * Keyed string hashing, SipHash-1-3 eating 8 bytes at a time.
+ *
+ * The key is random per process, so text from a client can't be picked to
+ * all land in the same bucket of a table. Don't persist the hashes or send
+ * them anywhere. The rounds make keys under about 24 bytes a few ns slower
+ * to hash than with an unkeyed multiply and add; that's the price of it.
+ */
+namespace StringHash {
+    uint64_t hash(const char* data, size_t dataLen);
+    // Equal to hash() of the text with ASCII letters lowercased
+    uint64_t hashIgnoreCase(const char* data, size_t dataLen);
+
+    // With a known key, e.g. for tests
+    uint64_t hash(const char* data, size_t dataLen, uint64_t key0, uint64_t key1);
+    uint64_t hashIgnoreCase(const char* data, size_t dataLen, uint64_t key0, uint64_t key1);
+}
+
+}
+
+#endif // CUPCAKE_STRING_HASH_H
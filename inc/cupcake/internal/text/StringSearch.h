@@ -0,0 +1,51 @@
+
+#ifndef CUPCAKE_STRING_SEARCH_H
+#define CUPCAKE_STRING_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Cupcake {
+
+/*
+ * The searching and comparing behind StringRef, vectorized where the CPU
+ * allows it.
+ *
+ * The implementation is picked on first use from what the CPU supports:
+ * AVX2 (32 bytes at a time), SSE2 (16 bytes) or plain scalar code. Searches
+ * compare the first and last character of the needle against a whole block
+ * at once and only check the rest at the positions where both match, which
+ * rules out nearly every position of real text in a couple of instructions.
+ *
+ * Case folding only touches ASCII letters. Bytes with the high bit set are
+ * compared as they are.
+ */
+namespace StringSearch {
+    enum class Level {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    // The best level this CPU can run
+    Level getSupportedLevel();
+    Level getLevel();
+    // Clamped to the supported level, for tests and benchmarks
+    void setLevel(Level level);
+
+    // First or last position of needle in data, or nullptr. An empty needle
+    // matches at the start or end respectively.
+    const char* find(const char* data, size_t dataLen, const char* needle, size_t needleLen);
+    const char* findLast(const char* data, size_t dataLen, const char* needle, size_t needleLen);
+
+    // First position of any of the chars in data, or nullptr
+    const char* findAny(const char* data, size_t dataLen, const char* chars, size_t charsLen);
+
+    bool equalsIgnoreCase(const char* a, const char* b, size_t len);
+    // Ordered as if both were lowercased, comparing bytes as unsigned like memcmp
+    int32_t compareIgnoreCase(const char* a, const char* b, size_t len);
+}
+
+}
+
+#endif // CUPCAKE_STRING_SEARCH_H
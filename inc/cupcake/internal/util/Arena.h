@@ -0,0 +1,50 @@
+
+#ifndef CUPCAKE_ARENA_H
+#define CUPCAKE_ARENA_H
+
+#include "cupcake/internal/util/BufferPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Cupcake {
+
+/*
+ * Bump allocator for memory that all goes away at once, like the strings of
+ * one request. Nothing is freed on its own, only by reset().
+ *
+ * Blocks come from the BufferPool. reset() hands back all but the first, so
+ * a connection keeps one block warm between requests and the common request
+ * doesn't allocate at all. Allocations too big to share a block get a pooled
+ * buffer of their own.
+ */
+class Arena {
+public:
+    Arena();
+
+    // Aligned to 8 bytes
+    char* allocate(size_t size);
+    // Everything allocated so far becomes invalid
+    void reset();
+
+    // Bytes handed out since the last reset
+    size_t getAllocatedSize() const;
+    size_t getBlockCount() const;
+
+private:
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    char* allocateSlow(size_t size);
+
+    std::vector<PooledBuffer> blocks; // The last one is being bumped through
+    std::vector<PooledBuffer> largeBlocks;
+    char* next;
+    char* end;
+    size_t allocatedSize;
+};
+
+}
+
+#endif // CUPCAKE_ARENA_H
@@ -0,0 +1,64 @@
+
+#ifndef CUPCAKE_BUFFER_POOL_H
+#define CUPCAKE_BUFFER_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Cupcake {
+
+/*
+ * A buffer owned by the pool. Goes back to it when destroyed or reset.
+ */
+class PooledBuffer {
+public:
+    PooledBuffer();
+    ~PooledBuffer();
+    PooledBuffer(PooledBuffer&& other);
+    PooledBuffer& operator=(PooledBuffer&& other);
+
+    char* get() const;
+    uint32_t size() const;
+    explicit operator bool() const;
+
+    void reset();
+    void swap(PooledBuffer& other);
+
+private:
+    friend class BufferPool;
+
+    PooledBuffer(char* data, uint32_t bufferSize);
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    char* data;
+    uint32_t bufferSize;
+};
+
+/*
+ * Process wide pool of I/O buffers in power of two size classes, from 1KB to
+ * 1MB, so connections don't go to the heap for every buffer they need.
+ *
+ * Each thread keeps a few free buffers of each class for itself, so the
+ * common case takes no lock. Past that they move in batches to a shared list,
+ * and past a limit there they're freed. Sizes above the largest class are
+ * allocated and freed directly.
+ */
+class BufferPool {
+public:
+    // The returned buffer's size is minSize rounded up to its size class
+    static PooledBuffer allocate(uint32_t minSize);
+    static uint32_t getClassSize(uint32_t minSize);
+
+    // Frees the buffers cached by the calling thread and in the shared lists
+    static void trim();
+
+private:
+    friend class PooledBuffer;
+
+    static void release(char* data, uint32_t bufferSize);
+};
+
+}
+
+#endif // CUPCAKE_BUFFER_POOL_H
@@ -6,49 +6,220 @@
 #include "cupcake/text/StringRef.h"
 
 #include <algorithm>
+#include <cstring>
+#include <deque>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace Cupcake {
 
+/*
+ * Values captured by the parameter segments of a path matched in a PathTrie.
+ * The values point into the path that was looked up, and the names into the
+ * trie, so neither can go away while this is in use.
+ */
+class PathParams {
+public:
+    static const size_t MAX_PARAMS = 8;
+
+    PathParams() :
+        values(),
+        count(0),
+        names(nullptr)
+    {}
+
+    size_t getCount() const {
+        return count;
+    }
+
+    StringRef getName(size_t index) const {
+        return (*names)[index];
+    }
+
+    StringRef getValue(size_t index) const {
+        return values[index];
+    }
+
+    std::tuple<StringRef, bool> get(const StringRef name) const {
+        for (size_t i = 0; i < count; i++) {
+            if (name.equals((*names)[i])) {
+                return std::make_tuple(values[i], true);
+            }
+        }
+        return std::make_tuple(StringRef(), false);
+    }
+
+    void clear() {
+        count = 0;
+        names = nullptr;
+    }
+
+private:
+    template<typename T>
+    friend class PathTrie;
+
+    StringRef values[MAX_PARAMS];
+    size_t count;
+    const std::vector<String>* names;
+};
+
 /*
  * A trie that supports lookups on paths in the form of exact matches, or paths
  * that end in '*', matching anything past that point.
+ *
+ * A whole segment can also be a parameter, "/users/{id}", matching any
+ * non-empty segment, or "{id:int}" and "{id:uuid}" for only decimal digits or
+ * a hyphenated UUID. When more than one path matches, static text wins over
+ * parameters, the more specific parameter type wins, and '*' comes last.
+ *
+ * Nodes are added to a pointer based tree, which is easy to modify but large
+ * and slow to walk. freeze() compiles that into a flat array of small nodes
+ * where each node's children sit next to each other, and no more nodes can be
+ * added.
  */
 template<typename T>
 class PathTrie {
 public:
-    PathTrie() {}
+    PathTrie() :
+        root(new TrieNode()),
+        frozenNodes(),
+        frozenLabels(),
+        frozenPrefixes(),
+        frozenValues(),
+        frozenParamNames()
+    {}
+
+    bool addNode(const StringRef path, const T& value) {
+        TrieNode* node = insertPath(path);
+        if (!node || node->hasValue) {
+            return false; // Collision or duplicate
+        }
 
-    bool addNode(const StringRef prefix, const T& value) {
-        StringRef prefixStr = prefix;
-        bool regex = prefix.endsWith('*');
-        if (regex) {
-            prefixStr = prefixStr.substring(0, prefixStr.length() - 1);
+        node->value = value;
+        node->hasValue = true;
+        return true;
+    }
+
+    // Value for exactly this path, to be modified in place. Added with a
+    // default value if it's not there yet. Null if the path can't be added.
+    T* getOrAddNode(const StringRef path) {
+        TrieNode* node = insertPath(path);
+        if (!node) {
+            return nullptr;
         }
-        return addNodeRecursive(&root, prefixStr, value, regex);
+        node->hasValue = true;
+        return &node->value;
     }
 
     std::tuple<T, bool> find(const StringRef path) const {
-        return findRecursive(&root, path);
+        PathParams params;
+        return find(path, params);
+    }
+
+    std::tuple<T, bool> find(const StringRef path, PathParams& params) const {
+        const T* value = lookup(path, params);
+        if (!value) {
+            return std::make_tuple(T(), false);
+        }
+        return std::make_tuple(*value, true);
+    }
+
+    // As find(), without copying the value out
+    const T* lookup(const StringRef path, PathParams& params) const {
+        params.clear();
+        if (root) {
+            const TrieNode* found = findRecursive(root.get(), path, 0, params);
+            if (!found) {
+                params.clear();
+                return nullptr;
+            }
+            params.names = &found->paramNames;
+            return &found->value;
+        }
+        return findFrozen(path, params);
+    }
+
+    void freeze() {
+        if (!root) {
+            return;
+        }
+
+        // Breadth first, so all of a node's children are added together
+        std::deque<std::tuple<const TrieNode*, uint32_t>> pending;
+        frozenNodes.push_back(FrozenNode());
+        frozenLabels.push_back('\0');
+        pending.push_back(std::make_tuple(root.get(), 0));
+
+        while (!pending.empty()) {
+            const TrieNode* node;
+            uint32_t frozenIndex;
+            std::tie(node, frozenIndex) = pending.front();
+            pending.pop_front();
+
+            FrozenNode frozen;
+            setFrozenPrefix(frozen, node->prefix);
+            frozen.regexEnd = node->regexEnd;
+            frozen.valueIndex = -1;
+            if (node->hasValue) {
+                frozen.valueIndex = (int32_t)frozenValues.size();
+                frozenValues.push_back(node->value);
+                frozenParamNames.push_back(node->paramNames);
+            }
+
+            frozen.firstChild = (uint32_t)frozenNodes.size();
+            frozen.childCount = 0;
+            for (uint32_t c = 0; c < 256; c++) {
+                const TrieNode* child = node->children[c].get();
+                if (child) {
+                    pending.push_back(std::make_tuple(child, (uint32_t)frozenNodes.size()));
+                    frozenNodes.push_back(FrozenNode());
+                    frozenLabels.push_back((char)c);
+                    frozen.childCount++;
+                }
+            }
+
+            // Parameter children go after the static ones, in ParamType order
+            frozen.paramMask = 0;
+            for (size_t type = 0; type < (size_t)ParamType::Count; type++) {
+                const TrieNode* child = node->paramChildren[type].get();
+                if (child) {
+                    pending.push_back(std::make_tuple(child, (uint32_t)frozenNodes.size()));
+                    frozenNodes.push_back(FrozenNode());
+                    frozenLabels.push_back('\0');
+                    frozen.paramMask |= (uint8_t)(1 << type);
+                }
+            }
+
+            frozenNodes[frozenIndex] = frozen;
+        }
+
+        root.reset();
+    }
+
+    bool isFrozen() const {
+        return !root;
     }
 
 private:
+    // In the order they are tried
+    enum class ParamType : uint8_t {
+        Int,
+        Uuid,
+        Any,
+        Count
+    };
+
     class TrieNode {
     public:
         TrieNode() :
             regexEnd(false),
             hasValue(false),
             value(),
-            children()
-        {}
-
-        TrieNode(T val) :
-            regexEnd(false),
-            hasValue(true),
-            value(val),
-            children()
+            children(),
+            paramChildren(),
+            paramNames()
         {}
 
         String prefix;
@@ -56,18 +227,174 @@ private:
         bool hasValue;
         T value;
         std::unique_ptr<TrieNode> children[256];
+        std::unique_ptr<TrieNode> paramChildren[(size_t)ParamType::Count];
+        std::vector<String> paramNames;
     };
 
-    static bool addNodeRecursive(TrieNode* root, const StringRef insertPrefix, const T& value, bool regexEnd) {
-        if (insertPrefix.length() == 0) {
-            if (root->hasValue) {
-                return false; // Duplicate
+    // Prefixes up to this long are kept in the node itself
+    static const size_t INLINE_PREFIX_LENGTH = 12;
+
+    // Alternatives a frozen lookup keeps on the stack to come back to after a
+    // dead end. Deeper ones spill to the heap.
+    static const size_t INLINE_BACKTRACK = 32;
+
+    class FrozenNode {
+    public:
+        union {
+            char inlined[INLINE_PREFIX_LENGTH];
+            uint32_t offset;
+        } prefix;
+        uint32_t prefixLength;
+        uint16_t childCount;
+        uint8_t paramMask;
+        bool regexEnd;
+        uint32_t firstChild;
+        int32_t valueIndex;
+    };
+
+    // Steps tried in turn at each node of a frozen lookup
+    enum LookupStage : uint8_t {
+        StaticStage = 0,
+        ParamStage = 1, // One per ParamType
+        WildcardStage = ParamStage + (uint8_t)ParamType::Count,
+        DoneStage
+    };
+
+    class Backtrack {
+    public:
+        uint32_t nodeIndex;
+        uint32_t pathIndex;
+        uint8_t captureCount;
+        uint8_t stage;
+    };
+
+    static std::tuple<StringRef, ParamType> parseParam(const StringRef param) {
+        ptrdiff_t typeIndex = param.indexOf(':');
+        if (typeIndex == -1) {
+            return std::make_tuple(param, ParamType::Any);
+        }
+
+        StringRef name = param.substring(0, typeIndex);
+        StringRef type = param.substring(typeIndex + 1);
+        if (type.equals("int")) {
+            return std::make_tuple(name, ParamType::Int);
+        } else if (type.equals("uuid")) {
+            return std::make_tuple(name, ParamType::Uuid);
+        }
+        return std::make_tuple(StringRef(), ParamType::Any);
+    }
+
+    static bool isHexDigit(char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    static bool matchesParam(ParamType type, const char* segment, size_t segmentLength) {
+        if (segmentLength == 0) {
+            return false;
+        }
+
+        switch (type) {
+        case ParamType::Int:
+            for (size_t i = 0; i < segmentLength; i++) {
+                if (segment[i] < '0' || segment[i] > '9') {
+                    return false;
+                }
+            }
+            return true;
+        case ParamType::Uuid:
+            // 8-4-4-4-12 hex digits
+            if (segmentLength != 36) {
+                return false;
+            }
+            for (size_t i = 0; i < segmentLength; i++) {
+                bool hyphen = (i == 8 || i == 13 || i == 18 || i == 23);
+                if (hyphen ? segment[i] != '-' : !isHexDigit(segment[i])) {
+                    return false;
+                }
             }
-            root->value = value;
-            root->hasValue = true;
-            root->regexEnd = regexEnd;
+            return true;
+        default:
             return true;
         }
+    }
+
+    static size_t findSegmentEnd(const char* path, size_t pathLength, size_t pathIndex) {
+        const char* slash = (const char*)std::memchr(path + pathIndex, '/', pathLength - pathIndex);
+        return slash ? slash - path : pathLength;
+    }
+
+    // Finds or creates the node for a path, without setting its value. Null if
+    // the path is invalid or collides with another.
+    TrieNode* insertPath(const StringRef path) {
+        if (!root) {
+            return nullptr; // Frozen
+        }
+
+        bool regex = path.endsWith('*');
+        size_t staticEnd = regex ? path.length() - 1 : path.length();
+
+        TrieNode* node = root.get();
+        std::vector<String> paramNames;
+        size_t pieceStart = 0;
+
+        do {
+            ptrdiff_t paramStart = path.indexOf('{', pieceStart);
+            if (paramStart == -1 || (size_t)paramStart >= staticEnd) {
+                break;
+            }
+
+            // Parameters take up a whole segment
+            ptrdiff_t paramEnd = path.indexOf('}', paramStart);
+            if (paramEnd == -1 || (size_t)paramEnd >= staticEnd ||
+                paramStart == 0 || path[paramStart - 1] != '/' ||
+                ((size_t)paramEnd + 1 != staticEnd && path[paramEnd + 1] != '/')) {
+                return nullptr;
+            }
+
+            StringRef paramName;
+            ParamType paramType;
+            std::tie(paramName, paramType) = parseParam(path.substring(paramStart + 1, paramEnd));
+            if (paramName.length() == 0 || paramNames.size() == PathParams::MAX_PARAMS) {
+                return nullptr;
+            }
+            paramNames.push_back(paramName);
+
+            node = insertStatic(node, path.substring(pieceStart, paramStart), false);
+            if (!node) {
+                return nullptr;
+            }
+
+            std::unique_ptr<TrieNode>& paramChild = node->paramChildren[(size_t)paramType];
+            if (!paramChild) {
+                paramChild.reset(new TrieNode());
+            }
+            node = paramChild.get();
+            pieceStart = paramEnd + 1;
+        } while (true);
+
+        node = insertStatic(node, path.substring(pieceStart, staticEnd), regex);
+        if (!node) {
+            return nullptr;
+        }
+
+        if (node->hasValue) {
+            // Only the same path again, not just one that lands on the same node
+            if (node->regexEnd != regex || node->paramNames.size() != paramNames.size() ||
+                !std::equal(paramNames.begin(), paramNames.end(), node->paramNames.begin())) {
+                return nullptr;
+            }
+        } else {
+            node->regexEnd = regex;
+            node->paramNames.swap(paramNames);
+        }
+        return node;
+    }
+
+    // Returns the node for exactly insertPrefix below root, creating it if needed
+    static TrieNode* insertStatic(TrieNode* root, const StringRef insertPrefix, bool regexEnd) {
+        if (insertPrefix.length() == 0) {
+            return root;
+        }
 
         unsigned char c = (unsigned char)insertPrefix.charAt(0);
 
@@ -86,29 +413,31 @@ private:
 
             if (anyDiff) {
                 std::unique_ptr<TrieNode> commonNode(new TrieNode());
-                std::unique_ptr<TrieNode> insertedNode(new TrieNode(value));
+                std::unique_ptr<TrieNode> insertedNode(new TrieNode());
+                TrieNode* inserted = insertedNode.get();
 
                 commonNode->prefix = insertPrefix.substring(0, diffIndex);
                 child->prefix = child->prefix.substring(diffIndex);
 
                 insertedNode->prefix = insertPrefix.substring(diffIndex);
-                insertedNode->regexEnd = regexEnd;
 
                 commonNode->children[(unsigned char)child->prefix[0]].swap(root->children[c]); // need to assign the unique_ptr
                 commonNode->children[(unsigned char)insertedNode->prefix[0]].swap(insertedNode);
                 root->children[c].swap(commonNode);
+                return inserted;
             } else {
                 if (child->prefix.length() <= insertPrefix.length()) {
-                    return addNodeRecursive(child, insertPrefix.substring(child->prefix.length()), value, regexEnd);
+                    return insertStatic(child, insertPrefix.substring(child->prefix.length()), regexEnd);
                 }
 
                 // Regex would be a collision here
                 if (regexEnd) {
-                    return false;
+                    return nullptr;
                 }
 
                 // Create a new shorter node with the common prefix portion
-                std::unique_ptr<TrieNode> shorterNode(new TrieNode(value));
+                std::unique_ptr<TrieNode> shorterNode(new TrieNode());
+                TrieNode* shorter = shorterNode.get();
                 shorterNode->prefix = child->prefix.substring(0, insertPrefix.length());
 
                 // Make the current child the not-common suffix, and make it a child of the shorter node
@@ -117,44 +446,201 @@ private:
 
                 // Replace the current child with the shorter node
                 root->children[c].swap(shorterNode);
+                return shorter;
             }
 
         } else {
-            std::unique_ptr<TrieNode> newChild(new TrieNode(value));
+            std::unique_ptr<TrieNode> newChild(new TrieNode());
+            TrieNode* inserted = newChild.get();
             newChild->prefix = insertPrefix;
-            newChild->regexEnd = regexEnd;
             root->children[c].swap(newChild);
+            return inserted;
         }
-
-        return true;
     }
 
-    static std::tuple<T, bool> findRecursive(const TrieNode* root, const StringRef pathSuffix) {
-        if (pathSuffix.length() == 0) {
-            if (!root->hasValue) {
-                return std::make_tuple(T(), false);
+    static const TrieNode* findRecursive(const TrieNode* root, const StringRef path, size_t pathIndex,
+                                         PathParams& params) {
+        size_t remaining = path.length() - pathIndex;
+        if (remaining == 0) {
+            return root->hasValue ? root : nullptr;
+        }
+
+        unsigned char c = (unsigned char)path[pathIndex];
+        const TrieNode* child = root->children[c].get();
+        if (child && child->prefix.length() <= remaining &&
+            std::memcmp(child->prefix.data(), path.data() + pathIndex, child->prefix.length()) == 0) {
+            const TrieNode* found = findRecursive(child, path, pathIndex + child->prefix.length(), params);
+            if (found) {
+                return found;
             }
-            return std::make_tuple(root->value, true);
         }
 
-        if (root->regexEnd) {
-            return std::make_tuple(root->value, true);
+        size_t captureIndex = params.count;
+        if (captureIndex < PathParams::MAX_PARAMS) {
+            size_t segmentEnd = findSegmentEnd(path.data(), path.length(), pathIndex);
+            for (size_t type = 0; type < (size_t)ParamType::Count; type++) {
+                const TrieNode* paramChild = root->paramChildren[type].get();
+                if (!paramChild || !matchesParam((ParamType)type, path.data() + pathIndex, segmentEnd - pathIndex)) {
+                    continue;
+                }
+
+                params.values[captureIndex] = path.substring(pathIndex, segmentEnd);
+                params.count = captureIndex + 1;
+                const TrieNode* found = findRecursive(paramChild, path, segmentEnd, params);
+                if (found) {
+                    return found;
+                }
+                params.count = captureIndex;
+            }
         }
 
-        unsigned char c = (unsigned char)pathSuffix[0];
-        TrieNode* child = root->children[c].get();
-        if (!child || child->prefix.length() > pathSuffix.length()) {
-            return std::make_tuple(T(), false);
+        if (root->regexEnd && root->hasValue) {
+            return root;
         }
+        return nullptr;
+    }
 
-        if (!pathSuffix.startsWith(child->prefix)) {
-            return std::make_tuple(T(), false);
+    void setFrozenPrefix(FrozenNode& frozen, const StringRef prefix) {
+        frozen.prefixLength = (uint32_t)prefix.length();
+        if (prefix.length() <= INLINE_PREFIX_LENGTH) {
+            std::memcpy(frozen.prefix.inlined, prefix.data(), prefix.length());
+        } else {
+            frozen.prefix.offset = (uint32_t)frozenPrefixes.size();
+            frozenPrefixes.insert(frozenPrefixes.end(), prefix.data(), prefix.data() + prefix.length());
         }
+    }
 
-        return findRecursive(child, pathSuffix.substring(child->prefix.length()));
+    const char* getFrozenPrefix(const FrozenNode& frozen) const {
+        if (frozen.prefixLength <= INLINE_PREFIX_LENGTH) {
+            return frozen.prefix.inlined;
+        }
+        return frozenPrefixes.data() + frozen.prefix.offset;
     }
 
-    TrieNode root;
+    const T* findFrozen(const StringRef path, PathParams& params) const {
+        const char* pathData = path.data();
+        size_t pathLength = path.length();
+
+        uint32_t nodeIndex = 0;
+        size_t pathIndex = 0;
+        size_t captureCount = 0;
+        uint8_t stage = StaticStage;
+
+        Backtrack backtrack[INLINE_BACKTRACK];
+        size_t backtrackDepth = 0;
+        std::vector<Backtrack> backtrackOverflow; // Only used once backtrack is full
+
+        while (true) {
+            const FrozenNode& node = frozenNodes[nodeIndex];
+            int32_t matchIndex = -1;
+            bool descended = false;
+
+            if (pathIndex == pathLength) {
+                matchIndex = node.valueIndex;
+                stage = DoneStage;
+            }
+
+            for (; stage < DoneStage && !descended && matchIndex == -1; stage++) {
+                uint32_t nextNode;
+                size_t nextPathIndex;
+
+                if (stage == StaticStage) {
+                    // Child labels are contiguous, so this is one short memchr
+                    const char* labels = frozenLabels.data() + node.firstChild;
+                    const char* label = (const char*)std::memchr(labels, pathData[pathIndex], node.childCount);
+                    if (label == nullptr) {
+                        continue;
+                    }
+
+                    nextNode = node.firstChild + (uint32_t)(label - labels);
+                    const FrozenNode& child = frozenNodes[nextNode];
+                    if (child.prefixLength > pathLength - pathIndex ||
+                        std::memcmp(getFrozenPrefix(child), pathData + pathIndex, child.prefixLength) != 0) {
+                        continue;
+                    }
+                    nextPathIndex = pathIndex + child.prefixLength;
+                } else if (stage < WildcardStage) {
+                    uint8_t typeBit = (uint8_t)(1 << (stage - ParamStage));
+                    if (!(node.paramMask & typeBit) || captureCount == PathParams::MAX_PARAMS) {
+                        continue;
+                    }
+
+                    size_t segmentEnd = findSegmentEnd(pathData, pathLength, pathIndex);
+                    if (!matchesParam((ParamType)(stage - ParamStage), pathData + pathIndex, segmentEnd - pathIndex)) {
+                        continue;
+                    }
+
+                    // Parameter children follow the static ones
+                    uint32_t paramOffset = 0;
+                    for (uint8_t mask = node.paramMask & (typeBit - 1); mask != 0; mask &= mask - 1) {
+                        paramOffset++;
+                    }
+                    nextNode = node.firstChild + node.childCount + paramOffset;
+                    nextPathIndex = segmentEnd;
+                    params.values[captureCount++] = StringRef(pathData + pathIndex, segmentEnd - pathIndex);
+                } else {
+                    if (node.regexEnd) {
+                        matchIndex = node.valueIndex;
+                    }
+                    continue;
+                }
+
+                // Come back for the remaining stages if this branch is a dead end
+                bool moreStages = node.paramMask != 0 || node.regexEnd;
+                if (moreStages) {
+                    Backtrack entry;
+                    entry.nodeIndex = nodeIndex;
+                    entry.pathIndex = (uint32_t)pathIndex;
+                    entry.captureCount = (uint8_t)(captureCount - (stage == StaticStage ? 0 : 1));
+                    entry.stage = stage + 1;
+                    if (backtrackDepth < INLINE_BACKTRACK) {
+                        backtrack[backtrackDepth++] = entry;
+                    } else {
+                        backtrackOverflow.push_back(entry);
+                    }
+                }
+
+                nodeIndex = nextNode;
+                pathIndex = nextPathIndex;
+                descended = true;
+            }
+
+            if (matchIndex != -1) {
+                params.count = captureCount;
+                params.names = &frozenParamNames[matchIndex];
+                return &frozenValues[matchIndex];
+            }
+
+            if (descended) {
+                stage = StaticStage;
+                continue;
+            }
+
+            Backtrack entry;
+            if (!backtrackOverflow.empty()) {
+                entry = backtrackOverflow.back();
+                backtrackOverflow.pop_back();
+            } else if (backtrackDepth != 0) {
+                entry = backtrack[--backtrackDepth];
+            } else {
+                params.clear();
+                return nullptr;
+            }
+            nodeIndex = entry.nodeIndex;
+            pathIndex = entry.pathIndex;
+            captureCount = entry.captureCount;
+            stage = entry.stage;
+        }
+    }
+
+    // Released once frozen
+    std::unique_ptr<TrieNode> root;
+
+    std::vector<FrozenNode> frozenNodes;
+    std::vector<char> frozenLabels; // First prefix character of each node
+    std::vector<char> frozenPrefixes;
+    std::vector<T> frozenValues;
+    std::vector<std::vector<String>> frozenParamNames; // Alongside frozenValues
 };
 
 }
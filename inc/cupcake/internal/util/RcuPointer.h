@@ -0,0 +1,134 @@
+
+#ifndef CUPCAKE_RCU_POINTER_H
+#define CUPCAKE_RCU_POINTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace Cupcake {
+
+/*
+ * Owning pointer to an immutable value that can be replaced while other
+ * threads are reading it.
+ *
+ * Readers take a ReadGuard, which keeps the value they saw alive until the
+ * guard is destroyed. Taking and dropping a guard is a fixed handful of
+ * atomic operations, so readers never wait on writers or each other.
+ *
+ * Replaced values are reclaimed by epoch. Readers count themselves into one
+ * of two counters picked by the parity of the epoch. A writer only advances
+ * the epoch once the counter the next epoch will reuse has drained, and a
+ * replaced value is freed after two advances, by which point every reader
+ * that could have seen it has left. Writers never wait for readers either;
+ * anything they can't free yet is retried on the next publish.
+ *
+ * Writers must be serialized by the caller.
+ */
+template <typename T>
+class RcuPointer {
+public:
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) :
+            readerCount(other.readerCount),
+            value(other.value)
+        {
+            other.readerCount = nullptr;
+        }
+
+        ~ReadGuard() {
+            if (readerCount) {
+                readerCount->fetch_sub(1);
+            }
+        }
+
+        const T* get() const {return value;}
+        const T* operator->() const {return value;}
+
+    private:
+        friend class RcuPointer;
+
+        ReadGuard(const RcuPointer* owner) :
+            readerCount(&owner->readers[owner->epoch.load() & 1]),
+            value(nullptr)
+        {
+            // The count has to be visible before the pointer is read, so a
+            // writer that doesn't see it is one whose swap we'll see
+            readerCount->fetch_add(1);
+            value = owner->current.load();
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+
+        std::atomic<uint32_t>* readerCount;
+        const T* value;
+    };
+
+    RcuPointer(std::unique_ptr<T> value) :
+        current(value.release()),
+        epoch(0),
+        readers(),
+        retired()
+    {}
+
+    // No readers may be left
+    ~RcuPointer() {
+        delete current.load();
+    }
+
+    ReadGuard read() const {
+        return ReadGuard(this);
+    }
+
+    void publish(std::unique_ptr<T> value) {
+        const T* previous = current.exchange(value.release());
+        retired.emplace_back(std::unique_ptr<const T>(previous), epoch.load());
+        reclaim();
+    }
+
+    // How many replaced values are still waiting on readers
+    size_t getRetiredCount() const {
+        return retired.size();
+    }
+
+private:
+    RcuPointer(const RcuPointer&) = delete;
+    RcuPointer& operator=(const RcuPointer&) = delete;
+
+    void reclaim() {
+        while (!retired.empty()) {
+            uint64_t currentEpoch = epoch.load();
+            if (readers[(currentEpoch + 1) & 1].load() != 0) {
+                break;
+            }
+            epoch.store(currentEpoch + 1);
+
+            size_t kept = 0;
+            for (size_t i = 0; i < retired.size(); i++) {
+                if (std::get<1>(retired[i]) + 2 > currentEpoch + 1) {
+                    if (kept != i) {
+                        retired[kept] = std::move(retired[i]);
+                    }
+                    kept++;
+                }
+            }
+            retired.resize(kept);
+        }
+    }
+
+    std::atomic<const T*> current;
+    std::atomic<uint64_t> epoch;
+    mutable std::atomic<uint32_t> readers[2];
+
+    // Replaced values and the epoch they were replaced in
+    std::vector<std::tuple<std::unique_ptr<const T>, uint64_t>> retired;
+};
+
+}
+
+#endif // CUPCAKE_RCU_POINTER_H
@@ -2,6 +2,7 @@
 #ifndef CUPCAKE_SOCKET_H
 #define CUPCAKE_SOCKET_H
 
+#include "cupcake/file/File.h"
 #include "cupcake/net/SockAddr.h"
 #include "cupcake/net/SocketError.h"
 #include "cupcake/text/StringRef.h"
@@ -39,8 +40,13 @@ public:
 
     std::tuple<uint32_t, SocketError> read(char* buffer, uint32_t bufferLen);
     std::tuple<uint32_t, SocketError> readv(INet::IoBuffer* buffers, uint32_t bufferCount);
+
+    // Waits until a read would not block, without needing a buffer to read into
+    SocketError waitReadable();
     SocketError write(const char* buffer, uint32_t bufferLen);
     SocketError writev(const INet::IoBuffer* buffers, uint32_t bufferCount);
+    SocketError sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+                         const File& file, uint64_t offset, uint64_t length);
 
     SocketError shutdownRead();
     SocketError shutdownWrite();
@@ -31,7 +31,10 @@ public:
 
     const char* data() const;
 
+    // Keyed per process, so only stable within one run
     size_t hash() const;
+    // Same for any ASCII case of the text
+    size_t engHashIgnoreCase() const;
 
     bool equals(const StringRef strRef) const;
 
@@ -43,6 +46,10 @@ public:
     ptrdiff_t indexOf(const StringRef strRef) const;
     ptrdiff_t indexOf(const StringRef strRef, size_t startIndex) const;
 
+    // First position of any of the given chars
+    ptrdiff_t indexOfAny(const StringRef chars) const;
+    ptrdiff_t indexOfAny(const StringRef chars, size_t startIndex) const;
+
     ptrdiff_t lastIndexOf(char c) const;
     ptrdiff_t lastIndexOf(char c, size_t startIndex) const;
     ptrdiff_t lastIndexOf(const StringRef strRef) const;
@@ -0,0 +1,180 @@
+
+#ifdef __linux__
+
+#include "cupcake/internal/file/FileWatcher.h"
+
+#include "cupcake/internal/CString.h"
+
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+using namespace Cupcake;
+
+#define WATCH_EVENTS (IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_DELETE_SELF | \
+                      IN_MODIFY | IN_MOVE_SELF | IN_MOVED_FROM | IN_MOVED_TO)
+
+static FileError getFileError(int errVal) {
+    switch (errVal) {
+        case ENOENT:
+        case ENOTDIR:
+            return FileError::NotFound;
+        case EACCES:
+        case EPERM:
+            return FileError::AccessDenied;
+        case EMFILE:
+        case ENFILE:
+        case ENOSPC: // Out of watches
+            return FileError::TooManyHandles;
+        case ENOMEM:
+            return FileError::OutOfMemory;
+        case EINVAL:
+            return FileError::InvalidArgument;
+        default:
+            return FileError::Unknown;
+    }
+}
+
+FileWatcher::FileWatcher() :
+    inotifyFd(-1),
+    wakeFds{-1, -1}
+{}
+
+FileWatcher::~FileWatcher() {
+    close();
+}
+
+FileError FileWatcher::init(ChangeCallback callback) {
+    if (inotifyFd != -1) {
+        return FileError::InvalidState;
+    }
+
+    int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd == -1) {
+        return getFileError(errno);
+    }
+
+    // Used to wake the watch thread up for shutdown
+    if (::pipe2(wakeFds, O_CLOEXEC) == -1) {
+        int err = errno;
+        ::close(fd);
+        return getFileError(err);
+    }
+
+    inotifyFd = fd;
+    this->callback = callback;
+    watchThread = std::thread([this] { watchLoop(); });
+    return FileError::Ok;
+}
+
+void FileWatcher::close() {
+    if (inotifyFd == -1) {
+        return;
+    }
+
+    char wake = 0;
+    while (::write(wakeFds[1], &wake, 1) == -1 && errno == EINTR) {}
+    watchThread.join();
+
+    ::close(wakeFds[0]);
+    ::close(wakeFds[1]);
+    ::close(inotifyFd);
+    wakeFds[0] = -1;
+    wakeFds[1] = -1;
+    inotifyFd = -1;
+
+    watchDirs.clear();
+    watchDescriptors.clear();
+}
+
+FileError FileWatcher::watchDirectory(const StringRef dirPath) {
+    if (inotifyFd == -1) {
+        return FileError::InvalidState;
+    }
+
+    std::lock_guard<std::mutex> lock(watchMutex);
+    String dirStr(dirPath);
+    if (watchDescriptors.find(dirStr) != watchDescriptors.end()) {
+        return FileError::Ok;
+    }
+
+    CStringBuf pathBuf(dirPath);
+    int wd = ::inotify_add_watch(inotifyFd, pathBuf.get(), WATCH_EVENTS | IN_ONLYDIR);
+    if (wd == -1) {
+        return getFileError(errno);
+    }
+
+    watchDirs[wd] = dirStr;
+    watchDescriptors[dirStr] = wd;
+    return FileError::Ok;
+}
+
+void FileWatcher::watchLoop() {
+    // Aligned as required for reading inotify_event structs out of it
+    alignas(struct inotify_event) char eventBuf[4096];
+
+    pollfd pollFds[2];
+    pollFds[0].fd = inotifyFd;
+    pollFds[0].events = POLLIN;
+    pollFds[1].fd = wakeFds[0];
+    pollFds[1].events = POLLIN;
+
+    while (true) {
+        int res = ::poll(pollFds, 2, -1);
+        if (res == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            callback(StringRef("", 0));
+            return;
+        }
+        if (pollFds[1].revents != 0) {
+            return;
+        }
+
+        ssize_t bytesRead = ::read(inotifyFd, eventBuf, sizeof(eventBuf));
+        if (bytesRead <= 0) {
+            continue;
+        }
+
+        for (ssize_t offset = 0; offset < bytesRead;) {
+            const inotify_event* event = (const inotify_event*)(eventBuf + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                callback(StringRef("", 0));
+                continue;
+            }
+
+            String changedPath;
+            {
+                std::lock_guard<std::mutex> lock(watchMutex);
+                auto dirIter = watchDirs.find(event->wd);
+                if (dirIter == watchDirs.end()) {
+                    continue;
+                }
+                changedPath = dirIter->second;
+
+                // The directory itself went away, so the watch is gone too
+                if ((event->mask & IN_IGNORED) != 0) {
+                    watchDescriptors.erase(dirIter->second);
+                    watchDirs.erase(dirIter);
+                }
+            }
+
+            if (event->len == 0) {
+                // Event on the directory itself, report everything under it as changed
+                callback(StringRef("", 0));
+            } else {
+                changedPath.appendChar('/');
+                changedPath.append(event->name, std::strlen(event->name));
+                callback(changedPath);
+            }
+        }
+    }
+}
+
+#endif // __linux__
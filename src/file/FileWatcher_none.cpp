@@ -0,0 +1,24 @@
+
+#ifndef __linux__
+
+#include "cupcake/internal/file/FileWatcher.h"
+
+using namespace Cupcake;
+
+// TODO: ReadDirectoryChangesW on Windows, kqueue on Darwin
+
+FileWatcher::FileWatcher() {}
+
+FileWatcher::~FileWatcher() {}
+
+FileError FileWatcher::init(ChangeCallback callback) {
+    return FileError::InvalidState;
+}
+
+void FileWatcher::close() {}
+
+FileError FileWatcher::watchDirectory(const StringRef dirPath) {
+    return FileError::InvalidState;
+}
+
+#endif // !__linux__
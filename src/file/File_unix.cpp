@@ -0,0 +1,155 @@
+
+#ifndef _WIN32
+
+#include "cupcake/file/File.h"
+
+#include "cupcake/internal/CString.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Cupcake;
+
+static FileError getFileError(int errVal) {
+    switch (errVal) {
+        case ENOENT:
+        case ENOTDIR:
+        case ELOOP:
+            return FileError::NotFound;
+        case EACCES:
+        case EPERM:
+            return FileError::AccessDenied;
+        case EMFILE:
+        case ENFILE:
+            return FileError::TooManyHandles;
+        case ENOMEM:
+            return FileError::OutOfMemory;
+        case EINVAL:
+        case ENAMETOOLONG:
+            return FileError::InvalidArgument;
+        case EBADF:
+            return FileError::InvalidState;
+        case EIO:
+            return FileError::IoError;
+        default:
+            return FileError::Unknown;
+    }
+}
+
+File::File() :
+    handle(-1),
+    regular(false),
+    size(0),
+    modifiedTime(0)
+{}
+
+File::~File() {
+    close();
+}
+
+File::File(File&& other) :
+    handle(other.handle),
+    regular(other.regular),
+    size(other.size),
+    modifiedTime(other.modifiedTime)
+{
+    other.handle = -1;
+}
+
+File& File::operator=(File&& other) {
+    if (this != &other) {
+        close();
+        handle = other.handle;
+        regular = other.regular;
+        size = other.size;
+        modifiedTime = other.modifiedTime;
+        other.handle = -1;
+    }
+    return *this;
+}
+
+FileError File::open(const StringRef path) {
+    if (handle != -1) {
+        return FileError::InvalidState;
+    }
+
+    CStringBuf pathBuf(path);
+
+    int flags = O_RDONLY;
+#ifdef O_CLOEXEC
+    flags |= O_CLOEXEC;
+#endif
+
+    int fd;
+    do {
+        fd = ::open(pathBuf.get(), flags);
+    } while (fd == -1 && errno == EINTR);
+
+    if (fd == -1) {
+        return getFileError(errno);
+    }
+
+    struct stat statBuf;
+    if (::fstat(fd, &statBuf) == -1) {
+        int err = errno;
+        ::close(fd);
+        return getFileError(err);
+    }
+
+    handle = fd;
+    regular = S_ISREG(statBuf.st_mode);
+    size = (uint64_t)statBuf.st_size;
+    modifiedTime = statBuf.st_mtime < 0 ? 0 : (uint64_t)statBuf.st_mtime;
+    return FileError::Ok;
+}
+
+FileError File::close() {
+    if (handle != -1) {
+        int closeRes = ::close(handle);
+        handle = -1;
+        if (closeRes == -1) {
+            return getFileError(errno);
+        }
+    }
+    return FileError::Ok;
+}
+
+bool File::isOpen() const {
+    return handle != -1;
+}
+
+bool File::isRegular() const {
+    return regular;
+}
+
+uint64_t File::getSize() const {
+    return size;
+}
+
+uint64_t File::getModifiedTime() const {
+    return modifiedTime;
+}
+
+std::tuple<uint32_t, FileError> File::read(uint64_t offset, char* buffer, uint32_t bufferLen) const {
+    if (handle == -1) {
+        return std::make_tuple(0, FileError::InvalidState);
+    }
+
+    ssize_t res;
+    do {
+        res = ::pread(handle, buffer, bufferLen, (off_t)offset);
+    } while (res == -1 && errno == EINTR);
+
+    if (res == -1) {
+        return std::make_tuple(0, getFileError(errno));
+    }
+    return std::make_tuple((uint32_t)res, FileError::Ok);
+}
+
+File::NativeHandle File::getNativeHandle() const {
+    return handle;
+}
+
+#endif // !_WIN32
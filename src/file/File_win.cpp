@@ -0,0 +1,169 @@
+
+#ifdef _WIN32
+
+#include "cupcake/file/File.h"
+
+#include "cupcake/internal/CString.h"
+
+#include <Windows.h>
+
+using namespace Cupcake;
+
+// Difference between the Windows epoch (1601) and the unix one (1970) in 100ns units
+#define WINDOWS_EPOCH_OFFSET 116444736000000000ULL
+
+static FileError getFileError(DWORD errVal) {
+    switch (errVal) {
+    case ERROR_FILE_NOT_FOUND:
+    case ERROR_PATH_NOT_FOUND:
+    case ERROR_INVALID_DRIVE:
+        return FileError::NotFound;
+    case ERROR_ACCESS_DENIED:
+    case ERROR_SHARING_VIOLATION:
+    case ERROR_LOCK_VIOLATION:
+        return FileError::AccessDenied;
+    case ERROR_TOO_MANY_OPEN_FILES:
+        return FileError::TooManyHandles;
+    case ERROR_NOT_ENOUGH_MEMORY:
+    case ERROR_OUTOFMEMORY:
+        return FileError::OutOfMemory;
+    case ERROR_INVALID_NAME:
+    case ERROR_INVALID_PARAMETER:
+    case ERROR_FILENAME_EXCED_RANGE:
+        return FileError::InvalidArgument;
+    case ERROR_INVALID_HANDLE:
+        return FileError::InvalidState;
+    case ERROR_NO_UNICODE_TRANSLATION:
+        return FileError::InvalidText;
+    default:
+        return FileError::Unknown;
+    }
+}
+
+File::File() :
+    handle(INVALID_HANDLE_VALUE),
+    regular(false),
+    size(0),
+    modifiedTime(0)
+{}
+
+File::~File() {
+    close();
+}
+
+File::File(File&& other) :
+    handle(other.handle),
+    regular(other.regular),
+    size(other.size),
+    modifiedTime(other.modifiedTime)
+{
+    other.handle = INVALID_HANDLE_VALUE;
+}
+
+File& File::operator=(File&& other) {
+    if (this != &other) {
+        close();
+        handle = other.handle;
+        regular = other.regular;
+        size = other.size;
+        modifiedTime = other.modifiedTime;
+        other.handle = INVALID_HANDLE_VALUE;
+    }
+    return *this;
+}
+
+FileError File::open(const StringRef path) {
+    if (handle != INVALID_HANDLE_VALUE) {
+        return FileError::InvalidState;
+    }
+
+    WinPathBuf pathBuf(path);
+    if (pathBuf.error()) {
+        return FileError::InvalidText;
+    }
+
+    // Backup semantics is required to open directories, which we want to be
+    // able to report as not regular rather than failing oddly.
+    HANDLE fileHandle = ::CreateFileW(pathBuf.get(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_BACKUP_SEMANTICS,
+        NULL);
+
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return getFileError(::GetLastError());
+    }
+
+    BY_HANDLE_FILE_INFORMATION fileInfo;
+    if (!::GetFileInformationByHandle(fileHandle, &fileInfo)) {
+        DWORD err = ::GetLastError();
+        ::CloseHandle(fileHandle);
+        return getFileError(err);
+    }
+
+    uint64_t writeTime = ((uint64_t)fileInfo.ftLastWriteTime.dwHighDateTime << 32) |
+        fileInfo.ftLastWriteTime.dwLowDateTime;
+
+    handle = fileHandle;
+    regular = (fileInfo.dwFileAttributes & (FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_DEVICE)) == 0;
+    size = ((uint64_t)fileInfo.nFileSizeHigh << 32) | fileInfo.nFileSizeLow;
+    modifiedTime = writeTime < WINDOWS_EPOCH_OFFSET ? 0 : (writeTime - WINDOWS_EPOCH_OFFSET) / 10000000;
+    return FileError::Ok;
+}
+
+FileError File::close() {
+    if (handle != INVALID_HANDLE_VALUE) {
+        BOOL closeRes = ::CloseHandle(handle);
+        handle = INVALID_HANDLE_VALUE;
+        if (!closeRes) {
+            return getFileError(::GetLastError());
+        }
+    }
+    return FileError::Ok;
+}
+
+bool File::isOpen() const {
+    return handle != INVALID_HANDLE_VALUE;
+}
+
+bool File::isRegular() const {
+    return regular;
+}
+
+uint64_t File::getSize() const {
+    return size;
+}
+
+uint64_t File::getModifiedTime() const {
+    return modifiedTime;
+}
+
+std::tuple<uint32_t, FileError> File::read(uint64_t offset, char* buffer, uint32_t bufferLen) const {
+    if (handle == INVALID_HANDLE_VALUE) {
+        return std::make_tuple(0, FileError::InvalidState);
+    }
+
+    // An OVERLAPPED on a synchronous handle just supplies the offset
+    OVERLAPPED overlapped;
+    std::memset(&overlapped, 0, sizeof(OVERLAPPED));
+    overlapped.Offset = (DWORD)offset;
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+    DWORD bytesRead = 0;
+    if (!::ReadFile(handle, buffer, bufferLen, &bytesRead, &overlapped)) {
+        DWORD err = ::GetLastError();
+        if (err == ERROR_HANDLE_EOF) {
+            return std::make_tuple(0, FileError::Ok);
+        }
+        return std::make_tuple(0, getFileError(err));
+    }
+    return std::make_tuple((uint32_t)bytesRead, FileError::Ok);
+}
+
+File::NativeHandle File::getNativeHandle() const {
+    return handle;
+}
+
+#endif // _WIN32
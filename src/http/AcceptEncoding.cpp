@@ -0,0 +1,96 @@
+
+#include "cupcake/internal/http/AcceptEncoding.h"
+
+#include "cupcake/internal/http/CommaListIterator.h"
+
+using namespace Cupcake;
+
+static
+StringRef trimTrailingWhitespace(const StringRef str) {
+    size_t len = str.length();
+    while (len > 0 && (str.charAt(len - 1) == ' ' || str.charAt(len - 1) == '\t')) {
+        len--;
+    }
+    return str.substring(0, len);
+}
+
+/*
+ * Parses the parameters after a coding, e.g. "; q=0.5", into thousandths. No q
+ * parameter means 1, and a malformed one is treated as unacceptable.
+ */
+static
+uint32_t parseQValue(const StringRef params) {
+    ptrdiff_t qIndex = -1;
+    for (size_t i = 0; i < params.length(); i++) {
+        char c = params.charAt(i);
+        if ((c == 'q' || c == 'Q') &&
+            i + 1 < params.length() && params.charAt(i + 1) == '=' &&
+            (i == 0 || params.charAt(i - 1) == ';' || params.charAt(i - 1) == ' ' || params.charAt(i - 1) == '\t')) {
+            qIndex = i + 2;
+            break;
+        }
+    }
+    if (qIndex == -1) {
+        return 1000;
+    }
+
+    const StringRef qValue = trimTrailingWhitespace(params.substring(qIndex));
+    if (qValue.length() == 0 || (qValue.charAt(0) != '0' && qValue.charAt(0) != '1')) {
+        return 0;
+    }
+
+    uint32_t quality = (qValue.charAt(0) - '0') * 1000;
+    if (qValue.length() > 1) {
+        if (qValue.charAt(1) != '.' || qValue.length() > 5) {
+            return 0;
+        }
+        uint32_t scale = 100;
+        for (size_t i = 2; i < qValue.length(); i++, scale /= 10) {
+            char c = qValue.charAt(i);
+            if (c < '0' || c > '9') {
+                return 0;
+            }
+            quality += (c - '0') * scale;
+        }
+    }
+    return quality > 1000 ? 0 : quality;
+}
+
+namespace Cupcake {
+
+namespace AcceptEncoding {
+
+uint32_t getQuality(const StringRef acceptEncoding, const StringRef coding) {
+    CommaListIterator listIter(acceptEncoding);
+    bool hasWildcard = false;
+    uint32_t wildcardQuality = 0;
+
+    while (true) {
+        StringRef item = listIter.next();
+        if (item.length() == 0) {
+            break;
+        }
+
+        ptrdiff_t paramIndex = item.indexOf(';');
+        StringRef name = trimTrailingWhitespace(paramIndex == -1 ? item : item.substring(0, paramIndex));
+        StringRef params = paramIndex == -1 ? StringRef("", 0) : item.substring(paramIndex);
+
+        if (name.engEqualsIgnoreCase(coding) ||
+            (coding == "gzip" && name.engEqualsIgnoreCase("x-gzip"))) {
+            return parseQValue(params);
+        } else if (name == "*") {
+            hasWildcard = true;
+            wildcardQuality = parseQValue(params);
+        }
+    }
+
+    // Identity is always acceptable unless explicitly excluded
+    if (coding == "identity" && !hasWildcard) {
+        return 1000;
+    }
+    return wildcardQuality;
+}
+
+}
+
+}
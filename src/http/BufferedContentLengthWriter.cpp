@@ -3,15 +3,29 @@
 
 #include "cupcake/internal/http/HttpResponseImpl.h"
 
+#include <algorithm>
+
 using namespace Cupcake;
 
+#define BLOCK_SIZE 4096
+#define DEFAULT_SPILL_THRESHOLD (64 * 1024)
+
 BufferedContentLengthWriter::BufferedContentLengthWriter() :
     responseImpl(nullptr),
+    spillSource(nullptr),
+    lastBlockUsed(BLOCK_SIZE),
+    bufferedLen(0),
+    spillThreshold(0),
     closed(false)
 {}
 
 void BufferedContentLengthWriter::init(HttpResponseImpl* initResponseImpl) {
+    init(initResponseImpl, DEFAULT_SPILL_THRESHOLD);
+}
+
+void BufferedContentLengthWriter::init(HttpResponseImpl* initResponseImpl, uint32_t initSpillThreshold) {
     responseImpl = initResponseImpl;
+    spillThreshold = initSpillThreshold;
 }
 
 BufferedContentLengthWriter::~BufferedContentLengthWriter() {
@@ -24,11 +38,35 @@ HttpError BufferedContentLengthWriter::write(const char* buffer, uint32_t buffer
     if (closed) {
         return HttpError::StreamClosed;
     }
-    contentBuffer.insert(contentBuffer.end(), buffer, buffer+bufferLen);
+    if (spillSource) {
+        return spillSource->write(buffer, bufferLen);
+    }
+    if (bufferedLen + bufferLen > spillThreshold) {
+        return spill(buffer, bufferLen);
+    }
+
+    while (bufferLen > 0) {
+        if (lastBlockUsed == BLOCK_SIZE) {
+            blocks.push_back(BufferPool::allocate(BLOCK_SIZE));
+            lastBlockUsed = 0;
+        }
+        uint32_t copyLen = std::min(bufferLen, (uint32_t)(BLOCK_SIZE - lastBlockUsed));
+        std::memcpy(blocks.back().get() + lastBlockUsed, buffer, copyLen);
+        lastBlockUsed += copyLen;
+        bufferedLen += copyLen;
+        buffer += copyLen;
+        bufferLen -= copyLen;
+    }
     return HttpError::Ok;
 }
 
 HttpError BufferedContentLengthWriter::flush() {
+    if (closed) {
+        return HttpError::StreamClosed;
+    }
+    if (spillSource) {
+        return spillSource->flush();
+    }
     return HttpError::Ok;
 }
 
@@ -37,5 +75,42 @@ HttpError BufferedContentLengthWriter::close() {
         return HttpError::StreamClosed;
     }
     closed = true;
-    return responseImpl->writeHeadersAndBody(contentBuffer.data(), contentBuffer.size());
-}
\ No newline at end of file
+    if (spillSource) {
+        return spillSource->flush();
+    }
+
+    std::unique_ptr<INet::IoBuffer[]> ioBufs(new INet::IoBuffer[blocks.size()]);
+    uint32_t ioBufCount = fillIoBuffers(ioBufs.get());
+    HttpError err = responseImpl->writeHeadersAndBody(ioBufs.get(), ioBufCount, bufferedLen);
+    blocks.clear();
+    return err;
+}
+
+// Too big to hold on to, so the headers go out without a length along with
+// everything so far, and the rest streams until the connection closes.
+HttpError BufferedContentLengthWriter::spill(const char* buffer, uint32_t bufferLen) {
+    HttpError err;
+    std::tie(spillSource, err) = responseImpl->startCloseDelimitedBody();
+    if (err != HttpError::Ok) {
+        return err;
+    }
+
+    std::unique_ptr<INet::IoBuffer[]> ioBufs(new INet::IoBuffer[blocks.size() + 1]);
+    uint32_t ioBufCount = fillIoBuffers(ioBufs.get());
+    ioBufs[ioBufCount].buffer = (char*)buffer;
+    ioBufs[ioBufCount].bufferLen = bufferLen;
+    ioBufCount++;
+
+    err = spillSource->writev(ioBufs.get(), ioBufCount);
+    blocks.clear();
+    blocks.shrink_to_fit();
+    return err;
+}
+
+uint32_t BufferedContentLengthWriter::fillIoBuffers(INet::IoBuffer* ioBufs) {
+    for (size_t i = 0; i < blocks.size(); i++) {
+        ioBufs[i].buffer = blocks[i].get();
+        ioBufs[i].bufferLen = (i == blocks.size() - 1) ? lastBlockUsed : BLOCK_SIZE;
+    }
+    return (uint32_t)blocks.size();
+}
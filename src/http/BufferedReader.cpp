@@ -18,6 +18,7 @@ uint32_t checkedDouble(uint32_t val) {
 BufferedReader::BufferedReader() :
     socket(nullptr),
     buffer(),
+    initialBufferLen(0),
     bufferLen(0),
     startIndex(0),
     endIndex(0)
@@ -25,11 +26,49 @@ BufferedReader::BufferedReader() :
 
 void BufferedReader::init(StreamSource* readSocket, size_t initialBufferSize) {
     socket = readSocket;
-    bufferLen = initialBufferSize;
-    buffer.reset(new char[initialBufferSize]);
+    initialBufferLen = (uint32_t)initialBufferSize;
+    bufferLen = 0;
+    buffer.reset();
+}
+
+void BufferedReader::releaseBuffer() {
+    if (startIndex == endIndex) {
+        buffer.reset();
+        bufferLen = 0;
+        startIndex = 0;
+        endIndex = 0;
+    }
+}
+
+bool BufferedReader::hasBuffer() const {
+    return (bool)buffer;
+}
+
+HttpError BufferedReader::waitForData() {
+    if (startIndex != endIndex) {
+        return HttpError::Ok;
+    }
+    releaseBuffer();
+    return socket->waitReadable();
+}
+
+void BufferedReader::ensureBuffer() {
+    if (!buffer) {
+        buffer = BufferPool::allocate(initialBufferLen);
+        bufferLen = initialBufferLen;
+    }
+}
+
+// Moves to a buffer of the next size class up, keeping the current contents
+void BufferedReader::growBuffer(uint32_t newBufferLen) {
+    PooledBuffer newBuffer = BufferPool::allocate(newBufferLen);
+    std::memcpy(newBuffer.get(), buffer.get(), bufferLen);
+    buffer.swap(newBuffer);
+    bufferLen = newBufferLen;
 }
 
 std::tuple<uint32_t, HttpError> BufferedReader::read(char* destBuffer, uint32_t destBufferLen) {
+    ensureBuffer();
     size_t available = endIndex - startIndex;
 
     // If there is available data, just move it into the dest buffer
@@ -68,6 +107,7 @@ std::tuple<uint32_t, HttpError> BufferedReader::read(char* destBuffer, uint32_t
 }
 
 std::tuple<StringRef, HttpError> BufferedReader::readLine(uint32_t maxLength) {
+    ensureBuffer();
     bool foundLineEnd = false;
     uint32_t searchIndex = startIndex;
 
@@ -77,11 +117,11 @@ std::tuple<StringRef, HttpError> BufferedReader::readLine(uint32_t maxLength) {
 
         // Look for a newline in existing data
         for (uint32_t i = searchIndex; !foundLineEnd && i < endIndex; i++) {
-            if (buffer[i] != '\n') {
+            if (buffer.get()[i] != '\n') {
                 continue;
             }
 
-            if (i != 0 && buffer[i - 1] == '\r') {
+            if (i != 0 && buffer.get()[i - 1] == '\r') {
                 lineEndIndex = i - 1;
             } else {
                 lineEndIndex = i;
@@ -110,11 +150,7 @@ std::tuple<StringRef, HttpError> BufferedReader::readLine(uint32_t maxLength) {
                 return std::make_tuple(StringRef(), HttpError::LineTooLong);
             }
 
-            uint32_t newBufferLen = std::min(checkedDouble(bufferLen), maxLength + 2); // +2 to allow for \r\n
-            std::unique_ptr<char[]> newPtr(new char[newBufferLen]);
-            std::memcpy(newPtr.get(), buffer.get(), bufferLen);
-            buffer.swap(newPtr);
-            bufferLen = newBufferLen;
+            growBuffer(std::min(checkedDouble(bufferLen), maxLength + 2)); // +2 to allow for \r\n
         }
 
         // Read some data
@@ -144,31 +180,53 @@ std::tuple<StringRef, HttpError> BufferedReader::readLine(uint32_t maxLength) {
 }
 
 HttpError BufferedReader::readFixedLength(char* destBuffer, uint32_t destBufferLen) {
+    return std::get<1>(readFixedLengthCounted(destBuffer, destBufferLen));
+}
+
+std::tuple<uint32_t, HttpError> BufferedReader::readFixedLengthCounted(char* destBuffer, uint32_t destBufferLen) {
+    // Buffered data goes first
+    uint32_t totalBytesRead = std::min(endIndex - startIndex, destBufferLen);
+    if (totalBytesRead != 0) {
+        std::memcpy(destBuffer, buffer.get() + startIndex, totalBytesRead);
+        startIndex += totalBytesRead;
+    }
+
+    // Then large reads skip the buffer, so nothing is copied twice and no
+    // buffer needs to be held for them
     HttpError err;
     uint32_t bytesRead;
-    while (destBufferLen > 0) {
-        std::tie(bytesRead, err) = read(destBuffer, destBufferLen);
+    while (destBufferLen - totalBytesRead >= largeBufferLen) {
+        std::tie(bytesRead, err) = socket->read(destBuffer + totalBytesRead, destBufferLen - totalBytesRead);
         if (err != HttpError::Ok) {
-            return err;
+            return std::make_tuple(totalBytesRead, err);
         }
         if (bytesRead == 0) {
-            return HttpError::Eof;
+            return std::make_tuple(totalBytesRead, HttpError::Eof);
         }
-        destBuffer += bytesRead;
-        destBufferLen -= bytesRead;
+        totalBytesRead += bytesRead;
     }
 
-    return HttpError::Ok;
+    // The tail reads through the buffer, which picks up whatever follows it
+    while (totalBytesRead < destBufferLen) {
+        std::tie(bytesRead, err) = read(destBuffer + totalBytesRead, destBufferLen - totalBytesRead);
+        if (err != HttpError::Ok) {
+            return std::make_tuple(totalBytesRead, err);
+        }
+        if (bytesRead == 0) {
+            return std::make_tuple(totalBytesRead, HttpError::Eof);
+        }
+        totalBytesRead += bytesRead;
+    }
+
+    return std::make_tuple(totalBytesRead, HttpError::Ok);
 }
 
 std::tuple<bool, HttpError> BufferedReader::peekMatch(char* expectedData, uint32_t expectedDataLen) {
+    ensureBuffer();
+
     // Resize internal buffer if needed (shouldn't be in practice)
     if (expectedDataLen > bufferLen) {
-        uint32_t newBufferLen = checkedDouble(expectedDataLen);
-        std::unique_ptr<char[]> newPtr(new char[newBufferLen]);
-        std::memcpy(newPtr.get(), buffer.get(), bufferLen);
-        buffer.swap(newPtr);
-        bufferLen = newBufferLen;
+        growBuffer(checkedDouble(expectedDataLen));
     }
 
     // If we can't fit things in given the current start index, move the data
@@ -212,6 +270,8 @@ std::tuple<bool, HttpError> BufferedReader::peekMatch(char* expectedData, uint32
 }
 
 HttpError BufferedReader::discard(uint32_t discardBytes) {
+    ensureBuffer();
+
     // Discard buffered data
     do {
         uint32_t available = endIndex - startIndex;
@@ -234,4 +294,75 @@ HttpError BufferedReader::discard(uint32_t discardBytes) {
         }
         endIndex = bytesRead;
     } while (1);
-}
\ No newline at end of file
+}
+StringRef BufferedReader::getBuffered() const {
+    if (!buffer) {
+        return StringRef();
+    }
+    return StringRef(buffer.get() + startIndex, endIndex - startIndex);
+}
+
+HttpError BufferedReader::fill(uint32_t maxBuffered) {
+    ensureBuffer();
+
+    if (endIndex == bufferLen) {
+        uint32_t available = endIndex - startIndex;
+        if (available >= maxBuffered) {
+            return HttpError::LineTooLong;
+        }
+
+        if (startIndex != 0) {
+            std::memmove(buffer.get(), buffer.get() + startIndex, available);
+            startIndex = 0;
+            endIndex = available;
+        } else {
+            growBuffer(std::min(checkedDouble(bufferLen), maxBuffered));
+        }
+    }
+
+    uint32_t bytesRead;
+    HttpError err;
+    std::tie(bytesRead, err) = socket->read(buffer.get() + endIndex, bufferLen - endIndex);
+    if (err != HttpError::Ok) {
+        return err;
+    }
+    if (bytesRead == 0) {
+        return HttpError::Eof;
+    }
+
+    endIndex += bytesRead;
+    return HttpError::Ok;
+}
+
+std::tuple<StringRef, HttpError> BufferedReader::readView(uint32_t maxLen, uint32_t preferredBufferLen) {
+    if (startIndex == endIndex) {
+        // Nothing to keep, so swapping buffers costs no copy
+        if (bufferLen < preferredBufferLen) {
+            buffer = BufferPool::allocate(preferredBufferLen);
+            bufferLen = preferredBufferLen;
+        } else {
+            ensureBuffer();
+        }
+        startIndex = 0;
+        endIndex = 0;
+
+        uint32_t bytesRead;
+        HttpError err;
+        std::tie(bytesRead, err) = socket->read(buffer.get(), bufferLen);
+        if (err != HttpError::Ok) {
+            return std::make_tuple(StringRef(), err);
+        }
+        if (bytesRead == 0) {
+            return std::make_tuple(StringRef(), HttpError::Eof);
+        }
+        endIndex = bytesRead;
+    }
+
+    uint32_t viewLen = std::min(endIndex - startIndex, maxLen);
+    return std::make_tuple(StringRef(buffer.get() + startIndex, viewLen), HttpError::Ok);
+}
+
+void BufferedReader::consume(uint32_t byteCount) {
+    assert(byteCount <= endIndex - startIndex);
+    startIndex += byteCount;
+}
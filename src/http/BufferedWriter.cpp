@@ -12,7 +12,7 @@ BufferedWriter::BufferedWriter() :
 void BufferedWriter::init(StreamSource* initStreamSource, uint32_t initBufferSize) {
     streamSource = initStreamSource;
     bufferLen = initBufferSize;
-    buffer.reset(new char[initBufferSize]);
+    buffer = BufferPool::allocate(initBufferSize);
 }
 
 HttpError BufferedWriter::write(const char* writeBuf, uint32_t inBufferLen) {
@@ -30,100 +30,170 @@ std::tuple<uint32_t, HttpError> ChunkedReader::read(char* buffer, uint32_t buffe
     HttpError err;
     uint32_t totalBytesRead = 0;
 
-    while (bufferLen > 0 && chunkedState != ChunkedState::Eof) {
+    while (bufferLen > 0) {
+        err = nextData();
+        if (err != HttpError::Ok) {
+            return std::make_tuple(0, err);
+        }
+        if (chunkedState == ChunkedState::Eof) {
+            break;
+        }
 
-        // If we need to read a length, read it
-        if (chunkedState == ChunkedState::Length) {
+        uint32_t bytesReadable = (uint32_t)std::min(curLength, (uint64_t)bufferLen);
+        uint32_t bytesRead;
+        std::tie(bytesRead, err) = bufReader.read(buffer, bytesReadable);
 
-            StringRef chunkedLine;
-            std::tie(chunkedLine, err) = bufReader.readLine(1024); // TODO: Define limit somewhere
-            if (err != HttpError::Ok) {
-                return std::make_tuple(0, err);
-            }
-            // Strip and ignore any chunked extension
-            ptrdiff_t semiIndex = chunkedLine.indexOf(';');
-            if (semiIndex != -1) {
-                chunkedLine = chunkedLine.substring(0, semiIndex);
-            }
+        if (err != HttpError::Ok) {
+            return std::make_tuple(0, err);
+        }
 
-            // Try to parse the hex length number
-            bool parseSuccess;
-            std::tie(curLength, parseSuccess) = Strconv::parseUint64(chunkedLine, 16);
-            if (!parseSuccess) {
-                return std::make_tuple(0, HttpError::ClientError);
-            }
-            if (curLength == 0) {
-                // Read the expected blank line or trailing headers. Just skipping trailing headers for now.
-                while (true) {
-                    std::tie(chunkedLine, err) = bufReader.readLine(64 * 1024); // TODO: Define limit somewhere
-
-                    // If we see a blank line it's the end of the trailing headers
-                    if (err != HttpError::Ok) {
-                        return std::make_tuple(0, err);
-                    }
-                    if (chunkedLine.length() == 0) {
-                        chunkedState = ChunkedState::Eof;
-
-                        if (totalBytesRead == 0) {
-                            return std::make_tuple(0, HttpError::Eof);
-                        } else {
-                            break;
-                        }
-                    }
-                    // Not doing any validation of the headers
-                }
-            } else {
-                chunkedState = ChunkedState::Data;
-            }
+        totalBytesRead += bytesRead;
+        buffer += bytesRead;
+        bufferLen -= bytesRead;
+
+        // On successful read, update bytes available to read and state if no more bytes in this chunk
+        curLength -= bytesRead;
+        if (curLength == 0) {
+            chunkedState = ChunkedState::DataEol;
         }
+    }
 
-        if (chunkedState == ChunkedState::Data) {
-            // Otherwise, read available data
-            uint32_t bytesReadable = (uint32_t)std::min(curLength, (uint64_t)bufferLen);
-            uint32_t bytesRead;
-            std::tie(bytesRead, err) = bufReader.read(buffer, bytesReadable);
+    if (totalBytesRead == 0 && chunkedState == ChunkedState::Eof) {
+        return std::make_tuple(0, HttpError::Eof);
+    }
+    return std::make_tuple(totalBytesRead, HttpError::Ok);
+}
 
-            if (err != HttpError::Ok) {
-                return std::make_tuple(0, err);
-            }
+std::tuple<uint32_t, HttpError> ChunkedReader::readFully(char* buffer, uint32_t bufferLen) {
+    HttpError err;
+    uint32_t totalBytesRead = 0;
+
+    while (bufferLen > 0) {
+        // What was read before an error is in the buffer, so it's counted
+        err = nextData();
+        if (err != HttpError::Ok) {
+            return std::make_tuple(totalBytesRead, err);
+        }
+        if (chunkedState == ChunkedState::Eof) {
+            break;
+        }
 
-            totalBytesRead += bytesRead;
-            buffer += bytesRead;
-            bufferLen -= bytesRead;
+        uint32_t readLen = (uint32_t)std::min(curLength, (uint64_t)bufferLen);
+        uint32_t bytesRead;
+        std::tie(bytesRead, err) = bufReader.readFixedLengthCounted(buffer, readLen);
 
-            // On successful read, update bytes available to read and state if no more bytes in this chunk
-            curLength -= bytesRead;
-            if (curLength == 0) {
-                chunkedState = ChunkedState::DataEol;
-            }
+        totalBytesRead += bytesRead;
+        buffer += bytesRead;
+        bufferLen -= bytesRead;
+
+        curLength -= bytesRead;
+        if (curLength == 0) {
+            chunkedState = ChunkedState::DataEol;
+        }
+        if (err != HttpError::Ok) {
+            return std::make_tuple(totalBytesRead, err);
         }
+    }
 
+    if (totalBytesRead == 0 && chunkedState == ChunkedState::Eof) {
+        return std::make_tuple(0, HttpError::Eof);
+    }
+    return std::make_tuple(totalBytesRead, HttpError::Ok);
+}
+
+// Views never span chunks, the lines between them are in the way
+std::tuple<StringRef, HttpError> ChunkedReader::readView(uint32_t maxLen) {
+    HttpError err = nextData();
+    if (err != HttpError::Ok) {
+        return std::make_tuple(StringRef(), err);
+    }
+    if (chunkedState == ChunkedState::Eof) {
+        return std::make_tuple(StringRef(), HttpError::Eof);
+    }
+
+    uint32_t viewLen = (uint32_t)std::min(curLength, (uint64_t)maxLen);
+    uint32_t preferredBufferLen = (curLength >= BufferedReader::largeBufferLen) ? BufferedReader::largeBufferLen : 0;
+    return bufReader.readView(viewLen, preferredBufferLen);
+}
+
+void ChunkedReader::consume(uint32_t byteCount) {
+    bufReader.consume(byteCount);
+    curLength -= byteCount;
+    if (curLength == 0 && chunkedState == ChunkedState::Data) {
+        chunkedState = ChunkedState::DataEol;
+    }
+}
+
+HttpError ChunkedReader::close() {
+    // If the user didn't read it, read all chunked content, throwing it away
+    while (chunkedState != ChunkedState::Eof) {
+        StringRef view;
+        HttpError err;
+        std::tie(view, err) = readView(UINT32_MAX);
+        if (err == HttpError::Eof) {
+            break;
+        }
+        if (err != HttpError::Ok) {
+            return err;
+        }
+        consume((uint32_t)view.length());
+    }
+    return HttpError::Ok;
+}
+
+// Reads through the lines between chunks until there's chunk data to read,
+// or the body has ended
+HttpError ChunkedReader::nextData() {
+    HttpError err;
+    StringRef chunkedLine;
+
+    while (chunkedState == ChunkedState::DataEol || chunkedState == ChunkedState::Length) {
         if (chunkedState == ChunkedState::DataEol) {
-            StringRef chunkedLine;
             std::tie(chunkedLine, err) = bufReader.readLine(1024); // TODO: Define limit somewhere
             if (err != HttpError::Ok) {
-                return std::make_tuple(0, err);
+                return err;
             }
             if (chunkedLine.length() > 0) {
-                return std::make_tuple(0, HttpError::ClientError);
+                return HttpError::ClientError;
             }
             chunkedState = ChunkedState::Length;
+            continue;
         }
-    }
 
-    return std::make_tuple(totalBytesRead, HttpError::Ok);
-}
-
-HttpError ChunkedReader::close() {
-    char discardBuffer[1024];
-    HttpError err;
-
-    // If the user didn't read it, read all chunked content, throwing it away
-    while (chunkedState != ChunkedState::Eof) {
-        std::tie(std::ignore, err) = read(discardBuffer, sizeof(discardBuffer));
+        std::tie(chunkedLine, err) = bufReader.readLine(1024); // TODO: Define limit somewhere
         if (err != HttpError::Ok) {
             return err;
         }
+        // Strip and ignore any chunked extension
+        ptrdiff_t semiIndex = chunkedLine.indexOf(';');
+        if (semiIndex != -1) {
+            chunkedLine = chunkedLine.substring(0, semiIndex);
+        }
+
+        // Try to parse the hex length number
+        bool parseSuccess;
+        std::tie(curLength, parseSuccess) = Strconv::parseUint64(chunkedLine, 16);
+        if (!parseSuccess) {
+            return HttpError::ClientError;
+        }
+        if (curLength != 0) {
+            chunkedState = ChunkedState::Data;
+            break;
+        }
+
+        // Read the expected blank line or trailing headers. Just skipping trailing headers for now.
+        while (true) {
+            std::tie(chunkedLine, err) = bufReader.readLine(64 * 1024); // TODO: Define limit somewhere
+            if (err != HttpError::Ok) {
+                return err;
+            }
+            // If we see a blank line it's the end of the trailing headers
+            if (chunkedLine.length() == 0) {
+                chunkedState = ChunkedState::Eof;
+                break;
+            }
+            // Not doing any validation of the headers
+        }
     }
     return HttpError::Ok;
 }
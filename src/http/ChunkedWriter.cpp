@@ -6,8 +6,13 @@
 
 using namespace Cupcake;
 
+#define DEFAULT_CHUNK_BUFFER_SIZE 4096
+
 ChunkedWriter::ChunkedWriter() :
     streamSource(nullptr),
+    buffer(),
+    bufferSize(0),
+    bufferUsed(0),
     closed(false)
 {}
 
@@ -18,33 +23,49 @@ ChunkedWriter::~ChunkedWriter() {
 }
 
 void ChunkedWriter::init(StreamSource* initStreamSource) {
+    init(initStreamSource, DEFAULT_CHUNK_BUFFER_SIZE);
+}
+
+void ChunkedWriter::init(StreamSource* initStreamSource, uint32_t initBufferSize) {
     streamSource = initStreamSource;
+    bufferSize = initBufferSize;
+    bufferUsed = 0;
+    closed = false;
 }
 
-HttpError ChunkedWriter::write(const char* buffer, uint32_t bufferLen) {
-    if (bufferLen == 0) {
+HttpError ChunkedWriter::write(const char* data, uint32_t dataLen) {
+    if (closed) {
+        return HttpError::StreamClosed;
+    }
+    if (dataLen == 0) {
         return HttpError::Ok;
     }
 
-    // TODO: Should probably buffer the small writes
-    char lengthBuffer[32];
-    size_t hexLen = Strconv::uint32ToStr(bufferLen, 16, lengthBuffer, sizeof(lengthBuffer));
+    if (dataLen <= bufferSize - bufferUsed) {
+        // Allocated on first use so responses that never write skip it
+        if (!buffer) {
+            buffer = BufferPool::allocate(bufferSize);
+        }
+        std::memcpy(buffer.get() + bufferUsed, data, dataLen);
+        bufferUsed += dataLen;
+        return HttpError::Ok;
+    }
 
-    INet::IoBuffer writeBufs[4];
-    writeBufs[0].buffer = lengthBuffer;
-    writeBufs[0].bufferLen = (uint32_t)hexLen;
-    writeBufs[1].buffer = (char*)"\r\n";
-    writeBufs[1].bufferLen = 2;
-    writeBufs[2].buffer = (char*)buffer;
-    writeBufs[2].bufferLen = bufferLen;
-    writeBufs[3].buffer = (char*)"\r\n";
-    writeBufs[3].bufferLen = 2;
-
-    return streamSource->writev(writeBufs, 4);
+    // Doesn't fit, so whatever is pending goes out in the same chunk
+    return writeChunk(data, dataLen, false);
 }
 
 HttpError ChunkedWriter::flush() {
-    return HttpError::Ok;
+    if (closed) {
+        return HttpError::Ok;
+    }
+    if (bufferUsed != 0) {
+        HttpError err = writeChunk(nullptr, 0, false);
+        if (err != HttpError::Ok) {
+            return err;
+        }
+    }
+    return streamSource->flush();
 }
 
 HttpError ChunkedWriter::close() {
@@ -53,5 +74,45 @@ HttpError ChunkedWriter::close() {
     }
     closed = true;
 
-    return streamSource->write("0\r\n\r\n", 5);
+    if (bufferUsed == 0) {
+        return streamSource->write("0\r\n\r\n", 5);
+    }
+    return writeChunk(nullptr, 0, true);
+}
+
+HttpError ChunkedWriter::writeChunk(const char* extra, uint32_t extraLen, bool last) {
+    uint32_t chunkLen = bufferUsed + extraLen;
+
+    char lengthBuffer[32];
+    size_t hexLen = Strconv::uint32ToStr(chunkLen, 16, lengthBuffer, sizeof(lengthBuffer) - 2);
+    lengthBuffer[hexLen++] = '\r';
+    lengthBuffer[hexLen++] = '\n';
+
+    INet::IoBuffer writeBufs[4];
+    uint32_t bufferCount = 0;
+    writeBufs[bufferCount].buffer = lengthBuffer;
+    writeBufs[bufferCount].bufferLen = (uint32_t)hexLen;
+    bufferCount++;
+    if (bufferUsed > 0) {
+        writeBufs[bufferCount].buffer = buffer.get();
+        writeBufs[bufferCount].bufferLen = bufferUsed;
+        bufferCount++;
+    }
+    if (extraLen > 0) {
+        writeBufs[bufferCount].buffer = (char*)extra;
+        writeBufs[bufferCount].bufferLen = extraLen;
+        bufferCount++;
+    }
+    // The terminating chunk rides along with the last data chunk
+    if (last) {
+        writeBufs[bufferCount].buffer = (char*)"\r\n0\r\n\r\n";
+        writeBufs[bufferCount].bufferLen = 7;
+    } else {
+        writeBufs[bufferCount].buffer = (char*)"\r\n";
+        writeBufs[bufferCount].bufferLen = 2;
+    }
+    bufferCount++;
+
+    bufferUsed = 0;
+    return streamSource->writev(writeBufs, bufferCount);
 }
@@ -0,0 +1,138 @@
+
+#include "cupcake/internal/http/CompressingWriter.h"
+
+#include "cupcake/internal/http/HttpResponseImpl.h"
+
+using namespace Cupcake;
+
+#define COMPRESS_BUFFER_SIZE (16 * 1024)
+
+CompressingWriter::CompressingWriter() :
+    responseImpl(nullptr),
+    outputStream(nullptr),
+    type(CompressionType::None),
+    minSize(0),
+    compressBufferUsed(0),
+    closed(false)
+{}
+
+CompressingWriter::~CompressingWriter() {
+    if (responseImpl && !closed) {
+        close();
+    }
+}
+
+void CompressingWriter::init(HttpResponseImpl* initResponseImpl, CompressionType initType, uint32_t initMinSize) {
+    responseImpl = initResponseImpl;
+    type = initType;
+    minSize = initMinSize;
+}
+
+HttpError CompressingWriter::write(const char* buffer, uint32_t bufferLen) {
+    if (closed) {
+        return HttpError::StreamClosed;
+    }
+
+    if (!outputStream) {
+        // Hold content back until it's clear the response is worth compressing
+        if (pendingContent.size() + bufferLen < minSize) {
+            pendingContent.insert(pendingContent.end(), buffer, buffer + bufferLen);
+            return HttpError::Ok;
+        }
+
+        HttpError err = startBody();
+        if (err != HttpError::Ok) {
+            return err;
+        }
+    }
+
+    return compressAndWrite(buffer, bufferLen, Compressor::Flush::None);
+}
+
+HttpError CompressingWriter::flush() {
+    if (closed) {
+        return HttpError::StreamClosed;
+    }
+
+    // Flushing commits to compressing, as the content so far has to go out now
+    if (!outputStream) {
+        HttpError err = startBody();
+        if (err != HttpError::Ok) {
+            return err;
+        }
+    }
+
+    HttpError err = compressAndWrite(nullptr, 0, Compressor::Flush::Sync);
+    if (err != HttpError::Ok) {
+        return err;
+    }
+    return outputStream->flush();
+}
+
+HttpError CompressingWriter::close() {
+    if (closed) {
+        return HttpError::StreamClosed;
+    }
+    closed = true;
+
+    if (!outputStream) {
+        return responseImpl->writeUncompressedBody(pendingContent.data(), pendingContent.size());
+    }
+
+    HttpError err = compressAndWrite(nullptr, 0, Compressor::Flush::Finish);
+    compressor.release();
+    if (err != HttpError::Ok) {
+        return err;
+    }
+    return outputStream->close();
+}
+
+HttpError CompressingWriter::startBody() {
+    HttpError err = compressor.init(type);
+    if (err != HttpError::Ok) {
+        return err;
+    }
+
+    std::tie(outputStream, err) = responseImpl->startCompressedBody(type);
+    if (err != HttpError::Ok) {
+        return err;
+    }
+
+    compressBuffer = BufferPool::allocate(COMPRESS_BUFFER_SIZE);
+    compressBufferUsed = 0;
+
+    err = compressAndWrite(pendingContent.data(), pendingContent.size(), Compressor::Flush::None);
+    pendingContent.clear();
+    pendingContent.shrink_to_fit();
+    return err;
+}
+
+HttpError CompressingWriter::compressAndWrite(const char* buffer, size_t bufferLen, Compressor::Flush flush) {
+    while (true) {
+        char* output = compressBuffer.get() + compressBufferUsed;
+        size_t outputLen = COMPRESS_BUFFER_SIZE - compressBufferUsed;
+
+        bool complete;
+        HttpError err;
+        std::tie(complete, err) = compressor.compress(&buffer, &bufferLen, &output, &outputLen, flush);
+        if (err != HttpError::Ok) {
+            return err;
+        }
+        compressBufferUsed = COMPRESS_BUFFER_SIZE - outputLen;
+
+        // Small writes accumulate until the buffer fills or there's a flush
+        if (compressBufferUsed == COMPRESS_BUFFER_SIZE || (complete && flush != Compressor::Flush::None)) {
+            if (compressBufferUsed != 0) {
+                err = outputStream->write(compressBuffer.get(), (uint32_t)compressBufferUsed);
+                if (err != HttpError::Ok) {
+                    return err;
+                }
+                compressBufferUsed = 0;
+            }
+        }
+
+        if (complete) {
+            return HttpError::Ok;
+        }
+    }
+}
@@ -0,0 +1,95 @@
+
+#include "cupcake/internal/http/CompressionConfig.h"
+
+#include "cupcake/internal/http/AcceptEncoding.h"
+
+using namespace Cupcake;
+
+static
+const char* defaultContentTypes[] = {
+    "text/*",
+    "application/javascript",
+    "application/json",
+    "application/xml",
+    "image/svg+xml",
+};
+
+static
+bool contentTypeMatches(const StringRef pattern, const StringRef mediaType) {
+    if (pattern.endsWith("/*")) {
+        size_t prefixLen = pattern.length() - 1;
+        return mediaType.length() > prefixLen &&
+            mediaType.substring(0, prefixLen).engEqualsIgnoreCase(pattern.substring(0, prefixLen));
+    }
+    return mediaType.engEqualsIgnoreCase(pattern);
+}
+
+CompressionConfig::CompressionConfig() :
+    enabled(false),
+    minSize(0)
+{}
+
+void CompressionConfig::enable(uint32_t minSize) {
+    enabled = true;
+    this->minSize = minSize;
+}
+
+void CompressionConfig::addContentType(const StringRef contentType) {
+    contentTypes.push_back(contentType);
+}
+
+bool CompressionConfig::isEnabled() const {
+    return enabled;
+}
+
+uint32_t CompressionConfig::getMinSize() const {
+    return minSize;
+}
+
+bool CompressionConfig::isCompressible(const StringRef contentType) const {
+    // Drop any parameters, e.g. "; charset=utf-8"
+    StringRef mediaType = contentType;
+    ptrdiff_t paramIndex = mediaType.indexOf(';');
+    if (paramIndex != -1) {
+        mediaType = mediaType.substring(0, paramIndex);
+    }
+    while (mediaType.length() > 0 && mediaType.endsWith(' ')) {
+        mediaType = mediaType.substring(0, mediaType.length() - 1);
+    }
+
+    if (contentTypes.empty()) {
+        for (const char* pattern : defaultContentTypes) {
+            if (contentTypeMatches(pattern, mediaType)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    for (const String& pattern : contentTypes) {
+        if (contentTypeMatches(pattern, mediaType)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CompressionType CompressionConfig::chooseType(const StringRef acceptEncoding) const {
+    // zstd first, as it wins ties
+    static const CompressionType candidates[] = {CompressionType::Zstd, CompressionType::Gzip};
+
+    CompressionType bestType = CompressionType::None;
+    uint32_t bestQuality = 0;
+
+    for (CompressionType candidate : candidates) {
+        if (!Compressor::isSupported(candidate)) {
+            continue;
+        }
+        uint32_t quality = AcceptEncoding::getQuality(acceptEncoding, Compressor::getCoding(candidate));
+        if (quality > bestQuality) {
+            bestType = candidate;
+            bestQuality = quality;
+        }
+    }
+    return bestType;
+}
@@ -0,0 +1,268 @@
+
+#include "cupcake/internal/http/Compressor.h"
+
+#ifdef CUPCAKE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef CUPCAKE_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+using namespace Cupcake;
+
+// Beyond this, contexts are freed rather than cached
+#define MAX_CACHED_CONTEXTS 4
+
+#define ZSTD_LEVEL 3
+
+// Add 16 to the window bits to get a gzip wrapper rather than zlib
+#define GZIP_WINDOW_BITS (15 + 16)
+
+/*
+ * Per-thread cache of compression contexts. Freed when the thread exits.
+ */
+class ContextCache {
+public:
+    ContextCache() = default;
+
+    ~ContextCache() {
+#ifdef CUPCAKE_HAVE_ZLIB
+        for (z_stream* stream : gzipContexts) {
+            ::deflateEnd(stream);
+            delete stream;
+        }
+#endif
+#ifdef CUPCAKE_HAVE_ZSTD
+        for (ZSTD_CCtx* cctx : zstdContexts) {
+            ::ZSTD_freeCCtx(cctx);
+        }
+#endif
+    }
+
+#ifdef CUPCAKE_HAVE_ZLIB
+    std::vector<z_stream*> gzipContexts;
+#endif
+#ifdef CUPCAKE_HAVE_ZSTD
+    std::vector<ZSTD_CCtx*> zstdContexts;
+#endif
+
+private:
+    ContextCache(const ContextCache&) = delete;
+    ContextCache& operator=(const ContextCache&) = delete;
+};
+
+static thread_local ContextCache contextCache;
+
+Compressor::Compressor() :
+    type(CompressionType::None),
+    context(nullptr)
+{}
+
+Compressor::~Compressor() {
+    release();
+}
+
+bool Compressor::isSupported(CompressionType type) {
+    switch (type) {
+#ifdef CUPCAKE_HAVE_ZLIB
+    case CompressionType::Gzip:
+        return true;
+#endif
+#ifdef CUPCAKE_HAVE_ZSTD
+    case CompressionType::Zstd:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+StringRef Compressor::getCoding(CompressionType type) {
+    switch (type) {
+    case CompressionType::Gzip:
+        return "gzip";
+    case CompressionType::Zstd:
+        return "zstd";
+    default:
+        return "identity";
+    }
+}
+
+HttpError Compressor::init(CompressionType type) {
+    if (context) {
+        return HttpError::InvalidState;
+    }
+
+    switch (type) {
+#ifdef CUPCAKE_HAVE_ZLIB
+    case CompressionType::Gzip: {
+        z_stream* stream;
+        if (!contextCache.gzipContexts.empty()) {
+            stream = contextCache.gzipContexts.back();
+            contextCache.gzipContexts.pop_back();
+        } else {
+            stream = new z_stream();
+            stream->zalloc = Z_NULL;
+            stream->zfree = Z_NULL;
+            stream->opaque = Z_NULL;
+            if (::deflateInit2(stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                delete stream;
+                return HttpError::OutOfMemory;
+            }
+        }
+        context = stream;
+        break;
+    }
+#endif
+#ifdef CUPCAKE_HAVE_ZSTD
+    case CompressionType::Zstd: {
+        ZSTD_CCtx* cctx;
+        if (!contextCache.zstdContexts.empty()) {
+            cctx = contextCache.zstdContexts.back();
+            contextCache.zstdContexts.pop_back();
+        } else {
+            cctx = ::ZSTD_createCCtx();
+            if (cctx == nullptr) {
+                return HttpError::OutOfMemory;
+            }
+            ::ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, ZSTD_LEVEL);
+        }
+        context = cctx;
+        break;
+    }
+#endif
+    default:
+        return HttpError::InvalidState;
+    }
+
+    this->type = type;
+    return HttpError::Ok;
+}
+
+std::tuple<bool, HttpError> Compressor::compress(const char** input, size_t* inputLen,
+    char** output, size_t* outputLen, Flush flush) {
+    if (!context) {
+        return std::make_tuple(false, HttpError::InvalidState);
+    }
+
+    switch (type) {
+#ifdef CUPCAKE_HAVE_ZLIB
+    case CompressionType::Gzip: {
+        z_stream* stream = (z_stream*)context;
+
+        // zlib counts in uInt, so large inputs are fed through in pieces
+        uInt inChunk = (uInt)std::min(*inputLen, (size_t)UINT_MAX);
+        uInt outChunk = (uInt)std::min(*outputLen, (size_t)UINT_MAX);
+        stream->next_in = (Bytef*)*input;
+        stream->avail_in = inChunk;
+        stream->next_out = (Bytef*)*output;
+        stream->avail_out = outChunk;
+
+        bool lastInput = inChunk == *inputLen;
+        int zflush = Z_NO_FLUSH;
+        if (lastInput && flush == Flush::Sync) {
+            zflush = Z_SYNC_FLUSH;
+        } else if (lastInput && flush == Flush::Finish) {
+            zflush = Z_FINISH;
+        }
+
+        int res = ::deflate(stream, zflush);
+        if (res == Z_STREAM_ERROR) {
+            return std::make_tuple(false, HttpError::InvalidState);
+        }
+
+        size_t consumed = inChunk - stream->avail_in;
+        size_t produced = outChunk - stream->avail_out;
+        *input += consumed;
+        *inputLen -= consumed;
+        *output += produced;
+        *outputLen -= produced;
+
+        bool complete;
+        if (*inputLen != 0) {
+            complete = false;
+        } else if (flush == Flush::None) {
+            complete = true;
+        } else if (flush == Flush::Sync) {
+            // A sync flush is only known to be complete if it didn't fill the output
+            complete = stream->avail_out != 0;
+        } else {
+            complete = res == Z_STREAM_END;
+        }
+        return std::make_tuple(complete, HttpError::Ok);
+    }
+#endif
+#ifdef CUPCAKE_HAVE_ZSTD
+    case CompressionType::Zstd: {
+        ZSTD_CCtx* cctx = (ZSTD_CCtx*)context;
+
+        ZSTD_inBuffer inBuffer = {*input, *inputLen, 0};
+        ZSTD_outBuffer outBuffer = {*output, *outputLen, 0};
+
+        ZSTD_EndDirective directive = ZSTD_e_continue;
+        if (flush == Flush::Sync) {
+            directive = ZSTD_e_flush;
+        } else if (flush == Flush::Finish) {
+            directive = ZSTD_e_end;
+        }
+
+        size_t remaining = ::ZSTD_compressStream2(cctx, &outBuffer, &inBuffer, directive);
+        if (::ZSTD_isError(remaining)) {
+            return std::make_tuple(false, HttpError::InvalidState);
+        }
+
+        *input += inBuffer.pos;
+        *inputLen -= inBuffer.pos;
+        *output += outBuffer.pos;
+        *outputLen -= outBuffer.pos;
+
+        bool complete = *inputLen == 0 && (flush == Flush::None || remaining == 0);
+        return std::make_tuple(complete, HttpError::Ok);
+    }
+#endif
+    default:
+        return std::make_tuple(false, HttpError::InvalidState);
+    }
+}
+
+void Compressor::release() {
+    if (!context) {
+        return;
+    }
+
+    switch (type) {
+#ifdef CUPCAKE_HAVE_ZLIB
+    case CompressionType::Gzip: {
+        z_stream* stream = (z_stream*)context;
+        if (contextCache.gzipContexts.size() < MAX_CACHED_CONTEXTS && ::deflateReset(stream) == Z_OK) {
+            contextCache.gzipContexts.push_back(stream);
+        } else {
+            ::deflateEnd(stream);
+            delete stream;
+        }
+        break;
+    }
+#endif
+#ifdef CUPCAKE_HAVE_ZSTD
+    case CompressionType::Zstd: {
+        ZSTD_CCtx* cctx = (ZSTD_CCtx*)context;
+        if (contextCache.zstdContexts.size() < MAX_CACHED_CONTEXTS) {
+            ::ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only);
+            contextCache.zstdContexts.push_back(cctx);
+        } else {
+            ::ZSTD_freeCCtx(cctx);
+        }
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+
+    context = nullptr;
+    type = CompressionType::None;
+}
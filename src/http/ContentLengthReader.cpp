@@ -16,7 +16,7 @@ std::tuple<uint32_t, HttpError> ContentLengthReader::read(char* buffer, uint32_t
         return std::make_tuple(0, HttpError::Eof);
     }
 
-    uint32_t readLen = std::min((uint32_t)contentLength, bufferLen);
+    uint32_t readLen = (uint32_t)std::min(contentLength, (uint64_t)bufferLen);
 
     uint32_t bytesRead;
     HttpError err;
@@ -27,7 +27,45 @@ std::tuple<uint32_t, HttpError> ContentLengthReader::read(char* buffer, uint32_t
     return std::make_tuple(bytesRead, err);
 }
 
+std::tuple<uint32_t, HttpError> ContentLengthReader::readFully(char* buffer, uint32_t bufferLen) {
+    if (contentLength == 0) {
+        return std::make_tuple(0, HttpError::Eof);
+    }
+
+    // As with chunked bodies, what was read before an error is counted
+    uint32_t readLen = (uint32_t)std::min(contentLength, (uint64_t)bufferLen);
+    uint32_t bytesRead;
+    HttpError err;
+    std::tie(bytesRead, err) = bufReader.readFixedLengthCounted(buffer, readLen);
+    contentLength -= bytesRead;
+    return std::make_tuple(bytesRead, err);
+}
+
+std::tuple<StringRef, HttpError> ContentLengthReader::readView(uint32_t maxLen) {
+    if (contentLength == 0) {
+        return std::make_tuple(StringRef(), HttpError::Eof);
+    }
+
+    uint32_t viewLen = (uint32_t)std::min(contentLength, (uint64_t)maxLen);
+    uint32_t preferredBufferLen = (contentLength >= BufferedReader::largeBufferLen) ? BufferedReader::largeBufferLen : 0;
+    return bufReader.readView(viewLen, preferredBufferLen);
+}
+
+void ContentLengthReader::consume(uint32_t byteCount) {
+    bufReader.consume(byteCount);
+    contentLength -= byteCount;
+}
+
+// Skips what the handler didn't read, without copying it anywhere
 HttpError ContentLengthReader::close() {
-    // TODO: Skip content
+    while (contentLength != 0) {
+        StringRef view;
+        HttpError err;
+        std::tie(view, err) = readView(UINT32_MAX);
+        if (err != HttpError::Ok) {
+            return err;
+        }
+        consume((uint32_t)view.length());
+    }
     return HttpError::Ok;
 }
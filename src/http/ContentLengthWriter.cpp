@@ -32,7 +32,7 @@ HttpError ContentLengthWriter::write(const char* buffer, uint32_t bufferLen) {
 }
 
 HttpError ContentLengthWriter::flush() {
-    return HttpError::Ok;
+    return streamSource->flush();
 }
 
 HttpError ContentLengthWriter::close() {
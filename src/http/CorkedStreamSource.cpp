@@ -0,0 +1,110 @@
+
+#include "cupcake/internal/http/CorkedStreamSource.h"
+
+#include <algorithm>
+
+using namespace Cupcake;
+
+CorkedStreamSource::CorkedStreamSource(StreamSource* streamSource) :
+    streamSource(streamSource),
+    corkedBuffers(nullptr),
+    corkedCount(0),
+    corkedCapacity(0)
+{}
+
+void CorkedStreamSource::cork(INet::IoBuffer* buffers, uint32_t bufferCount, uint32_t bufferCapacity) {
+    corkedBuffers = buffers;
+    corkedCount = bufferCount;
+    corkedCapacity = bufferCapacity;
+}
+
+bool CorkedStreamSource::isCorked() const {
+    return corkedCount != 0;
+}
+
+std::tuple<StreamSource*, HttpError> CorkedStreamSource::accept() {
+    return streamSource->accept();
+}
+
+std::tuple<uint32_t, HttpError> CorkedStreamSource::read(char* buffer, uint32_t bufferLen) {
+    return streamSource->read(buffer, bufferLen);
+}
+
+std::tuple<uint32_t, HttpError> CorkedStreamSource::readv(INet::IoBuffer* buffers, uint32_t bufferCount) {
+    return streamSource->readv(buffers, bufferCount);
+}
+
+HttpError CorkedStreamSource::waitReadable() {
+    return streamSource->waitReadable();
+}
+
+HttpError CorkedStreamSource::write(const char* buffer, uint32_t bufferLen) {
+    if (corkedCount == 0) {
+        return streamSource->write(buffer, bufferLen);
+    }
+
+    INet::IoBuffer ioBuf;
+    ioBuf.buffer = (char*)buffer;
+    ioBuf.bufferLen = bufferLen;
+    return writev(&ioBuf, 1);
+}
+
+HttpError CorkedStreamSource::writev(const INet::IoBuffer* buffers, uint32_t bufferCount) {
+    if (corkedCount == 0) {
+        return streamSource->writev(buffers, bufferCount);
+    }
+
+    std::unique_ptr<INet::IoBuffer[]> overflow;
+    uint32_t totalCount = corkedCount + bufferCount;
+    const INet::IoBuffer* allBuffers = gather(buffers, bufferCount, &overflow);
+    corkedCount = 0;
+    return streamSource->writev(allBuffers, totalCount);
+}
+
+HttpError CorkedStreamSource::flush() {
+    if (corkedCount != 0) {
+        uint32_t count = corkedCount;
+        corkedCount = 0;
+        HttpError err = streamSource->writev(corkedBuffers, count);
+        if (err != HttpError::Ok) {
+            return err;
+        }
+    }
+    return streamSource->flush();
+}
+
+HttpError CorkedStreamSource::close() {
+    HttpError err = flush();
+    if (err != HttpError::Ok) {
+        return err;
+    }
+    return streamSource->close();
+}
+
+HttpError CorkedStreamSource::sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+    const File& file, uint64_t offset, uint64_t length) {
+
+    if (corkedCount == 0) {
+        return streamSource->sendFile(headBuffers, headBufferCount, file, offset, length);
+    }
+
+    std::unique_ptr<INet::IoBuffer[]> overflow;
+    uint32_t totalCount = corkedCount + headBufferCount;
+    const INet::IoBuffer* allBuffers = gather(headBuffers, headBufferCount, &overflow);
+    corkedCount = 0;
+    return streamSource->sendFile(allBuffers, totalCount, file, offset, length);
+}
+
+const INet::IoBuffer* CorkedStreamSource::gather(const INet::IoBuffer* buffers, uint32_t bufferCount,
+    std::unique_ptr<INet::IoBuffer[]>* overflow) {
+
+    if (corkedCount + bufferCount <= corkedCapacity) {
+        std::copy_n(buffers, bufferCount, corkedBuffers + corkedCount);
+        return corkedBuffers;
+    }
+
+    overflow->reset(new INet::IoBuffer[corkedCount + bufferCount]);
+    std::copy_n(corkedBuffers, corkedCount, overflow->get());
+    std::copy_n(buffers, bufferCount, overflow->get() + corkedCount);
+    return overflow->get();
+}
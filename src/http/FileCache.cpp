@@ -0,0 +1,402 @@
+
+#include "cupcake/internal/http/FileCache.h"
+
+#include "cupcake/internal/text/Strconv.h"
+
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+using namespace Cupcake;
+
+#define DEFAULT_MAX_ENTRIES 1024
+#define DEFAULT_SMALL_FILE_LIMIT (16 * 1024)
+#define DEFAULT_MAX_MEMORY (16 * 1024 * 1024)
+#define MAX_SHARDS 16
+#define REVALIDATE_MILLIS 1000
+
+struct ContentTypeEntry {
+    const char* extension;
+    const char* contentType;
+};
+
+static
+const ContentTypeEntry contentTypes[] = {
+    {"css", "text/css"},
+    {"csv", "text/csv"},
+    {"gif", "image/gif"},
+    {"htm", "text/html"},
+    {"html", "text/html"},
+    {"ico", "image/x-icon"},
+    {"jpeg", "image/jpeg"},
+    {"jpg", "image/jpeg"},
+    {"js", "application/javascript"},
+    {"json", "application/json"},
+    {"mp4", "video/mp4"},
+    {"otf", "font/otf"},
+    {"pdf", "application/pdf"},
+    {"png", "image/png"},
+    {"svg", "image/svg+xml"},
+    {"ttf", "font/ttf"},
+    {"txt", "text/plain"},
+    {"wasm", "application/wasm"},
+    {"webm", "video/webm"},
+    {"webp", "image/webp"},
+    {"woff", "font/woff"},
+    {"woff2", "font/woff2"},
+    {"xml", "application/xml"},
+};
+
+static
+StringRef getContentType(const StringRef path) {
+    ptrdiff_t dotIndex = path.lastIndexOf('.');
+    ptrdiff_t slashIndex = path.lastIndexOf('/');
+    if (dotIndex == -1 || dotIndex < slashIndex) {
+        return "application/octet-stream";
+    }
+
+    const StringRef extension = path.substring(dotIndex + 1);
+    for (const ContentTypeEntry& entry : contentTypes) {
+        if (extension.engEqualsIgnoreCase(entry.extension)) {
+            return entry.contentType;
+        }
+    }
+    return "application/octet-stream";
+}
+
+static
+void appendTwoDigits(char* buffer, uint32_t value) {
+    buffer[0] = (char)('0' + (value / 10));
+    buffer[1] = (char)('0' + (value % 10));
+}
+
+/* Formats an IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT". The buffer must hold 29 chars. */
+static
+size_t formatHttpDate(uint64_t unixTime, char* buffer) {
+    static const char* dayNames[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static const char* monthNames[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                       "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    uint64_t days = unixTime / 86400;
+    uint32_t secondsOfDay = (uint32_t)(unixTime % 86400);
+
+    // Civil date from days since the epoch, counting in 400 year eras starting in March
+    uint64_t z = days + 719468;
+    uint64_t era = z / 146097;
+    uint32_t dayOfEra = (uint32_t)(z - era * 146097);
+    uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    uint32_t monthIndex = (5 * dayOfYear + 2) / 153;
+    uint32_t day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    uint32_t month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    uint64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+    if (year > 9999) {
+        year = 9999;
+    }
+
+    std::memcpy(buffer, dayNames[(days + 4) % 7], 3);
+    buffer[3] = ',';
+    buffer[4] = ' ';
+    appendTwoDigits(buffer + 5, day);
+    buffer[7] = ' ';
+    std::memcpy(buffer + 8, monthNames[month - 1], 3);
+    buffer[11] = ' ';
+    appendTwoDigits(buffer + 12, (uint32_t)(year / 100));
+    appendTwoDigits(buffer + 14, (uint32_t)(year % 100));
+    buffer[16] = ' ';
+    appendTwoDigits(buffer + 17, secondsOfDay / 3600);
+    buffer[19] = ':';
+    appendTwoDigits(buffer + 20, (secondsOfDay / 60) % 60);
+    buffer[22] = ':';
+    appendTwoDigits(buffer + 23, secondsOfDay % 60);
+    std::memcpy(buffer + 25, " GMT", 4);
+    return 29;
+}
+
+static
+size_t appendHex(uint64_t value, char* buffer) {
+    static const char hexChars[] = "0123456789abcdef";
+
+    size_t len = 1;
+    for (uint64_t remaining = value >> 4; remaining != 0; remaining >>= 4) {
+        len++;
+    }
+    for (size_t i = len; i > 0; i--) {
+        buffer[i - 1] = hexChars[value & 0xF];
+        value >>= 4;
+    }
+    return len;
+}
+
+/* Validator built from the modification time and size, e.g. "5f3a1c2b-1a4". The buffer must hold 35 chars. */
+static
+size_t formatEtag(uint64_t modifiedTime, uint64_t size, char* buffer) {
+    size_t len = 0;
+    buffer[len++] = '"';
+    len += appendHex(modifiedTime, buffer + len);
+    buffer[len++] = '-';
+    len += appendHex(size, buffer + len);
+    buffer[len++] = '"';
+    return len;
+}
+
+static
+uint64_t getMillis() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * One lock's worth of the cache. Entries are kept in LRU order with the most
+ * recently used at the front.
+ */
+class FileCache::Shard {
+public:
+    typedef std::list<std::pair<String, std::shared_ptr<Entry>>> EntryList;
+
+    Shard() :
+        maxEntries(0),
+        maxMemory(0),
+        memoryUsed(0),
+        generation(0)
+    {}
+
+    void removeEntry(EntryList::iterator entryIter) {
+        memoryUsed -= entryIter->second->content ? entryIter->second->size : 0;
+        entryMap.erase(entryIter->first);
+        entries.erase(entryIter);
+    }
+
+    std::mutex shardMutex;
+    EntryList entries;
+    std::unordered_map<String, EntryList::iterator> entryMap;
+
+    uint32_t maxEntries;
+    uint64_t maxMemory;
+    uint64_t memoryUsed;
+
+    // Bumped on every invalidation, so that a load racing with a change
+    // doesn't insert what it read before the change.
+    uint64_t generation;
+};
+
+FileCache::FileCache() :
+    smallFileLimit(0),
+    shardCount(0),
+    watching(false)
+{}
+
+FileCache::~FileCache() {
+    // Stop callbacks before the shards go away
+    fileWatcher.close();
+}
+
+FileError FileCache::init(const StringRef rootDir) {
+    return init(rootDir, DEFAULT_MAX_ENTRIES, DEFAULT_SMALL_FILE_LIMIT, DEFAULT_MAX_MEMORY);
+}
+
+FileError FileCache::init(const StringRef rootDir, uint32_t maxEntries, uint32_t smallFileLimit, uint64_t maxMemory) {
+    if (shards) {
+        return FileError::InvalidState;
+    }
+    if (rootDir.length() == 0 || maxEntries == 0) {
+        return FileError::InvalidArgument;
+    }
+
+    // Paths are built as root + '/' + relative path, so "/" becomes empty
+    this->rootDir = rootDir.endsWith('/') ? rootDir.substring(0, rootDir.length() - 1) : rootDir;
+    this->smallFileLimit = smallFileLimit;
+
+    // Small caches get fewer shards so each still has a useful number of entries
+    shardCount = 1;
+    while (shardCount < MAX_SHARDS && (shardCount * 2) * 64 <= maxEntries) {
+        shardCount *= 2;
+    }
+
+    shards.reset(new Shard[shardCount]);
+    for (uint32_t i = 0; i < shardCount; i++) {
+        shards[i].maxEntries = maxEntries / shardCount;
+        shards[i].maxMemory = maxMemory / shardCount;
+    }
+
+    FileError err = fileWatcher.init([this](const StringRef path) {
+        onFileChanged(path);
+    });
+    watching = err == FileError::Ok;
+
+    return FileError::Ok;
+}
+
+std::tuple<std::shared_ptr<const FileCache::Entry>, FileError> FileCache::get(const StringRef relativePath) {
+    if (!shards) {
+        return std::make_tuple(nullptr, FileError::InvalidState);
+    }
+
+    Shard& shard = getShard(relativePath);
+    String key(relativePath);
+    uint64_t generation;
+
+    {
+        std::lock_guard<std::mutex> lock(shard.shardMutex);
+        auto mapIter = shard.entryMap.find(key);
+        if (mapIter != shard.entryMap.end()) {
+            Shard::EntryList::iterator entryIter = mapIter->second;
+            if (watching || getMillis() - entryIter->second->loadedAt < REVALIDATE_MILLIS) {
+                shard.entries.splice(shard.entries.begin(), shard.entries, entryIter);
+                if (!entryIter->second->found) {
+                    return std::make_tuple(nullptr, FileError::NotFound);
+                }
+                return std::make_tuple(entryIter->second, FileError::Ok);
+            }
+            shard.removeEntry(entryIter);
+        }
+        generation = shard.generation;
+    }
+
+    String fullPath(rootDir);
+    fullPath.appendChar('/');
+    fullPath.append(relativePath);
+
+    // Start watching before opening, so that any change after the open is seen
+    bool cacheable = true;
+    if (watching) {
+        ptrdiff_t slashIndex = fullPath.lastIndexOf("/");
+        FileError watchErr = fileWatcher.watchDirectory(slashIndex == 0 ? StringRef("/") : fullPath.substring(0, slashIndex));
+        cacheable = watchErr == FileError::Ok;
+    }
+
+    std::shared_ptr<Entry> entry;
+    FileError err;
+    std::tie(entry, err) = loadEntry(fullPath);
+    if (!cacheable || (err != FileError::Ok && err != FileError::NotFound)) {
+        return std::make_tuple(entry, err);
+    }
+
+    // Misses are remembered too, as probing for optional files is common
+    if (err == FileError::NotFound) {
+        entry.reset(new Entry());
+        entry->size = 0;
+        entry->found = false;
+        entry->loadedAt = getMillis();
+    }
+
+    std::lock_guard<std::mutex> lock(shard.shardMutex);
+    if (shard.generation != generation || shard.entryMap.find(key) != shard.entryMap.end()) {
+        return std::make_tuple(entry->found ? entry : nullptr, err);
+    }
+
+    shard.entries.emplace_front(key, entry);
+    shard.entryMap[key] = shard.entries.begin();
+    shard.memoryUsed += entry->content ? entry->size : 0;
+
+    while (shard.entries.size() > 1 &&
+           (shard.entries.size() > shard.maxEntries || shard.memoryUsed > shard.maxMemory)) {
+        shard.removeEntry(std::prev(shard.entries.end()));
+    }
+
+    if (!entry->found) {
+        return std::make_tuple(nullptr, FileError::NotFound);
+    }
+    return std::make_tuple(entry, FileError::Ok);
+}
+
+void FileCache::invalidate(const StringRef relativePath) {
+    if (!shards) {
+        return;
+    }
+
+    Shard& shard = getShard(relativePath);
+    std::lock_guard<std::mutex> lock(shard.shardMutex);
+    shard.generation++;
+
+    auto mapIter = shard.entryMap.find(String(relativePath));
+    if (mapIter != shard.entryMap.end()) {
+        shard.removeEntry(mapIter->second);
+    }
+}
+
+void FileCache::invalidateAll() {
+    if (!shards) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < shardCount; i++) {
+        Shard& shard = shards[i];
+        std::lock_guard<std::mutex> lock(shard.shardMutex);
+        shard.generation++;
+        shard.entries.clear();
+        shard.entryMap.clear();
+        shard.memoryUsed = 0;
+    }
+}
+
+FileCache::Shard& FileCache::getShard(const StringRef relativePath) {
+    return shards[relativePath.hash() & (shardCount - 1)];
+}
+
+void FileCache::onFileChanged(const StringRef path) {
+    // Paths come back as they were watched, which is under the root
+    if (path.length() > rootDir.length() &&
+        path.startsWith(rootDir) &&
+        path.charAt(rootDir.length()) == '/') {
+        invalidate(path.substring(rootDir.length() + 1));
+    } else {
+        invalidateAll();
+    }
+}
+
+std::tuple<std::shared_ptr<FileCache::Entry>, FileError> FileCache::loadEntry(const StringRef fullPath) {
+    std::shared_ptr<Entry> entry(new Entry());
+
+    FileError err = entry->file.open(fullPath);
+    if (err != FileError::Ok) {
+        return std::make_tuple(nullptr, err);
+    }
+
+    // Directories and devices are not served
+    if (!entry->file.isRegular()) {
+        return std::make_tuple(nullptr, FileError::NotFound);
+    }
+
+    uint64_t size = entry->file.getSize();
+    uint64_t modifiedTime = entry->file.getModifiedTime();
+
+    char contentLenBuffer[20];
+    size_t contentLenStrLen = Strconv::uint64ToStr(size, contentLenBuffer, sizeof(contentLenBuffer));
+    char dateBuffer[29];
+    size_t dateLen = formatHttpDate(modifiedTime, dateBuffer);
+    char etagBuffer[35];
+    size_t etagLen = formatEtag(modifiedTime, size, etagBuffer);
+
+    entry->size = size;
+    entry->contentLength = StringRef(contentLenBuffer, contentLenStrLen);
+    entry->lastModified = StringRef(dateBuffer, dateLen);
+    entry->etag = StringRef(etagBuffer, etagLen);
+    entry->contentType = getContentType(fullPath);
+    entry->found = true;
+    entry->loadedAt = getMillis();
+
+    if (size <= smallFileLimit) {
+        entry->content.reset(new char[size == 0 ? 1 : size]);
+
+        uint64_t totalRead = 0;
+        while (totalRead < size) {
+            uint32_t bytesRead;
+            std::tie(bytesRead, err) = entry->file.read(totalRead, entry->content.get() + totalRead, (uint32_t)(size - totalRead));
+            if (err != FileError::Ok) {
+                return std::make_tuple(nullptr, err);
+            }
+
+            // Truncated while reading, the watcher or revalidation will pick up the new version
+            if (bytesRead == 0) {
+                return std::make_tuple(nullptr, FileError::IoError);
+            }
+            totalRead += bytesRead;
+        }
+        entry->file.close();
+    }
+
+    return std::make_tuple(entry, FileError::Ok);
+}
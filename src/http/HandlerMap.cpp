@@ -4,9 +4,41 @@
 using namespace Cupcake;
 
 bool HandlerMap::addHandler(const StringRef path, HttpHandler handler) {
-    return handlers.addNode(path, handler);
+    return addHandler(ALL_METHODS, path, handler);
 }
 
-std::tuple<HttpHandler, bool> HandlerMap::getHandler(const StringRef path) const {
-    return handlers.find(path);
-}
\ No newline at end of file
+bool HandlerMap::addHandler(HttpMethod method, const StringRef path, HttpHandler handler) {
+    return addHandler(1u << (uint32_t)method, path, handler);
+}
+
+bool HandlerMap::addHandler(uint32_t methodMask, const StringRef path, HttpHandler handler) {
+    Route* route = routes.getOrAddNode(path);
+    if (!route || methodMask == 0 || (route->methodMask & methodMask) != 0) {
+        return false; // Invalid path, or already handled
+    }
+
+    for (size_t i = 0; i < METHOD_COUNT; i++) {
+        if (methodMask & (1u << i)) {
+            route->handlers[i] = handler;
+        }
+    }
+    route->methodMask |= methodMask;
+    return true;
+}
+
+void HandlerMap::freeze() {
+    routes.freeze();
+}
+
+std::tuple<const HttpHandler*, uint32_t> HandlerMap::getHandler(HttpMethod method, const StringRef path,
+                                                                PathParams& pathParams) const {
+    const Route* route = routes.lookup(path, pathParams);
+    if (!route) {
+        return std::make_tuple(nullptr, 0);
+    }
+
+    if (!(route->methodMask & (1u << (uint32_t)method))) {
+        return std::make_tuple(nullptr, route->methodMask);
+    }
+    return std::make_tuple(&route->handlers[(size_t)method], route->methodMask);
+}
@@ -6,24 +6,16 @@
 #include "cupcake/internal/http/ContentLengthReader.h"
 #include "cupcake/internal/http/HttpRequestImpl.h"
 #include "cupcake/internal/http/HttpResponseImpl.h"
+#include "cupcake/internal/http/HttpTokens.h"
 #include "cupcake/internal/http/NullReader.h"
 #include "cupcake/internal/text/Strconv.h"
-
-#include <unordered_map>
+#include "cupcake/internal/text/StringBuilder.h"
 
 using namespace Cupcake;
 
-static
-std::unordered_map<StringRef, HttpMethod> methodLookupMap = {
-    {"CONNECT", HttpMethod::Connect},
-    {"DELETE", HttpMethod::Delete},
-    {"GET", HttpMethod::Get},
-    {"HEAD", HttpMethod::Head},
-    {"OPTIONS", HttpMethod::Options},
-    {"POST", HttpMethod::Post},
-    {"PUT", HttpMethod::Put},
-    {"TRACE", HttpMethod::Trace},
-};
+// Limits on what a client can make us buffer before the request body
+#define MAX_URL_LENGTH (64 * 1024)
+#define MAX_HEAD_LENGTH (1 * 1024 * 1024)
 
 enum class HttpConnection::HttpState {
     Headers,
@@ -31,16 +23,21 @@ enum class HttpConnection::HttpState {
     Failed,
 };
 
-HttpConnection::HttpConnection(StreamSource* streamSource, BufferedReader& bufReader, const HandlerMap* handlerMap) :
-    handlerMap(handlerMap),
+HttpConnection::HttpConnection(StreamSource* streamSource, BufferedReader& bufReader, const RouteTable* routeTable,
+                               const CompressionConfig* compressionConfig) :
+    routeTable(routeTable),
+    compressionConfig(compressionConfig),
     bufReader(bufReader),
     streamSource(streamSource),
     state(HttpState::Headers),
+    arena(),
+    requestData(&arena),
     keepAlive(false),
     hasContentLength(false),
     contentLength(0),
     isChunked(false),
-    hasHost(false)
+    hasHost(false),
+    requestParser(MAX_URL_LENGTH, MAX_HEAD_LENGTH)
 {}
 
 HttpConnection::~HttpConnection() {
@@ -59,10 +56,15 @@ HttpConnection::UpgradeType HttpConnection::run() {
 
 std::tuple<HttpConnection::UpgradeType, HttpError> HttpConnection::innerRun() {
     HttpError err;
-    StringRef line;
     Status status;
     bool http2Preface;
 
+    // Nothing to hold a buffer for until the client sends something
+    err = bufReader.waitForData();
+    if (err != HttpError::Ok) {
+        return std::make_tuple(UpgradeType::None, err);
+    }
+
     // Check for an HTTP2 preface (client knows HTTP2 is supported)
     std::tie(http2Preface, err) = bufReader.peekMatch("PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n", 24);
     if (err != HttpError::Ok) {
@@ -75,36 +77,47 @@ std::tuple<HttpConnection::UpgradeType, HttpError> HttpConnection::innerRun() {
     do {
         state = HttpState::Headers;
         requestData.reset();
+        arena.reset();
+        specialHeaders.clear();
         keepAlive = false;
         hasContentLength = false;
         contentLength = 0;
         isChunked = false;
         hasHost = false;
 
-        // Read the request line
-        std::tie(line, err) = bufReader.readLine(64 * 1024); // TODO: Define limit somewhere
+        // Between keep-alive requests the connection idles here without a
+        // read buffer, unless the next request is already buffered
+        err = bufReader.waitForData();
         if (err != HttpError::Ok) {
             return std::make_tuple(UpgradeType::None, err);
         }
 
-        status = parseRequestLine(line);
+        // Parse the head as it arrives, straight out of the read buffer
+        requestParser.reset();
+        RequestParser::Result parseResult;
+        do {
+            StringRef buffered = bufReader.getBuffered();
+            parseResult = requestParser.parse(buffered.data(), buffered.length());
+            if (parseResult == RequestParser::Result::Incomplete) {
+                err = bufReader.fill(MAX_HEAD_LENGTH);
+                if (err == HttpError::LineTooLong) {
+                    parseResult = RequestParser::Result::HeadTooLarge;
+                } else if (err != HttpError::Ok) {
+                    return std::make_tuple(UpgradeType::None, err);
+                }
+            }
+        } while (parseResult == RequestParser::Result::Incomplete);
+
+        status = parseResultStatus(parseResult);
         if (!status.ok()) {
             break;
         }
 
-        // Read the headers
-        do {
-            std::tie(line, err) = bufReader.readLine(1 * 1024 * 1024); // TODO: Define limit somewhere
-            if (err != HttpError::Ok) {
-                return std::make_tuple(UpgradeType::None, err);
-            }
-
-            // Switches to body state on empty line
-            status = parseHeaderLine(line);
-            if (!status.ok()) {
-                break;
-            }
-        } while (state == HttpState::Headers);
+        status = copyRequestHead();
+        state = HttpState::Body;
+        if (!status.ok()) {
+            break;
+        }
 
         // Go through the headers so far and parse out special ones we need to pay attention to
         status = parseSpecialHeaders();
@@ -118,19 +131,14 @@ std::tuple<HttpConnection::UpgradeType, HttpError> HttpConnection::innerRun() {
             break;
         }
 
-        // Lookup a handler for the URL
-        HttpHandler handler;
-        bool foundHandler;
-        std::tie(handler, foundHandler) = handlerMap->getHandler(requestData.getUrl());
-
-        // If there is no handler, just 404 and loop
-        if (!foundHandler) {
-            err = sendStatus(404, "Not Found");
-            if (err != HttpError::Ok) {
-                return std::make_tuple(UpgradeType::None, err);
-            }
-            continue;
-        }
+        // Lookup a handler for the URL. The snapshot keeps it alive until the
+        // request is done, even if the routes change meanwhile.
+        RouteTable::Snapshot routes = routeTable->getSnapshot();
+        const HttpHandler* handler;
+        uint32_t allowedMethods;
+        PathParams pathParams;
+        std::tie(handler, allowedMethods) = routes->getHandler(requestData.getMethod(), requestData.getPath(),
+                                                               pathParams);
 
         // Set up a reader based on the request
         ChunkedReader chunkedReader(bufReader);
@@ -146,17 +154,55 @@ std::tuple<HttpConnection::UpgradeType, HttpError> HttpConnection::innerRun() {
             inputStream = &nullReader;
         }
 
+        // If there is no handler, just 404, 405 or answer the OPTIONS and loop
+        if (!handler) {
+            if (allowedMethods == 0) {
+                err = sendStatus(404, "Not Found");
+            } else if (requestData.getMethod() == HttpMethod::Options) {
+                err = sendAllowedMethods(200, "OK", allowedMethods);
+            } else {
+                err = sendAllowedMethods(405, "Method Not Allowed", allowedMethods);
+            }
+            if (err != HttpError::Ok) {
+                return std::make_tuple(UpgradeType::None, err);
+            }
+            // The body has to be read past before the next request can be
+            if (inputStream->close() != HttpError::Ok) {
+                keepAlive = false;
+            }
+            continue;
+        }
+
         // Create request and response objects
-        HttpRequestImpl requestImpl(requestData, *inputStream);
-        HttpResponseImpl responseImpl(requestData.getVersion(), streamSource);
+        HttpRequestImpl requestImpl(requestData, pathParams, *inputStream);
+        HttpResponseImpl responseImpl(requestData.getVersion(), streamSource, &arena);
+
+        if (compressionConfig && compressionConfig->isEnabled()) {
+            StringRef acceptEncoding;
+            bool hasAcceptEncoding;
+            std::tie(acceptEncoding, hasAcceptEncoding) = requestImpl.getHeader(HttpHeader::AcceptEncoding);
+            if (hasAcceptEncoding) {
+                responseImpl.setCompression(compressionConfig, acceptEncoding);
+            }
+        }
 
         // Run the user handler
-        handler(requestImpl, responseImpl);
+        (*handler)(requestImpl, responseImpl);
+
+        // Skips whatever of the body the handler didn't read, so it can't be
+        // taken for the next request. If that fails, there's no telling where
+        // the next request starts.
+        if (inputStream->close() != HttpError::Ok) {
+            keepAlive = false;
+        }
 
         err = responseImpl.close();
         if (err != HttpError::Ok) {
             return std::make_tuple(UpgradeType::None, err);
         }
+        if (responseImpl.isCloseDelimited()) {
+            keepAlive = false;
+        }
     } while (keepAlive);
 
     // If we exit the main loop because we need to emit a status, it should be a
@@ -171,124 +217,69 @@ std::tuple<HttpConnection::UpgradeType, HttpError> HttpConnection::innerRun() {
     return std::make_tuple(UpgradeType::None, HttpError::Ok);
 }
 
-HttpConnection::Status HttpConnection::parseRequestLine(const StringRef line) {
-    // Assuming exactly two spaces at the moment
-    ptrdiff_t firstSpaceIndex = line.indexOf(' ');
-    if (firstSpaceIndex == -1 || firstSpaceIndex == line.length() - 1) {
-        return Status(400, "Bad Request");
-    }
-
-    ptrdiff_t secondSpaceIndex = line.indexOf(' ', firstSpaceIndex + 1);
-    if (secondSpaceIndex == -1) {
-        return Status(400, "Bad Request");
-    }
-
-    // Extract method
-    StringRef methodStr = line.substring(0, firstSpaceIndex);
-    auto methodLookup = methodLookupMap.find(methodStr);
-    if (methodLookup == methodLookupMap.end()) {
+HttpConnection::Status HttpConnection::parseResultStatus(RequestParser::Result parseResult) {
+    switch (parseResult) {
+    case RequestParser::Result::Complete:
+        return Status();
+    case RequestParser::Result::UnknownMethod:
         // https://www.w3.org/Protocols/rfc2616/rfc2616-sec5.html#sec5.1.1
         return Status(501, "Not Implemented");
-    }
-
-    requestData.setMethod(methodLookup->second);
-
-    // Extract URL
-    StringRef url = line.substring(firstSpaceIndex + 1, secondSpaceIndex);
-
-    if (url.length() == 0) {
+    case RequestParser::Result::UnsupportedVersion:
+        return Status(505, "HTTP Version Not Supported");
+    case RequestParser::Result::UriTooLong:
+        return Status(414, "URI Too Long");
+    case RequestParser::Result::HeadTooLarge:
+        return Status(431, "Request Header Fields Too Large");
+    default:
         return Status(400, "Bad Request");
     }
+}
 
-    requestData.setUrl(url);
+// Copies what the parser found out of the read buffer, so the buffer can be
+// reused for the body
+HttpConnection::Status HttpConnection::copyRequestHead() {
+    const char* head = bufReader.getBuffered().data();
 
-    // Extract the version
-    StringRef version = line.substring(secondSpaceIndex + 1, line.length());
+    requestData.setMethod(requestParser.getMethod());
+    bool validUrl = requestData.setUrl(requestParser.getUrl(head));
+    requestData.setVersion(requestParser.getVersion());
+    keepAlive = (requestParser.getVersion() == HttpVersion::Http1_1);
 
-    if (version.equals("HTTP/1.0")) {
-        requestData.setVersion(HttpVersion::Http1_0);
-        keepAlive = false;
-    } else if (version.equals("HTTP/1.1")) {
-        requestData.setVersion(HttpVersion::Http1_1);
-        keepAlive = true;
-    } else {
-        if (version.startsWith("HTTP/")) {
-            return Status(505, "HTTP Version Not Supported");
+    for (size_t i = 0; i < requestParser.getHeaderCount(); i++) {
+        if (requestParser.isContinuation(i)) {
+            requestData.appendToHeaderValue(requestParser.getHeaderValue(head, i));
         } else {
-            return Status(400, "Bad Request");
-        }
-    }
-
-    return Status();
-}
-
-HttpConnection::Status HttpConnection::parseHeaderLine(const StringRef line) {
-    // Check for end of headers
-    if (line.length() == 0) {
-        state = HttpState::Body;
-        return Status();
-    }
+            HttpHeader header = requestParser.getHeader(i);
+            switch (header) {
+            case HttpHeader::ContentLength:
+            case HttpHeader::TransferEncoding:
+            case HttpHeader::Connection:
+            case HttpHeader::Host:
+                specialHeaders.push_back(SpecialHeader{header, requestData.getHeaderCount()});
+                break;
+            default:
+                break;
+            }
 
-    // Check pad length
-    size_t padLength = 0;
-    while (line.charAt(padLength) == ' ' ||
-           line.charAt(padLength) == '\t') {
-        padLength++;
+            requestData.addHeaderName(requestParser.getHeaderName(head, i), header, requestParser.getHeaderHash(i));
+            requestData.addHeaderValue(requestParser.getHeaderValue(head, i));
+        }
     }
 
-    // If padded, treat as extension of previous line
-    if (padLength != 0) {
-        requestData.appendToHeaderValue(line.substring(padLength));
-        return Status();
-    }
+    bufReader.consume((uint32_t)requestParser.getHeadLength());
 
-    // If not padded, try to split
-    ptrdiff_t colonIndex = line.indexOf(':');
-    if (colonIndex == -1) {
+    if (!validUrl) {
         return Status(400, "Bad Request");
     }
-
-    // The spec only specifies leading whitespace on the value, but also
-    // right trimming the header name.
-    StringRef headerName = line.substring(0, colonIndex);
-    while (headerName.endsWith(' ') ||
-           headerName.endsWith('\t')) {
-        headerName = headerName.substring(0, headerName.length() - 1);
-    }
-
-    StringRef headerValue = line.substring(colonIndex + 1, line.length());
-    while (headerValue.startsWith(' ') ||
-           headerValue.startsWith('\t')) {
-        headerValue = headerValue.substring(1);
-    }
-
-    // There is the possibility of multiple headers with the same name.
-    // In that case, we want to append it as a comma separated value to
-    // the previous header.
-    // https://www.w3.org/Protocols/rfc2616/rfc2616-sec4.html#sec4.2
-    /*
-    for (size_t i = 0; i < requestData.getHeaderCount(); i++) {
-        const String& existingHeaderName = requestData.getHeaderName(i);
-        if (headerName.engEqualsIgnoreCase(existingHeaderName)) {
-            String& existingValue = headerValues[i];
-            existingValue.appendChar(',');
-            existingValue.append(headerValue);
-            return Status();
-        }
-    }
-    */
-
-    requestData.addHeaderName(headerName);
-    requestData.addHeaderValue(headerValue);
     return Status();
 }
 
-// TODO: Store index of these headers so we don't need to find them?
+// Only looks at the headers recorded while copying the head, which have
+// their final values by now
 HttpConnection::Status HttpConnection::parseSpecialHeaders() {
-    for (size_t i = 0; i < requestData.getHeaderCount(); i++) {
-        const StringRef headerName = requestData.getHeaderName(i);
-        const StringRef headerValue = requestData.getHeaderValue(i);
-        if (headerName.engEqualsIgnoreCase("Content-Length")) {
+    for (const SpecialHeader& special : specialHeaders) {
+        const StringRef headerValue = requestData.getHeaderValue(special.index);
+        if (special.header == HttpHeader::ContentLength) {
             bool validNumber;
             std::tie(contentLength, validNumber) = Strconv::parseUint64(headerValue);
 
@@ -296,7 +287,7 @@ HttpConnection::Status HttpConnection::parseSpecialHeaders() {
                 return Status(400, "Bad Request");
             }
             hasContentLength = true;
-        } else if (headerName.engEqualsIgnoreCase("Transfer-Encoding")) {
+        } else if (special.header == HttpHeader::TransferEncoding) {
             // Chunked if value after last comma is "chunked"
             StringRef last = CommaListIterator(headerValue).getLast();
             isChunked = last.engEqualsIgnoreCase("chunked");
@@ -305,7 +296,7 @@ HttpConnection::Status HttpConnection::parseSpecialHeaders() {
             if (requestData.getVersion() == HttpVersion::Http1_0 && isChunked) {
                 return Status(400, "Bad Request");
             }
-        } else if (headerName.engEqualsIgnoreCase("Connection")) {
+        } else if (special.header == HttpHeader::Connection) {
             // The Connection header is a comma separater list
             CommaListIterator connectionIter(headerValue);
             bool closeFound = false;
@@ -325,7 +316,7 @@ HttpConnection::Status HttpConnection::parseSpecialHeaders() {
             if (closeFound && keepAliveFound) {
                 return Status(400, "Bad Request");
             }
-        } else if (headerName.engEqualsIgnoreCase("Host")) {
+        } else if (special.header == HttpHeader::Host) {
             if (hasHost) {
                 return Status(400, "Bad Request");
             }
@@ -375,3 +366,24 @@ HttpError HttpConnection::sendStatus(uint32_t code, const StringRef reasonPhrase
 
     return streamSource->writev(ioBufs, 3);
 }
+
+HttpError HttpConnection::sendAllowedMethods(uint32_t code, const StringRef reasonPhrase, uint32_t allowedMethods) {
+    // OPTIONS is always answered, by the handler or by us
+    allowedMethods |= 1u << (uint32_t)HttpMethod::Options;
+
+    StringBuilder allow;
+    for (uint32_t i = 0; i < HandlerMap::METHOD_COUNT; i++) {
+        if (allowedMethods & (1u << i)) {
+            if (allow.length() != 0) {
+                allow.append(", ");
+            }
+            allow.append(HttpTokens::getMethodName((HttpMethod)i));
+        }
+    }
+
+    HttpResponseImpl responseImpl(requestData.getVersion(), streamSource, &arena);
+    responseImpl.setStatus(code, reasonPhrase);
+    responseImpl.addHeader("Allow", allow.build(&arena));
+    responseImpl.addHeader("Content-Length", "0");
+    return responseImpl.close();
+}
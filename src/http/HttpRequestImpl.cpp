@@ -4,8 +4,10 @@
 using namespace Cupcake;
 
 HttpRequestImpl::HttpRequestImpl(RequestData& requestData,
+    const PathParams& pathParams,
     HttpInputStream& inputStream) :
     requestData(requestData),
+    pathParams(pathParams),
     inputStream(inputStream)
 {}
 
@@ -17,6 +19,30 @@ const StringRef HttpRequestImpl::getUrl() const {
     return requestData.getUrl();
 }
 
+const StringRef HttpRequestImpl::getPath() const {
+    return requestData.getPath();
+}
+
+const StringRef HttpRequestImpl::getQuery() const {
+    return requestData.getQuery();
+}
+
+uint32_t HttpRequestImpl::getQueryParamCount() const {
+    return (uint32_t)requestData.getQueryParamCount();
+}
+
+std::tuple<StringRef, StringRef> HttpRequestImpl::getQueryParam(uint32_t index) const {
+    return std::make_tuple(requestData.getQueryParamName(index), requestData.getQueryParamValue(index));
+}
+
+std::tuple<StringRef, bool> HttpRequestImpl::getQueryParam(const StringRef name) const {
+    ptrdiff_t index = requestData.findQueryParam(name);
+    if (index == -1) {
+        return std::make_tuple(StringRef(), false);
+    }
+    return std::make_tuple(requestData.getQueryParamValue(index), true);
+}
+
 uint32_t HttpRequestImpl::getHeaderCount() const {
     return requestData.getHeaderCount();
 }
@@ -25,15 +51,45 @@ std::tuple<StringRef, StringRef> HttpRequestImpl::getHeader(uint32_t index) cons
     return std::make_tuple(requestData.getHeaderName(index), requestData.getHeaderValue(index));
 }
 
+// TODO: These should probably merge into a comma delimited list if there are multiple
 std::tuple<StringRef, bool> HttpRequestImpl::getHeader(const StringRef headerName) const {
-    // TODO: This should probably merge into a comma delimited list if there are multiple
-    for (size_t i = 0; i < requestData.getHeaderCount(); i++) {
-        const StringRef testName = requestData.getHeaderName(i);
-        if (testName.engEqualsIgnoreCase(headerName)) {
-            return std::make_tuple(requestData.getHeaderValue(i), true);
-        }
+    ptrdiff_t index = requestData.findHeader(headerName);
+    if (index == -1) {
+        return std::make_tuple(StringRef(), false);
+    }
+    return std::make_tuple(requestData.getHeaderValue(index), true);
+}
+
+std::tuple<StringRef, bool> HttpRequestImpl::getHeader(HttpHeader header) const {
+    ptrdiff_t index = requestData.findHeader(header);
+    if (index == -1) {
+        return std::make_tuple(StringRef(), false);
     }
-    return std::make_tuple(StringRef(), false);
+    return std::make_tuple(requestData.getHeaderValue(index), true);
+}
+
+ptrdiff_t HttpRequestImpl::findHeader(const StringRef headerName) const {
+    return requestData.findHeader(headerName);
+}
+
+ptrdiff_t HttpRequestImpl::findHeader(HttpHeader header) const {
+    return requestData.findHeader(header);
+}
+
+ptrdiff_t HttpRequestImpl::findNextHeader(uint32_t index) const {
+    return requestData.findNextHeader(index);
+}
+
+uint32_t HttpRequestImpl::getPathParamCount() const {
+    return (uint32_t)pathParams.getCount();
+}
+
+std::tuple<StringRef, StringRef> HttpRequestImpl::getPathParam(uint32_t index) const {
+    return std::make_tuple(pathParams.getName(index), pathParams.getValue(index));
+}
+
+std::tuple<StringRef, bool> HttpRequestImpl::getPathParam(const StringRef name) const {
+    return pathParams.get(name);
 }
 
 HttpInputStream& HttpRequestImpl::getInputStream() {
@@ -3,37 +3,72 @@
 
 #include "cupcake/internal/http/CommaListIterator.h"
 #include "cupcake/internal/text/Strconv.h"
+#include "cupcake/internal/text/StringBuilder.h"
 
+#include <algorithm>
 #include <memory>
 
 using namespace Cupcake;
 
+// Room after the headers for the first body write to be gathered in
+#define CORK_SPARE_BUFFERS 8
+
 enum class HttpResponseImpl::ResponseStatus {
     HEADERS,
     CLOSED
 };
 
 HttpResponseImpl::HttpResponseImpl(HttpVersion version, StreamSource* streamSource) :
+    HttpResponseImpl(version, streamSource, nullptr)
+{}
+
+HttpResponseImpl::HttpResponseImpl(HttpVersion version, StreamSource* streamSource, Arena* arena) :
 version(version),
 streamSource(streamSource),
 respStatus(ResponseStatus::HEADERS),
+corkedSource(streamSource),
+headerBuffers(),
 httpOutputStream(nullptr),
 contentLengthWriter(),
 chunkedWriter(),
+compressingWriter(),
+compressionConfig(nullptr),
+acceptEncoding(),
+arena(arena),
+statusCode(0),
+statusText(arena),
+headerNames(),
+headerValues(),
+statusSet(false),
 setContentLength(false),
 contentLength(0),
-setTeChunked(false)
+setTeChunked(false),
+closeDelimited(false)
 {}
 
+void HttpResponseImpl::setCompression(const CompressionConfig* compressionConfig, const StringRef acceptEncoding) {
+    this->compressionConfig = compressionConfig;
+    this->acceptEncoding = acceptEncoding;
+}
+
+// Both are ignored once the headers are committed. Corked headers point
+// straight at these strings, so changing them then would leave the buffers
+// dangling.
 void HttpResponseImpl::setStatus(uint32_t code, StringRef statusText) {
+    if (respStatus != ResponseStatus::HEADERS) {
+        return;
+    }
     this->statusCode = code;
     this->statusText = statusText;
     statusSet = true;
 }
 
 void HttpResponseImpl::addHeader(StringRef headerName, StringRef headerValue) {
-    headerNames.push_back(headerName);
-    headerValues.push_back(headerValue);
+    if (respStatus != ResponseStatus::HEADERS) {
+        return;
+    }
+    headerNames.emplace_back(headerName, arena);
+    headerValues.emplace_back(headerValue, arena);
 }
 
 std::tuple<HttpOutputStream*, HttpError> HttpResponseImpl::getOutputStream() {
@@ -51,6 +86,14 @@ std::tuple<HttpOutputStream*, HttpError> HttpResponseImpl::getOutputStream() {
         return std::make_tuple(nullptr, err);
     }
     
+    // Compression defers writing the headers until it knows whether to compress
+    CompressionType compressionType = chooseCompression();
+    if (compressionType != CompressionType::None) {
+        compressingWriter.init(this, compressionType, compressionConfig->getMinSize());
+        httpOutputStream = &compressingWriter;
+        return std::make_tuple(httpOutputStream, HttpError::Ok);
+    }
+    
     if (!setContentLength && !setTeChunked) {
         // In the special case that it's HTTP1.0, and no content-length was specified,
         // return a writer that buffers the content
@@ -60,9 +103,9 @@ std::tuple<HttpOutputStream*, HttpError> HttpResponseImpl::getOutputStream() {
             return std::make_tuple(httpOutputStream, HttpError::Ok);
         }
         
-        headerNames.push_back("Transfer-Encoding");
-        headerValues.push_back("chunked");
-        chunkedWriter.init(streamSource);
+        headerNames.emplace_back("Transfer-Encoding", arena);
+        headerValues.emplace_back("chunked", arena);
+        chunkedWriter.init(&corkedSource);
         httpOutputStream = &chunkedWriter;
     }
     
@@ -74,45 +117,175 @@ std::tuple<HttpOutputStream*, HttpError> HttpResponseImpl::getOutputStream() {
 }
 
 HttpError HttpResponseImpl::close() {
-    if (respStatus == ResponseStatus::CLOSED) {
-        return HttpError::Ok;
+    HttpError err;
+    if (respStatus == ResponseStatus::HEADERS) {
+        respStatus = ResponseStatus::CLOSED;
+
+        err = parseHeaders();
+        if (err != HttpError::Ok) {
+            return err;
+        }
+        err = writeHeaders();
+        if (err != HttpError::Ok) {
+            return err;
+        }
+    } else if (httpOutputStream) {
+        // Already closed by the handler is fine
+        err = httpOutputStream->close();
+        if (err != HttpError::Ok && err != HttpError::StreamClosed) {
+            return err;
+        }
     }
+
+    return corkedSource.flush();
+}
+
+HttpError HttpResponseImpl::sendFile(const File& file, uint64_t offset, uint64_t length) {
     if (respStatus != ResponseStatus::HEADERS) {
         return HttpError::InvalidState;
     }
     respStatus = ResponseStatus::CLOSED;
-    
+
     HttpError err = parseHeaders();
     if (err != HttpError::Ok) {
         return err;
     }
-    
-    return writeHeaders();
+
+    // The file is the whole body, so it has to be described by a Content-Length
+    if (setTeChunked) {
+        return HttpError::InvalidHeader;
+    }
+    if (setContentLength) {
+        if (contentLength != length) {
+            return HttpError::InvalidHeader;
+        }
+    } else {
+        char contentLenBuffer[20];
+        size_t contentLengthStrLen = Strconv::uint64ToStr(length, contentLenBuffer, sizeof(contentLenBuffer));
+        headerNames.emplace_back("Content-Length", arena);
+        headerValues.emplace_back(StringRef(contentLenBuffer, contentLengthStrLen), arena);
+    }
+
+    size_t buffersNeeded = 5 + (4 * headerNames.size());
+
+    // TODO: malloca
+    std::unique_ptr<INet::IoBuffer[]> ioBufHolder(new INet::IoBuffer[buffersNeeded]);
+    INet::IoBuffer* ioBufs = ioBufHolder.get();
+
+    fillHeaderBuffers(ioBufs, codeBuffer, sizeof(codeBuffer));
+
+    return streamSource->sendFile(ioBufs, (uint32_t)buffersNeeded, file, offset, length);
+}
+
+std::tuple<HttpOutputStream*, HttpError> HttpResponseImpl::startCompressedBody(CompressionType type) {
+    // The compressed length isn't known up front
+    if (setContentLength) {
+        removeHeader("Content-Length");
+        setContentLength = false;
+    }
+    // The encoded bytes differ, so a strong validator no longer applies
+    for (size_t i = 0; i < headerNames.size(); i++) {
+        if (headerNames[i].engEqualsIgnoreCase("ETag") && headerValues[i].startsWith("\"")) {
+            headerValues[i] = StringBuilder().append("W/").append(headerValues[i]).build(arena);
+        }
+    }
+    headerNames.emplace_back("Content-Encoding", arena);
+    headerValues.emplace_back(Compressor::getCoding(type), arena);
+    addVary("Accept-Encoding");
+
+    if (!setTeChunked) {
+        headerNames.emplace_back("Transfer-Encoding", arena);
+        headerValues.emplace_back("chunked", arena);
+        chunkedWriter.init(&corkedSource);
+    }
+
+    HttpError err = writeHeaders();
+    if (err != HttpError::Ok) {
+        return std::make_tuple(nullptr, err);
+    }
+    return std::make_tuple(&chunkedWriter, HttpError::Ok);
+}
+
+HttpError HttpResponseImpl::writeUncompressedBody(const char* content, size_t contentLen) {
+    addVary("Accept-Encoding");
+
+    HttpOutputStream* outputStream;
+    if (setContentLength) {
+        outputStream = &contentLengthWriter;
+    } else if (setTeChunked) {
+        outputStream = &chunkedWriter;
+    } else if (contentLen != 0) {
+        // Everything is here, so it can go out with a Content-Length in one write
+        return writeHeadersAndBody(content, contentLen);
+    } else {
+        headerNames.emplace_back("Content-Length", arena);
+        headerValues.emplace_back("0", arena);
+        return writeHeaders();
+    }
+
+    HttpError err = writeHeaders();
+    if (err != HttpError::Ok) {
+        return err;
+    }
+    err = outputStream->write(content, (uint32_t)contentLen);
+    if (err != HttpError::Ok) {
+        return err;
+    }
+    return outputStream->close();
+}
+
+bool HttpResponseImpl::isCloseDelimited() const {
+    return closeDelimited;
 }
 
 HttpError HttpResponseImpl::writeHeadersAndBody(const char* bufferedContent, size_t bufferedContentLen) {
+    INet::IoBuffer contentBuf;
+    contentBuf.buffer = (char*)bufferedContent;
+    contentBuf.bufferLen = (uint32_t)bufferedContentLen;
+    return writeHeadersAndBody(&contentBuf, bufferedContentLen != 0 ? 1 : 0, bufferedContentLen);
+}
+
+HttpError HttpResponseImpl::writeHeadersAndBody(const INet::IoBuffer* content, uint32_t contentCount, uint64_t contentLen) {
     
     // If this is the special case of an HTTP1/0 response where we're buffering
-    // content of an unknown length, append a content length header, and make
-    // room in the iovec array for the data.
-    if (bufferedContentLen != 0) {
+    // content of an unknown length, append a content length header.
+    if (contentLen != 0) {
         char contentLenBuffer[20];
-        size_t contentLengthStrLen = Strconv::int64ToStr((uint64_t)bufferedContentLen, contentLenBuffer, sizeof(contentLenBuffer));
-        headerNames.push_back("Content-Length");
-        headerValues.push_back(StringRef(contentLenBuffer, contentLengthStrLen));
+        size_t contentLengthStrLen = Strconv::uint64ToStr(contentLen, contentLenBuffer, sizeof(contentLenBuffer));
+        headerNames.emplace_back("Content-Length", arena);
+        headerValues.emplace_back(StringRef(contentLenBuffer, contentLengthStrLen), arena);
     }
     
+    // The headers stay corked until there's body to send with them, or the
+    // response is closed. Sized so the content can be gathered in place.
     size_t buffersNeeded = 5 + (4 * headerNames.size());
-    if (bufferedContentLen != 0) {
-        buffersNeeded++;
-    }
-    
-    // TODO: malloca
-    std::auto_ptr<INet::IoBuffer> ioBufHolder(new INet::IoBuffer[buffersNeeded]);
-    INet::IoBuffer* ioBufs = ioBufHolder.get();
+    size_t bufferCapacity = buffersNeeded + std::max((size_t)contentCount, (size_t)CORK_SPARE_BUFFERS);
+    headerBuffers.reset(new INet::IoBuffer[bufferCapacity]);
+    fillHeaderBuffers(headerBuffers.get(), codeBuffer, sizeof(codeBuffer));
+    corkedSource.cork(headerBuffers.get(), (uint32_t)buffersNeeded, (uint32_t)bufferCapacity);
     
-    char codeBuffer[12];
-    size_t codeBytes = Strconv::uint32ToStr(statusCode, codeBuffer, sizeof(codeBuffer));
+    if (contentCount == 0) {
+        return HttpError::Ok;
+    }
+    return corkedSource.writev(content, contentCount);
+}
+
+std::tuple<StreamSource*, HttpError> HttpResponseImpl::startCloseDelimitedBody() {
+    headerNames.emplace_back("Connection", arena);
+    headerValues.emplace_back("close", arena);
+    closeDelimited = true;
+
+    HttpError err = writeHeaders();
+    if (err != HttpError::Ok) {
+        return std::make_tuple(nullptr, err);
+    }
+    return std::make_tuple(&corkedSource, HttpError::Ok);
+}
+
+// Fills in the status line, headers and the terminating empty line.
+// Returns the number of buffers used, 5 + (4 * headerCount).
+size_t HttpResponseImpl::fillHeaderBuffers(INet::IoBuffer* ioBufs, char* codeBuffer, size_t codeBufferLen) {
+    size_t codeBytes = Strconv::uint32ToStr(statusCode, codeBuffer, codeBufferLen - 1);
     codeBuffer[codeBytes] = ' ';
     
     if (version == HttpVersion::Http1_0) {
@@ -143,18 +316,10 @@ HttpError HttpResponseImpl::writeHeadersAndBody(const char* bufferedContent, siz
         ioBufs[offset + 3].bufferLen = 2;
     }
     
-    if (bufferedContentLen != 0) {
-        // TODO: Ideally, we'd handle content length over 2 gigs... but *shrug*
-        ioBufs[buffersNeeded - 2].buffer = (char*)"\r\n";
-        ioBufs[buffersNeeded - 2].bufferLen = 2;
-        ioBufs[buffersNeeded - 1].buffer = (char*)bufferedContent;
-        ioBufs[buffersNeeded - 1].bufferLen = (uint32_t)bufferedContentLen;
-    } else {
-        ioBufs[buffersNeeded - 1].buffer = (char*)"\r\n";
-        ioBufs[buffersNeeded - 1].bufferLen = 2;
-    }
-    
-    return streamSource->writev(ioBufs, buffersNeeded);
+    size_t end = 4 + (4 * headerNames.size());
+    ioBufs[end].buffer = (char*)"\r\n";
+    ioBufs[end].bufferLen = 2;
+    return end + 1;
 }
 
 HttpError HttpResponseImpl::parseHeaders() {
@@ -180,7 +345,7 @@ HttpError HttpResponseImpl::parseHeaders() {
                 return HttpError::InvalidHeader;
             }
             
-            contentLengthWriter.init(streamSource, contentLength);
+            contentLengthWriter.init(&corkedSource, contentLength);
             setContentLength = true;
         } else if (headerName.engEqualsIgnoreCase("Transfer-Encoding")) {
             // Only supported in Http1.1
@@ -194,16 +359,85 @@ HttpError HttpResponseImpl::parseHeaders() {
     }
     
     if (setContentLength) {
-        contentLengthWriter.init(streamSource, contentLength);
+        contentLengthWriter.init(&corkedSource, contentLength);
         httpOutputStream = &contentLengthWriter;
     } else if (setTeChunked) {
-        chunkedWriter.init(streamSource);
+        chunkedWriter.init(&corkedSource);
         httpOutputStream = &chunkedWriter;
     }
     
     return HttpError::Ok;
 }
 
+CompressionType HttpResponseImpl::chooseCompression() {
+    // Needs chunked encoding, so HTTP1.1 only
+    if (!compressionConfig ||
+        !compressionConfig->isEnabled() ||
+        version != HttpVersion::Http1_1 ||
+        statusCode < 200 || statusCode == 204 || statusCode == 206 || statusCode == 304) {
+        return CompressionType::None;
+    }
+
+    if (setContentLength && contentLength < compressionConfig->getMinSize()) {
+        return CompressionType::None;
+    }
+
+    bool compressible = false;
+    for (size_t i = 0; i < headerNames.size(); i++) {
+        const String& headerName = headerNames[i];
+        if (headerName.engEqualsIgnoreCase("Content-Encoding")) {
+            return CompressionType::None; // Already encoded by the handler
+        } else if (headerName.engEqualsIgnoreCase("Content-Type")) {
+            compressible = compressionConfig->isCompressible(headerValues[i]);
+        }
+    }
+    if (!compressible) {
+        return CompressionType::None;
+    }
+
+    return compressionConfig->chooseType(acceptEncoding);
+}
+
+void HttpResponseImpl::removeHeader(const StringRef headerName) {
+    for (size_t i = 0; i < headerNames.size();) {
+        if (headerNames[i].engEqualsIgnoreCase(headerName)) {
+            headerNames.erase(headerNames.begin() + i);
+            headerValues.erase(headerValues.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+// Adds a field name to Vary, merging it into one the handler already set
+void HttpResponseImpl::addVary(const StringRef fieldName) {
+    size_t varyIndex = headerNames.size();
+    for (size_t i = 0; i < headerNames.size(); i++) {
+        if (!headerNames[i].engEqualsIgnoreCase("Vary")) {
+            continue;
+        }
+        if (varyIndex == headerNames.size()) {
+            varyIndex = i;
+        }
+
+        CommaListIterator fieldIter(headerValues[i]);
+        StringRef field;
+        do {
+            field = fieldIter.next();
+            if (field == "*" || field.engEqualsIgnoreCase(fieldName)) {
+                return;
+            }
+        } while (field.length() != 0);
+    }
+
+    if (varyIndex == headerNames.size()) {
+        headerNames.emplace_back("Vary", arena);
+        headerValues.emplace_back(fieldName, arena);
+    } else {
+        headerValues[varyIndex] = StringBuilder().append(headerValues[varyIndex]).append(", ").append(fieldName).build(arena);
+    }
+}
+
 HttpError HttpResponseImpl::writeHeaders() {
     return writeHeadersAndBody(nullptr, 0);
 }
@@ -7,6 +7,9 @@
 
 using namespace Cupcake;
 
+// Enough for most request headers. The reader grows it for longer lines.
+#define READ_BUFFER_SIZE 2048
+
 HttpServer::HttpServer() :
     started(false)
 {}
@@ -16,7 +19,31 @@ HttpServer::~HttpServer() {
 }
 
 bool HttpServer::addHandler(const StringRef path, HttpHandler handler) {
-    return handlerMap.addHandler(path, handler);
+    return routeTable.addHandler(path, handler);
+}
+
+bool HttpServer::addHandler(HttpMethod method, const StringRef path, HttpHandler handler) {
+    return routeTable.addHandler(method, path, handler);
+}
+
+bool HttpServer::addStaticHandler(const StringRef path, const StringRef rootDir) {
+    return routeTable.addStaticHandler(path, rootDir);
+}
+
+bool HttpServer::removeHandler(const StringRef path) {
+    return routeTable.removeHandler(path);
+}
+
+bool HttpServer::removeHandler(HttpMethod method, const StringRef path) {
+    return routeTable.removeHandler(method, path);
+}
+
+void HttpServer::enableCompression(uint32_t minSize) {
+    compressionConfig.enable(minSize);
+}
+
+void HttpServer::addCompressibleType(const StringRef contentType) {
+    compressionConfig.addContentType(contentType);
 }
 
 HttpError HttpServer::start(StreamSource* streamSource) {
@@ -31,7 +58,8 @@ HttpError HttpServer::start(StreamSource* streamSource) {
 }
 
 HttpError HttpServer::acceptLoop() {
-    const HandlerMap* handlerMapPtr = &handlerMap;
+    const RouteTable* routeTablePtr = &routeTable;
+    const CompressionConfig* compressionConfigPtr = &compressionConfig;
 
     while (true) {
         StreamSource* acceptedSocket;
@@ -44,10 +72,10 @@ HttpError HttpServer::acceptLoop() {
             return err;
         }
 
-        Async::runAsync([&acceptedSocket, handlerMapPtr] {
+        Async::runAsync([&acceptedSocket, routeTablePtr, compressionConfigPtr] {
             BufferedReader bufReader;
-            bufReader.init(acceptedSocket, 2048); // TODO: Define read constant somewhere
-            HttpConnection httpConnection(acceptedSocket, bufReader, handlerMapPtr);
+            bufReader.init(acceptedSocket, READ_BUFFER_SIZE);
+            HttpConnection httpConnection(acceptedSocket, bufReader, routeTablePtr, compressionConfigPtr);
             try {
                 HttpConnection::UpgradeType upgradeType = httpConnection.run();
 
@@ -0,0 +1,286 @@
+
+#include "cupcake/internal/http/HttpTokens.h"
+
+#include <cstring>
+
+using namespace Cupcake;
+
+// Power of two, and large enough for the seed to find a spread with no collisions
+#define HEADER_TABLE_BITS 9
+#define HEADER_TABLE_SIZE (1 << HEADER_TABLE_BITS)
+
+// Access-Control-Allow-Credentials
+#define MAX_HEADER_NAME_LENGTH 32
+
+// In HttpHeader order, starting after Unknown
+static constexpr
+const char* headerNames[] = {
+    "Accept",
+    "Accept-Charset",
+    "Accept-Encoding",
+    "Accept-Language",
+    "Accept-Ranges",
+    "Access-Control-Allow-Credentials",
+    "Access-Control-Allow-Headers",
+    "Access-Control-Allow-Methods",
+    "Access-Control-Allow-Origin",
+    "Access-Control-Expose-Headers",
+    "Access-Control-Max-Age",
+    "Access-Control-Request-Headers",
+    "Access-Control-Request-Method",
+    "Age",
+    "Allow",
+    "Authorization",
+    "Cache-Control",
+    "Connection",
+    "Content-Disposition",
+    "Content-Encoding",
+    "Content-Language",
+    "Content-Length",
+    "Content-Location",
+    "Content-Range",
+    "Content-Security-Policy",
+    "Content-Type",
+    "Cookie",
+    "Date",
+    "DNT",
+    "ETag",
+    "Expect",
+    "Expires",
+    "Forwarded",
+    "From",
+    "Host",
+    "If-Match",
+    "If-Modified-Since",
+    "If-None-Match",
+    "If-Range",
+    "If-Unmodified-Since",
+    "Keep-Alive",
+    "Last-Modified",
+    "Link",
+    "Location",
+    "Max-Forwards",
+    "Origin",
+    "Pragma",
+    "Proxy-Authenticate",
+    "Proxy-Authorization",
+    "Range",
+    "Referer",
+    "Retry-After",
+    "Sec-WebSocket-Accept",
+    "Sec-WebSocket-Extensions",
+    "Sec-WebSocket-Key",
+    "Sec-WebSocket-Protocol",
+    "Sec-WebSocket-Version",
+    "Server",
+    "Set-Cookie",
+    "Strict-Transport-Security",
+    "TE",
+    "Trailer",
+    "Transfer-Encoding",
+    "Upgrade",
+    "Upgrade-Insecure-Requests",
+    "User-Agent",
+    "Vary",
+    "Via",
+    "WWW-Authenticate",
+    "X-Content-Type-Options",
+    "X-Forwarded-For",
+    "X-Forwarded-Host",
+    "X-Forwarded-Proto",
+    "X-Frame-Options",
+    "X-Requested-With",
+};
+
+static_assert(sizeof(headerNames) / sizeof(headerNames[0]) == (size_t)HttpHeader::Count - 1,
+              "Header names out of sync with HttpHeader");
+
+static constexpr
+size_t constLength(const char* str) {
+    size_t len = 0;
+    while (str[len] != '\0') {
+        len++;
+    }
+    return len;
+}
+
+static constexpr
+uint32_t constHash(const char* str) {
+    uint32_t hash = HttpTokens::HEADER_HASH_SEED;
+    for (size_t i = 0; str[i] != '\0'; i++) {
+        hash = HttpTokens::hashHeaderChar(hash, str[i]);
+    }
+    return hash;
+}
+
+static constexpr
+uint32_t tableSlot(uint32_t hash) {
+    return hash >> (32 - HEADER_TABLE_BITS);
+}
+
+namespace {
+
+// Slot to HttpHeader value, 0 for empty
+class HeaderTable {
+public:
+    uint8_t slots[HEADER_TABLE_SIZE];
+    uint8_t lengths[(size_t)HttpHeader::Count];
+    bool perfect;
+};
+
+}
+
+static constexpr
+HeaderTable buildHeaderTable() {
+    HeaderTable table = {};
+    table.perfect = true;
+    for (size_t i = 0; i < sizeof(headerNames) / sizeof(headerNames[0]); i++) {
+        uint32_t slot = tableSlot(constHash(headerNames[i]));
+        if (table.slots[slot] != 0) {
+            table.perfect = false;
+        }
+        table.slots[slot] = (uint8_t)(i + 1);
+        table.lengths[i + 1] = (uint8_t)constLength(headerNames[i]);
+    }
+    return table;
+}
+
+static constexpr
+HeaderTable headerTable = buildHeaderTable();
+
+static_assert(headerTable.perfect, "Header names collide, pick another HEADER_HASH_SEED");
+
+namespace {
+
+// Indexed by HttpHeader, with an empty name for Unknown
+class LowercaseNames {
+public:
+    char names[(size_t)HttpHeader::Count][MAX_HEADER_NAME_LENGTH + 1];
+    bool fits;
+};
+
+}
+
+static constexpr
+LowercaseNames buildLowercaseNames() {
+    LowercaseNames lowercase = {};
+    lowercase.fits = true;
+    for (size_t i = 0; i < sizeof(headerNames) / sizeof(headerNames[0]); i++) {
+        if (constLength(headerNames[i]) > MAX_HEADER_NAME_LENGTH) {
+            lowercase.fits = false;
+            continue;
+        }
+        for (size_t j = 0; headerNames[i][j] != '\0'; j++) {
+            lowercase.names[i + 1][j] = HttpTokens::canonicalHeaderChar(headerNames[i][j]);
+        }
+    }
+    return lowercase;
+}
+
+static constexpr
+LowercaseNames lowercaseNames = buildLowercaseNames();
+
+static_assert(lowercaseNames.fits, "Header name too long, raise MAX_HEADER_NAME_LENGTH");
+
+std::tuple<HttpMethod, bool> HttpTokens::lookupMethod(const StringRef str) {
+    // Methods are case sensitive, so after switching on the length a fixed
+    // size compare settles it
+    const char* data = str.data();
+    switch (str.length()) {
+    case 3:
+        if (std::memcmp(data, "GET", 3) == 0) {
+            return std::make_tuple(HttpMethod::Get, true);
+        } else if (std::memcmp(data, "PUT", 3) == 0) {
+            return std::make_tuple(HttpMethod::Put, true);
+        }
+        break;
+    case 4:
+        if (std::memcmp(data, "POST", 4) == 0) {
+            return std::make_tuple(HttpMethod::Post, true);
+        } else if (std::memcmp(data, "HEAD", 4) == 0) {
+            return std::make_tuple(HttpMethod::Head, true);
+        }
+        break;
+    case 5:
+        if (std::memcmp(data, "PATCH", 5) == 0) {
+            return std::make_tuple(HttpMethod::Patch, true);
+        } else if (std::memcmp(data, "TRACE", 5) == 0) {
+            return std::make_tuple(HttpMethod::Trace, true);
+        }
+        break;
+    case 6:
+        if (std::memcmp(data, "DELETE", 6) == 0) {
+            return std::make_tuple(HttpMethod::Delete, true);
+        }
+        break;
+    case 7:
+        if (std::memcmp(data, "OPTIONS", 7) == 0) {
+            return std::make_tuple(HttpMethod::Options, true);
+        } else if (std::memcmp(data, "CONNECT", 7) == 0) {
+            return std::make_tuple(HttpMethod::Connect, true);
+        }
+        break;
+    }
+    return std::make_tuple(HttpMethod::Get, false);
+}
+
+StringRef HttpTokens::getMethodName(HttpMethod method) {
+    switch (method) {
+    case HttpMethod::Get:
+        return "GET";
+    case HttpMethod::Head:
+        return "HEAD";
+    case HttpMethod::Post:
+        return "POST";
+    case HttpMethod::Put:
+        return "PUT";
+    case HttpMethod::Patch:
+        return "PATCH";
+    case HttpMethod::Delete:
+        return "DELETE";
+    case HttpMethod::Trace:
+        return "TRACE";
+    case HttpMethod::Options:
+        return "OPTIONS";
+    case HttpMethod::Connect:
+        return "CONNECT";
+    }
+    return StringRef();
+}
+
+uint32_t HttpTokens::hashHeaderName(const StringRef name) {
+    uint32_t hash = HEADER_HASH_SEED;
+    for (size_t i = 0; i < name.length(); i++) {
+        hash = hashHeaderChar(hash, name.data()[i]);
+    }
+    return hash;
+}
+
+HttpHeader HttpTokens::lookupHeader(const StringRef name) {
+    return lookupHeader(name, hashHeaderName(name));
+}
+
+HttpHeader HttpTokens::lookupHeader(const StringRef name, uint32_t nameHash) {
+    uint8_t header = headerTable.slots[tableSlot(nameHash)];
+    if (header == 0 || headerTable.lengths[header] != name.length()) {
+        return HttpHeader::Unknown;
+    }
+    if (!name.engEqualsIgnoreCase(headerNames[header - 1])) {
+        return HttpHeader::Unknown;
+    }
+    return (HttpHeader)header;
+}
+
+StringRef HttpTokens::getHeaderName(HttpHeader header) {
+    if (header == HttpHeader::Unknown || header >= HttpHeader::Count) {
+        return StringRef();
+    }
+    return headerNames[(size_t)header - 1];
+}
+
+StringRef HttpTokens::getLowercaseHeaderName(HttpHeader header) {
+    if (header == HttpHeader::Unknown || header >= HttpHeader::Count) {
+        return StringRef();
+    }
+    return StringRef(lowercaseNames.names[(size_t)header], headerTable.lengths[(size_t)header]);
+}
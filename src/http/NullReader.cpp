@@ -7,6 +7,17 @@ std::tuple<uint32_t, HttpError> NullReader::read(char* buffer, uint32_t bufferLe
     return std::make_tuple(0, HttpError::Eof);
 }
 
+std::tuple<uint32_t, HttpError> NullReader::readFully(char* buffer, uint32_t bufferLen) {
+    return std::make_tuple(0, HttpError::Eof);
+}
+
+std::tuple<StringRef, HttpError> NullReader::readView(uint32_t maxLen) {
+    return std::make_tuple(StringRef(), HttpError::Eof);
+}
+
+void NullReader::consume(uint32_t byteCount) {
+}
+
 HttpError NullReader::close() {
     return HttpError::Ok;
 }
\ No newline at end of file
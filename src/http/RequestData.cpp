@@ -1,8 +1,63 @@
 
 #include "cupcake/internal/http/RequestData.h"
 
+#include "cupcake/internal/http/HttpTokens.h"
+#include "cupcake/internal/http/UrlParser.h"
+
+#include <algorithm>
+
 using namespace Cupcake;
 
+// Power of two, grows to keep it at most half full
+#define INITIAL_NAME_INDEX_SIZE 32
+
+#define LOWERCASE_CHUNK_SIZE 64
+
+// Goes through a buffer on the stack so the name is only allocated once.
+// Names from HTTP2 haven't been checked, so anything that isn't a token char
+// is kept as it is.
+static
+String lowercaseName(const StringRef name, Arena* arena) {
+    String lowercase(arena);
+    lowercase.reserve(name.length());
+
+    char chunk[LOWERCASE_CHUNK_SIZE];
+    for (size_t start = 0; start < name.length(); start += LOWERCASE_CHUNK_SIZE) {
+        size_t chunkLen = std::min(name.length() - start, (size_t)LOWERCASE_CHUNK_SIZE);
+        for (size_t i = 0; i < chunkLen; i++) {
+            char c = name.data()[start + i];
+            char canonical = HttpTokens::canonicalHeaderChar(c);
+            chunk[i] = (canonical != '\0') ? canonical : c;
+        }
+        lowercase.append(chunk, chunkLen);
+    }
+    return lowercase;
+}
+
+RequestData::RequestData() :
+    RequestData(nullptr)
+{}
+
+RequestData::RequestData(Arena* arena) :
+    arena(arena),
+    version(HttpVersion::Http1_1),
+    method(HttpMethod::Get),
+    url(arena),
+    path(),
+    query(),
+    pathBuffer(),
+    queryParsed(false),
+    queryBuffer(),
+    queryParams(),
+    headerNames(),
+    headerValues(),
+    headerEntries(),
+    nameIndex(INITIAL_NAME_INDEX_SIZE),
+    distinctNames(0)
+{
+    std::fill(knownHeaders, knownHeaders + (size_t)HttpHeader::Count, -1);
+}
+
 void RequestData::setVersion(HttpVersion newVersion) {
     version = newVersion;
 }
@@ -19,16 +74,94 @@ HttpMethod RequestData::getMethod() const {
     return method;
 }
 
-void RequestData::setUrl(const StringRef newUrl) {
+bool RequestData::setUrl(const StringRef newUrl) {
     url = newUrl;
+    queryParsed = false;
+    queryParams.clear();
+
+    UrlParser::UrlParts parts = UrlParser::split(url);
+    query = parts.query;
+    if (!parts.hasEscapes && !parts.hasDotSegments) {
+        path = parts.path;
+        return true;
+    }
+
+    // Decoding can make new dot segments, so always normalize after it
+    pathBuffer.resize(parts.path.length());
+    size_t pathLen = parts.path.length();
+    if (parts.hasEscapes) {
+        bool validPath;
+        std::tie(pathLen, validPath) = UrlParser::percentDecode(parts.path, false, pathBuffer.data());
+        if (!validPath) {
+            path = StringRef();
+            return false;
+        }
+    } else {
+        std::copy(parts.path.data(), parts.path.data() + pathLen, pathBuffer.begin());
+    }
+    pathLen = UrlParser::removeDotSegments(pathBuffer.data(), pathLen);
+    path = StringRef(pathBuffer.data(), pathLen);
+    return true;
 }
 
 const StringRef RequestData::getUrl() const {
     return url;
 }
 
+const StringRef RequestData::getPath() const {
+    return path;
+}
+
+const StringRef RequestData::getQuery() const {
+    return query;
+}
+
+size_t RequestData::getQueryParamCount() const {
+    if (!queryParsed) {
+        parseQuery();
+    }
+    return queryParams.size();
+}
+
+const StringRef RequestData::getQueryParamName(size_t paramIndex) const {
+    if (!queryParsed) {
+        parseQuery();
+    }
+    return queryParams.at(paramIndex).name;
+}
+
+const StringRef RequestData::getQueryParamValue(size_t paramIndex) const {
+    if (!queryParsed) {
+        parseQuery();
+    }
+    return queryParams.at(paramIndex).value;
+}
+
+ptrdiff_t RequestData::findQueryParam(const StringRef paramName) const {
+    if (!queryParsed) {
+        parseQuery();
+    }
+    for (size_t i = 0; i < queryParams.size(); i++) {
+        if (queryParams[i].name.equals(paramName)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 void RequestData::addHeaderName(const StringRef headerName) {
-    headerNames.push_back(headerName);
+    uint32_t nameHash = HttpTokens::hashHeaderName(headerName);
+    addHeaderName(headerName, HttpTokens::lookupHeader(headerName, nameHash), nameHash);
+}
+
+void RequestData::addHeaderName(const StringRef headerName, HttpHeader header, uint32_t nameHash) {
+    if (header != HttpHeader::Unknown) {
+        headerNames.emplace_back(arena);
+    } else {
+        headerNames.push_back(lowercaseName(headerName, arena));
+    }
+    headerEntries.push_back(HeaderEntry{nameHash, -1, header});
+    indexHeader(headerNames.size() - 1);
 }
 
 void RequestData::addStaticHeaderName(const StringRef headerName) {
@@ -37,7 +170,7 @@ void RequestData::addStaticHeaderName(const StringRef headerName) {
 }
 
 void RequestData::addHeaderValue(const StringRef headerValue) {
-    headerValues.push_back(headerValue);
+    headerValues.emplace_back(headerValue, arena);
 }
 
 void RequestData::addStaticHeaderValue(const StringRef headerValue) {
@@ -55,16 +188,163 @@ size_t RequestData::getHeaderCount() const {
 }
 
 const StringRef RequestData::getHeaderName(size_t headerIndex) const {
-    return headerNames.at(headerIndex);
+    HttpHeader header = headerEntries.at(headerIndex).header;
+    if (header != HttpHeader::Unknown) {
+        return HttpTokens::getLowercaseHeaderName(header);
+    }
+    return headerNames[headerIndex];
 }
 
 const StringRef RequestData::getHeaderValue(size_t headerIndex) const {
     return headerValues.at(headerIndex);
 }
 
+ptrdiff_t RequestData::findHeader(const StringRef headerName) const {
+    uint32_t nameHash = HttpTokens::hashHeaderName(headerName);
+    HttpHeader header = HttpTokens::lookupHeader(headerName, nameHash);
+    if (header != HttpHeader::Unknown) {
+        return knownHeaders[(size_t)header];
+    }
+
+    // Stored lowercase, but the name asked for could be any case
+    size_t mask = nameIndex.size() - 1;
+    for (size_t slot = nameHash & mask; nameIndex[slot] != 0; slot = (slot + 1) & mask) {
+        size_t headerIndex = nameIndex[slot] - 1;
+        if (headerEntries[headerIndex].nameHash == nameHash &&
+            headerName.engEqualsIgnoreCase(headerNames[headerIndex])) {
+            return headerIndex;
+        }
+    }
+    return -1;
+}
+
+ptrdiff_t RequestData::findHeader(HttpHeader header) const {
+    if (header == HttpHeader::Unknown || header >= HttpHeader::Count) {
+        return -1;
+    }
+    return knownHeaders[(size_t)header];
+}
+
+ptrdiff_t RequestData::findNextHeader(size_t headerIndex) const {
+    return headerEntries.at(headerIndex).nextIndex;
+}
+
 void RequestData::reset() {
     method = HttpMethod();
-    url.clear();
+    // Let go of any memory in the arena before it's reset
+    url = StringRef();
+    path = StringRef();
+    query = StringRef();
+    queryParsed = false;
+    queryParams.clear();
+    for (const HeaderEntry& entry : headerEntries) {
+        if (entry.header != HttpHeader::Unknown) {
+            knownHeaders[(size_t)entry.header] = -1;
+        }
+    }
     headerNames.clear();
     headerValues.clear();
-}
\ No newline at end of file
+    headerEntries.clear();
+    if (distinctNames != 0) {
+        std::fill(nameIndex.begin(), nameIndex.end(), 0);
+        distinctNames = 0;
+    }
+}
+
+// Either starts a new chain, or goes on the end of the chain for an earlier
+// header with the same name
+void RequestData::indexHeader(size_t headerIndex) {
+    HttpHeader header = headerEntries[headerIndex].header;
+    if (header != HttpHeader::Unknown) {
+        if (knownHeaders[(size_t)header] == -1) {
+            knownHeaders[(size_t)header] = (int32_t)headerIndex;
+        } else {
+            appendToChain(knownHeaders[(size_t)header], headerIndex);
+        }
+        return;
+    }
+
+    uint32_t nameHash = headerEntries[headerIndex].nameHash;
+    const StringRef headerName = headerNames[headerIndex];
+    size_t mask = nameIndex.size() - 1;
+
+    size_t slot = nameHash & mask;
+    for (; nameIndex[slot] != 0; slot = (slot + 1) & mask) {
+        size_t chainIndex = nameIndex[slot] - 1;
+        // Both lowercase already
+        if (headerEntries[chainIndex].nameHash == nameHash && headerName.equals(headerNames[chainIndex])) {
+            appendToChain(chainIndex, headerIndex);
+            return;
+        }
+    }
+
+    nameIndex[slot] = (uint32_t)(headerIndex + 1);
+    distinctNames++;
+    if (distinctNames * 2 > nameIndex.size()) {
+        growIndex();
+    }
+}
+
+// Repeats are rare enough that walking the chain is fine
+void RequestData::appendToChain(size_t chainIndex, size_t headerIndex) {
+    while (headerEntries[chainIndex].nextIndex != -1) {
+        chainIndex = headerEntries[chainIndex].nextIndex;
+    }
+    headerEntries[chainIndex].nextIndex = (int32_t)headerIndex;
+}
+
+void RequestData::growIndex() {
+    std::vector<uint32_t> oldIndex(nameIndex.size() * 2);
+    oldIndex.swap(nameIndex);
+
+    size_t mask = nameIndex.size() - 1;
+    for (uint32_t entry : oldIndex) {
+        if (entry == 0) {
+            continue;
+        }
+        size_t slot = headerEntries[entry - 1].nameHash & mask;
+        while (nameIndex[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        nameIndex[slot] = entry;
+    }
+}
+
+// Decodes every pair into queryBuffer, which is sized up front so the
+// params can point into it. Pairs that don't decode are left out.
+void RequestData::parseQuery() const {
+    queryParsed = true;
+    queryParams.clear();
+    queryBuffer.resize(query.length());
+
+    size_t bufferLen = 0;
+    size_t pairStart = 0;
+    while (pairStart <= query.length()) {
+        ptrdiff_t ampersand = query.indexOf('&', pairStart);
+        size_t pairEnd = (ampersand == -1) ? query.length() : ampersand;
+        const StringRef pair = query.substring(pairStart, pairEnd);
+        pairStart = pairEnd + 1;
+        if (pair.length() == 0) {
+            continue;
+        }
+
+        ptrdiff_t equals = pair.indexOf('=');
+        const StringRef encodedName = (equals == -1) ? pair : pair.substring(0, equals);
+        const StringRef encodedValue = (equals == -1) ? StringRef() : pair.substring(equals + 1);
+
+        size_t nameLen;
+        size_t valueLen;
+        bool validName;
+        bool validValue;
+        char* name = queryBuffer.data() + bufferLen;
+        std::tie(nameLen, validName) = UrlParser::percentDecode(encodedName, true, name);
+        char* value = name + nameLen;
+        std::tie(valueLen, validValue) = UrlParser::percentDecode(encodedValue, true, value);
+        if (!validName || !validValue) {
+            continue;
+        }
+
+        queryParams.push_back(QueryParam{StringRef(name, nameLen), StringRef(value, valueLen)});
+        bufferLen += nameLen + valueLen;
+    }
+}
@@ -0,0 +1,295 @@
+
+#include "cupcake/internal/http/RequestParser.h"
+
+#include "cupcake/internal/http/HttpTokens.h"
+
+using namespace Cupcake;
+
+enum class RequestParser::ParseState {
+    RequestLineStart,
+    Method,
+    Url,
+    Version,
+    RequestLineEnd,
+    HeaderLineStart,
+    HeaderName,
+    HeaderNameEnd,
+    ValueStart,
+    Value,
+    HeaderLineEnd,
+    HeadEnd,
+    Complete
+};
+
+static
+bool isWhitespace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+RequestParser::RequestParser(uint32_t maxUrlLength, uint32_t maxHeadLength) :
+    maxUrlLength(maxUrlLength),
+    maxHeadLength(maxHeadLength),
+    state(ParseState::RequestLineStart),
+    index(0),
+    tokenStart(0),
+    tokenEnd(0),
+    nameHash(0),
+    method(HttpMethod::Get),
+    version(HttpVersion::Http1_1),
+    url()
+{}
+
+void RequestParser::reset() {
+    state = ParseState::RequestLineStart;
+    index = 0;
+    tokenStart = 0;
+    tokenEnd = 0;
+    nameHash = 0;
+    method = HttpMethod::Get;
+    version = HttpVersion::Http1_1;
+    url = Span();
+    headers.clear();
+}
+
+RequestParser::Result RequestParser::parse(const char* data, size_t dataLen) {
+    if (state == ParseState::Complete) {
+        return Result::Complete;
+    }
+
+    // Past the limit, parse what's allowed and then give up if that wasn't enough
+    bool overLimit = dataLen > maxHeadLength;
+    uint32_t parseLen = overLimit ? maxHeadLength : (uint32_t)dataLen;
+
+    for (; index < parseLen; index++) {
+        char c = data[index];
+
+        switch (state) {
+        case ParseState::RequestLineStart:
+            // Robustness, empty lines before the request line are ignored
+            // https://tools.ietf.org/html/rfc7230#section-3.5
+            if (c != '\r' && c != '\n') {
+                tokenStart = index;
+                state = ParseState::Method;
+            }
+            break;
+
+        case ParseState::Method:
+            if (c == ' ') {
+                Result res = finishMethod(data);
+                if (res != Result::Incomplete) {
+                    return res;
+                }
+                tokenStart = index + 1;
+                state = ParseState::Url;
+            } else if (c == '\r' || c == '\n') {
+                return Result::BadRequest;
+            }
+            break;
+
+        case ParseState::Url:
+            if (c == ' ') {
+                if (index == tokenStart) {
+                    return Result::BadRequest;
+                }
+                url.offset = tokenStart;
+                url.length = index - tokenStart;
+                tokenStart = index + 1;
+                state = ParseState::Version;
+            } else if (c == '\r' || c == '\n') {
+                return Result::BadRequest;
+            } else if (index - tokenStart >= maxUrlLength) {
+                return Result::UriTooLong;
+            }
+            break;
+
+        case ParseState::Version:
+            if (c == '\r' || c == '\n') {
+                Result res = finishVersion(data);
+                if (res != Result::Incomplete) {
+                    return res;
+                }
+                state = (c == '\r') ? ParseState::RequestLineEnd : ParseState::HeaderLineStart;
+            }
+            break;
+
+        case ParseState::RequestLineEnd:
+        case ParseState::HeaderLineEnd:
+            if (c != '\n') {
+                return Result::BadRequest;
+            }
+            state = ParseState::HeaderLineStart;
+            break;
+
+        case ParseState::HeaderLineStart:
+            if (c == '\r') {
+                state = ParseState::HeadEnd;
+            } else if (c == '\n') {
+                state = ParseState::Complete;
+                index++;
+                return Result::Complete;
+            } else if (isWhitespace(c)) {
+                // Folded onto the previous header's value
+                if (headers.empty()) {
+                    return Result::BadRequest;
+                }
+                headers.push_back(HeaderSpan());
+                headers.back().nameHash = 0;
+                headers.back().header = HttpHeader::Unknown;
+                headers.back().continuation = true;
+                state = ParseState::ValueStart;
+            } else if (HttpTokens::canonicalHeaderChar(c) == '\0') {
+                return Result::BadRequest;
+            } else {
+                headers.push_back(HeaderSpan());
+                headers.back().continuation = false;
+                tokenStart = index;
+                tokenEnd = index + 1;
+                nameHash = HttpTokens::hashHeaderChar(HttpTokens::HEADER_HASH_SEED, c);
+                state = ParseState::HeaderName;
+            }
+            break;
+
+        case ParseState::HeaderName:
+            if (c == ':') {
+                finishName(data);
+                state = ParseState::ValueStart;
+            } else if (c == '\r' || c == '\n') {
+                return Result::BadRequest;
+            } else if (isWhitespace(c)) {
+                state = ParseState::HeaderNameEnd;
+            } else if (HttpTokens::canonicalHeaderChar(c) == '\0') {
+                return Result::BadRequest;
+            } else {
+                tokenEnd = index + 1;
+                nameHash = HttpTokens::hashHeaderChar(nameHash, c);
+            }
+            break;
+
+        case ParseState::HeaderNameEnd:
+            // Whitespace before the colon is trimmed off the name, but there
+            // can't be any inside it
+            if (c == ':') {
+                finishName(data);
+                state = ParseState::ValueStart;
+            } else if (!isWhitespace(c)) {
+                return Result::BadRequest;
+            }
+            break;
+
+        case ParseState::ValueStart:
+            if (isWhitespace(c)) {
+                break;
+            }
+            tokenStart = index;
+            tokenEnd = index;
+            state = ParseState::Value;
+            // Fall through, this is the first character of the value
+
+        case ParseState::Value:
+            if (c == '\r') {
+                finishValue();
+                state = ParseState::HeaderLineEnd;
+            } else if (c == '\n') {
+                finishValue();
+                state = ParseState::HeaderLineStart;
+            } else if (!isWhitespace(c)) {
+                tokenEnd = index + 1;
+            }
+            break;
+
+        case ParseState::HeadEnd:
+            if (c != '\n') {
+                return Result::BadRequest;
+            }
+            state = ParseState::Complete;
+            index++;
+            return Result::Complete;
+
+        case ParseState::Complete:
+            return Result::Complete;
+        }
+    }
+
+    if (overLimit) {
+        return (state == ParseState::Url) ? Result::UriTooLong : Result::HeadTooLarge;
+    }
+    return Result::Incomplete;
+}
+
+HttpMethod RequestParser::getMethod() const {
+    return method;
+}
+
+HttpVersion RequestParser::getVersion() const {
+    return version;
+}
+
+StringRef RequestParser::getUrl(const char* data) const {
+    return url.get(data);
+}
+
+size_t RequestParser::getHeaderCount() const {
+    return headers.size();
+}
+
+StringRef RequestParser::getHeaderName(const char* data, size_t headerIndex) const {
+    return headers[headerIndex].name.get(data);
+}
+
+StringRef RequestParser::getHeaderValue(const char* data, size_t headerIndex) const {
+    return headers[headerIndex].value.get(data);
+}
+
+HttpHeader RequestParser::getHeader(size_t headerIndex) const {
+    return headers[headerIndex].header;
+}
+
+uint32_t RequestParser::getHeaderHash(size_t headerIndex) const {
+    return headers[headerIndex].nameHash;
+}
+
+bool RequestParser::isContinuation(size_t headerIndex) const {
+    return headers[headerIndex].continuation;
+}
+
+size_t RequestParser::getHeadLength() const {
+    return index;
+}
+
+RequestParser::Result RequestParser::finishMethod(const char* data) {
+    bool knownMethod;
+    std::tie(method, knownMethod) = HttpTokens::lookupMethod(StringRef(data + tokenStart, index - tokenStart));
+    if (!knownMethod) {
+        // https://www.w3.org/Protocols/rfc2616/rfc2616-sec5.html#sec5.1.1
+        return Result::UnknownMethod;
+    }
+    return Result::Incomplete;
+}
+
+RequestParser::Result RequestParser::finishVersion(const char* data) {
+    StringRef versionStr(data + tokenStart, index - tokenStart);
+    if (versionStr.equals("HTTP/1.0")) {
+        version = HttpVersion::Http1_0;
+    } else if (versionStr.equals("HTTP/1.1")) {
+        version = HttpVersion::Http1_1;
+    } else if (versionStr.startsWith("HTTP/")) {
+        return Result::UnsupportedVersion;
+    } else {
+        return Result::BadRequest;
+    }
+    return Result::Incomplete;
+}
+
+void RequestParser::finishName(const char* data) {
+    HeaderSpan& headerSpan = headers.back();
+    headerSpan.name.offset = tokenStart;
+    headerSpan.name.length = tokenEnd - tokenStart;
+    headerSpan.nameHash = nameHash;
+    headerSpan.header = HttpTokens::lookupHeader(headerSpan.name.get(data), nameHash);
+}
+
+// Trailing whitespace is left off the value
+void RequestParser::finishValue() {
+    headers.back().value.offset = tokenStart;
+    headers.back().value.length = tokenEnd - tokenStart;
+}
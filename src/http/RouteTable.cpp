@@ -0,0 +1,91 @@
+
+#include "cupcake/internal/http/RouteTable.h"
+
+#include "cupcake/internal/http/StaticFileHandler.h"
+
+using namespace Cupcake;
+
+RouteTable::RouteTable() :
+    writeMutex(),
+    definitions(),
+    handlerMap(std::unique_ptr<HandlerMap>(new HandlerMap()))
+{}
+
+bool RouteTable::addHandler(const StringRef path, HttpHandler handler) {
+    return addRoute(HandlerMap::ALL_METHODS, path, handler);
+}
+
+bool RouteTable::addHandler(HttpMethod method, const StringRef path, HttpHandler handler) {
+    return addRoute(1u << (uint32_t)method, path, handler);
+}
+
+bool RouteTable::addStaticHandler(const StringRef path, const StringRef rootDir) {
+    if (!path.endsWith('*') || rootDir.length() == 0) {
+        return false;
+    }
+
+    std::shared_ptr<FileCache> fileCache(new FileCache());
+    if (fileCache->init(rootDir) != FileError::Ok) {
+        return false;
+    }
+
+    StaticFileHandler handler(path.substring(0, path.length() - 1), fileCache);
+    return addRoute(HandlerMap::ALL_METHODS, path, handler);
+}
+
+bool RouteTable::removeHandler(const StringRef path) {
+    return removeRoute(HandlerMap::ALL_METHODS, path);
+}
+
+bool RouteTable::removeHandler(HttpMethod method, const StringRef path) {
+    return removeRoute(1u << (uint32_t)method, path);
+}
+
+RouteTable::Snapshot RouteTable::getSnapshot() const {
+    return handlerMap.read();
+}
+
+bool RouteTable::addRoute(uint32_t methodMask, const StringRef path, HttpHandler handler) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    std::vector<RouteDefinition> newDefinitions(definitions);
+    newDefinitions.push_back(RouteDefinition{path, methodMask, handler});
+    return publish(newDefinitions);
+}
+
+bool RouteTable::removeRoute(uint32_t methodMask, const StringRef path) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    std::vector<RouteDefinition> newDefinitions;
+    bool removed = false;
+    for (const RouteDefinition& definition : definitions) {
+        if (definition.path != path || (definition.methodMask & methodMask) == 0) {
+            newDefinitions.push_back(definition);
+            continue;
+        }
+
+        removed = true;
+        uint32_t remainingMask = definition.methodMask & ~methodMask;
+        if (remainingMask != 0) {
+            newDefinitions.push_back(RouteDefinition{definition.path, remainingMask, definition.handler});
+        }
+    }
+
+    return removed && publish(newDefinitions);
+}
+
+// Builds the snapshot for the new routes, only replacing the old ones if
+// they're all valid together
+bool RouteTable::publish(const std::vector<RouteDefinition>& newDefinitions) {
+    std::unique_ptr<HandlerMap> newHandlerMap(new HandlerMap());
+    for (const RouteDefinition& definition : newDefinitions) {
+        if (!newHandlerMap->addHandler(definition.methodMask, definition.path, definition.handler)) {
+            return false;
+        }
+    }
+    newHandlerMap->freeze();
+
+    definitions = newDefinitions;
+    handlerMap.publish(std::move(newHandlerMap));
+    return true;
+}
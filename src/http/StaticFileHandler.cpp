@@ -0,0 +1,202 @@
+
+#include "cupcake/internal/http/StaticFileHandler.h"
+
+#include "cupcake/internal/http/AcceptEncoding.h"
+#include "cupcake/internal/http/CommaListIterator.h"
+
+using namespace Cupcake;
+
+/* Rejects anything that could escape the root: empty, "." or ".." segments, and backslashes or NULs. */
+static
+bool isSafeRelativePath(const StringRef path) {
+    size_t segmentStart = 0;
+    for (size_t i = 0; i <= path.length(); i++) {
+        if (i < path.length()) {
+            char c = path.charAt(i);
+            if (c == '\\' || c == '\0' || c == ':') {
+                return false;
+            }
+            if (c != '/') {
+                continue;
+            }
+        }
+
+        const StringRef segment = path.substring(segmentStart, i);
+        if (segment.length() == 0 || segment == "." || segment == "..") {
+            return false;
+        }
+        segmentStart = i + 1;
+    }
+    return true;
+}
+
+static
+bool etagMatches(const StringRef ifNoneMatch, const StringRef etag) {
+    CommaListIterator listIter(ifNoneMatch);
+    StringRef value;
+    do {
+        value = listIter.next();
+        if (value.startsWith("W/")) {
+            value = value.substring(2);
+        }
+        if (value == "*" || value == etag) {
+            return true;
+        }
+    } while (value.length() != 0);
+    return false;
+}
+
+struct PrecompressedEncoding {
+    const char* coding;
+    const char* extension;
+};
+
+// In order of preference when the client weighs them equally
+static
+const PrecompressedEncoding precompressedEncodings[] = {
+    {"br", ".br"},
+    {"zstd", ".zst"},
+    {"gzip", ".gz"},
+};
+
+static
+void sendEmptyResponse(HttpResponse& response, uint32_t code, const StringRef statusText) {
+    response.setStatus(code, statusText);
+    response.addHeader("Content-Length", "0");
+    response.close();
+}
+
+StaticFileHandler::StaticFileHandler(const StringRef urlPrefix, std::shared_ptr<FileCache> fileCache) :
+    urlPrefix(urlPrefix),
+    fileCache(fileCache)
+{}
+
+void StaticFileHandler::operator()(HttpRequest& request, HttpResponse& response) const {
+    HttpMethod method = request.getMethod();
+    if (method != HttpMethod::Get && method != HttpMethod::Head) {
+        response.addHeader("Allow", "GET, HEAD");
+        sendEmptyResponse(response, 405, "Method Not Allowed");
+        return;
+    }
+
+    const StringRef path = request.getPath();
+    if (!path.startsWith(urlPrefix)) {
+        sendEmptyResponse(response, 404, "Not Found");
+        return;
+    }
+
+    StringRef relativePath = path.substring(urlPrefix.length());
+    if (relativePath.startsWith('/')) {
+        relativePath = relativePath.substring(1);
+    }
+    if (!isSafeRelativePath(relativePath)) {
+        sendEmptyResponse(response, 404, "Not Found");
+        return;
+    }
+
+    std::shared_ptr<const FileCache::Entry> entry;
+    FileError fileErr;
+    std::tie(entry, fileErr) = fileCache->get(relativePath);
+    if (fileErr == FileError::NotFound || fileErr == FileError::InvalidArgument) {
+        sendEmptyResponse(response, 404, "Not Found");
+        return;
+    } else if (fileErr == FileError::AccessDenied) {
+        sendEmptyResponse(response, 403, "Forbidden");
+        return;
+    } else if (fileErr != FileError::Ok) {
+        sendEmptyResponse(response, 500, "Internal Server Error");
+        return;
+    }
+
+    // Look for precompressed siblings, e.g. "app.js.br", and pick the one the client
+    // weighs highest. Lookups are cached, misses included, so probing is cheap.
+    StringRef acceptEncoding;
+    bool hasAcceptEncoding;
+    std::tie(acceptEncoding, hasAcceptEncoding) = request.getHeader(HttpHeader::AcceptEncoding);
+    uint32_t bestQuality = hasAcceptEncoding ? AcceptEncoding::getQuality(acceptEncoding, "identity") : 1000;
+
+    std::shared_ptr<const FileCache::Entry> bodyEntry = entry;
+    StringRef contentEncoding;
+    bool hasSiblings = false;
+    String siblingPath(relativePath);
+
+    for (const PrecompressedEncoding& encoding : precompressedEncodings) {
+        siblingPath = relativePath;
+        siblingPath.append(encoding.extension);
+
+        std::shared_ptr<const FileCache::Entry> siblingEntry;
+        std::tie(siblingEntry, fileErr) = fileCache->get(siblingPath);
+        if (fileErr != FileError::Ok) {
+            continue;
+        }
+        hasSiblings = true;
+
+        uint32_t quality = hasAcceptEncoding ? AcceptEncoding::getQuality(acceptEncoding, encoding.coding) : 0;
+        if (quality > 0 && (quality > bestQuality || (contentEncoding.length() == 0 && quality == bestQuality))) {
+            bestQuality = quality;
+            bodyEntry = siblingEntry;
+            contentEncoding = encoding.coding;
+        }
+    }
+
+    // Caches need to know the response depends on Accept-Encoding whichever version is sent
+    if (hasSiblings) {
+        response.addHeader("Vary", "Accept-Encoding");
+    }
+
+    const StringRef lastModified = bodyEntry->lastModified;
+    const StringRef etag = bodyEntry->etag;
+    response.addHeader("Last-Modified", lastModified);
+    response.addHeader("ETag", etag);
+
+    // If-None-Match takes precedence, and If-Modified-Since is only honored on an exact
+    // match of the date we'd send, which is what any well behaved cache echoes back.
+    StringRef ifNoneMatch;
+    StringRef ifModifiedSince;
+    bool hasIfNoneMatch;
+    bool hasIfModifiedSince;
+    std::tie(ifNoneMatch, hasIfNoneMatch) = request.getHeader(HttpHeader::IfNoneMatch);
+    std::tie(ifModifiedSince, hasIfModifiedSince) = request.getHeader(HttpHeader::IfModifiedSince);
+
+    bool notModified;
+    if (hasIfNoneMatch) {
+        notModified = etagMatches(ifNoneMatch, etag);
+    } else {
+        notModified = hasIfModifiedSince && ifModifiedSince == lastModified;
+    }
+    if (notModified) {
+        response.setStatus(304, "Not Modified");
+        response.close();
+        return;
+    }
+
+    response.setStatus(200, "OK");
+    response.addHeader("Content-Type", entry->contentType);
+    if (contentEncoding.length() != 0) {
+        response.addHeader("Content-Encoding", contentEncoding);
+    }
+    response.addHeader("Content-Length", bodyEntry->contentLength);
+
+    if (method == HttpMethod::Head) {
+        response.close();
+        return;
+    }
+
+    // Small files are held in memory, everything else is sent from the open handle
+    if (bodyEntry->content) {
+        HttpOutputStream* outputStream;
+        HttpError err;
+        std::tie(outputStream, err) = response.getOutputStream();
+        if (err != HttpError::Ok) {
+            return;
+        }
+        err = outputStream->write(bodyEntry->content.get(), (uint32_t)bodyEntry->size);
+        if (err != HttpError::Ok) {
+            return;
+        }
+        outputStream->close();
+        return;
+    }
+
+    response.sendFile(bodyEntry->file, 0, bodyEntry->size);
+}
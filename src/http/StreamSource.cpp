@@ -0,0 +1,50 @@
+
+#include "cupcake/internal/http/StreamSource.h"
+
+#include <algorithm>
+
+using namespace Cupcake;
+
+HttpError StreamSource::waitReadable() {
+    return HttpError::Ok;
+}
+
+HttpError StreamSource::flush() {
+    return HttpError::Ok;
+}
+
+HttpError StreamSource::sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+    const File& file, uint64_t offset, uint64_t length) {
+
+    HttpError err;
+    if (headBufferCount != 0) {
+        err = writev(headBuffers, headBufferCount);
+        if (err != HttpError::Ok) {
+            return err;
+        }
+    }
+
+    char copyBuffer[16 * 1024];
+    while (length > 0) {
+        uint32_t readLen = (uint32_t)std::min(length, (uint64_t)sizeof(copyBuffer));
+        uint32_t bytesRead;
+        FileError fileErr;
+        std::tie(bytesRead, fileErr) = file.read(offset, copyBuffer, readLen);
+        if (fileErr != FileError::Ok) {
+            return HttpError::IoError;
+        }
+        // The file shrank underneath us. Can't honor the length we promised.
+        if (bytesRead == 0) {
+            return HttpError::Eof;
+        }
+
+        err = write(copyBuffer, bytesRead);
+        if (err != HttpError::Ok) {
+            return err;
+        }
+        offset += bytesRead;
+        length -= bytesRead;
+    }
+
+    return HttpError::Ok;
+}
@@ -61,6 +61,16 @@ std::tuple<uint32_t, HttpError> StreamSourceSocket::readv(INet::IoBuffer* buffer
     return std::make_tuple(bytesRead, HttpError::Ok);
 }
 
+HttpError StreamSourceSocket::waitReadable() {
+    SocketError err = socket.waitReadable();
+
+    if (err != SocketError::Ok) {
+        return HttpError::IoError;
+    }
+
+    return HttpError::Ok;
+}
+
 HttpError StreamSourceSocket::write(const char* buffer, uint32_t bufferLen) {
     SocketError err = socket.write(buffer, bufferLen);
 
@@ -81,6 +91,17 @@ HttpError StreamSourceSocket::writev(const INet::IoBuffer* buffers, uint32_t buf
     return HttpError::Ok;
 }
 
+HttpError StreamSourceSocket::sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+    const File& file, uint64_t offset, uint64_t length) {
+    SocketError err = socket.sendFile(headBuffers, headBufferCount, file, offset, length);
+
+    if (err != SocketError::Ok) {
+        return HttpError::IoError;
+    }
+
+    return HttpError::Ok;
+}
+
 HttpError StreamSourceSocket::close() {
     SocketError err = socket.close();
     if (err != SocketError::Ok) {
@@ -0,0 +1,191 @@
+
+#include "cupcake/internal/http/UrlParser.h"
+
+#include <cstring>
+
+using namespace Cupcake;
+
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+
+// Non zero if any byte of the word is c
+static inline
+uint64_t findByte(uint64_t word, uint8_t c) {
+    uint64_t diff = word ^ (SWAR_ONES * c);
+    return (diff - SWAR_ONES) & ~diff & SWAR_HIGHS;
+}
+
+static inline
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// Where the path starts in an absolute form target, just past the authority
+static
+size_t skipSchemeAndAuthority(const char* data, size_t dataLen) {
+    const char* schemeEnd = (const char*)std::memchr(data, ':', dataLen);
+    if (!schemeEnd || (size_t)(schemeEnd - data) + 3 > dataLen || schemeEnd[1] != '/' || schemeEnd[2] != '/') {
+        return 0;
+    }
+
+    size_t i = (schemeEnd - data) + 3;
+    while (i < dataLen && data[i] != '/' && data[i] != '?' && data[i] != '#') {
+        i++;
+    }
+    return i;
+}
+
+UrlParser::UrlParts UrlParser::split(const StringRef target) {
+    const char* data = target.data();
+    size_t dataLen = target.length();
+
+    UrlParts parts;
+    parts.hasEscapes = false;
+    parts.hasDotSegments = false;
+
+    size_t pathStart = 0;
+    if (dataLen != 0 && data[0] != '/' && !(dataLen == 1 && data[0] == '*')) {
+        pathStart = skipSchemeAndAuthority(data, dataLen);
+    }
+
+    // Whole words without '?' or '#' are all path
+    size_t i = pathStart;
+    uint64_t escapes = 0;
+    uint64_t dots = 0;
+    while (i + 8 <= dataLen) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        if (findByte(word, '?') | findByte(word, '#')) {
+            break;
+        }
+        escapes |= findByte(word, '%');
+        dots |= findByte(word, '.');
+        i += 8;
+    }
+
+    for (; i < dataLen; i++) {
+        char c = data[i];
+        if (c == '?' || c == '#') {
+            break;
+        }
+        if (c == '%') {
+            escapes = 1;
+        } else if (c == '.') {
+            dots = 1;
+        }
+    }
+    size_t pathEnd = i;
+
+    if (pathStart == pathEnd && pathStart != 0) {
+        parts.path = "/"; // "http://host" asks for the root
+    } else {
+        parts.path = target.substring(pathStart, pathEnd);
+    }
+    parts.hasEscapes = (escapes != 0);
+    parts.hasDotSegments = (dots != 0) && hasDotSegments(parts.path);
+
+    if (pathEnd < dataLen && data[pathEnd] == '?') {
+        const char* fragment = (const char*)std::memchr(data + pathEnd, '#', dataLen - pathEnd);
+        size_t queryEnd = fragment ? fragment - data : dataLen;
+        parts.query = target.substring(pathEnd + 1, queryEnd);
+        pathEnd = queryEnd;
+    }
+    if (pathEnd < dataLen) {
+        parts.fragment = target.substring(pathEnd + 1);
+    }
+
+    return parts;
+}
+
+std::tuple<size_t, bool> UrlParser::percentDecode(const StringRef input, bool plusIsSpace, char* output) {
+    const char* data = input.data();
+    size_t dataLen = input.length();
+
+    size_t outputLen = 0;
+    for (size_t i = 0; i < dataLen; i++) {
+        char c = data[i];
+        if (c == '%') {
+            if (i + 2 >= dataLen) {
+                return std::make_tuple(0, false);
+            }
+            int high = hexValue(data[i + 1]);
+            int low = hexValue(data[i + 2]);
+            if (high < 0 || low < 0 || (high == 0 && low == 0)) {
+                return std::make_tuple(0, false);
+            }
+            output[outputLen++] = (char)((high << 4) | low);
+            i += 2;
+        } else if (c == '+' && plusIsSpace) {
+            output[outputLen++] = ' ';
+        } else {
+            output[outputLen++] = c;
+        }
+    }
+    return std::make_tuple(outputLen, true);
+}
+
+bool UrlParser::hasDotSegments(const StringRef path) {
+    const char* data = path.data();
+    size_t dataLen = path.length();
+
+    const char* dot = (const char*)std::memchr(data, '.', dataLen);
+    while (dot) {
+        size_t i = dot - data;
+        if (i != 0 && data[i - 1] == '/') {
+            if (i + 1 == dataLen || data[i + 1] == '/') {
+                return true;
+            }
+            if (data[i + 1] == '.' && (i + 2 == dataLen || data[i + 2] == '/')) {
+                return true;
+            }
+        }
+        dot = (const char*)std::memchr(dot + 1, '.', dataLen - i - 1);
+    }
+    return false;
+}
+
+// Works a "/segment" at a time. The output is never longer than what's been
+// read, so it can overwrite the input as it goes.
+size_t UrlParser::removeDotSegments(char* path, size_t pathLen) {
+    if (pathLen == 0 || path[0] != '/') {
+        return pathLen;
+    }
+
+    size_t in = 0;
+    size_t out = 0;
+    while (in < pathLen) {
+        size_t segmentStart = in + 1;
+        const char* nextSlash = (const char*)std::memchr(path + segmentStart, '/', pathLen - segmentStart);
+        size_t segmentEnd = nextSlash ? nextSlash - path : pathLen;
+        size_t segmentLen = segmentEnd - segmentStart;
+
+        if (segmentLen == 1 && path[segmentStart] == '.') {
+            if (segmentEnd == pathLen) {
+                path[out++] = '/';
+            }
+        } else if (segmentLen == 2 && path[segmentStart] == '.' && path[segmentStart + 1] == '.') {
+            // Drop the last "/segment" written
+            while (out > 0) {
+                out--;
+                if (path[out] == '/') {
+                    break;
+                }
+            }
+            if (segmentEnd == pathLen) {
+                path[out++] = '/';
+            }
+        } else {
+            std::memmove(path + out, path + in, segmentEnd - in);
+            out += segmentEnd - in;
+        }
+        in = segmentEnd;
+    }
+    return out;
+}
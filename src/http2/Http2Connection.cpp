@@ -43,11 +43,11 @@ const char* Http2Connection::DataBuf::getPtr() const {
 
 Http2Connection::Http2Connection(StreamSource* streamSource,
     BufferedReader& bufReader,
-    const HandlerMap* handlerMap,
+    const RouteTable* routeTable,
     bool skipPreface) :
     streamSource(streamSource),
     bufReader(bufReader),
-    handlerMap(handlerMap)
+    routeTable(routeTable)
 {}
 
 Http2Connection::~Http2Connection() {
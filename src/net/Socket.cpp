@@ -77,6 +77,10 @@ std::tuple<uint32_t, SocketError> Socket::readv(INet::IoBuffer* buffers, uint32_
     return impl->readv(buffers, bufferCount);
 }
 
+SocketError Socket::waitReadable() {
+    return impl->waitReadable();
+}
+
 SocketError Socket::write(const char* buffer, uint32_t bufferLen) {
     return impl->write(buffer, bufferLen);
 }
@@ -85,6 +89,11 @@ SocketError Socket::writev(const INet::IoBuffer* buffers, uint32_t bufferCount)
     return impl->writev(buffers, bufferCount);
 }
 
+SocketError Socket::sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+                             const File& file, uint64_t offset, uint64_t length) {
+    return impl->sendFile(headBuffers, headBufferCount, file, offset, length);
+}
+
 SocketError Socket::shutdownRead() {
     return impl->shutdownRead();
 }
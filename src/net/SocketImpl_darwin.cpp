@@ -11,6 +11,7 @@
 
 #include <errno.h>
 #include <sys/socket.h>
+#include <sys/types.h>
 #include <sys/uio.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -315,6 +316,53 @@ private:
     SocketError socketError;
 };
 
+class SocketImpl::ReadableAwaiter {
+public:
+    ReadableAwaiter(SocketImpl* socketImpl) :
+        socketImpl(socketImpl),
+        socketError(SocketError::Ok)
+    {}
+    
+    bool await_ready() {
+        bool readable;
+        std::tie(readable, socketError) = socketImpl->tryReadable();
+        
+        if (readable || socketError != SocketError::Ok) {
+            return true;
+        }
+
+        ::dispatch_set_context(socketImpl->readSource, (void*)this);
+        ::dispatch_source_set_event_handler_f(socketImpl->readSource, dispatchCallback);
+        ::dispatch_resume(socketImpl->readSource);
+        
+        return false;
+    }
+    
+    void await_suspend(std::experimental::coroutine_handle<> coroutineHandle) {
+        this->coroutineHandle = coroutineHandle;
+    }
+    
+    SocketError await_resume() {
+        return socketError;
+    }
+    
+private:
+    static
+    void dispatchCallback(void* voidAwaiter) {
+        ReadableAwaiter* awaiter = (ReadableAwaiter*)voidAwaiter;
+
+        // The source firing is the readiness we were waiting for
+        ::dispatch_source_cancel(awaiter->socketImpl->readSource);
+        awaiter->coroutineHandle.resume();
+    }
+    
+    SocketImpl* socketImpl;
+    std::experimental::coroutine_handle<> coroutineHandle;
+    
+    // Result value
+    SocketError socketError;
+};
+
 // Note that this mutates the passed IoBuffers
 class SocketImpl::WriteAwaiter {
 public:
@@ -411,6 +459,100 @@ private:
     SocketError socketError;
 };
 
+// Note that this mutates the passed header iovecs
+class SocketImpl::SendFileAwaiter {
+public:
+    SendFileAwaiter(SocketImpl* socketImpl,
+                    iovec* iov,
+                    int iovcnt,
+                    int fileFd,
+                    off_t offset,
+                    off_t length) :
+        socketImpl(socketImpl),
+        iov(iov),
+        iovcnt(iovcnt),
+        fileFd(fileFd),
+        offset(offset),
+        length(length),
+        socketError(SocketError::Ok)
+    {}
+
+    bool await_ready() {
+        if (trySend()) {
+            return true;
+        }
+
+        ::dispatch_set_context(socketImpl->writeSource, (void*)this);
+        ::dispatch_source_set_event_handler_f(socketImpl->writeSource, dispatchCallback);
+        ::dispatch_resume(socketImpl->writeSource);
+
+        return false;
+    }
+
+    void await_suspend(std::experimental::coroutine_handle<> coroutineHandle) {
+        this->coroutineHandle = coroutineHandle;
+    }
+
+    SocketError await_resume() {
+        return socketError;
+    }
+
+private:
+    static
+    void dispatchCallback(void* voidAwaiter) {
+        SendFileAwaiter* awaiter = (SendFileAwaiter*)voidAwaiter;
+
+        // If we finished or failed, clear the dispatch source and resume
+        if (awaiter->trySend()) {
+            ::dispatch_source_cancel(awaiter->socketImpl->writeSource);
+            awaiter->coroutineHandle.resume();
+            return;
+        }
+
+        // Otherwise, let the callback trigger again
+    }
+
+    // Sends as much as the socket will take. Returns true once done or failed.
+    bool trySend() {
+        while (iovcnt > 0 || length > 0) {
+            off_t bytesSent;
+            std::tie(bytesSent, socketError) = socketImpl->trySendFile(fileFd, offset, length, iov, iovcnt);
+            if (socketError != SocketError::Ok) {
+                return true;
+            }
+            if (bytesSent == 0) {
+                return false;
+            }
+
+            // Headers are sent first, so consume those before the file range
+            while (iovcnt > 0 && bytesSent > 0) {
+                size_t removable = std::min(iov->iov_len, (size_t)bytesSent);
+                iov->iov_len -= removable;
+                iov->iov_base = (char*)iov->iov_base + removable;
+                bytesSent -= removable;
+                if (iov->iov_len == 0) {
+                    iov++;
+                    iovcnt--;
+                }
+            }
+            offset += bytesSent;
+            length -= bytesSent;
+        }
+        return true;
+    }
+
+    SocketImpl* socketImpl;
+    iovec* iov;
+    int iovcnt;
+    int fileFd;
+    off_t offset;
+    off_t length;
+    std::experimental::coroutine_handle<> coroutineHandle;
+
+    // Result values
+    SocketError socketError;
+};
+
 std::tuple<SocketImpl*, SocketError> SocketImpl::tryAccept() {
     bool retry = true;
     sockaddr_storage storage;
@@ -505,6 +647,23 @@ std::tuple<ssize_t, SocketError> SocketImpl::tryRead(iovec *iov, int iovcnt) {
     return std::make_tuple(res, SocketError::Ok);
 }
 
+// Readable includes the peer having closed, which the following read reports
+std::tuple<bool, SocketError> SocketImpl::tryReadable() {
+    char peekByte;
+    ssize_t res = ::recv(fd, &peekByte, 1, MSG_PEEK);
+    if (res == -1) {
+        int err = errno;
+        
+        if (err == EAGAIN) {
+            return std::make_tuple(false, SocketError::Ok);
+        } else {
+            return std::make_tuple(false, getSocketError(err));
+        }
+    }
+    
+    return std::make_tuple(true, SocketError::Ok);
+}
+
 std::tuple<ssize_t, SocketError> SocketImpl::tryWrite(const iovec *iov, int iovcnt) {
     ssize_t res = ::writev(fd, iov, iovcnt);
     if (res == -1) {
@@ -520,6 +679,30 @@ std::tuple<ssize_t, SocketError> SocketImpl::tryWrite(const iovec *iov, int iovc
     return std::make_tuple(res, SocketError::Ok);
 }
 
+std::tuple<off_t, SocketError> SocketImpl::trySendFile(int fileFd, off_t offset, off_t length, iovec* headers, int headerCount) {
+    sf_hdtr hdtr;
+    hdtr.headers = headers;
+    hdtr.hdr_cnt = headerCount;
+    hdtr.trailers = nullptr;
+    hdtr.trl_cnt = 0;
+
+    // On input the length is the file range, on output the bytes sent including headers
+    off_t sendLen = length;
+    int res = ::sendfile(fileFd, fd, offset, &sendLen, headerCount > 0 ? &hdtr : nullptr, 0);
+    if (res == -1) {
+        int err = errno;
+
+        // Partial sends report progress through the length
+        if (err == EAGAIN || err == EINTR) {
+            return std::make_tuple(sendLen, SocketError::Ok);
+        } else {
+            return std::make_tuple(0, getSocketError(err));
+        }
+    }
+
+    return std::make_tuple(sendLen, SocketError::Ok);
+}
+
 SocketImpl::SocketImpl() :
     fd(-1),
     localAddr(),
@@ -744,6 +927,20 @@ std::tuple<uint32_t, SocketError> SocketImpl::readv(INet::IoBuffer* buffers, uin
     return res;
 }
 
+std::future<void> SocketImpl::readable_co(SocketError* res) {
+    (*res) = co_await ReadableAwaiter(this);
+}
+
+SocketError SocketImpl::waitReadable() {
+    if (fd == -1) {
+        return SocketError::NotInitialized;
+    }
+    
+    SocketError res = SocketError::Ok;
+    readable_co(&res).get();
+    return res;
+}
+
 std::future<void> SocketImpl::write_co(const INet::IoBuffer* buffers, uint32_t bufferCount, SocketError* res) {
     (*res) = co_await WriteAwaiter(this, buffers, bufferCount);
 }
@@ -779,6 +976,40 @@ SocketError SocketImpl::writev(const INet::IoBuffer* buffers, uint32_t bufferCou
     return res;
 }
 
+std::future<void> SocketImpl::sendFile_co(iovec* iov, int iovcnt, int fileFd, off_t offset, off_t length, SocketError* res) {
+    (*res) = co_await SendFileAwaiter(this, iov, iovcnt, fileFd, offset, length);
+}
+
+SocketError SocketImpl::sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+                                 const File& file, uint64_t offset, uint64_t length) {
+    if (fd == -1) {
+        return SocketError::NotInitialized;
+    }
+    if (headBufferCount > INT_MAX) {
+        return SocketError::InvalidArgument;
+    }
+
+    iovec staticBufs[20];
+    std::unique_ptr<iovec[]> dynamicBufs;
+    iovec* usableBuf = nullptr;
+
+    if (headBufferCount <= 20) {
+        usableBuf = staticBufs;
+    } else {
+        dynamicBufs.reset(new iovec[headBufferCount]);
+        usableBuf = dynamicBufs.get();
+    }
+
+    for (uint32_t i = 0; i < headBufferCount; i++) {
+        usableBuf[i].iov_base = headBuffers[i].buffer;
+        usableBuf[i].iov_len = headBuffers[i].bufferLen;
+    }
+
+    SocketError res = SocketError::Ok;
+    sendFile_co(usableBuf, (int)headBufferCount, file.getNativeHandle(), (off_t)offset, (off_t)length, &res).get();
+    return res;
+}
+
 SocketError SocketImpl::shutdownRead() {
     if (fd == -1) {
         return SocketError::NotInitialized;
@@ -8,8 +8,11 @@
 
 #include <Ws2tcpip.h>
 #include <Mstcpip.h>
+#include <Mswsock.h>
 
+#include <algorithm>
 #include <experimental/resumable>
+#include <memory>
 
 using namespace Cupcake;
 
@@ -651,6 +654,97 @@ private:
     uint32_t bytesXfer;
 };
 
+class SocketImpl::TransmitFileAwaiter {
+public:
+    TransmitFileAwaiter(SocketImpl* socketImpl,
+        char* head,
+        uint32_t headLen,
+        HANDLE fileHandle,
+        uint64_t offset,
+        uint32_t length) :
+        socketImpl(socketImpl),
+        head(head),
+        headLen(headLen),
+        fileHandle(fileHandle),
+        offset(offset),
+        length(length),
+        overlappedData(),
+        socketError(SocketError::Ok),
+        completed(false)
+    {}
+
+    bool await_ready() const {
+        return false;
+    }
+
+    bool await_suspend(std::experimental::coroutine_handle<> coroutineHandle) {
+        overlappedData.coroutineHandle = coroutineHandle.to_address();
+        overlappedData.completionResult = &completionResult;
+
+        // The file offset to send from is passed through the OVERLAPPED
+        overlappedData.overlapped.Offset = (DWORD)offset;
+        overlappedData.overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+        TRANSMIT_FILE_BUFFERS transmitBuffers;
+        transmitBuffers.Head = head;
+        transmitBuffers.HeadLength = headLen;
+        transmitBuffers.Tail = NULL;
+        transmitBuffers.TailLength = 0;
+
+        ::StartThreadpoolIo(socketImpl->ptpIo);
+
+        BOOL res = ::TransmitFile(socketImpl->socket,
+            fileHandle,
+            length,
+            0,
+            (OVERLAPPED*)&overlappedData,
+            headLen != 0 ? &transmitBuffers : NULL,
+            TF_USE_KERNEL_APC);
+
+        if (res) {
+            ::CancelThreadpoolIo(socketImpl->ptpIo);
+            completed = true;
+            return false;
+        } else {
+            int wsaErr = ::WSAGetLastError();
+
+            if (wsaErr != WSA_IO_PENDING && wsaErr != ERROR_IO_PENDING) {
+                ::CancelThreadpoolIo(socketImpl->ptpIo);
+                socketError = getSocketError(wsaErr);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    SocketError await_resume() {
+        if (socketError != SocketError::Ok) {
+            return socketError;
+        } else if (completed) {
+            return SocketError::Ok;
+        } else if (completionResult.error != ERROR_SUCCESS) {
+            return getSocketError((int)completionResult.error);
+        } else {
+            return SocketError::Ok;
+        }
+    }
+
+private:
+    SocketImpl* socketImpl;
+    char* head;
+    uint32_t headLen;
+    HANDLE fileHandle;
+    uint64_t offset;
+    uint32_t length;
+    OverlappedData overlappedData;
+    CompletionResult completionResult;
+
+    // Result value
+    SocketError socketError;
+    bool completed;
+};
+
 SocketImpl::SocketImpl() :
     socket(INVALID_SOCKET),
     ptpIo(NULL),
@@ -838,6 +932,22 @@ std::tuple<uint32_t, SocketError> SocketImpl::readv(INet::IoBuffer* buffers, uin
     return res;
 }
 
+// A zero byte receive completes once data arrives, so nothing has to be
+// handed to the OS while waiting
+SocketError SocketImpl::waitReadable() {
+    if (socket == INVALID_SOCKET) {
+        return SocketError::NotInitialized;
+    }
+
+    INet::IoBuffer ioBuffer;
+    ioBuffer.buffer = nullptr;
+    ioBuffer.bufferLen = 0;
+
+    std::tuple<uint32_t, SocketError> res(0, SocketError::Ok);
+    read_co(&ioBuffer, 1, &res).get();
+    return std::get<1>(res);
+}
+
 std::future<void> SocketImpl::write_co(const INet::IoBuffer* buffers, uint32_t bufferCount, SocketError* res) {
     (*res) = co_await WriteAwaiter(this, buffers, bufferCount);
 }
@@ -859,6 +969,61 @@ SocketError SocketImpl::writev(const INet::IoBuffer* buffers, uint32_t bufferCou
     return res;
 }
 
+std::future<void> SocketImpl::transmitFile_co(char* head, uint32_t headLen, HANDLE fileHandle, uint64_t offset, uint32_t length, SocketError* res) {
+    (*res) = co_await TransmitFileAwaiter(this, head, headLen, fileHandle, offset, length);
+}
+
+// TransmitFile caps a single call just short of 2GB
+#define MAX_TRANSMIT_FILE_BYTES 0x7FFFFFFE
+
+SocketError SocketImpl::sendFile(const INet::IoBuffer* headBuffers, uint32_t headBufferCount,
+                                 const File& file, uint64_t offset, uint64_t length) {
+    if (socket == INVALID_SOCKET) {
+        return SocketError::NotInitialized;
+    }
+
+    // TransmitFile only takes a single head buffer, so gather them if needed.
+    // This is header sized data, so the copy is cheap compared to a second send.
+    std::unique_ptr<char[]> gatheredHead;
+    char* head = nullptr;
+    uint32_t headLen = 0;
+
+    if (headBufferCount == 1) {
+        head = headBuffers[0].buffer;
+        headLen = headBuffers[0].bufferLen;
+    } else if (headBufferCount > 1) {
+        for (uint32_t i = 0; i < headBufferCount; i++) {
+            headLen += headBuffers[i].bufferLen;
+        }
+        gatheredHead.reset(new char[headLen]);
+        head = gatheredHead.get();
+
+        uint32_t headOffset = 0;
+        for (uint32_t i = 0; i < headBufferCount; i++) {
+            std::memcpy(head + headOffset, headBuffers[i].buffer, headBuffers[i].bufferLen);
+            headOffset += headBuffers[i].bufferLen;
+        }
+    }
+
+    do {
+        uint32_t sendLen = (uint32_t)std::min(length, (uint64_t)MAX_TRANSMIT_FILE_BYTES);
+
+        SocketError res = SocketError::Ok;
+        transmitFile_co(head, headLen, (HANDLE)file.getNativeHandle(), offset, sendLen, &res).get();
+        if (res != SocketError::Ok) {
+            return res;
+        }
+
+        // Head only goes out with the first piece
+        head = nullptr;
+        headLen = 0;
+        offset += sendLen;
+        length -= sendLen;
+    } while (length > 0);
+
+    return SocketError::Ok;
+}
+
 SocketError SocketImpl::shutdownRead() {
     if (socket == INVALID_SOCKET) {
         return SocketError::NotInitialized;
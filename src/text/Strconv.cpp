@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 
 static
 int8_t charValue[256] = {
@@ -48,6 +49,9 @@ const char two_digit_lookup[201] =
 #define P11 100000000000ULL
 #define P12 1000000000000ULL
 
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+
 #define INT32_MIN_STR "-2147483648"
 #define INT64_MIN_STR "-9223372036854775808"
 
@@ -139,12 +143,13 @@ size_t digitsBase10(uint64_t v) {
         }
         return 11 + (v >= P11);
     }
-    return 12 + digitsBase10(v / P12);
+    return 12 + digitsBase10((uint64_t)(v / P12));
 }
 
-static
-size_t uint32ToStr(uint32_t value, char* buffer) {
-    size_t length = digitsBase10(value);
+// Writes value as exactly length digits ending at buffer + length, two at a
+// time from the end
+static inline
+void writeDigits(uint32_t value, char* buffer, size_t length) {
     size_t next = length - 1;
     while (value >= 100) {
         auto const i = (value % 100) * 2;
@@ -161,28 +166,42 @@ size_t uint32ToStr(uint32_t value, char* buffer) {
         buffer[next] = two_digit_lookup[i + 1];
         buffer[next - 1] = two_digit_lookup[i];
     }
+}
+
+// Eight digits with leading zeros
+static inline
+void writeEightDigits(uint32_t value, char* buffer) {
+    for (int next = 6; next >= 0; next -= 2) {
+        auto const i = (value % 100) * 2;
+        value /= 100;
+        buffer[next + 1] = two_digit_lookup[i + 1];
+        buffer[next] = two_digit_lookup[i];
+    }
+}
+
+static
+size_t uint32ToStr(uint32_t value, char* buffer) {
+    size_t length = digitsBase10(value);
+    writeDigits(value, buffer, length);
     return length;
 }
 
 static
 size_t uint64ToStr(uint64_t value, char* buffer) {
-    size_t length = digitsBase10(value);
-    size_t next = length - 1;
-    while (value >= 100) {
-        auto const i = (value % 100) * 2;
-        value /= 100;
-        buffer[next] = two_digit_lookup[i + 1];
-        buffer[next - 1] = two_digit_lookup[i];
-        next -= 2;
+    if (value <= UINT32_MAX) {
+        return uint32ToStr((uint32_t)value, buffer);
     }
-    // Handle last 1-2 digits
-    if (value < 10) {
-        buffer[next] = '0' + char(value);
-    } else {
-        auto i = uint32_t(value) * 2;
-        buffer[next] = two_digit_lookup[i + 1];
-        buffer[next - 1] = two_digit_lookup[i];
+
+    // Peel off eight digits at a time until the rest can be done with 32 bit
+    // division, which is several times cheaper
+    size_t length = digitsBase10(value);
+    size_t next = length;
+    while (value > UINT32_MAX) {
+        next -= 8;
+        writeEightDigits((uint32_t)(value % P08), buffer + next);
+        value /= P08;
     }
+    writeDigits((uint32_t)value, buffer, next);
     return length;
 }
 
@@ -216,44 +235,52 @@ size_t int64ToStr(int64_t value, char* buffer) {
 
 // Less efficient varients that allow any radix
 
+// Counted up front so the digits can be written straight into place from
+// the end, rather than collected backward and reversed
 static
-size_t uint32ToStr(uint32_t value, uint32_t radix, char* buffer) {
-    unsigned char values[32]; // Worst case is base2
-    size_t length = 0;
-
-    while (value > 0) {
-        values[length] = value % radix;
-        value /= radix;
+size_t digitsForRadix(uint64_t value, uint32_t radix) {
+    size_t length = 1;
+    uint64_t power = radix;
+    while (value >= power) {
         length++;
+        if (power > UINT64_MAX / radix) {
+            // radix^length doesn't fit, so value is below it
+            break;
+        }
+        power *= radix;
     }
-
-    // Fill in backward as it's in reverse order
-    for (size_t i = 0, j = length-1; i < length; i++, j--) {
-        buffer[i] = valueAsChar[values[j]];
-    }
-
     return length;
 }
 
 static
 size_t uint64ToStr(uint64_t value, uint32_t radix, char* buffer) {
-    unsigned char values[64]; // Worst case is base2
-    size_t length = 0;
-
-    while (value > 0) {
-        values[length] = value % radix;
-        value /= radix;
-        length++;
-    }
+    size_t length = digitsForRadix(value, radix);
 
-    // Fill in backward as it's in reverse order
-    for (size_t i = 0, j = length - 1; i < length; i++, j--) {
-        buffer[i] = valueAsChar[values[j]];
+    if ((radix & (radix - 1)) == 0) {
+        // Powers of two, which covers hex chunk lengths, are shifts and masks
+        uint32_t shift = 0;
+        while ((1u << shift) < radix) {
+            shift++;
+        }
+        for (size_t i = length; i > 0; i--) {
+            buffer[i - 1] = valueAsChar[value & (radix - 1)];
+            value >>= shift;
+        }
+    } else {
+        for (size_t i = length; i > 0; i--) {
+            buffer[i - 1] = valueAsChar[value % radix];
+            value /= radix;
+        }
     }
 
     return length;
 }
 
+static
+size_t uint32ToStr(uint32_t value, uint32_t radix, char* buffer) {
+    return uint64ToStr((uint64_t)value, radix, buffer);
+}
+
 static
 size_t int32ToStr(int32_t value, int32_t radix, char* buffer) {
     if (value == INT32_MIN) {
@@ -286,10 +313,167 @@ size_t int64ToStr(int64_t value, int32_t radix, char* buffer) {
     }
 }
 
+// SWAR parsing. Eight digits are loaded into a 64 bit word, first digit in
+// the lowest byte, then validated and converted together with a handful of
+// word-wide operations instead of a table lookup and branch per digit.
+// See: http://0x80.pl/articles/swar-digits-validate.html and
+// https://lemire.me/blog/2022/01/21/swar-explained-parsing-eight-digits/
+
+static inline
+uint64_t loadWord(const char* data) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t word;
+    std::memcpy(&word, bytes, 8);
+
+    const uint16_t endianTest = 1;
+    if (*(const unsigned char*)&endianTest == 1) {
+        return word;
+    }
+
+    word = 0;
+    for (int i = 7; i >= 0; i--) {
+        word = (word << 8) | bytes[i];
+    }
+    return word;
+}
+
+// The high bit of each byte that's between lo and hi. Bytes can't carry
+// into their neighbours as long as none has its own high bit set, which
+// callers rule out separately.
+static inline
+uint64_t bytesInRange(uint64_t word, uint8_t lo, uint8_t hi) {
+    return (word + SWAR_ONES * (0x80 - lo)) & ~(word + SWAR_ONES * (0x7F - hi)) & SWAR_HIGHS;
+}
+
+static inline
+bool isEightDigits(uint64_t word) {
+    return ((word & SWAR_HIGHS) | (bytesInRange(word, '0', '9') ^ SWAR_HIGHS)) == 0;
+}
+
+static inline
+bool isEightHexDigits(uint64_t word) {
+    // Setting 0x20 folds A-F onto a-f, and only those
+    uint64_t hexDigits = bytesInRange(word, '0', '9') | bytesInRange(word | (SWAR_ONES * 0x20), 'a', 'f');
+    return ((word & SWAR_HIGHS) | (hexDigits ^ SWAR_HIGHS)) == 0;
+}
+
+// Each multiply combines neighbouring pairs: digits into two digit numbers,
+// those into four digit numbers, then the two halves
+static inline
+uint32_t eightDigitsValue(uint64_t word) {
+    word = ((word & 0x0F0F0F0F0F0F0F0FULL) * (1 + (10 << 8))) >> 8;
+    word = ((word & 0x00FF00FF00FF00FFULL) * (1 + (100ULL << 16))) >> 16;
+    return (uint32_t)(((word & 0x0000FFFF0000FFFFULL) * (1 + (10000ULL << 32))) >> 32);
+}
+
+static inline
+uint32_t eightHexDigitsValue(uint64_t word) {
+    // Letters have 0x40 set and their low nibble is one through six
+    word = (word & (SWAR_ONES * 0x0F)) + ((word >> 6) & SWAR_ONES) * 9;
+    word = ((word << 4) | (word >> 8)) & 0x00FF00FF00FF00FFULL;
+    word = ((word << 8) | (word >> 16)) & 0x0000FFFF0000FFFFULL;
+    return (uint32_t)((word << 16) | (word >> 32));
+}
+
+// Any run of up to 19 digits fits. Validity is only checked at the end, so
+// there's no branch per digit. The last few digits don't fill a word and go
+// one at a time, which is quicker than padding them out for short numbers.
+static inline
+std::tuple<uint64_t, bool> parseDecimalDigits(const char* data, size_t len) {
+    uint64_t value = 0;
+    bool valid = true;
+    for (; len >= 8; data += 8, len -= 8) {
+        uint64_t word = loadWord(data);
+        valid &= isEightDigits(word);
+        value = value * P08 + eightDigitsValue(word);
+    }
+    for (size_t i = 0; i < len; i++) {
+        uint32_t digit = (uint8_t)data[i] - (uint32_t)'0';
+        valid &= digit < 10;
+        value = value * 10 + digit;
+    }
+    return std::make_tuple(value, valid);
+}
+
+// Leading zeros don't count towards the digits that fit
+static inline
+void skipLeadingZeros(const char*& data, size_t& len) {
+    while (len > 1 && data[0] == '0') {
+        data++;
+        len--;
+    }
+}
+
+static inline
+std::tuple<uint64_t, bool> parseUint64Decimal(const char* data, size_t len) {
+    if (len == 0) {
+        return std::make_tuple(0, false);
+    }
+
+    skipLeadingZeros(data, len);
+    if (len < UINT64_MAX_LEN) {
+        return parseDecimalDigits(data, len);
+    } else if (len > UINT64_MAX_LEN) {
+        return std::make_tuple(0, false);
+    }
+
+    // Twenty digits only fit up to UINT64_MAX, so the last is checked alone
+    uint64_t value;
+    bool valid;
+    std::tie(value, valid) = parseDecimalDigits(data, UINT64_MAX_LEN - 1);
+    uint32_t last = (uint8_t)data[UINT64_MAX_LEN - 1] - (uint32_t)'0';
+    if (!valid || last > 9 || value > (UINT64_MAX - last) / 10) {
+        return std::make_tuple(0, false);
+    }
+    return std::make_tuple(value * 10 + last, true);
+}
+
+static inline
+std::tuple<uint64_t, bool> parseUint64Hex(const char* data, size_t len) {
+    if (len == 0) {
+        return std::make_tuple(0, false);
+    }
+
+    // Every hex digit is four bits, so anything up to 16 fits
+    skipLeadingZeros(data, len);
+    if (len > 16) {
+        return std::make_tuple(0, false);
+    }
+
+    uint64_t value = 0;
+    bool valid = true;
+    for (; len >= 8; data += 8, len -= 8) {
+        uint64_t word = loadWord(data);
+        valid &= isEightHexDigits(word);
+        value = (value << 32) | eightHexDigitsValue(word);
+    }
+    for (size_t i = 0; i < len; i++) {
+        int8_t digit = charValue[(uint8_t)data[i]];
+        valid &= digit >= 0;
+        value = (value << 4) | (uint8_t)digit;
+    }
+    return std::make_tuple(value, valid);
+}
+
 namespace Cupcake {
 
 namespace Strconv {
 
+// Radix 10 and 16 on top of parseUint64. Negative numbers can go one
+// further than positive ones.
+static
+std::tuple<uint64_t, bool, bool> parseSigned(const StringRef str, uint32_t radix, uint64_t maxValue) {
+    bool negative = str.length() > 0 && str.data()[0] == '-';
+
+    uint64_t magnitude;
+    bool valid;
+    std::tie(magnitude, valid) = parseUint64(negative ? str.substring(1) : str, radix);
+    if (!valid || magnitude > maxValue + (negative ? 1 : 0)) {
+        return std::make_tuple(0, false, false);
+    }
+    return std::make_tuple(magnitude, negative, true);
+}
+
 size_t int32ToStr(int32_t value, char* buffer, size_t bufferLen) {
     char tempBuf[INT32_MAX_LEN];
 
@@ -404,6 +588,13 @@ size_t uint64ToStr(uint64_t value, uint32_t radix, char* buffer, size_t bufferLe
 }
 
 std::tuple<int32_t, bool> parseInt32(const StringRef str, uint32_t radix) {
+    if (radix == 10 || radix == 16) {
+        uint64_t magnitude;
+        bool negative;
+        bool valid;
+        std::tie(magnitude, negative, valid) = parseSigned(str, radix, INT32_MAX);
+        return std::make_tuple(negative ? (int32_t)(0 - (uint32_t)magnitude) : (int32_t)magnitude, valid);
+    }
     if (radix < 2 || radix > 16) {
         return std::make_tuple(0, false);
     }
@@ -480,6 +671,13 @@ std::tuple<int32_t, bool> parseInt32(const StringRef str, uint32_t radix) {
 }
 
 std::tuple<int64_t, bool> parseInt64(const StringRef str, uint32_t radix) {
+    if (radix == 10 || radix == 16) {
+        uint64_t magnitude;
+        bool negative;
+        bool valid;
+        std::tie(magnitude, negative, valid) = parseSigned(str, radix, INT64_MAX);
+        return std::make_tuple(negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude, valid);
+    }
     if (radix < 2 || radix > 16) {
         return std::make_tuple(0, false);
     }
@@ -556,6 +754,15 @@ std::tuple<int64_t, bool> parseInt64(const StringRef str, uint32_t radix) {
 }
 
 std::tuple<uint32_t, bool> parseUint32(const StringRef str, uint32_t radix) {
+    if (radix == 10 || radix == 16) {
+        uint64_t value;
+        bool valid;
+        std::tie(value, valid) = parseUint64(str, radix);
+        if (!valid || value > UINT32_MAX) {
+            return std::make_tuple(0, false);
+        }
+        return std::make_tuple((uint32_t)value, true);
+    }
     if (radix < 2 || radix > 16) {
         return std::make_tuple(0, false);
     }
@@ -613,6 +820,12 @@ std::tuple<uint32_t, bool> parseUint32(const StringRef str, uint32_t radix) {
 }
 
 std::tuple<uint64_t, bool> parseUint64(const StringRef str, uint32_t radix) {
+    // The SWAR paths, the rest go a char at a time
+    if (radix == 10) {
+        return ::parseUint64Decimal(str.data(), str.length());
+    } else if (radix == 16) {
+        return ::parseUint64Hex(str.data(), str.length());
+    }
     if (radix < 2 || radix > 16) {
         return std::make_tuple(0, false);
     }
@@ -0,0 +1,836 @@
+
+#include "cupcake/internal/text/Strconv.h"
+#include "cupcake/internal/text/FloatData.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace Cupcake;
+
+// Floating point to and from strings without going near the locale.
+//
+// Formatting uses Schubfach, from "The Schubfach way to render doubles" by
+// Raffaello Giulietti, which finds the shortest decimal that rounds back to
+// the same value with a few 128 bit multiplies. This follows the structure
+// of the reference implementation in the JDK.
+//
+// Parsing uses the Eisel-Lemire algorithm, as in the fast_float library by
+// Daniel Lemire. A 64 bit multiply against a table of powers of five gives
+// the correctly rounded result for anything up to 19 significant digits.
+// Longer inputs that land too close to halfway between two values are
+// settled by comparing every digit against the halfway point exactly.
+
+#define DOUBLE_MAX_LEN 25 // -0.0000012345678901234567
+#define FLOAT_MAX_LEN 22  // -123456789000000000000
+
+#define POWERS_OF_FIVE_MIN -342
+#define POWERS_OF_TEN_MIN_K -324
+
+#define MASK_32 0xFFFFFFFFULL
+#define MASK_63 0x7FFFFFFFFFFFFFFFULL
+
+// Longest run of significant digits that matters. Halfway points between
+// doubles have at most 767, so digits past this only act as a tiebreak.
+#define MAX_SIGNIFICANT_DIGITS 800
+
+// Past this the value is zero or infinity regardless of the digits
+#define MAX_EXPONENT 100000
+
+#define BIG_INTEGER_LIMBS 100
+
+static
+const double exactPowersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/*
+ * The parameters of an IEEE binary format, for the code shared between
+ * float and double.
+ */
+class DoubleFormat {
+public:
+    typedef double Type;
+    typedef uint64_t Bits;
+
+    static const int32_t mantissaBits = 52;
+    static const int32_t minExponent = -1023;
+    static const int32_t infinitePower = 0x7FF;
+    // Decimal exponents where a product can be exactly halfway
+    static const int32_t minRoundToEven = -4;
+    static const int32_t maxRoundToEven = 23;
+    // Anything outside is zero or infinity
+    static const int32_t minPowerOfTen = -342;
+    static const int32_t maxPowerOfTen = 308;
+    // Where both the mantissa and power of ten are exact
+    static const int32_t maxExactPowerOfTen = 22;
+    static const uint64_t maxExactMantissa = 1ULL << 53;
+};
+
+class FloatFormat {
+public:
+    typedef float Type;
+    typedef uint32_t Bits;
+
+    static const int32_t mantissaBits = 23;
+    static const int32_t minExponent = -127;
+    static const int32_t infinitePower = 0xFF;
+    static const int32_t minRoundToEven = -17;
+    static const int32_t maxRoundToEven = 10;
+    static const int32_t minPowerOfTen = -65;
+    static const int32_t maxPowerOfTen = 38;
+    static const int32_t maxExactPowerOfTen = 10;
+    static const uint64_t maxExactMantissa = 1ULL << 24;
+};
+
+// The high and low halves of a * b
+static inline
+std::tuple<uint64_t, uint64_t> multiply128(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    return std::make_tuple((uint64_t)(product >> 64), (uint64_t)product);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    uint64_t low = _umul128(a, b, &high);
+    return std::make_tuple(high, low);
+#else
+    uint64_t aLow = (uint32_t)a;
+    uint64_t aHigh = a >> 32;
+    uint64_t bLow = (uint32_t)b;
+    uint64_t bHigh = b >> 32;
+
+    uint64_t lowLow = aLow * bLow;
+    uint64_t lowHigh = aLow * bHigh;
+    uint64_t highLow = aHigh * bLow;
+    uint64_t middle = (lowLow >> 32) + (uint32_t)lowHigh + (uint32_t)highLow;
+    return std::make_tuple(aHigh * bHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32),
+                           (middle << 32) | (uint32_t)lowLow);
+#endif
+}
+
+static inline
+uint32_t countLeadingZeros(uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - (uint32_t)index;
+#elif defined(_MSC_VER)
+    uint32_t count = 0;
+    while ((value & (1ULL << 63)) == 0) {
+        value <<= 1;
+        count++;
+    }
+    return count;
+#else
+    return (uint32_t)__builtin_clzll(value);
+#endif
+}
+
+// floor(e log10(2)), floor(e log10(3/4 2)) and floor(e log2(10)), exact for
+// every exponent either format can reach
+static inline
+int32_t floorLog10Pow2(int32_t e) {
+    return (int32_t)(((int64_t)e * 661971961083LL) >> 41);
+}
+
+static inline
+int32_t floorLog10ThreeQuartersPow2(int32_t e) {
+    return (int32_t)(((int64_t)e * 661971961083LL - 274743187321LL) >> 41);
+}
+
+static inline
+int32_t floorLog2Pow10(int32_t e) {
+    return (int32_t)(((int64_t)e * 913124641741LL) >> 38);
+}
+
+// g cp 2^-127 rounded to odd, which keeps whether it was exact in the
+// lowest bit
+static inline
+uint64_t roundToOdd(uint64_t g1, uint64_t g0, uint64_t cp) {
+    uint64_t x1 = std::get<0>(multiply128(g0, cp));
+    uint64_t y1;
+    uint64_t y0;
+    std::tie(y1, y0) = multiply128(g1, cp);
+    uint64_t z = (y0 >> 1) + x1;
+    uint64_t vbp = y1 + (z >> 63);
+    return vbp | (((z & MASK_63) + MASK_63) >> 63);
+}
+
+static inline
+uint32_t roundToOdd(uint64_t g, uint64_t cp) {
+    uint64_t x1 = std::get<0>(multiply128(g, cp));
+    uint64_t vbp = x1 >> 31;
+    return (uint32_t)(vbp | (((x1 & MASK_32) + MASK_32) >> 32));
+}
+
+// The shortest f 10^e that rounds back to c 2^q, the closest one to it if
+// there are several
+static
+std::tuple<uint64_t, int32_t> doubleToDecimal(int32_t q, uint64_t c) {
+    uint64_t out = c & 1;
+    uint64_t cb = c << 2;
+    uint64_t cbr = cb + 2;
+    uint64_t cbl;
+    int32_t k;
+    // The interval is lopsided at the bottom of each binade
+    if (c != (1ULL << DoubleFormat::mantissaBits) || q == -1074) {
+        cbl = cb - 2;
+        k = floorLog10Pow2(q);
+    } else {
+        cbl = cb - 1;
+        k = floorLog10ThreeQuartersPow2(q);
+    }
+    int32_t h = q + floorLog2Pow10(-k) + 2;
+
+    const uint64_t* g = Cupcake::FloatData::powersOfTen[k - POWERS_OF_TEN_MIN_K];
+    uint64_t vb = roundToOdd(g[0], g[1], cb << h);
+    uint64_t vbl = roundToOdd(g[0], g[1], cbl << h);
+    uint64_t vbr = roundToOdd(g[0], g[1], cbr << h);
+
+    // Try one digit shorter first. The interval is under 10 wide so at most
+    // one of these can be in it. The JDK waits for s >= 100 since Java wants
+    // at least two digits, which would make 5e-324 come out as 4.9e-324.
+    uint64_t s = vb >> 2;
+    if (s >= 10) {
+        uint64_t sp10 = s / 10 * 10;
+        uint64_t tp10 = sp10 + 10;
+        bool upin = vbl + out <= sp10 << 2;
+        bool wpin = (tp10 << 2) + out <= vbr;
+        if (upin != wpin) {
+            return std::make_tuple(upin ? sp10 : tp10, k);
+        }
+    }
+
+    uint64_t t = s + 1;
+    bool uin = vbl + out <= s << 2;
+    bool win = (t << 2) + out <= vbr;
+    if (uin != win) {
+        return std::make_tuple(uin ? s : t, k);
+    }
+
+    // Both in range, so take the closer one
+    int64_t cmp = (int64_t)(vb - ((s + t) << 1));
+    return std::make_tuple((cmp < 0 || (cmp == 0 && (s & 1) == 0)) ? s : t, k);
+}
+
+static
+std::tuple<uint64_t, int32_t> floatToDecimal(int32_t q, uint64_t c) {
+    uint64_t out = c & 1;
+    uint64_t cb = c << 2;
+    uint64_t cbr = cb + 2;
+    uint64_t cbl;
+    int32_t k;
+    if (c != (1ULL << FloatFormat::mantissaBits) || q == -149) {
+        cbl = cb - 2;
+        k = floorLog10Pow2(q);
+    } else {
+        cbl = cb - 1;
+        k = floorLog10ThreeQuartersPow2(q);
+    }
+    int32_t h = q + floorLog2Pow10(-k) + 33;
+
+    // The top 63 bits are plenty here
+    uint64_t g = Cupcake::FloatData::powersOfTen[k - POWERS_OF_TEN_MIN_K][0] + 1;
+    uint32_t vb = roundToOdd(g, cb << h);
+    uint32_t vbl = roundToOdd(g, cbl << h);
+    uint32_t vbr = roundToOdd(g, cbr << h);
+
+    uint32_t s = vb >> 2;
+    // As for doubles
+    if (s >= 10) {
+        uint32_t sp10 = s / 10 * 10;
+        uint32_t tp10 = sp10 + 10;
+        bool upin = vbl + out <= (uint64_t)sp10 << 2;
+        bool wpin = ((uint64_t)tp10 << 2) + out <= vbr;
+        if (upin != wpin) {
+            return std::make_tuple(upin ? sp10 : tp10, k);
+        }
+    }
+
+    uint32_t t = s + 1;
+    bool uin = vbl + out <= (uint64_t)s << 2;
+    bool win = ((uint64_t)t << 2) + out <= vbr;
+    if (uin != win) {
+        return std::make_tuple(uin ? s : t, k);
+    }
+
+    int64_t cmp = (int64_t)vb - (((int64_t)s + t) << 1);
+    return std::make_tuple((cmp < 0 || (cmp == 0 && (s & 1) == 0)) ? s : t, k);
+}
+
+// Writes f 10^e the way JavaScript does, plain for exponents that aren't too
+// far from zero and scientific otherwise: "1500", "0.015", "1.5e+300"
+static
+size_t formatDecimal(bool negative, uint64_t f, int32_t e, char* buffer) {
+    while (f % 10 == 0) {
+        f /= 10;
+        e++;
+    }
+
+    char digits[20];
+    size_t length = Strconv::uint64ToStr(f, digits, sizeof(digits));
+    // Where the decimal point goes relative to the first digit
+    int32_t point = (int32_t)length + e;
+
+    char* next = buffer;
+    if (negative) {
+        *next++ = '-';
+    }
+
+    if ((int32_t)length <= point && point <= 21) {
+        std::memcpy(next, digits, length);
+        std::memset(next + length, '0', point - length);
+        next += point;
+    } else if (0 < point && point <= 21) {
+        std::memcpy(next, digits, point);
+        next[point] = '.';
+        std::memcpy(next + point + 1, digits + point, length - point);
+        next += length + 1;
+    } else if (-6 < point && point <= 0) {
+        *next++ = '0';
+        *next++ = '.';
+        std::memset(next, '0', -point);
+        next += -point;
+        std::memcpy(next, digits, length);
+        next += length;
+    } else {
+        *next++ = digits[0];
+        if (length > 1) {
+            *next++ = '.';
+            std::memcpy(next, digits + 1, length - 1);
+            next += length - 1;
+        }
+        *next++ = 'e';
+        int32_t exponent = point - 1;
+        *next++ = exponent < 0 ? '-' : '+';
+        next += Strconv::uint32ToStr((uint32_t)(exponent < 0 ? -exponent : exponent), next, 3);
+    }
+
+    return next - buffer;
+}
+
+static
+size_t formatSpecial(bool negative, bool nan, char* buffer) {
+    const char* str = nan ? "NaN" : (negative ? "-Infinity" : "Infinity");
+    size_t len = std::strlen(str);
+    std::memcpy(buffer, str, len);
+    return len;
+}
+
+static
+size_t doubleToStr(double value, char* buffer) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    bool negative = (bits >> 63) != 0;
+    uint64_t t = bits & ((1ULL << DoubleFormat::mantissaBits) - 1);
+    int32_t bq = (int32_t)(bits >> DoubleFormat::mantissaBits) & DoubleFormat::infinitePower;
+
+    if (bq == DoubleFormat::infinitePower) {
+        return formatSpecial(negative, t != 0, buffer);
+    }
+
+    uint64_t f;
+    int32_t e;
+    if (bq != 0) {
+        int32_t mq = 1075 - bq;
+        uint64_t c = (1ULL << DoubleFormat::mantissaBits) | t;
+        // Integers are already as short as they get
+        if (0 < mq && mq < 53 && ((c >> mq) << mq) == c) {
+            return formatDecimal(negative, c >> mq, 0, buffer);
+        }
+        std::tie(f, e) = doubleToDecimal(-mq, c);
+    } else if (t != 0) {
+        // The JDK scales the smallest subnormals up by 10 here to get its two
+        // digits, which shrinks the interval and loses the shortest form
+        std::tie(f, e) = doubleToDecimal(-1074, t);
+    } else {
+        size_t len = 0;
+        if (negative) {
+            buffer[len++] = '-';
+        }
+        buffer[len++] = '0';
+        return len;
+    }
+    return formatDecimal(negative, f, e, buffer);
+}
+
+static
+size_t floatToStr(float value, char* buffer) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    bool negative = (bits >> 31) != 0;
+    uint32_t t = bits & ((1u << FloatFormat::mantissaBits) - 1);
+    int32_t bq = (int32_t)(bits >> FloatFormat::mantissaBits) & FloatFormat::infinitePower;
+
+    if (bq == FloatFormat::infinitePower) {
+        return formatSpecial(negative, t != 0, buffer);
+    }
+
+    uint64_t f;
+    int32_t e;
+    if (bq != 0) {
+        int32_t mq = 150 - bq;
+        uint32_t c = (1u << FloatFormat::mantissaBits) | t;
+        if (0 < mq && mq < 24 && ((c >> mq) << mq) == c) {
+            return formatDecimal(negative, c >> mq, 0, buffer);
+        }
+        std::tie(f, e) = floatToDecimal(-mq, c);
+    } else if (t != 0) {
+        std::tie(f, e) = floatToDecimal(-149, t);
+    } else {
+        size_t len = 0;
+        if (negative) {
+            buffer[len++] = '-';
+        }
+        buffer[len++] = '0';
+        return len;
+    }
+    return formatDecimal(negative, f, e, buffer);
+}
+
+/*
+ * Just enough of an arbitrary precision integer to compare a long run of
+ * decimal digits against a halfway point exactly.
+ */
+class BigInteger {
+public:
+    BigInteger(uint64_t value) :
+        length(0)
+    {
+        while (value != 0) {
+            limbs[length++] = (uint32_t)value;
+            value >>= 32;
+        }
+    }
+
+    void multiplyAdd(uint32_t multiplier, uint32_t addend) {
+        uint64_t carry = addend;
+        for (uint32_t i = 0; i < length; i++) {
+            uint64_t product = (uint64_t)limbs[i] * multiplier + carry;
+            limbs[i] = (uint32_t)product;
+            carry = product >> 32;
+        }
+        if (carry != 0 && length < BIG_INTEGER_LIMBS) {
+            limbs[length++] = (uint32_t)carry;
+        }
+    }
+
+    void multiplyPow5(uint32_t exponent) {
+        // 5^13 is the largest that fits in 32 bits
+        static const uint32_t powersOf5[] = {
+            1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125, 9765625, 48828125,
+            244140625, 1220703125
+        };
+        for (; exponent >= 13; exponent -= 13) {
+            multiplyAdd(powersOf5[13], 0);
+        }
+        multiplyAdd(powersOf5[exponent], 0);
+    }
+
+    void shiftLeft(uint32_t bits) {
+        if (length == 0) {
+            return;
+        }
+
+        uint32_t limbShift = std::min(bits / 32, (uint32_t)BIG_INTEGER_LIMBS - length);
+        uint32_t bitShift = bits % 32;
+        if (bitShift != 0) {
+            uint32_t carry = 0;
+            for (uint32_t i = 0; i < length; i++) {
+                uint32_t limb = limbs[i];
+                limbs[i] = (limb << bitShift) | carry;
+                carry = limb >> (32 - bitShift);
+            }
+            if (carry != 0 && length < BIG_INTEGER_LIMBS) {
+                limbs[length++] = carry;
+            }
+        }
+        if (limbShift != 0) {
+            std::memmove(limbs + limbShift, limbs, length * sizeof(uint32_t));
+            std::memset(limbs, 0, limbShift * sizeof(uint32_t));
+            length += limbShift;
+        }
+    }
+
+    int32_t compare(const BigInteger& other) const {
+        if (length != other.length) {
+            return length < other.length ? -1 : 1;
+        }
+        for (uint32_t i = length; i > 0; i--) {
+            if (limbs[i - 1] != other.limbs[i - 1]) {
+                return limbs[i - 1] < other.limbs[i - 1] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+private:
+    uint32_t limbs[BIG_INTEGER_LIMBS];
+    uint32_t length;
+};
+
+/*
+ * A decimal number split into its parts, with the first 19 significant
+ * digits gathered up.
+ */
+class DecimalNumber {
+public:
+    DecimalNumber() :
+        negative(false),
+        infinite(false),
+        nan(false),
+        mantissa(0),
+        exponent(0),
+        truncated(false),
+        integerDigits(nullptr),
+        integerLength(0),
+        fractionDigits(nullptr),
+        fractionLength(0),
+        explicitExponent(0)
+    {}
+
+    bool negative;
+    bool infinite;
+    bool nan;
+
+    // Close to mantissa 10^exponent, exactly unless truncated
+    uint64_t mantissa;
+    int64_t exponent;
+    bool truncated;
+
+    // Exactly digits 10^(explicitExponent - fractionLength)
+    const char* integerDigits;
+    size_t integerLength;
+    const char* fractionDigits;
+    size_t fractionLength;
+    int64_t explicitExponent;
+};
+
+static inline
+bool isDigit(char c) {
+    return (uint8_t)(c - '0') < 10;
+}
+
+// Accepts what strtod would other than hex, a leading plus sign and
+// whitespace, plus "Infinity" and "NaN" as formatted above
+static
+std::tuple<DecimalNumber, bool> scanDecimal(const StringRef str) {
+    DecimalNumber number;
+    const char* next = str.data();
+    const char* end = next + str.length();
+
+    if (next != end && *next == '-') {
+        number.negative = true;
+        next++;
+    }
+
+    StringRef rest(next, end - next);
+    if (rest == "Infinity") {
+        number.infinite = true;
+        return std::make_tuple(number, true);
+    } else if (rest == "NaN") {
+        number.nan = true;
+        return std::make_tuple(number, true);
+    }
+
+    number.integerDigits = next;
+    while (next != end && isDigit(*next)) {
+        next++;
+    }
+    number.integerLength = next - number.integerDigits;
+
+    if (next != end && *next == '.') {
+        next++;
+        number.fractionDigits = next;
+        while (next != end && isDigit(*next)) {
+            next++;
+        }
+        number.fractionLength = next - number.fractionDigits;
+    }
+
+    if (number.integerLength + number.fractionLength == 0) {
+        return std::make_tuple(number, false);
+    }
+
+    if (next != end && (*next == 'e' || *next == 'E')) {
+        next++;
+        bool negativeExponent = false;
+        if (next != end && (*next == '-' || *next == '+')) {
+            negativeExponent = *next == '-';
+            next++;
+        }
+        if (next == end || !isDigit(*next)) {
+            return std::make_tuple(number, false);
+        }
+
+        int64_t exponent = 0;
+        for (; next != end && isDigit(*next); next++) {
+            if (exponent < MAX_EXPONENT) {
+                exponent = exponent * 10 + (*next - '0');
+            }
+        }
+        number.explicitExponent = negativeExponent ? -exponent : exponent;
+    }
+
+    if (next != end) {
+        return std::make_tuple(number, false);
+    }
+
+    // Gather up to 19 significant digits, which always fit. Leading zeros
+    // don't count.
+    size_t used = 0;
+    size_t dropped = 0;
+    const char* ranges[2][2] = {
+        {number.integerDigits, number.integerDigits + number.integerLength},
+        {number.fractionDigits, number.fractionDigits + number.fractionLength}
+    };
+    for (const auto& range : ranges) {
+        for (const char* digit = range[0]; digit != range[1]; digit++) {
+            if (used == 0 && *digit == '0') {
+                continue;
+            }
+            if (used < 19) {
+                number.mantissa = number.mantissa * 10 + (*digit - '0');
+                used++;
+            } else {
+                number.truncated |= *digit != '0';
+                dropped++;
+            }
+        }
+    }
+    number.exponent = number.explicitExponent - (int64_t)number.fractionLength + (int64_t)dropped;
+
+    return std::make_tuple(number, true);
+}
+
+// The bits of the value closest to w 10^q, for up to 19 digits of w
+template <typename Format>
+static
+uint64_t eiselLemire(int64_t q, uint64_t w) {
+    if (w == 0 || q < Format::minPowerOfTen) {
+        return 0;
+    } else if (q > Format::maxPowerOfTen) {
+        return (uint64_t)Format::infinitePower << Format::mantissaBits;
+    }
+
+    uint32_t leadingZeros = countLeadingZeros(w);
+    w <<= leadingZeros;
+
+    // The first half of the power is enough unless the bits below what
+    // matters are all ones, when the carry from the second could matter
+    const uint64_t* power = Cupcake::FloatData::powersOfFive[q - POWERS_OF_FIVE_MIN];
+    uint64_t high;
+    uint64_t low;
+    std::tie(high, low) = multiply128(w, power[0]);
+    uint64_t precisionMask = UINT64_MAX >> (Format::mantissaBits + 3);
+    if ((high & precisionMask) == precisionMask) {
+        uint64_t secondHigh = std::get<0>(multiply128(w, power[1]));
+        low += secondHigh;
+        if (secondHigh > low) {
+            high++;
+        }
+    }
+
+    int32_t upperBit = (int32_t)(high >> 63);
+    int32_t shift = upperBit + 64 - Format::mantissaBits - 3;
+    uint64_t mantissa = high >> shift;
+    // floor(q log2(10)) + 63, plus the bias
+    int32_t power2 = (int32_t)(((((152170 + 65536) * (int32_t)q) >> 16) + 63) + upperBit -
+                               (int32_t)leadingZeros - Format::minExponent);
+
+    if (power2 <= 0) {
+        // Subnormal. Values this small can't be exactly halfway.
+        if (-power2 + 1 >= 64) {
+            return 0;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        // Rounding up can make it the smallest normal, which sets the same bit
+        return mantissa;
+    }
+
+    // Exactly halfway, which has to round to even rather than up
+    if (low <= 1 && q >= Format::minRoundToEven && q <= Format::maxRoundToEven &&
+        (mantissa & 3) == 1 && (mantissa << shift) == high) {
+        mantissa &= ~1ULL;
+    }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (2ULL << Format::mantissaBits)) {
+        mantissa = 1ULL << Format::mantissaBits;
+        power2++;
+    }
+    mantissa &= ~(1ULL << Format::mantissaBits);
+
+    if (power2 >= Format::infinitePower) {
+        return (uint64_t)Format::infinitePower << Format::mantissaBits;
+    }
+    return mantissa | ((uint64_t)power2 << Format::mantissaBits);
+}
+
+// Picks between bits and the value after it, by comparing all the digits
+// against the point halfway between them
+template <typename Format>
+static
+uint64_t roundByDigits(const DecimalNumber& number, uint64_t bits) {
+    int32_t power2 = (int32_t)(bits >> Format::mantissaBits);
+    uint64_t mantissa = bits & ((1ULL << Format::mantissaBits) - 1);
+    int32_t binaryExponent = 1 + Format::minExponent - Format::mantissaBits;
+    if (power2 != 0) {
+        mantissa |= 1ULL << Format::mantissaBits;
+        binaryExponent = power2 + Format::minExponent - Format::mantissaBits;
+    }
+    // (2 mantissa + 1) 2^(binaryExponent - 1)
+    BigInteger halfway(2 * mantissa + 1);
+    int64_t halfwayExponent = binaryExponent - 1;
+
+    // Past the limit the rest of the digits only matter if they're not zero
+    BigInteger digits(0);
+    size_t used = 0;
+    size_t dropped = 0;
+    bool nonZeroDropped = false;
+    uint32_t chunk = 0;
+    uint32_t chunkLength = 0;
+    const char* ranges[2][2] = {
+        {number.integerDigits, number.integerDigits + number.integerLength},
+        {number.fractionDigits, number.fractionDigits + number.fractionLength}
+    };
+    for (const auto& range : ranges) {
+        for (const char* digit = range[0]; digit != range[1]; digit++) {
+            if (used == 0 && *digit == '0') {
+                continue;
+            }
+            if (used < MAX_SIGNIFICANT_DIGITS) {
+                chunk = chunk * 10 + (*digit - '0');
+                chunkLength++;
+                used++;
+                if (chunkLength == 9) {
+                    digits.multiplyAdd(1000000000, chunk);
+                    chunk = 0;
+                    chunkLength = 0;
+                }
+            } else {
+                nonZeroDropped |= *digit != '0';
+                dropped++;
+            }
+        }
+    }
+    if (chunkLength != 0) {
+        digits.multiplyAdd((uint32_t)exactPowersOf10[chunkLength], chunk);
+    }
+    int64_t decimalExponent = number.explicitExponent - (int64_t)number.fractionLength + (int64_t)dropped;
+
+    // Compare digits 5^d 2^d against halfway 2^h, moving the powers of five
+    // to whichever side keeps them positive and lining up the powers of two
+    if (decimalExponent >= 0) {
+        digits.multiplyPow5((uint32_t)decimalExponent);
+    } else {
+        halfway.multiplyPow5((uint32_t)-decimalExponent);
+    }
+    int64_t binaryDifference = decimalExponent - halfwayExponent;
+    if (binaryDifference > 0) {
+        digits.shiftLeft((uint32_t)binaryDifference);
+    } else if (binaryDifference < 0) {
+        halfway.shiftLeft((uint32_t)-binaryDifference);
+    }
+
+    int32_t compared = digits.compare(halfway);
+    if (compared > 0 || (compared == 0 && (nonZeroDropped || (bits & 1) != 0))) {
+        return bits + 1;
+    }
+    return bits;
+}
+
+template <typename Format>
+static
+std::tuple<typename Format::Type, bool> parseFloatingPoint(const StringRef str) {
+    typedef typename Format::Type Type;
+    typedef typename Format::Bits Bits;
+
+    DecimalNumber number;
+    bool valid;
+    std::tie(number, valid) = scanDecimal(str);
+    if (!valid) {
+        return std::make_tuple((Type)0, false);
+    }
+
+    uint64_t bits;
+    if (number.nan) {
+        bits = ((uint64_t)Format::infinitePower << Format::mantissaBits) | (1ULL << (Format::mantissaBits - 1));
+    } else if (number.infinite) {
+        bits = (uint64_t)Format::infinitePower << Format::mantissaBits;
+    } else if (!number.truncated && number.mantissa <= Format::maxExactMantissa &&
+               number.exponent >= -Format::maxExactPowerOfTen && number.exponent <= Format::maxExactPowerOfTen) {
+        // Both exact, so one correctly rounded operation gives the answer
+        Type value = (Type)number.mantissa;
+        if (number.exponent < 0) {
+            value /= (Type)exactPowersOf10[-number.exponent];
+        } else {
+            value *= (Type)exactPowersOf10[number.exponent];
+        }
+        return std::make_tuple(number.negative ? -value : value, true);
+    } else {
+        bits = eiselLemire<Format>(number.exponent, number.mantissa);
+        // With digits cut off the answer is somewhere from here to what
+        // one more in the last kept digit gives
+        if (number.truncated && bits != eiselLemire<Format>(number.exponent, number.mantissa + 1)) {
+            bits = roundByDigits<Format>(number, bits);
+        }
+    }
+
+    if (number.negative) {
+        bits |= 1ULL << (sizeof(Bits) * 8 - 1);
+    }
+    Bits valueBits = (Bits)bits;
+    Type value;
+    std::memcpy(&value, &valueBits, sizeof(value));
+    return std::make_tuple(value, true);
+}
+
+namespace Cupcake {
+
+namespace Strconv {
+
+size_t doubleToStr(double value, char* buffer, size_t bufferLen) {
+    char tempBuf[DOUBLE_MAX_LEN];
+
+    if (bufferLen >= sizeof(tempBuf)) {
+        return ::doubleToStr(value, buffer);
+    } else {
+        size_t size = ::doubleToStr(value, tempBuf);
+        std::memcpy(buffer, tempBuf, std::min(size, bufferLen));
+        return size;
+    }
+}
+
+size_t floatToStr(float value, char* buffer, size_t bufferLen) {
+    char tempBuf[FLOAT_MAX_LEN];
+
+    if (bufferLen >= sizeof(tempBuf)) {
+        return ::floatToStr(value, buffer);
+    } else {
+        size_t size = ::floatToStr(value, tempBuf);
+        std::memcpy(buffer, tempBuf, std::min(size, bufferLen));
+        return size;
+    }
+}
+
+std::tuple<double, bool> parseDouble(const StringRef str) {
+    return parseFloatingPoint<DoubleFormat>(str);
+}
+
+std::tuple<float, bool> parseFloat(const StringRef str) {
+    return parseFloatingPoint<FloatFormat>(str);
+}
+
+} // End namespace Strconv
+
+} // End namespace Cupcake
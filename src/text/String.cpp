@@ -1,6 +1,8 @@
 
 #include "cupcake/internal/text/String.h"
 
+#include "cupcake/internal/util/Arena.h"
+
 #include <algorithm>
 #include <cassert>
 #include <cstdarg>
@@ -8,35 +10,54 @@
 #include <memory>
 
 
-String::String() {
+String::String() :
+    arena(nullptr)
+{
     _short._size = 0;
     _short._data[0] = '\0';
 }
 
-String::String(const String& str) {
+String::String(Cupcake::Arena* arena) :
+    arena(arena)
+{
+    _short._size = 0;
+    _short._data[0] = '\0';
+}
+
+String::String(const String& str) :
+    arena(nullptr)
+{
     size_t len = str.length();
 
     if (len < minCapacity) {
         _short = str._short;
     } else {
         size_t newCap = getValidCapacity(len+1);
-        char* data = new char[newCap];
+        char* data = allocateData(newCap);
         const char* otherData = str._long._data;
         setLongCapacity(newCap);
         _long._size = len;
         _long._data = data;
-        std::memcpy(data, otherData, newCap);
+        std::memcpy(data, otherData, len+1);
     }
 }
 
-String::String(String&& str) noexcept {
+String::String(String&& str) noexcept :
+    arena(str.arena)
+{
     _long = str._long; // Default copy
 
     str._short._size = 0;
     str._short._data[0] = '\0';
 }
 
-String::String(const StringRef strRef) {
+String::String(const StringRef strRef) :
+    String(strRef, nullptr)
+{}
+
+String::String(const StringRef strRef, Cupcake::Arena* arena) :
+    arena(arena)
+{
     size_t len = strRef.length();
     char* data;
 
@@ -45,7 +66,7 @@ String::String(const StringRef strRef) {
         data = _short._data;
     } else {
         size_t newCap = getValidCapacity(len+1);
-        data = new char[newCap];
+        data = allocateData(newCap);
         setLongCapacity(newCap);
         _long._size = len;
         _long._data = data;
@@ -55,7 +76,9 @@ String::String(const StringRef strRef) {
     data[len] = '\0';
 }
 
-String::String(const char* cstr) {
+String::String(const char* cstr) :
+    arena(nullptr)
+{
     size_t len = std::strlen(cstr);
     size_t lenWithNull = len+1;
     char* data;
@@ -65,7 +88,7 @@ String::String(const char* cstr) {
         data = _short._data;
     } else {
         size_t newCap = getValidCapacity(lenWithNull);
-        data = new char[newCap];
+        data = allocateData(newCap);
         setLongCapacity(newCap);
         _long._size = len;
         _long._data = data;
@@ -74,22 +97,12 @@ String::String(const char* cstr) {
     std::memcpy(data, cstr, lenWithNull);
 }
 
-String::String(const char* cstr, size_t len) {
-    char* data;
+String::String(const char* cstr, size_t len) :
+    String(StringRef(cstr, len), nullptr)
+{}
 
-    if (len < minCapacity) {
-        setShortSize(len);
-        data = _short._data;
-    } else {
-        size_t newCap = getValidCapacity(len+1);
-        data = new char[newCap];
-        setLongCapacity(newCap);
-        _long._size = len;
-        _long._data = data;
-    }
-
-    std::memcpy(data, cstr, len);
-    data[len] = '\0';
+String::~String() {
+    freeData();
 }
 
 String& String::operator=(const String& str) {
@@ -97,9 +110,7 @@ String& String::operator=(const String& str) {
         return *this;
     }
 
-    if (isLong()) {
-        delete[] _long._data;
-    }
+    freeData();
 
     if (str.isLong()) {
         size_t len = str.length();
@@ -108,7 +119,7 @@ String& String::operator=(const String& str) {
 
         setLongCapacity(newCap);
         _long._size = len;
-        _long._data = new char[newCap];
+        _long._data = allocateData(newCap);
         std::memcpy(_long._data, str._long._data, lenWithNull);
     } else {
         _short = str._short;
@@ -122,6 +133,12 @@ String& String::operator=(String&& str) noexcept {
         return *this;
     }
 
+    // Memory from another arena can't be taken, it might go away first
+    if (arena != str.arena && str.isLong()) {
+        return *this = StringRef(str);
+    }
+
+    freeData();
     _long = str._long; // Default copy
 
     str._short._size = 0;
@@ -136,7 +153,7 @@ String& String::operator=(const StringRef strRef) {
     // deletion of the old data until the end.
     const char* oldData = nullptr;
 
-    if (isLong()) {
+    if (isLong() && arena == nullptr) {
         oldData = _long._data;
     }
 
@@ -149,7 +166,7 @@ String& String::operator=(const StringRef strRef) {
         data = _short._data;
     } else {
         size_t newCap = getValidCapacity(lenWithNull);
-        data = new char[newCap];
+        data = allocateData(newCap);
         setLongCapacity(newCap);
         _long._size = len;
         _long._data = data;
@@ -164,28 +181,7 @@ String& String::operator=(const StringRef strRef) {
 }
 
 String& String::operator=(const char* cstr) {
-    if (isLong()) {
-        delete[] _long._data;
-    }
-
-    size_t len = std::strlen(cstr);
-    size_t lenWithNull = len+1;
-    char* data;
-
-    if (len < minCapacity) {
-        setShortSize(len);
-        data = _short._data;
-    } else {
-        size_t newCap = getValidCapacity(lenWithNull);
-        data = new char[newCap];
-        setLongCapacity(newCap);
-        _long._size = len;
-        _long._data = data;
-    }
-
-    std::memcpy(data, cstr, lenWithNull);
-
-    return *this;
+    return *this = StringRef(cstr, std::strlen(cstr));
 }
 
 void String::append(const StringRef strRef) {
@@ -213,12 +209,10 @@ void String::append_raw(const char* appendData, size_t dataLen)
     } else {
         size_t newLen = len + dataLen;
         size_t newCapacity = getValidCapacity(newLen * 2);
-        char* newData = new char[newCapacity];
+        char* newData = allocateData(newCapacity);
         std::memcpy(newData, data, len);
 
-        if (isLong()) {
-            delete[] _long._data;
-        }
+        freeData();
 
         std::memcpy(newData + len, appendData, dataLen);
         newData[len + dataLen] = '\0';
@@ -241,12 +235,10 @@ void String::append_cstr(const char* cstr, size_t cstrLen)
     } else {
         size_t newLen = len + cstrLen + 1;
         size_t newCapacity = getValidCapacity(newLen * 2);
-        char* newData = new char[newCapacity];
+        char* newData = allocateData(newCapacity);
         std::memcpy(newData, data, len);
 
-        if (isLong()) {
-            delete[] _long._data;
-        }
+        freeData();
 
         std::memcpy(newData + len, cstr, cstrLen+1);
 
@@ -268,6 +260,10 @@ size_t String::hash() const {
     return StringRef(*this).hash();
 }
 
+size_t String::engHashIgnoreCase() const {
+    return StringRef(*this).engHashIgnoreCase();
+}
+
 const char String::charAt(size_t pos) const {
     return data()[pos];
 }
@@ -376,20 +372,35 @@ void String::reserve(size_t size) {
 
     size_t oldLength = length();
     size_t newCapacity = getValidCapacity(size+1);
-    char* newBuffer = new char[newCapacity];
+    char* newBuffer = allocateData(newCapacity);
 
     size_t len = length();
     std::memcpy(newBuffer, data(), len+1); // Always at least a null
 
-    if (isLong()) {
-        delete[] _long._data;
-    }
+    freeData();
 
     setLongCapacity(newCapacity);
     _long._size = oldLength;
     _long._data = newBuffer;
 }
 
+Cupcake::Arena* String::getArena() const {
+    return arena;
+}
+
+char* String::allocateData(size_t capacity) {
+    if (arena) {
+        return arena->allocate(capacity);
+    }
+    return new char[capacity];
+}
+
+void String::freeData() {
+    if (isLong() && arena == nullptr) {
+        delete[] _long._data;
+    }
+}
+
 bool String::isLong() const {
     if (isBigEndian()) {
         return (_short._size & 0x80) != 0;
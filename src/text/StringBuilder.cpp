@@ -0,0 +1,62 @@
+
+#include "cupcake/internal/text/StringBuilder.h"
+
+#include <cstring>
+
+StringBuilder::StringBuilder() :
+    morePieces(),
+    pieceCount(0),
+    totalLength(0)
+{}
+
+StringBuilder& StringBuilder::append(const StringRef strRef) {
+    if (strRef.length() != 0) {
+        addPiece(strRef.data(), strRef.length(), '\0');
+    }
+    return *this;
+}
+
+StringBuilder& StringBuilder::append(char c) {
+    addPiece(nullptr, 1, c);
+    return *this;
+}
+
+size_t StringBuilder::length() const {
+    return totalLength;
+}
+
+String StringBuilder::build() const {
+    return build(nullptr);
+}
+
+String StringBuilder::build(Cupcake::Arena* arena) const {
+    String str(arena);
+    str.reserve(totalLength);
+
+    for (size_t i = 0; i < pieceCount; i++) {
+        const Piece& piece = i < inlinePieceCount ? inlinePieces[i] : morePieces[i - inlinePieceCount];
+        if (piece.data) {
+            str.append(piece.data, piece.dataLen);
+        } else {
+            str.appendChar(piece.c);
+        }
+    }
+
+    return str;
+}
+
+void StringBuilder::clear() {
+    morePieces.clear();
+    pieceCount = 0;
+    totalLength = 0;
+}
+
+void StringBuilder::addPiece(const char* data, size_t dataLen, char c) {
+    if (pieceCount < inlinePieceCount) {
+        inlinePieces[pieceCount] = Piece{data, dataLen, c};
+    } else {
+        morePieces.push_back(Piece{data, dataLen, c});
+    }
+    pieceCount++;
+    totalLength += dataLen;
+}
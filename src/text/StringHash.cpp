@@ -0,0 +1,174 @@
+
+#include "cupcake/internal/text/StringHash.h"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+
+using namespace Cupcake;
+
+// Rounds per word and at the end. 1-3 is plenty for hash tables.
+#define COMPRESSION_ROUNDS 1
+#define FINALIZATION_ROUNDS 3
+
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+
+class HashKey {
+public:
+    uint64_t key0;
+    uint64_t key1;
+};
+
+// Mixes in the time and an address, in case random_device turns out to be
+// deterministic on some platform
+static
+HashKey makeProcessKey() {
+    std::random_device randomDevice;
+    uint64_t time = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    uint64_t address = (uint64_t)(uintptr_t)&randomDevice;
+
+    HashKey key;
+    key.key0 = (((uint64_t)randomDevice() << 32) | randomDevice()) ^ time;
+    key.key1 = (((uint64_t)randomDevice() << 32) | randomDevice()) ^ (address * 0x9e3779b97f4a7c15ULL);
+    return key;
+}
+
+static
+const HashKey& getProcessKey() {
+    static const HashKey processKey = makeProcessKey();
+    return processKey;
+}
+
+static inline
+uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline
+void sipRound(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+    v0 += v1;
+    v1 = rotateLeft(v1, 13);
+    v1 ^= v0;
+    v0 = rotateLeft(v0, 32);
+    v2 += v3;
+    v3 = rotateLeft(v3, 16);
+    v3 ^= v2;
+    v0 += v3;
+    v3 = rotateLeft(v3, 21);
+    v3 ^= v0;
+    v2 += v1;
+    v1 = rotateLeft(v1, 17);
+    v1 ^= v2;
+    v2 = rotateLeft(v2, 32);
+}
+
+// Little endian, so the hash doesn't depend on where the word boundaries fall
+// relative to the data on either kind of machine
+static inline
+uint64_t loadWord(const char* data) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t word;
+    std::memcpy(&word, bytes, 8);
+
+    const uint16_t endianTest = 1;
+    if (*(const unsigned char*)&endianTest == 1) {
+        return word;
+    }
+
+    word = 0;
+    for (int i = 7; i >= 0; i--) {
+        word = (word << 8) | bytes[i];
+    }
+    return word;
+}
+
+// The last 0-7 bytes as the low bytes of a word, little endian like
+// loadWord(). Short keys are mostly this, and a variable length memcpy into a
+// zeroed word would cost more than the rounds.
+static inline
+uint64_t loadTail(const char* data, size_t tailLen) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    if (tailLen >= 4) {
+        // Two 4 byte reads, overlapping when there are fewer than 8
+        uint64_t low = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint64_t)bytes[3] << 24);
+        const unsigned char* end = bytes + tailLen - 4;
+        uint64_t high = end[0] | (end[1] << 8) | (end[2] << 16) | ((uint64_t)end[3] << 24);
+        return low | (high << ((tailLen - 4) * 8));
+    }
+    if (tailLen > 0) {
+        // The first, middle and last bytes, which are all of them
+        return bytes[0] | ((uint64_t)bytes[tailLen / 2] << (tailLen / 2 * 8)) |
+               ((uint64_t)bytes[tailLen - 1] << ((tailLen - 1) * 8));
+    }
+    return 0;
+}
+
+static inline
+uint64_t identityWord(uint64_t word) {
+    return word;
+}
+
+// 'A'-'Z' in each byte get 0x20 added. Bytes with the high bit set are left
+// alone, so no carries cross between bytes.
+static inline
+uint64_t lowercaseWord(uint64_t word) {
+    uint64_t low7 = word & ~SWAR_HIGHS;
+    uint64_t atLeastA = low7 + SWAR_ONES * (0x80 - 'A');
+    uint64_t aboveZ = low7 + SWAR_ONES * (0x80 - 'Z' - 1);
+    uint64_t upper = atLeastA & ~aboveZ & ~word & SWAR_HIGHS;
+    return word | (upper >> 2);
+}
+
+template <uint64_t (*transform)(uint64_t)>
+static
+uint64_t sipHash(const char* data, size_t dataLen, uint64_t key0, uint64_t key1) {
+    uint64_t v0 = key0 ^ 0x736f6d6570736575ULL;
+    uint64_t v1 = key1 ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = key0 ^ 0x6c7967656e657261ULL;
+    uint64_t v3 = key1 ^ 0x7465646279746573ULL;
+
+    const char* end = data + (dataLen & ~(size_t)7);
+    for (; data != end; data += 8) {
+        uint64_t word = transform(loadWord(data));
+        v3 ^= word;
+        for (int i = 0; i < COMPRESSION_ROUNDS; i++) {
+            sipRound(v0, v1, v2, v3);
+        }
+        v0 ^= word;
+    }
+
+    // The last 0-7 bytes, with the length in the top byte
+    uint64_t last = transform(loadTail(data, dataLen & 7));
+    last = (last & 0x00ffffffffffffffULL) | ((uint64_t)dataLen << 56);
+
+    v3 ^= last;
+    for (int i = 0; i < COMPRESSION_ROUNDS; i++) {
+        sipRound(v0, v1, v2, v3);
+    }
+    v0 ^= last;
+
+    v2 ^= 0xff;
+    for (int i = 0; i < FINALIZATION_ROUNDS; i++) {
+        sipRound(v0, v1, v2, v3);
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+uint64_t StringHash::hash(const char* data, size_t dataLen) {
+    const HashKey& key = getProcessKey();
+    return sipHash<identityWord>(data, dataLen, key.key0, key.key1);
+}
+
+uint64_t StringHash::hashIgnoreCase(const char* data, size_t dataLen) {
+    const HashKey& key = getProcessKey();
+    return sipHash<lowercaseWord>(data, dataLen, key.key0, key.key1);
+}
+
+uint64_t StringHash::hash(const char* data, size_t dataLen, uint64_t key0, uint64_t key1) {
+    return sipHash<identityWord>(data, dataLen, key0, key1);
+}
+
+uint64_t StringHash::hashIgnoreCase(const char* data, size_t dataLen, uint64_t key0, uint64_t key1) {
+    return sipHash<lowercaseWord>(data, dataLen, key0, key1);
+}
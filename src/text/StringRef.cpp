@@ -1,34 +1,12 @@
 
 #include "cupcake/text/StringRef.h"
 
+#include "cupcake/internal/text/StringHash.h"
+#include "cupcake/internal/text/StringSearch.h"
+
 #include <cassert>
 #include <cstring>
 
-// Define missing std functions from cstring if visual studio
-#ifdef _MSC_VER
-#include <memory.h>
-#endif
-
-#if defined(_MSC_VER) || defined(__APPLE__)
-namespace std {
-void* memrchr(void* ptr, int ch, std::size_t count) {
-    unsigned char val = (unsigned char)ch;
-    const unsigned char* start = (const unsigned char*)ptr;
-    const unsigned char* search = start + count - 1;
-    while (search >= start && (*search) != val) {
-        search--;
-    }
-    if (search < start) {
-        return nullptr;
-    }
-    return (void*)search;
-}
-const void* memrchr(const void* ptr, int ch, std::size_t count) {
-    return (const void*)memrchr((void*)ptr, ch, count);
-}
-}
-#endif
-
 // Declare some String members for the incomplete type
 class String {
 public:
@@ -96,14 +74,11 @@ const char* StringRef::data() const {
 }
 
 size_t StringRef::hash() const {
-    size_t hash = 0;
-
-    for (size_t i = 0; i < len; i++) {
-        size_t c = strData[i];
-        hash = c + (hash << 6) + (hash << 16) - hash;
-    }
+    return (size_t)Cupcake::StringHash::hash(strData, len);
+}
 
-    return hash;
+size_t StringRef::engHashIgnoreCase() const {
+    return (size_t)Cupcake::StringHash::hashIgnoreCase(strData, len);
 }
 
 bool StringRef::equals(const StringRef strRef) const {
@@ -114,24 +89,10 @@ bool StringRef::equals(const StringRef strRef) const {
 }
 
 int32_t StringRef::engCompareIgnoreCase(const StringRef strRef) const {
-    for (size_t i = 0;
-         i < len && i < strRef.len;
-         i++)
-    {
-        char a = strData[i];
-
-        if (a >= 'a' || a <= 'z') {
-            a -= 'a' - 'A';
-        }
-
-        char b = strRef.strData[i];
-
-        if (b >= 'a' || b <= 'z') {
-            b -= 'a' - 'A';
-        }
-
-        if (a != b)
-            return a - b;
+    size_t commonLen = len < strRef.len ? len : strRef.len;
+    int32_t partial = Cupcake::StringSearch::compareIgnoreCase(strData, strRef.strData, commonLen);
+    if (partial != 0) {
+        return partial;
     }
 
     if (len < strRef.len) {
@@ -147,25 +108,7 @@ bool StringRef::engEqualsIgnoreCase(const StringRef strRef) const {
     if (len != strRef.len)
         return false;
 
-    for (size_t i = 0; i < len; i++) {
-        char a = strData[i];
-
-        if (a >= 'a' && a <= 'z') {
-            a -= ('a' - 'A');
-        }
-
-        char b = strRef.strData[i];
-
-        if (b >= 'a' && b <= 'z') {
-            b -= ('a' - 'A');
-        }
-
-        if (a != b) {
-            return false;
-        }
-    }
-
-    return true;
+    return Cupcake::StringSearch::equalsIgnoreCase(strData, strRef.strData, len);
 }
 
 ptrdiff_t StringRef::indexOf(char c) const {
@@ -197,77 +140,37 @@ ptrdiff_t StringRef::indexOf(const StringRef strRef, size_t startIndex) const {
         return 0;
     }
 
-    size_t searchLen = len - startIndex;
-
-    // Return -1 for overlong strings as there can be no match.
-    if (strRefLen > searchLen) {
+    const char* match = Cupcake::StringSearch::find(strData + startIndex, len - startIndex,
+                                                    strRef.strData, strRefLen);
+    if (match == nullptr) {
         return -1;
     }
+    return match - strData;
+}
 
-    // For short search areas, brute force. It's not worth building a table
-    // to speed things up.
-    if (searchLen < 256) {
-        for (size_t i = startIndex; i < len - strRefLen + 1; i++) {
-            bool match = true;
-
-            for (size_t j = 0; match && j < strRefLen; j++) {
-                if (strData[i+j] != strRef.strData[j])
-                    match = false;
-            }
+ptrdiff_t StringRef::indexOfAny(const StringRef chars) const {
+    return indexOfAny(chars, 0);
+}
 
-            if (match)
-                return i;
-        }
+ptrdiff_t StringRef::indexOfAny(const StringRef chars, size_t startIndex) const {
+    assert(startIndex <= len);
 
+    const char* match = Cupcake::StringSearch::findAny(strData + startIndex, len - startIndex,
+                                                       chars.strData, chars.len);
+    if (match == nullptr) {
         return -1;
     }
-
-    // In the general case, use the Boyer-Moore-Horspool algorithm. This has
-    // average case of O(n) and worst case O(n*m), which is worse than the
-    // Boyer-Moore algorithm, but has the advantage of not requiring memory
-    // allocation.
-
-    const char* strRefData = strRef.strData;
-    size_t endIndex = strRefLen - 1;
-
-    // Create an array of "skip" offsets when searching the string
-    size_t badCharSkip[256];
-
-    for (uint32_t i = 0; i < 256; i++) {
-        badCharSkip[i] = strRefLen;
-    }
-
-    for (uint32_t i = 0; i < endIndex; i++) {
-        badCharSkip[(unsigned)strRefData[i]] = endIndex - i;
-    }
-
-    const char* searchEnd = strData + len - strRefLen;
-    const char* searchPtr = strData + startIndex;
-
-    while (searchPtr <= searchEnd) {
-        for (size_t scan = endIndex;
-             searchPtr[scan] == strRef.strData[scan];
-             scan--)
-        {
-            if (scan == 0) // If complete match
-                return searchPtr - strData;
-        }
-
-        searchPtr += badCharSkip[(uint8_t)searchPtr[endIndex]];
-    }
-
-    // No match found
-    return -1;
+    return match - strData;
 }
 
 ptrdiff_t StringRef::lastIndexOf(char c) const {
-    return lastIndexOf(c, 0);
+    return lastIndexOf(c, len);
 }
 
 ptrdiff_t StringRef::lastIndexOf(char c, size_t endIndex) const {
     const char* start = data();
 
-    const char* match = (const char*)std::memrchr(start, (int)c, endIndex);
+    const char* match = Cupcake::StringSearch::findLast(start, endIndex, &c, 1);
     if (match == nullptr) {
         return -1;
     }
@@ -289,62 +192,11 @@ ptrdiff_t StringRef::lastIndexOf(const StringRef strRef, size_t endIndex) const
         return 0;
     }
 
-    ptrdiff_t searchLen = (ptrdiff_t)endIndex - (ptrdiff_t)strRefLen;
-
-    // Return -1 for overlong strings as there can be no match.
-    if (searchLen < 0) {
-        return -1;
-    }
-
-    // For short search areas, brute force. It's not worth building a table
-    // to speed things up.
-    if (searchLen < 256) {
-        for (ptrdiff_t i = searchLen; i >= 0; i--) {
-            bool match = true;
-
-            for (size_t j = 0; match && j < strRefLen; j++) {
-                if (strData[i+j] != strRef.strData[j])
-                    match = false;
-            }
-
-            if (match)
-                return i;
-        }
-
+    const char* match = Cupcake::StringSearch::findLast(strData, endIndex, strRef.strData, strRefLen);
+    if (match == nullptr) {
         return -1;
     }
-
-    // Like indexOf, using the Boyer-Moore-Horspool algorithm, but reversed.
-    // This also changes how the 'skip' indexes are generated.
-
-    const char* strRefData = strRef.strData;
-    size_t strRefLast = strRefLen - 1;
-
-    // Create an array of "skip" offsets when searching the string
-    size_t skip[255];
-
-    for (uint32_t i = 0; i < 255; i++) {
-        skip[i] = strRefLen;
-    }
-
-    for (uint32_t i = 0; i < strRefLen; i++) {
-        skip[(unsigned)strRefData[i]] = strRefLast - (strRefLast - i);
-    }
-
-    // Do the reverse search
-    const char* searchStart = strData;
-    const char* searchPtr = searchStart + endIndex - strRefLen;
-
-    while (searchPtr >= searchStart) {
-        if (std::memcmp(searchPtr, strRefData, strRefLen) == 0) {
-            return searchPtr - searchStart;
-        }
-
-        searchPtr -= skip[(uint8_t)searchPtr[0]];
-    }
-
-    // No match found
-    return -1;
+    return match - strData;
 }
 
 size_t StringRef::length() const {
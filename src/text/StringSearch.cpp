@@ -0,0 +1,638 @@
+
+#include "cupcake/internal/text/StringSearch.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CUPCAKE_SEARCH_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only allow the intrinsics in functions built for the
+// instruction set, while the rest of the file stays portable
+#if defined(CUPCAKE_SEARCH_X86) && !defined(_MSC_VER)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+// Past this many chars findAny uses a lookup table rather than comparing
+// each block against every char
+#define MAX_VECTOR_SET_CHARS 8
+
+// How many times memchr can stop on the first char of a needle without the
+// rest matching before find switches over to the vector filter
+#define MAX_MEMCHR_FALSE_MATCHES 8
+
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+
+using namespace Cupcake;
+
+class SearchFunctions {
+public:
+    // Needles are 1 to dataLen long, data for findAny and mismatchIgnoreCase
+    // at least 1 byte
+    const char* (*find)(const char* data, size_t dataLen, const char* needle, size_t needleLen);
+    const char* (*findLast)(const char* data, size_t dataLen, const char* needle, size_t needleLen);
+    const char* (*findAny)(const char* data, size_t dataLen, const char* chars, size_t charsLen);
+    // Index of the first byte that differs ignoring case, or len
+    size_t (*mismatchIgnoreCase)(const char* a, const char* b, size_t len);
+};
+
+static inline
+unsigned char lowercaseChar(char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : (unsigned char)c;
+}
+
+// 'A'-'Z' in each byte get 0x20 added, as in StringHash
+static inline
+uint64_t lowercaseWord(uint64_t word) {
+    uint64_t low7 = word & ~SWAR_HIGHS;
+    uint64_t atLeastA = low7 + SWAR_ONES * (0x80 - 'A');
+    uint64_t aboveZ = low7 + SWAR_ONES * (0x80 - 'Z' - 1);
+    uint64_t upper = atLeastA & ~aboveZ & ~word & SWAR_HIGHS;
+    return word | (upper >> 2);
+}
+
+static
+const char* findScalar(const char* data, size_t dataLen, const char* needle, size_t needleLen) {
+    const char* lastStart = data + dataLen - needleLen;
+    const char* search = data;
+    while (search <= lastStart) {
+        search = (const char*)std::memchr(search, needle[0], lastStart - search + 1);
+        if (search == nullptr) {
+            return nullptr;
+        }
+        if (std::memcmp(search + 1, needle + 1, needleLen - 1) == 0) {
+            return search;
+        }
+        search++;
+    }
+    return nullptr;
+}
+
+static
+const char* findLastScalar(const char* data, size_t dataLen, const char* needle, size_t needleLen) {
+    for (const char* search = data + dataLen - needleLen; ; search--) {
+        if (*search == needle[0] && std::memcmp(search + 1, needle + 1, needleLen - 1) == 0) {
+            return search;
+        }
+        if (search == data) {
+            return nullptr;
+        }
+    }
+}
+
+static
+const char* findAnyScalar(const char* data, size_t dataLen, const char* chars, size_t charsLen) {
+    if (charsLen == 1) {
+        return (const char*)std::memchr(data, chars[0], dataLen);
+    }
+
+    bool inSet[256] = {};
+    for (size_t i = 0; i < charsLen; i++) {
+        inSet[(unsigned char)chars[i]] = true;
+    }
+    for (size_t i = 0; i < dataLen; i++) {
+        if (inSet[(unsigned char)data[i]]) {
+            return data + i;
+        }
+    }
+    return nullptr;
+}
+
+static
+size_t mismatchIgnoreCaseScalar(const char* a, const char* b, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t wordA;
+        uint64_t wordB;
+        std::memcpy(&wordA, a + i, 8);
+        std::memcpy(&wordB, b + i, 8);
+        if (lowercaseWord(wordA) != lowercaseWord(wordB)) {
+            break;
+        }
+    }
+    for (; i < len; i++) {
+        if (lowercaseChar(a[i]) != lowercaseChar(b[i])) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static const SearchFunctions scalarFunctions = {
+    findScalar,
+    findLastScalar,
+    findAnyScalar,
+    mismatchIgnoreCaseScalar
+};
+
+#ifdef CUPCAKE_SEARCH_X86
+
+static inline
+uint32_t lowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(mask);
+#endif
+}
+
+static inline
+uint32_t highestBit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return (uint32_t)index;
+#else
+    return 31 - (uint32_t)__builtin_clz(mask);
+#endif
+}
+
+// memchr is already vectorized and much quicker than the filter below while
+// the first char of the needle is rare, so it goes first. Returns true if the
+// search is over, with the result in match, or false with start moved up to
+// where the filter should carry on.
+static inline
+bool findWithMemchr(const char* data, size_t dataLen, const char* needle, size_t needleLen,
+                    size_t& start, const char*& match) {
+    const char* lastStart = data + dataLen - needleLen;
+    const char* search = data + start;
+    for (uint32_t falseMatches = 0; falseMatches < MAX_MEMCHR_FALSE_MATCHES; falseMatches++) {
+        search = (const char*)std::memchr(search, needle[0], lastStart - search + 1);
+        if (search == nullptr || std::memcmp(search + 1, needle + 1, needleLen - 1) == 0) {
+            match = search;
+            return true;
+        }
+        search++;
+        if (search > lastStart) {
+            match = nullptr;
+            return true;
+        }
+    }
+    start = search - data;
+    return false;
+}
+
+// Moves 'A'-'Z' to the bottom of the signed range, so one signed compare
+// picks them out
+TARGET_SSE2 static inline
+__m128i lowercaseSse2(__m128i block) {
+    __m128i shifted = _mm_add_epi8(block, _mm_set1_epi8((char)(0x80 - 'A')));
+    __m128i isUpper = _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(-128 + 26)));
+    return _mm_or_si128(block, _mm_and_si128(isUpper, _mm_set1_epi8(0x20)));
+}
+
+// Bit i is set when a start at i matches the first and last char of the needle
+TARGET_SSE2 static inline
+uint32_t candidatesSse2(const char* start, size_t needleLen, __m128i first, __m128i last) {
+    __m128i blockFirst = _mm_loadu_si128((const __m128i*)start);
+    __m128i blockLast = _mm_loadu_si128((const __m128i*)(start + needleLen - 1));
+    __m128i matches = _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last));
+    return (uint32_t)_mm_movemask_epi8(matches);
+}
+
+TARGET_SSE2 static
+const char* findSse2(const char* data, size_t dataLen, const char* needle, size_t needleLen) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needleLen - 1]);
+
+    size_t i = 0;
+    const char* match;
+    if (findWithMemchr(data, dataLen, needle, needleLen, i, match)) {
+        return match;
+    }
+
+    size_t startCount = dataLen - needleLen + 1;
+    for (; i + 16 <= startCount; i += 16) {
+        uint32_t mask = candidatesSse2(data + i, needleLen, first, last);
+        while (mask != 0) {
+            const char* candidate = data + i + lowestBit(mask);
+            if (needleLen <= 2 || std::memcmp(candidate + 1, needle + 1, needleLen - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    if (i < startCount) {
+        return findScalar(data + i, dataLen - i, needle, needleLen);
+    }
+    return nullptr;
+}
+
+TARGET_SSE2 static
+const char* findLastSse2(const char* data, size_t dataLen, const char* needle, size_t needleLen) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needleLen - 1]);
+
+    // Starts before this are still to be checked
+    size_t startEnd = dataLen - needleLen + 1;
+    while (startEnd >= 16) {
+        size_t i = startEnd - 16;
+        uint32_t mask = candidatesSse2(data + i, needleLen, first, last);
+        while (mask != 0) {
+            uint32_t bit = highestBit(mask);
+            const char* candidate = data + i + bit;
+            if (needleLen <= 2 || std::memcmp(candidate + 1, needle + 1, needleLen - 2) == 0) {
+                return candidate;
+            }
+            mask &= ~((uint32_t)1 << bit);
+        }
+        startEnd = i;
+    }
+
+    if (startEnd > 0) {
+        return findLastScalar(data, startEnd + needleLen - 1, needle, needleLen);
+    }
+    return nullptr;
+}
+
+TARGET_SSE2 static
+const char* findAnySse2(const char* data, size_t dataLen, const char* chars, size_t charsLen) {
+    if (charsLen > MAX_VECTOR_SET_CHARS || dataLen < 16) {
+        return findAnyScalar(data, dataLen, chars, charsLen);
+    }
+
+    __m128i set[MAX_VECTOR_SET_CHARS];
+    for (size_t i = 0; i < charsLen; i++) {
+        set[i] = _mm_set1_epi8(chars[i]);
+    }
+
+    // The last block is moved back to end with the data. Anything it
+    // overlaps has already been ruled out.
+    size_t i = 0;
+    while (true) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i matches = _mm_cmpeq_epi8(block, set[0]);
+        for (size_t j = 1; j < charsLen; j++) {
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, set[j]));
+        }
+
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(matches);
+        if (mask != 0) {
+            return data + i + lowestBit(mask);
+        }
+        if (i + 16 == dataLen) {
+            return nullptr;
+        }
+        i = (i + 32 <= dataLen) ? i + 16 : dataLen - 16;
+    }
+}
+
+TARGET_SSE2 static
+size_t mismatchIgnoreCaseSse2(const char* a, const char* b, size_t len) {
+    if (len < 16) {
+        return mismatchIgnoreCaseScalar(a, b, len);
+    }
+
+    size_t i = 0;
+    while (true) {
+        __m128i blockA = lowercaseSse2(_mm_loadu_si128((const __m128i*)(a + i)));
+        __m128i blockB = lowercaseSse2(_mm_loadu_si128((const __m128i*)(b + i)));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(blockA, blockB)) ^ 0xffff;
+        if (mask != 0) {
+            return i + lowestBit(mask);
+        }
+        if (i + 16 == len) {
+            return len;
+        }
+        i = (i + 32 <= len) ? i + 16 : len - 16;
+    }
+}
+
+static const SearchFunctions sse2Functions = {
+    findSse2,
+    findLastSse2,
+    findAnySse2,
+    mismatchIgnoreCaseSse2
+};
+
+// The AVX2 versions are the SSE2 ones over twice the width, handing anything
+// shorter than a block down to them
+
+TARGET_AVX2 static inline
+__m256i lowercaseAvx2(__m256i block) {
+    __m256i shifted = _mm256_add_epi8(block, _mm256_set1_epi8((char)(0x80 - 'A')));
+    __m256i isUpper = _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128 + 26)), shifted);
+    return _mm256_or_si256(block, _mm256_and_si256(isUpper, _mm256_set1_epi8(0x20)));
+}
+
+// Whether the chars between the first and last match. A loop rather than
+// memcmp, as any call in a search loop has the compiler spill the 256 bit
+// first and last chars and reload them for every block.
+static inline
+bool matchesMiddle(const char* candidate, const char* needle, size_t needleLen) {
+    for (size_t i = 1; i + 1 < needleLen; i++) {
+        if (candidate[i] != needle[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TARGET_AVX2 static inline
+uint32_t candidatesAvx2(const char* start, size_t needleLen, __m256i first, __m256i last) {
+    __m256i blockFirst = _mm256_loadu_si256((const __m256i*)start);
+    __m256i blockLast = _mm256_loadu_si256((const __m256i*)(start + needleLen - 1));
+    __m256i matches = _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last));
+    return (uint32_t)_mm256_movemask_epi8(matches);
+}
+
+TARGET_AVX2 static
+const char* findAvx2(const char* data, size_t dataLen, const char* needle, size_t needleLen) {
+    // Checked before anything 256 bit, so short searches don't pay for
+    // switching back to SSE
+    size_t startCount = dataLen - needleLen + 1;
+    if (startCount < 32) {
+        return findSse2(data, dataLen, needle, needleLen);
+    }
+
+    size_t i = 0;
+    const char* match;
+    if (findWithMemchr(data, dataLen, needle, needleLen, i, match)) {
+        return match;
+    }
+
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needleLen - 1]);
+
+    while (true) {
+        uint32_t mask = 0;
+        while (mask == 0 && i + 32 <= startCount) {
+            mask = candidatesAvx2(data + i, needleLen, first, last);
+            i += 32;
+        }
+
+        // The last block is moved back to end with the data, ignoring the
+        // starts it overlaps that were already checked
+        size_t blockStart = i - 32;
+        if (mask == 0) {
+            if (i == startCount) {
+                return nullptr;
+            }
+            blockStart = startCount - 32;
+            mask = candidatesAvx2(data + blockStart, needleLen, first, last) & (~(uint32_t)0 << (i - blockStart));
+            i = startCount;
+        }
+
+        while (mask != 0) {
+            const char* candidate = data + blockStart + lowestBit(mask);
+            if (matchesMiddle(candidate, needle, needleLen)) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+        if (i == startCount) {
+            return nullptr;
+        }
+    }
+}
+
+TARGET_AVX2 static
+const char* findLastAvx2(const char* data, size_t dataLen, const char* needle, size_t needleLen) {
+    size_t startEnd = dataLen - needleLen + 1;
+    if (startEnd < 32) {
+        return findLastSse2(data, dataLen, needle, needleLen);
+    }
+
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needleLen - 1]);
+
+    // Starts from i on have been checked
+    size_t i = startEnd;
+    while (true) {
+        uint32_t mask = 0;
+        while (mask == 0 && i >= 32) {
+            i -= 32;
+            mask = candidatesAvx2(data + i, needleLen, first, last);
+        }
+
+        // The last block is moved forward to start with the data
+        if (mask == 0) {
+            if (i == 0) {
+                return nullptr;
+            }
+            mask = candidatesAvx2(data, needleLen, first, last) & (((uint32_t)1 << i) - 1);
+            i = 0;
+        }
+
+        while (mask != 0) {
+            uint32_t bit = highestBit(mask);
+            const char* candidate = data + i + bit;
+            if (matchesMiddle(candidate, needle, needleLen)) {
+                return candidate;
+            }
+            mask &= ~((uint32_t)1 << bit);
+        }
+        if (i == 0) {
+            return nullptr;
+        }
+    }
+}
+
+TARGET_AVX2 static
+const char* findAnyAvx2(const char* data, size_t dataLen, const char* chars, size_t charsLen) {
+    if (charsLen > MAX_VECTOR_SET_CHARS || dataLen < 32) {
+        return findAnySse2(data, dataLen, chars, charsLen);
+    }
+
+    __m256i set[MAX_VECTOR_SET_CHARS];
+    for (size_t i = 0; i < charsLen; i++) {
+        set[i] = _mm256_set1_epi8(chars[i]);
+    }
+
+    size_t i = 0;
+    while (true) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i matches = _mm256_cmpeq_epi8(block, set[0]);
+        for (size_t j = 1; j < charsLen; j++) {
+            matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, set[j]));
+        }
+
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(matches);
+        if (mask != 0) {
+            return data + i + lowestBit(mask);
+        }
+        if (i + 32 == dataLen) {
+            return nullptr;
+        }
+        i = (i + 64 <= dataLen) ? i + 32 : dataLen - 32;
+    }
+}
+
+TARGET_AVX2 static
+size_t mismatchIgnoreCaseAvx2(const char* a, const char* b, size_t len) {
+    if (len < 32) {
+        return mismatchIgnoreCaseSse2(a, b, len);
+    }
+
+    size_t i = 0;
+    while (true) {
+        __m256i blockA = lowercaseAvx2(_mm256_loadu_si256((const __m256i*)(a + i)));
+        __m256i blockB = lowercaseAvx2(_mm256_loadu_si256((const __m256i*)(b + i)));
+        uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(blockA, blockB));
+        if (mask != 0) {
+            return i + lowestBit(mask);
+        }
+        if (i + 32 == len) {
+            return len;
+        }
+        i = (i + 64 <= len) ? i + 32 : len - 32;
+    }
+}
+
+static const SearchFunctions avx2Functions = {
+    findAvx2,
+    findLastAvx2,
+    findAnyAvx2,
+    mismatchIgnoreCaseAvx2
+};
+
+#endif // CUPCAKE_SEARCH_X86
+
+static
+StringSearch::Level detectLevel() {
+#if defined(CUPCAKE_SEARCH_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    bool hasSse2 = (info[3] & (1 << 26)) != 0;
+    // AVX2 also needs the OS to save the upper halves of the registers
+    bool hasAvx = (info[2] & (1 << 28)) != 0 &&
+        (info[2] & (1 << 27)) != 0 &&
+        (_xgetbv(0) & 6) == 6;
+
+    bool hasAvx2 = false;
+    if (hasAvx && maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        hasAvx2 = (info[1] & (1 << 5)) != 0;
+    }
+#elif defined(CUPCAKE_SEARCH_X86)
+    // These check for OS support of the registers too
+    __builtin_cpu_init();
+    bool hasSse2 = __builtin_cpu_supports("sse2");
+    bool hasAvx2 = __builtin_cpu_supports("avx2");
+#else
+    bool hasSse2 = false;
+    bool hasAvx2 = false;
+#endif
+
+    if (hasAvx2) {
+        return StringSearch::Level::Avx2;
+    } else if (hasSse2) {
+        return StringSearch::Level::Sse2;
+    } else {
+        return StringSearch::Level::Scalar;
+    }
+}
+
+static
+const SearchFunctions* getLevelFunctions(StringSearch::Level level) {
+    switch (level) {
+#ifdef CUPCAKE_SEARCH_X86
+    case StringSearch::Level::Avx2:
+        return &avx2Functions;
+    case StringSearch::Level::Sse2:
+        return &sse2Functions;
+#endif
+    default:
+        return &scalarFunctions;
+    }
+}
+
+// Picked on first use. Any thread may race to pick, they all pick the same.
+static std::atomic<const SearchFunctions*> activeFunctions(nullptr);
+
+static inline
+const SearchFunctions& getFunctions() {
+    const SearchFunctions* functions = activeFunctions.load(std::memory_order_relaxed);
+    if (functions == nullptr) {
+        functions = getLevelFunctions(StringSearch::getSupportedLevel());
+        activeFunctions.store(functions, std::memory_order_relaxed);
+    }
+    return *functions;
+}
+
+StringSearch::Level StringSearch::getSupportedLevel() {
+    static const Level supportedLevel = detectLevel();
+    return supportedLevel;
+}
+
+StringSearch::Level StringSearch::getLevel() {
+    const SearchFunctions* functions = &getFunctions();
+    if (functions == &scalarFunctions) {
+        return Level::Scalar;
+    }
+#ifdef CUPCAKE_SEARCH_X86
+    if (functions == &sse2Functions) {
+        return Level::Sse2;
+    }
+#endif
+    return Level::Avx2;
+}
+
+void StringSearch::setLevel(Level level) {
+    if ((int)level > (int)getSupportedLevel()) {
+        level = getSupportedLevel();
+    }
+    activeFunctions.store(getLevelFunctions(level), std::memory_order_relaxed);
+}
+
+const char* StringSearch::find(const char* data, size_t dataLen, const char* needle, size_t needleLen) {
+    if (needleLen == 0) {
+        return data;
+    }
+    if (needleLen > dataLen) {
+        return nullptr;
+    }
+    return getFunctions().find(data, dataLen, needle, needleLen);
+}
+
+const char* StringSearch::findLast(const char* data, size_t dataLen, const char* needle, size_t needleLen) {
+    if (needleLen == 0) {
+        return data + dataLen;
+    }
+    if (needleLen > dataLen) {
+        return nullptr;
+    }
+    return getFunctions().findLast(data, dataLen, needle, needleLen);
+}
+
+const char* StringSearch::findAny(const char* data, size_t dataLen, const char* chars, size_t charsLen) {
+    if (dataLen == 0 || charsLen == 0) {
+        return nullptr;
+    }
+    return getFunctions().findAny(data, dataLen, chars, charsLen);
+}
+
+bool StringSearch::equalsIgnoreCase(const char* a, const char* b, size_t len) {
+    if (len == 0) {
+        return true;
+    }
+    return getFunctions().mismatchIgnoreCase(a, b, len) == len;
+}
+
+int32_t StringSearch::compareIgnoreCase(const char* a, const char* b, size_t len) {
+    if (len == 0) {
+        return 0;
+    }
+
+    size_t index = getFunctions().mismatchIgnoreCase(a, b, len);
+    if (index == len) {
+        return 0;
+    }
+    return (int32_t)lowercaseChar(a[index]) - (int32_t)lowercaseChar(b[index]);
+}
@@ -0,0 +1,64 @@
+
+#include "cupcake/internal/util/Arena.h"
+
+using namespace Cupcake;
+
+#define ARENA_BLOCK_SIZE 4096
+// Anything bigger than this gets its own buffer, so a block isn't left mostly empty
+#define MAX_SHARED_ALLOCATION (ARENA_BLOCK_SIZE / 4)
+#define ARENA_ALIGNMENT 8
+
+Arena::Arena() :
+    blocks(),
+    largeBlocks(),
+    next(nullptr),
+    end(nullptr),
+    allocatedSize(0)
+{}
+
+char* Arena::allocate(size_t size) {
+    size_t alignedSize = (size + (ARENA_ALIGNMENT - 1)) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (alignedSize > (size_t)(end - next)) {
+        return allocateSlow(alignedSize);
+    }
+
+    char* allocated = next;
+    next += alignedSize;
+    allocatedSize += alignedSize;
+    return allocated;
+}
+
+char* Arena::allocateSlow(size_t size) {
+    allocatedSize += size;
+
+    if (size > MAX_SHARED_ALLOCATION) {
+        largeBlocks.push_back(BufferPool::allocate((uint32_t)size));
+        return largeBlocks.back().get();
+    }
+
+    blocks.push_back(BufferPool::allocate(ARENA_BLOCK_SIZE));
+    char* allocated = blocks.back().get();
+    next = allocated + size;
+    end = allocated + blocks.back().size();
+    return allocated;
+}
+
+void Arena::reset() {
+    largeBlocks.clear();
+    if (blocks.size() > 1) {
+        blocks.resize(1);
+    }
+    if (!blocks.empty()) {
+        next = blocks[0].get();
+        end = next + blocks[0].size();
+    }
+    allocatedSize = 0;
+}
+
+size_t Arena::getAllocatedSize() const {
+    return allocatedSize;
+}
+
+size_t Arena::getBlockCount() const {
+    return blocks.size() + largeBlocks.size();
+}
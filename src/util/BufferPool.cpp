@@ -0,0 +1,226 @@
+
+#include "cupcake/internal/util/BufferPool.h"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace Cupcake;
+
+#define MIN_CLASS_SHIFT 10
+#define MAX_CLASS_SHIFT 20
+#define CLASS_COUNT (MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1)
+
+// Bytes of free buffers kept per size class, with at least a few of each
+#define THREAD_CACHE_BYTES (256 * 1024)
+#define SHARED_CACHE_BYTES (16 * 1024 * 1024)
+#define MIN_CACHED_BUFFERS 4
+
+static
+uint32_t getClassIndex(uint32_t size) {
+    uint32_t shift = MIN_CLASS_SHIFT;
+    while (((uint32_t)1 << shift) < size) {
+        shift++;
+    }
+    return shift - MIN_CLASS_SHIFT;
+}
+
+static
+size_t getCacheLimit(uint32_t classIndex, size_t cacheBytes) {
+    size_t limit = cacheBytes >> (classIndex + MIN_CLASS_SHIFT);
+    return limit < MIN_CACHED_BUFFERS ? MIN_CACHED_BUFFERS : limit;
+}
+
+static
+void freeAll(std::vector<char*>* buffers) {
+    for (char* buffer : *buffers) {
+        delete[] buffer;
+    }
+    buffers->clear();
+}
+
+namespace {
+
+class SharedPool {
+public:
+    // Takes up to half a thread cache's worth, returning how many were moved
+    size_t take(uint32_t classIndex, std::vector<char*>* out) {
+        std::lock_guard<std::mutex> lock(mutexes[classIndex]);
+        std::vector<char*>& freeList = freeLists[classIndex];
+        size_t count = std::min(freeList.size(), getCacheLimit(classIndex, THREAD_CACHE_BYTES) / 2 + 1);
+        out->insert(out->end(), freeList.end() - count, freeList.end());
+        freeList.resize(freeList.size() - count);
+        return count;
+    }
+
+    // Frees whatever doesn't fit
+    void give(uint32_t classIndex, std::vector<char*>* buffers, size_t count) {
+        std::vector<char*> overflow;
+        {
+            std::lock_guard<std::mutex> lock(mutexes[classIndex]);
+            std::vector<char*>& freeList = freeLists[classIndex];
+            size_t limit = getCacheLimit(classIndex, SHARED_CACHE_BYTES);
+            for (size_t i = 0; i < count; i++) {
+                char* buffer = buffers->back();
+                buffers->pop_back();
+                if (freeList.size() < limit) {
+                    freeList.push_back(buffer);
+                } else {
+                    overflow.push_back(buffer);
+                }
+            }
+        }
+        freeAll(&overflow);
+    }
+
+    void trim() {
+        for (uint32_t i = 0; i < CLASS_COUNT; i++) {
+            std::vector<char*> freed;
+            {
+                std::lock_guard<std::mutex> lock(mutexes[i]);
+                freed.swap(freeLists[i]);
+            }
+            freeAll(&freed);
+        }
+    }
+
+private:
+    std::mutex mutexes[CLASS_COUNT];
+    std::vector<char*> freeLists[CLASS_COUNT];
+};
+
+// Never destroyed, as threads can exit and return buffers after static destruction
+SharedPool* getSharedPool() {
+    static SharedPool* sharedPool = new SharedPool();
+    return sharedPool;
+}
+
+class ThreadCache {
+public:
+    ~ThreadCache() {
+        for (uint32_t i = 0; i < CLASS_COUNT; i++) {
+            getSharedPool()->give(i, &freeLists[i], freeLists[i].size());
+        }
+    }
+
+    char* allocate(uint32_t classIndex) {
+        std::vector<char*>& freeList = freeLists[classIndex];
+        if (freeList.empty() && getSharedPool()->take(classIndex, &freeList) == 0) {
+            return new char[(size_t)1 << (classIndex + MIN_CLASS_SHIFT)];
+        }
+        char* buffer = freeList.back();
+        freeList.pop_back();
+        return buffer;
+    }
+
+    void release(uint32_t classIndex, char* buffer) {
+        std::vector<char*>& freeList = freeLists[classIndex];
+        freeList.push_back(buffer);
+
+        // Hand back half, so a thread that frees what others allocate doesn't hit the lock every time
+        size_t limit = getCacheLimit(classIndex, THREAD_CACHE_BYTES);
+        if (freeList.size() > limit) {
+            getSharedPool()->give(classIndex, &freeList, freeList.size() - limit / 2);
+        }
+    }
+
+    void trim() {
+        for (uint32_t i = 0; i < CLASS_COUNT; i++) {
+            freeAll(&freeLists[i]);
+        }
+    }
+
+private:
+    std::vector<char*> freeLists[CLASS_COUNT];
+};
+
+thread_local ThreadCache threadCache;
+
+}
+
+PooledBuffer::PooledBuffer() :
+    data(nullptr),
+    bufferSize(0)
+{}
+
+PooledBuffer::PooledBuffer(char* data, uint32_t bufferSize) :
+    data(data),
+    bufferSize(bufferSize)
+{}
+
+PooledBuffer::~PooledBuffer() {
+    reset();
+}
+
+PooledBuffer::PooledBuffer(PooledBuffer&& other) :
+    data(other.data),
+    bufferSize(other.bufferSize)
+{
+    other.data = nullptr;
+    other.bufferSize = 0;
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) {
+    if (this != &other) {
+        reset();
+        data = other.data;
+        bufferSize = other.bufferSize;
+        other.data = nullptr;
+        other.bufferSize = 0;
+    }
+    return *this;
+}
+
+char* PooledBuffer::get() const {
+    return data;
+}
+
+uint32_t PooledBuffer::size() const {
+    return bufferSize;
+}
+
+PooledBuffer::operator bool() const {
+    return data != nullptr;
+}
+
+void PooledBuffer::reset() {
+    if (data) {
+        BufferPool::release(data, bufferSize);
+        data = nullptr;
+        bufferSize = 0;
+    }
+}
+
+void PooledBuffer::swap(PooledBuffer& other) {
+    std::swap(data, other.data);
+    std::swap(bufferSize, other.bufferSize);
+}
+
+PooledBuffer BufferPool::allocate(uint32_t minSize) {
+    uint32_t classSize = getClassSize(minSize);
+    if (classSize > ((uint32_t)1 << MAX_CLASS_SHIFT)) {
+        return PooledBuffer(new char[classSize], classSize);
+    }
+    return PooledBuffer(threadCache.allocate(getClassIndex(classSize)), classSize);
+}
+
+uint32_t BufferPool::getClassSize(uint32_t minSize) {
+    if (minSize > ((uint32_t)1 << MAX_CLASS_SHIFT)) {
+        return minSize;
+    }
+    return (uint32_t)1 << (getClassIndex(minSize) + MIN_CLASS_SHIFT);
+}
+
+void BufferPool::trim() {
+    threadCache.trim();
+    getSharedPool()->trim();
+}
+
+void BufferPool::release(char* data, uint32_t bufferSize) {
+    if (bufferSize > ((uint32_t)1 << MAX_CLASS_SHIFT)) {
+        delete[] data;
+        return;
+    }
+    threadCache.release(getClassIndex(bufferSize), data);
+}
@@ -16,7 +16,8 @@ public:
     BuffReaderTestSource(const char* sourceData, size_t dataLen) :
         sourceData(sourceData),
         dataLen(dataLen),
-        readCount(0) {}
+        readCount(0),
+        waitCount(0) {}
 
     std::tuple<StreamSource*, HttpError> accept() override {
         return std::make_tuple(nullptr, HttpError::Ok);
@@ -51,6 +52,10 @@ public:
         }
         return std::make_tuple(bytesCopied, HttpError::Ok);
     }
+    HttpError waitReadable() override {
+        waitCount++;
+        return HttpError::Ok;
+    }
     HttpError write(const char* buffer, uint32_t bufferLen) override {
         return HttpError::Ok;
     }
@@ -62,11 +67,13 @@ public:
     }
 
     uint32_t getReadCount() { return readCount; }
+    uint32_t getWaitCount() { return waitCount; }
 
 private:
     const char* sourceData;
     size_t dataLen;
     uint32_t readCount;
+    uint32_t waitCount;
 };
 
 bool test_bufferedreader_basic() {
@@ -265,3 +272,237 @@ bool test_bufferedreader_peekfixed() {
 
     return true;
 }
+
+// Tests the buffer is only given up when nothing is left in it
+bool test_bufferedreader_release() {
+    StringRef data = "line one\r\nline two\r\n";
+    BuffReaderTestSource testSource(data.data(), data.length());
+    BufferedReader bufReader;
+    bufReader.init(&testSource, 100);
+
+    StringRef line;
+    HttpError err;
+    std::tie(line, err) = bufReader.readLine(100);
+    if (err != HttpError::Ok || line != "line one") {
+        testf("Failed to read first line");
+        return false;
+    }
+
+    // Still holding the second line, so this must keep the buffer
+    bufReader.releaseBuffer();
+    std::tie(line, err) = bufReader.readLine(100);
+    if (err != HttpError::Ok || line != "line two") {
+        testf("Buffered data lost on release");
+        return false;
+    }
+
+    // Empty now, and the next read picks up a new buffer
+    bufReader.releaseBuffer();
+    std::tie(line, err) = bufReader.readLine(100);
+    if (err != HttpError::Eof) {
+        testf("Expected EOF after release, got %d", err);
+        return false;
+    }
+
+    return true;
+}
+
+// Tests waiting for data only involves the stream, and a buffer, when needed
+bool test_bufferedreader_wait() {
+    StringRef data = "line one\r\nline two\r\n";
+    BuffReaderTestSource testSource(data.data(), data.length());
+    BufferedReader bufReader;
+    bufReader.init(&testSource, 100);
+
+    if (bufReader.hasBuffer()) {
+        testf("Buffer taken before anything was read");
+        return false;
+    }
+
+    HttpError err = bufReader.waitForData();
+    if (err != HttpError::Ok || testSource.getWaitCount() != 1 || bufReader.hasBuffer()) {
+        testf("Wait did not go to the stream");
+        return false;
+    }
+
+    StringRef line;
+    std::tie(line, err) = bufReader.readLine(100);
+    if (err != HttpError::Ok || line != "line one" || !bufReader.hasBuffer()) {
+        testf("Failed to read first line");
+        return false;
+    }
+
+    // Second line is already buffered
+    err = bufReader.waitForData();
+    if (err != HttpError::Ok || testSource.getWaitCount() != 1 || !bufReader.hasBuffer()) {
+        testf("Waited with data already buffered");
+        return false;
+    }
+
+    std::tie(line, err) = bufReader.readLine(100);
+    if (err != HttpError::Ok || line != "line two") {
+        testf("Failed to read second line");
+        return false;
+    }
+
+    err = bufReader.waitForData();
+    if (err != HttpError::Ok || testSource.getWaitCount() != 2 || bufReader.hasBuffer()) {
+        testf("Buffer held while waiting");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_bufferedreader_fill() {
+    std::vector<char> data(3000);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (char)('a' + i % 26);
+    }
+    BuffReaderTestSource testSource(data.data(), data.size());
+    BufferedReader bufReader;
+    bufReader.init(&testSource, 4); // Intentionally small
+
+    if (bufReader.getBuffered().length() != 0) {
+        testf("Expected nothing buffered before the first fill");
+        return false;
+    }
+
+    // Grows until the limit is buffered
+    HttpError err;
+    do {
+        err = bufReader.fill(2048);
+    } while (err == HttpError::Ok);
+
+    if (err != HttpError::LineTooLong) {
+        testf("Expected LineTooLong at the fill limit, got %d", err);
+        return false;
+    }
+    StringRef buffered = bufReader.getBuffered();
+    if (buffered.length() != 2048 || std::memcmp(buffered.data(), data.data(), 2048) != 0) {
+        testf("Buffered data did not match source");
+        return false;
+    }
+
+    // Consuming makes room again, keeping the unread data in order
+    bufReader.consume(1000);
+    err = bufReader.fill(2048);
+    if (err != HttpError::Ok) {
+        testf("Failed to fill after consume with %d", err);
+        return false;
+    }
+    buffered = bufReader.getBuffered();
+    if (buffered.length() != 2000 || std::memcmp(buffered.data(), data.data() + 1000, 2000) != 0) {
+        testf("Buffered data did not match source after consume");
+        return false;
+    }
+
+    bufReader.consume(2000);
+    err = bufReader.fill(2048);
+    if (err != HttpError::Eof) {
+        testf("Expected EOF after consuming everything, got %d", err);
+        return false;
+    }
+
+    return true;
+}
+
+bool test_bufferedreader_read_view() {
+    std::vector<char> data(3000);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (char)('a' + i % 26);
+    }
+    BuffReaderTestSource testSource(data.data(), data.size());
+    BufferedReader bufReader;
+    bufReader.init(&testSource, 100);
+
+    // Limited to maxLen, and nothing is taken until it's consumed
+    StringRef view;
+    HttpError err;
+    std::tie(view, err) = bufReader.readView(50, 0);
+    if (err != HttpError::Ok || view.length() != 50 || std::memcmp(view.data(), data.data(), 50) != 0) {
+        testf("First view did not match source");
+        return false;
+    }
+    bufReader.consume(20);
+    std::tie(view, err) = bufReader.readView(1000, 0);
+    if (err != HttpError::Ok || view.length() != 80 || std::memcmp(view.data(), data.data() + 20, 80) != 0) {
+        testf("View after partial consume did not match source");
+        return false;
+    }
+    bufReader.consume(80);
+
+    // Swaps to the preferred size once nothing is buffered
+    std::tie(view, err) = bufReader.readView(UINT32_MAX, 2048);
+    if (err != HttpError::Ok || view.length() != 2048 || std::memcmp(view.data(), data.data() + 100, 2048) != 0) {
+        testf("Expected a view of the larger buffer, got %d bytes", (int)view.length());
+        return false;
+    }
+    bufReader.consume(2048);
+
+    // The rest fits in the buffer already taken
+    std::tie(view, err) = bufReader.readView(UINT32_MAX, 2048);
+    if (err != HttpError::Ok || view.length() != 852 || std::memcmp(view.data(), data.data() + 2148, 852) != 0) {
+        testf("Last view did not match source");
+        return false;
+    }
+    bufReader.consume(852);
+
+    std::tie(view, err) = bufReader.readView(UINT32_MAX, 2048);
+    if (err != HttpError::Eof || view.length() != 0) {
+        testf("Expected EOF after the last view, got %d", err);
+        return false;
+    }
+
+    return true;
+}
+
+bool test_bufferedreader_readfixed_large() {
+    std::vector<char> data(160000);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (char)('a' + i % 26);
+    }
+    BuffReaderTestSource testSource(data.data(), data.size());
+    BufferedReader bufReader;
+    bufReader.init(&testSource, 100);
+
+    // Leaves the rest of the buffer full
+    std::vector<char> dest(data.size());
+    HttpError err = bufReader.readFixedLength(dest.data(), 50);
+    if (err != HttpError::Ok) {
+        testf("Failed to read start with %d", err);
+        return false;
+    }
+
+    // The buffered part is copied out, everything after in one read straight from the source
+    uint32_t readCount = testSource.getReadCount();
+    err = bufReader.readFixedLength(dest.data() + 50, 150000);
+    if (err != HttpError::Ok) {
+        testf("Failed large read with %d", err);
+        return false;
+    }
+    if (testSource.getReadCount() != readCount + 1) {
+        testf("Expected one read from the source, saw %d", (int)(testSource.getReadCount() - readCount));
+        return false;
+    }
+
+    // Too small to skip the buffer
+    err = bufReader.readFixedLength(dest.data() + 150050, 9950);
+    if (err != HttpError::Ok) {
+        testf("Failed to read tail with %d", err);
+        return false;
+    }
+    if (dest != data) {
+        testf("Read data did not match source");
+        return false;
+    }
+
+    char fixedBuf[5];
+    err = bufReader.readFixedLength(fixedBuf, 5);
+    if (err != HttpError::Eof) {
+        testf("Did not hit expected end of file");
+        return false;
+    }
+
+    return true;
+}
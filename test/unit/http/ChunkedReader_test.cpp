@@ -277,3 +277,184 @@ bool test_chunkedreader_trailing_headers() {
 
     return true;
 }
+
+// Tests mixing views with reads, and that views stop at the end of each chunk
+bool test_chunkedreader_read_view() {
+    const StringRef inputData(
+        "5\r\n"
+        "abcde\r\n"
+        "3\r\n"
+        "fgh\r\n"
+        "1\r\n"
+        "i\r\n"
+        "0\r\n"
+        "\r\n");
+
+    ChunkedReaderTestSource testSource(inputData.data(), inputData.length());
+    BufferedReader bufferedReader;
+    bufferedReader.init(&testSource, 1024);
+    ChunkedReader reader(bufferedReader);
+
+    StringRef view;
+    HttpError err;
+    std::tie(view, err) = reader.readView(1024);
+    if (err != HttpError::Ok || view != "abcde") {
+        testf("First view was not the first chunk");
+        return false;
+    }
+
+    // Only consuming part leaves the rest for the next call
+    reader.consume(2);
+    char readBuffer[1024];
+    uint32_t bytesRead;
+    std::tie(bytesRead, err) = reader.read(readBuffer, 4);
+    if (err != HttpError::Ok || StringRef(readBuffer, bytesRead) != "cdef") {
+        testf("Read after partial consume did not match");
+        return false;
+    }
+
+    std::tie(view, err) = reader.readView(1024);
+    if (err != HttpError::Ok || view != "gh") {
+        testf("View did not stop at the end of the chunk");
+        return false;
+    }
+    reader.consume(2);
+    std::tie(view, err) = reader.readView(1024);
+    if (err != HttpError::Ok || view != "i") {
+        testf("View of last chunk did not match");
+        return false;
+    }
+    reader.consume(1);
+
+    std::tie(view, err) = reader.readView(1024);
+    if (err != HttpError::Eof || view.length() != 0) {
+        testf("Did not see expected EOF at end of stream");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests that closing reads through the rest of the body, leaving the next request
+bool test_chunkedreader_close() {
+    const StringRef inputData(
+        "5\r\n"
+        "abcde\r\n"
+        "3\r\n"
+        "fgh\r\n"
+        "0\r\n"
+        "Some-Header: headerval\r\n"
+        "\r\n"
+        "next");
+
+    ChunkedReaderTestSource testSource(inputData.data(), inputData.length());
+    BufferedReader bufferedReader;
+    bufferedReader.init(&testSource, 1024);
+    ChunkedReader reader(bufferedReader);
+
+    char readBuffer[1024];
+    uint32_t bytesRead;
+    HttpError err;
+    std::tie(bytesRead, err) = reader.read(readBuffer, 2);
+    if (err != HttpError::Ok || bytesRead != 2) {
+        testf("Failed to read start of body");
+        return false;
+    }
+
+    err = reader.close();
+    if (err != HttpError::Ok) {
+        testf("Close failed with: %d", err);
+        return false;
+    }
+    if (bufferedReader.getBuffered() != "next") {
+        testf("Close did not stop at the end of the body");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests that readFully fills the buffer across chunks
+bool test_chunkedreader_read_fully() {
+    const StringRef inputData(
+        "5\r\n"
+        "abcde\r\n"
+        "3\r\n"
+        "fgh\r\n"
+        "1\r\n"
+        "i\r\n"
+        "0\r\n"
+        "\r\n");
+
+    ChunkedReaderTestSource testSource(inputData.data(), inputData.length());
+    BufferedReader bufferedReader;
+    bufferedReader.init(&testSource, 4); // Intentionally small
+    ChunkedReader reader(bufferedReader);
+
+    char readBuffer[1024];
+    uint32_t bytesRead;
+    HttpError err;
+    std::tie(bytesRead, err) = reader.readFully(readBuffer, 7);
+    if (err != HttpError::Ok || StringRef(readBuffer, bytesRead) != "abcdefg") {
+        testf("First readFully did not fill the buffer");
+        return false;
+    }
+
+    std::tie(bytesRead, err) = reader.readFully(readBuffer, sizeof(readBuffer));
+    if (err != HttpError::Ok || StringRef(readBuffer, bytesRead) != "hi") {
+        testf("Second readFully did not stop at the end of the body");
+        return false;
+    }
+
+    std::tie(bytesRead, err) = reader.readFully(readBuffer, sizeof(readBuffer));
+    if (err != HttpError::Eof || bytesRead != 0) {
+        testf("Did not see expected EOF at end of stream");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests that readFully counts what it read before a bad or cut off chunk
+bool test_chunkedreader_read_fully_error() {
+    const StringRef badSizeData(
+        "5\r\n"
+        "abcde\r\n"
+        "xyz\r\n"
+        "fgh\r\n"
+        "0\r\n"
+        "\r\n");
+
+    ChunkedReaderTestSource badSizeSource(badSizeData.data(), badSizeData.length());
+    BufferedReader badSizeReader;
+    badSizeReader.init(&badSizeSource, 4);
+    ChunkedReader reader(badSizeReader);
+
+    char readBuffer[1024];
+    uint32_t bytesRead;
+    HttpError err;
+    std::tie(bytesRead, err) = reader.readFully(readBuffer, sizeof(readBuffer));
+    if (err != HttpError::ClientError || StringRef(readBuffer, bytesRead) != "abcde") {
+        testf("Bad chunk size did not return the first chunk with the error");
+        return false;
+    }
+
+    const StringRef truncatedData(
+        "5\r\n"
+        "abcde\r\n"
+        "8\r\n"
+        "fgh");
+
+    ChunkedReaderTestSource truncatedSource(truncatedData.data(), truncatedData.length());
+    BufferedReader truncatedReader;
+    truncatedReader.init(&truncatedSource, 4);
+    ChunkedReader truncated(truncatedReader);
+
+    std::tie(bytesRead, err) = truncated.readFully(readBuffer, sizeof(readBuffer));
+    if (err != HttpError::Eof || StringRef(readBuffer, bytesRead) != "abcdefgh") {
+        testf("Cut off chunk did not return what was read with the error");
+        return false;
+    }
+
+    return true;
+}
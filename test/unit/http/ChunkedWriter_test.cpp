@@ -12,9 +12,11 @@
 
 using namespace Cupcake;
 
-class WriteTestSource : public StreamSource {
+class ChunkedWriterTestSource : public StreamSource {
 public:
-    WriteTestSource() {}
+    ChunkedWriterTestSource() :
+        writeCount(0)
+    {}
 
     std::tuple<StreamSource*, HttpError> accept() override {
         return std::make_tuple(nullptr, HttpError::Ok);
@@ -26,10 +28,12 @@ public:
         return std::make_tuple(0, HttpError::Ok);
     }
     HttpError write(const char* buffer, uint32_t bufferLen) override {
+        writeCount++;
         std::copy_n(buffer, bufferLen, std::back_inserter(dataWritten));
         return HttpError::Ok;
     }
     HttpError writev(const INet::IoBuffer* buffers, uint32_t bufferCount) override {
+        writeCount++;
         for (uint32_t i = 0; i < bufferCount; i++) {
             const INet::IoBuffer& bufferIter = buffers[i];
             std::copy_n(bufferIter.buffer, bufferIter.bufferLen, std::back_inserter(dataWritten));
@@ -40,12 +44,17 @@ public:
         return HttpError::Ok;
     }
 
+    StringRef getData() const {
+        return dataWritten.empty() ? StringRef("", 0) : StringRef(&dataWritten[0], dataWritten.size());
+    }
+
     std::vector<char> dataWritten;
+    uint32_t writeCount;
 };
 
 // Tests basic chunked writer functionality
 bool test_chunkedwriter_basic() {
-    WriteTestSource streamSource;
+    ChunkedWriterTestSource streamSource;
     ChunkedWriter writer;
     writer.init(&streamSource);
 
@@ -68,10 +77,8 @@ bool test_chunkedwriter_basic() {
     }
 
     const StringRef expected =
-        "A\r\n"
-        "0123456789\r\n"
-        "4\r\n"
-        "abcd\r\n"
+        "E\r\n"
+        "0123456789abcd\r\n"
         "0\r\n"
         "\r\n";
 
@@ -80,13 +87,17 @@ bool test_chunkedwriter_basic() {
         testf("Did not write expected data");
         return false;
     }
+    if (streamSource.writeCount != 1) {
+        testf("Expected a single write, got %u", streamSource.writeCount);
+        return false;
+    }
 
     return true;
 }
 
 // Tests closing a stream with nothing written
 bool test_chunkedwriter_empty() {
-    WriteTestSource streamSource;
+    ChunkedWriterTestSource streamSource;
     ChunkedWriter writer;
     writer.init(&streamSource);
 
@@ -108,3 +119,108 @@ bool test_chunkedwriter_empty() {
 
     return true;
 }
+
+// Tests flush sends what's been buffered as its own chunk
+bool test_chunkedwriter_flush() {
+    ChunkedWriterTestSource streamSource;
+    ChunkedWriter writer;
+    writer.init(&streamSource);
+
+    HttpError err = writer.write("abc", 3);
+    if (err != HttpError::Ok) {
+        testf("Write failed");
+        return false;
+    }
+    if (streamSource.writeCount != 0) {
+        testf("Small write was not buffered");
+        return false;
+    }
+
+    err = writer.flush();
+    if (err != HttpError::Ok) {
+        testf("Flush failed");
+        return false;
+    }
+    if (streamSource.getData() != "3\r\nabc\r\n") {
+        testf("Flush did not write the pending chunk");
+        return false;
+    }
+
+    // Nothing pending, so nothing to write
+    err = writer.flush();
+    if (err != HttpError::Ok || streamSource.writeCount != 1) {
+        testf("Empty flush wrote data");
+        return false;
+    }
+
+    err = writer.write("de", 2);
+    if (err != HttpError::Ok) {
+        testf("Write failed");
+        return false;
+    }
+    err = writer.close();
+    if (err != HttpError::Ok) {
+        testf("Close failed");
+        return false;
+    }
+
+    if (streamSource.getData() != "3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n" || streamSource.writeCount != 2) {
+        testf("Did not write expected data");
+        return false;
+    }
+
+    err = writer.write("f", 1);
+    if (err != HttpError::StreamClosed) {
+        testf("Write after close did not fail");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests writes that overflow the buffer go out along with what is pending
+bool test_chunkedwriter_large_write() {
+    ChunkedWriterTestSource streamSource;
+    ChunkedWriter writer;
+    writer.init(&streamSource, 8);
+
+    HttpError err = writer.write("0123", 4);
+    if (err != HttpError::Ok) {
+        testf("Write failed");
+        return false;
+    }
+    err = writer.write("456789abcdef", 12);
+    if (err != HttpError::Ok) {
+        testf("Write failed");
+        return false;
+    }
+    if (streamSource.getData() != "10\r\n0123456789abcdef\r\n" || streamSource.writeCount != 1) {
+        testf("Overflowing write was not sent with the pending data");
+        return false;
+    }
+
+    err = writer.close();
+    if (err != HttpError::Ok) {
+        testf("Close failed");
+        return false;
+    }
+    if (streamSource.getData() != "10\r\n0123456789abcdef\r\n0\r\n\r\n") {
+        testf("Did not write expected data");
+        return false;
+    }
+
+    // No buffering at all
+    ChunkedWriterTestSource unbufferedSource;
+    ChunkedWriter unbufferedWriter;
+    unbufferedWriter.init(&unbufferedSource, 0);
+
+    unbufferedWriter.write("ab", 2);
+    unbufferedWriter.write("c", 1);
+    unbufferedWriter.close();
+    if (unbufferedSource.getData() != "2\r\nab\r\n1\r\nc\r\n0\r\n\r\n" || unbufferedSource.writeCount != 3) {
+        testf("Unbuffered writer did not write a chunk per write");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,323 @@
+
+#include "unit/http/Compression_test.h"
+#include "unit/UnitTest.h"
+
+#include "cupcake/internal/http/AcceptEncoding.h"
+#include "cupcake/internal/http/CompressionConfig.h"
+#include "cupcake/internal/http/HttpResponseImpl.h"
+#include "cupcake/internal/http/StreamSource.h"
+#include "cupcake/internal/text/Strconv.h"
+#include "cupcake/internal/text/String.h"
+
+#ifdef CUPCAKE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+using namespace Cupcake;
+
+class CompressionTestSource : public StreamSource {
+public:
+    CompressionTestSource() {}
+
+    std::tuple<StreamSource*, HttpError> accept() override {
+        return std::make_tuple(nullptr, HttpError::Ok);
+    }
+    std::tuple<uint32_t, HttpError> read(char* buffer, uint32_t bufferLen) override {
+        return std::make_tuple(0, HttpError::Ok);
+    }
+    std::tuple<uint32_t, HttpError> readv(INet::IoBuffer* buffers, uint32_t bufferCount) override {
+        return std::make_tuple(0, HttpError::Ok);
+    }
+    HttpError write(const char* buffer, uint32_t bufferLen) override {
+        std::copy_n(buffer, bufferLen, std::back_inserter(dataWritten));
+        return HttpError::Ok;
+    }
+    HttpError writev(const INet::IoBuffer* buffers, uint32_t bufferCount) override {
+        for (uint32_t i = 0; i < bufferCount; i++) {
+            const INet::IoBuffer& bufferIter = buffers[i];
+            std::copy_n(bufferIter.buffer, bufferIter.bufferLen, std::back_inserter(dataWritten));
+        }
+        return HttpError::Ok;
+    }
+    HttpError close() override {
+        return HttpError::Ok;
+    }
+
+    StringRef getData() const {
+        return dataWritten.empty() ? StringRef("", 0) : StringRef(&dataWritten[0], dataWritten.size());
+    }
+
+    std::vector<char> dataWritten;
+};
+
+static
+HttpError writeResponse(CompressionTestSource* streamSource, const CompressionConfig& config,
+                        const StringRef contentType, const StringRef body) {
+    HttpResponseImpl response(HttpVersion::Http1_1, streamSource);
+    response.setCompression(&config, "gzip, deflate");
+    response.setStatus(200, "OK");
+    response.addHeader("Content-Type", contentType);
+
+    HttpOutputStream* outputStream;
+    HttpError err;
+    std::tie(outputStream, err) = response.getOutputStream();
+    if (err != HttpError::Ok) {
+        return err;
+    }
+
+    // Written in pieces to exercise the buffering
+    for (size_t i = 0; i < body.length(); i += 100) {
+        size_t len = std::min((size_t)100, body.length() - i);
+        err = outputStream->write(body.data() + i, (uint32_t)len);
+        if (err != HttpError::Ok) {
+            return err;
+        }
+    }
+    return outputStream->close();
+}
+
+#ifdef CUPCAKE_HAVE_ZLIB
+// Undoes the chunked encoding. Returns false if it's malformed.
+static
+bool dechunk(const StringRef chunked, std::vector<char>* body) {
+    size_t index = 0;
+    while (true) {
+        ptrdiff_t lineEnd = chunked.indexOf("\r\n", index);
+        if (lineEnd == -1) {
+            return false;
+        }
+        uint32_t chunkLen;
+        bool valid;
+        std::tie(chunkLen, valid) = Strconv::parseUint32(chunked.substring(index, lineEnd), 16);
+        if (!valid || (size_t)lineEnd + 2 + chunkLen + 2 > chunked.length()) {
+            return false;
+        }
+        if (chunkLen == 0) {
+            return true;
+        }
+        const char* chunkStart = chunked.data() + lineEnd + 2;
+        body->insert(body->end(), chunkStart, chunkStart + chunkLen);
+        index = lineEnd + 2 + chunkLen + 2;
+    }
+}
+#endif
+
+// Tests q-value handling of Accept-Encoding
+bool test_compression_accept_encoding() {
+    struct QualityTest {
+        const char* acceptEncoding;
+        const char* coding;
+        uint32_t expected;
+    };
+
+    const QualityTest tests[] = {
+        {"gzip", "gzip", 1000},
+        {"gzip;q=0.5", "gzip", 500},
+        {"gzip ; q=0.25, br", "gzip", 250},
+        {"br, GZIP;Q=1.0", "gzip", 1000},
+        {"x-gzip", "gzip", 1000},
+        {"gzip;q=0", "gzip", 0},
+        {"gzip;q=1.5", "gzip", 0},
+        {"gzip;q=abc", "gzip", 0},
+        {"br", "gzip", 0},
+        {"*;q=0.3", "gzip", 300},
+        {"br", "identity", 1000},
+        {"*;q=0", "identity", 0},
+        {"identity;q=0.1, *", "identity", 100},
+    };
+
+    for (const QualityTest& test : tests) {
+        uint32_t quality = AcceptEncoding::getQuality(test.acceptEncoding, test.coding);
+        if (quality != test.expected) {
+            testf("Expected %u for %s in \"%s\", got %u", test.expected, test.coding, test.acceptEncoding, quality);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Tests a large enough compressible response is gzipped
+bool test_compression_gzip_response() {
+#ifdef CUPCAKE_HAVE_ZLIB
+    CompressionConfig config;
+    config.enable(256);
+
+    String body;
+    for (int i = 0; i < 200; i++) {
+        body += "{\"id\": 12345, \"name\": \"compressible\"},";
+    }
+
+    CompressionTestSource streamSource;
+    HttpError err = writeResponse(&streamSource, config, "application/json; charset=utf-8", body);
+    if (err != HttpError::Ok) {
+        testf("Failed to write response with: %d", err);
+        return false;
+    }
+
+    const StringRef output = streamSource.getData();
+    ptrdiff_t headerEnd = output.indexOf("\r\n\r\n");
+    if (headerEnd == -1) {
+        testf("Did not find end of headers");
+        return false;
+    }
+    const StringRef headers = output.substring(0, headerEnd + 2);
+    if (headers.indexOf("\r\nContent-Encoding: gzip\r\n") == -1 ||
+        headers.indexOf("\r\nVary: Accept-Encoding\r\n") == -1 ||
+        headers.indexOf("\r\nTransfer-Encoding: chunked\r\n") == -1) {
+        testf("Missing expected headers");
+        return false;
+    }
+
+    std::vector<char> compressed;
+    if (!dechunk(output.substring(headerEnd + 4), &compressed)) {
+        testf("Invalid chunked body");
+        return false;
+    }
+    if (compressed.size() >= body.length() / 4) {
+        testf("Body did not compress: %u bytes", (uint32_t)compressed.size());
+        return false;
+    }
+
+    std::vector<char> inflated(body.length() + 1);
+    z_stream stream = {};
+    ::inflateInit2(&stream, 15 + 16);
+    stream.next_in = (Bytef*)compressed.data();
+    stream.avail_in = (uInt)compressed.size();
+    stream.next_out = (Bytef*)inflated.data();
+    stream.avail_out = (uInt)inflated.size();
+    int res = ::inflate(&stream, Z_FINISH);
+    size_t inflatedLen = inflated.size() - stream.avail_out;
+    ::inflateEnd(&stream);
+
+    if (res != Z_STREAM_END ||
+        inflatedLen != body.length() ||
+        std::memcmp(inflated.data(), body.data(), inflatedLen) != 0) {
+        testf("Body did not decompress to the original");
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+// Tests small responses are sent as is with a Content-Length
+bool test_compression_below_min_size() {
+    // Without a compressor the response streams like any other
+#ifdef CUPCAKE_HAVE_ZLIB
+    CompressionConfig config;
+    config.enable(256);
+
+    CompressionTestSource streamSource;
+    HttpError err = writeResponse(&streamSource, config, "application/json", "{\"small\": true}");
+    if (err != HttpError::Ok) {
+        testf("Failed to write response with: %d", err);
+        return false;
+    }
+
+    const StringRef output = streamSource.getData();
+    if (output.indexOf("Content-Encoding") != -1 ||
+        output.indexOf("\r\nContent-Length: 15\r\n") == -1 ||
+        !output.endsWith("\r\n\r\n{\"small\": true}")) {
+        testf("Small response was not sent uncompressed");
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+// Tests content types outside the allowlist are left alone
+bool test_compression_content_type() {
+    CompressionConfig config;
+    config.enable(0);
+
+    CompressionTestSource streamSource;
+    HttpError err = writeResponse(&streamSource, config, "image/png", "not really a png");
+    if (err != HttpError::Ok) {
+        testf("Failed to write response with: %d", err);
+        return false;
+    }
+
+    const StringRef output = streamSource.getData();
+    if (output.indexOf("Content-Encoding") != -1 ||
+        !output.endsWith("\r\n\r\n10\r\nnot really a png\r\n0\r\n\r\n")) {
+        testf("Image response was compressed");
+        return false;
+    }
+
+    CompressionConfig customConfig;
+    customConfig.enable(0);
+    customConfig.addContentType("image/*");
+    if (!customConfig.isCompressible("image/png") ||
+        !customConfig.isCompressible("IMAGE/PNG; foo=bar") ||
+        customConfig.isCompressible("text/html")) {
+        testf("Custom content types not matched as expected");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests Vary from the handler is merged into rather than repeated
+bool test_compression_vary() {
+#ifdef CUPCAKE_HAVE_ZLIB
+    CompressionConfig config;
+    config.enable(256);
+
+    String largeBody;
+    for (int i = 0; i < 20; i++) {
+        largeBody += "{\"id\": 12345, \"name\": \"compressible\"},";
+    }
+
+    const struct {
+        const char* vary;
+        const char* body;
+        const char* expectedVary;
+    } tests[] = {
+        {"Accept-Encoding", largeBody.c_str(), "\r\nVary: Accept-Encoding\r\n"},
+        {"accept-encoding", "{\"small\": true}", "\r\nVary: accept-encoding\r\n"},
+        {"Origin", largeBody.c_str(), "\r\nVary: Origin, Accept-Encoding\r\n"},
+        {"Origin", "{\"small\": true}", "\r\nVary: Origin, Accept-Encoding\r\n"},
+        {"*", largeBody.c_str(), "\r\nVary: *\r\n"},
+    };
+
+    for (const auto& test : tests) {
+        CompressionTestSource streamSource;
+        HttpResponseImpl response(HttpVersion::Http1_1, &streamSource);
+        response.setCompression(&config, "gzip");
+        response.setStatus(200, "OK");
+        response.addHeader("Content-Type", "application/json");
+        response.addHeader("Vary", test.vary);
+
+        HttpOutputStream* outputStream;
+        HttpError err;
+        std::tie(outputStream, err) = response.getOutputStream();
+        if (err != HttpError::Ok) {
+            testf("Failed to get output stream with: %d", err);
+            return false;
+        }
+        outputStream->write(test.body, (uint32_t)std::strlen(test.body));
+        err = outputStream->close();
+        if (err != HttpError::Ok) {
+            testf("Failed to write response with: %d", err);
+            return false;
+        }
+
+        const StringRef output = streamSource.getData();
+        const StringRef headers = output.substring(0, output.indexOf("\r\n\r\n") + 2);
+        ptrdiff_t varyIndex = headers.indexOf(test.expectedVary);
+        if (varyIndex == -1 || headers.indexOf("\r\nVary:", varyIndex + 1) != -1) {
+            testf("Expected a single %s for Vary: %s", test.expectedVary + 2, test.vary);
+            return false;
+        }
+    }
+#endif
+
+    return true;
+}
@@ -0,0 +1,215 @@
+
+#include "unit/http/ContentLengthReader_test.h"
+
+#include "unit/UnitTest.h"
+
+#include "cupcake/text/StringRef.h"
+#include "cupcake/internal/http/ContentLengthReader.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace Cupcake;
+
+class ContentLengthReaderTestSource : public StreamSource {
+public:
+    ContentLengthReaderTestSource(const char* sourceData, size_t dataLen) :
+        sourceData(sourceData),
+        dataLen(dataLen) {}
+
+    std::tuple<StreamSource*, HttpError> accept() override {
+        return std::make_tuple(nullptr, HttpError::Ok);
+    }
+    std::tuple<uint32_t, HttpError> read(char* buffer, uint32_t bufferLen) override {
+        if (dataLen == 0) {
+            return std::make_tuple(0, HttpError::Eof);
+        }
+
+        uint32_t copyLen = std::min((uint32_t)dataLen, bufferLen);
+        std::memcpy(buffer, sourceData, copyLen);
+        sourceData += copyLen;
+        dataLen -= copyLen;
+        return std::make_tuple(copyLen, HttpError::Ok);
+    }
+    std::tuple<uint32_t, HttpError> readv(INet::IoBuffer* buffers, uint32_t bufferCount) override {
+        if (dataLen == 0) {
+            return std::make_tuple(0, HttpError::Eof);
+        }
+
+        uint32_t bytesCopied = 0;
+        for (uint32_t i = 0; i < bufferCount && dataLen > 0; i++) {
+            uint32_t copyLen = std::min((uint32_t)dataLen, buffers[i].bufferLen);
+            std::memcpy(buffers[i].buffer, sourceData, copyLen);
+            sourceData += copyLen;
+            dataLen -= copyLen;
+            bytesCopied += copyLen;
+        }
+        return std::make_tuple(bytesCopied, HttpError::Ok);
+    }
+    HttpError write(const char* buffer, uint32_t bufferLen) override {
+        return HttpError::Ok;
+    }
+    HttpError writev(const INet::IoBuffer* buffers, uint32_t bufferCount) override {
+        return HttpError::Ok;
+    }
+    HttpError close() override {
+        return HttpError::Ok;
+    }
+
+private:
+    const char* sourceData;
+    size_t dataLen;
+};
+
+// Tests that views stop at the content length, mixed with reads
+bool test_contentlengthreader_read_view() {
+    const StringRef inputData("abcdefghijGET");
+
+    ContentLengthReaderTestSource testSource(inputData.data(), inputData.length());
+    BufferedReader bufferedReader;
+    bufferedReader.init(&testSource, 1024);
+    ContentLengthReader reader(bufferedReader, 10);
+
+    StringRef view;
+    HttpError err;
+    std::tie(view, err) = reader.readView(4);
+    if (err != HttpError::Ok || view != "abcd") {
+        testf("First view did not match");
+        return false;
+    }
+    reader.consume(4);
+
+    char readBuffer[1024];
+    uint32_t bytesRead;
+    std::tie(bytesRead, err) = reader.read(readBuffer, 2);
+    if (err != HttpError::Ok || StringRef(readBuffer, bytesRead) != "ef") {
+        testf("Read after view did not match");
+        return false;
+    }
+
+    std::tie(view, err) = reader.readView(1024);
+    if (err != HttpError::Ok || view != "ghij") {
+        testf("View went past the content length");
+        return false;
+    }
+    reader.consume(4);
+
+    std::tie(view, err) = reader.readView(1024);
+    if (err != HttpError::Eof || view.length() != 0) {
+        testf("Did not see expected EOF at end of content");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests that closing skips what wasn't read, leaving the next request
+bool test_contentlengthreader_close() {
+    const StringRef inputData("abcdefghijGET");
+
+    ContentLengthReaderTestSource testSource(inputData.data(), inputData.length());
+    BufferedReader bufferedReader;
+    bufferedReader.init(&testSource, 4); // Intentionally small
+    ContentLengthReader reader(bufferedReader, 10);
+
+    char readBuffer[1024];
+    uint32_t bytesRead;
+    HttpError err;
+    std::tie(bytesRead, err) = reader.read(readBuffer, 3);
+    if (err != HttpError::Ok || bytesRead != 3) {
+        testf("Failed to read start of content");
+        return false;
+    }
+
+    err = reader.close();
+    if (err != HttpError::Ok) {
+        testf("Close failed with: %d", err);
+        return false;
+    }
+
+    size_t readIndex = 0;
+    while (true) {
+        std::tie(bytesRead, err) = bufferedReader.read(readBuffer + readIndex, sizeof(readBuffer) - readIndex);
+        if (err != HttpError::Ok) {
+            break;
+        }
+        readIndex += bytesRead;
+    }
+    if (err != HttpError::Eof || StringRef(readBuffer, readIndex) != "GET") {
+        testf("Close did not stop at the end of the content");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests that readFully fills the buffer across source reads, and stops at the content length
+bool test_contentlengthreader_read_fully() {
+    std::vector<char> data(200000);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (char)('a' + i % 26);
+    }
+
+    ContentLengthReaderTestSource testSource(data.data(), data.size());
+    BufferedReader bufferedReader;
+    bufferedReader.init(&testSource, 1024);
+    ContentLengthReader reader(bufferedReader, 150000);
+
+    // Starts with what's buffered
+    char readBuffer[10];
+    uint32_t bytesRead;
+    HttpError err;
+    std::tie(bytesRead, err) = reader.read(readBuffer, sizeof(readBuffer));
+    if (err != HttpError::Ok || bytesRead != sizeof(readBuffer)) {
+        testf("Failed to read start of content");
+        return false;
+    }
+
+    std::vector<char> largeBuffer(100000);
+    std::tie(bytesRead, err) = reader.readFully(largeBuffer.data(), (uint32_t)largeBuffer.size());
+    if (err != HttpError::Ok || bytesRead != largeBuffer.size() ||
+        std::memcmp(largeBuffer.data(), data.data() + 10, largeBuffer.size()) != 0) {
+        testf("First readFully did not match");
+        return false;
+    }
+
+    std::tie(bytesRead, err) = reader.readFully(largeBuffer.data(), (uint32_t)largeBuffer.size());
+    if (err != HttpError::Ok || bytesRead != 49990 ||
+        std::memcmp(largeBuffer.data(), data.data() + 100010, 49990) != 0) {
+        testf("Second readFully did not stop at the content length");
+        return false;
+    }
+
+    std::tie(bytesRead, err) = reader.readFully(largeBuffer.data(), (uint32_t)largeBuffer.size());
+    if (err != HttpError::Eof || bytesRead != 0) {
+        testf("Did not see expected EOF at end of content");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests that readFully counts what it read before the connection ended early
+bool test_contentlengthreader_read_fully_truncated() {
+    std::vector<char> data(100000);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (char)('a' + i % 26);
+    }
+
+    ContentLengthReaderTestSource testSource(data.data(), data.size());
+    BufferedReader bufferedReader;
+    bufferedReader.init(&testSource, 1024);
+    ContentLengthReader reader(bufferedReader, 150000);
+
+    std::vector<char> largeBuffer(150000);
+    uint32_t bytesRead;
+    HttpError err;
+    std::tie(bytesRead, err) = reader.readFully(largeBuffer.data(), (uint32_t)largeBuffer.size());
+    if (err != HttpError::Eof || bytesRead != data.size() ||
+        std::memcmp(largeBuffer.data(), data.data(), data.size()) != 0) {
+        testf("readFully did not return what was read with the error");
+        return false;
+    }
+
+    return true;
+}
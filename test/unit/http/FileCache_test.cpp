@@ -0,0 +1,197 @@
+
+#include "unit/http/FileCache_test.h"
+#include "unit/UnitTest.h"
+
+#include "cupcake/internal/http/FileCache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace Cupcake;
+
+static
+bool writeTestFile(const char* name, const StringRef content) {
+    FILE* file = std::fopen(name, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool res = std::fwrite(content.data(), 1, content.length(), file) == content.length();
+    return (std::fclose(file) == 0) && res;
+}
+
+// Tests small files are held in memory and lookups hit the same entry
+bool test_filecache_basic() {
+    if (!writeTestFile("FileCache_test_basic.css", "body {}")) {
+        testf("Failed to write test file");
+        return false;
+    }
+
+    FileCache fileCache;
+    FileError err = fileCache.init(".");
+    if (err != FileError::Ok) {
+        std::remove("FileCache_test_basic.css");
+        testf("Failed to init cache with: %d", err);
+        return false;
+    }
+
+    std::shared_ptr<const FileCache::Entry> entry;
+    std::shared_ptr<const FileCache::Entry> entry2;
+    std::tie(entry, err) = fileCache.get("FileCache_test_basic.css");
+    std::tie(entry2, std::ignore) = fileCache.get("FileCache_test_basic.css");
+    std::remove("FileCache_test_basic.css");
+
+    if (err != FileError::Ok) {
+        testf("Failed to get entry with: %d", err);
+        return false;
+    }
+    if (entry != entry2) {
+        testf("Second lookup did not hit the cache");
+        return false;
+    }
+    if (entry->size != 7 ||
+        !entry->content ||
+        std::memcmp(entry->content.get(), "body {}", 7) != 0 ||
+        entry->file.isOpen()) {
+        testf("Small file was not held in memory");
+        return false;
+    }
+    if (entry->contentLength != "7" ||
+        entry->contentType != "text/css" ||
+        entry->lastModified.length() != 29 ||
+        !entry->etag.startsWith("\"")) {
+        testf("Unexpected header values");
+        return false;
+    }
+
+    std::tie(entry, err) = fileCache.get("FileCache_test_missing.css");
+    if (err != FileError::NotFound) {
+        testf("Expected NotFound for missing file, got: %d", err);
+        return false;
+    }
+
+    return true;
+}
+
+// Tests files over the small file limit are kept open instead
+bool test_filecache_large_file() {
+    if (!writeTestFile("FileCache_test_large.bin", "0123456789")) {
+        testf("Failed to write test file");
+        return false;
+    }
+
+    FileCache fileCache;
+    fileCache.init(".", 16, 4, 1024);
+
+    std::shared_ptr<const FileCache::Entry> entry;
+    FileError err;
+    std::tie(entry, err) = fileCache.get("FileCache_test_large.bin");
+    std::remove("FileCache_test_large.bin");
+
+    if (err != FileError::Ok) {
+        testf("Failed to get entry with: %d", err);
+        return false;
+    }
+    if (entry->content || !entry->file.isOpen() || entry->size != 10) {
+        testf("Large file was not kept open");
+        return false;
+    }
+    if (entry->contentType != "application/octet-stream") {
+        testf("Unexpected content type");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests the least recently used entry is dropped once over the limit
+bool test_filecache_eviction() {
+    if (!writeTestFile("FileCache_test_a.txt", "a") ||
+        !writeTestFile("FileCache_test_b.txt", "b") ||
+        !writeTestFile("FileCache_test_c.txt", "c")) {
+        testf("Failed to write test files");
+        return false;
+    }
+
+    FileCache fileCache;
+    fileCache.init(".", 2, 1024, 1024);
+
+    std::shared_ptr<const FileCache::Entry> entryA;
+    std::shared_ptr<const FileCache::Entry> entryB;
+    std::shared_ptr<const FileCache::Entry> entryAgain;
+    std::tie(entryA, std::ignore) = fileCache.get("FileCache_test_a.txt");
+    std::tie(entryB, std::ignore) = fileCache.get("FileCache_test_b.txt");
+    std::tie(std::ignore, std::ignore) = fileCache.get("FileCache_test_a.txt");
+    std::tie(std::ignore, std::ignore) = fileCache.get("FileCache_test_c.txt");
+
+    // B was the least recently used
+    std::tie(entryAgain, std::ignore) = fileCache.get("FileCache_test_a.txt");
+    bool aEvicted = entryAgain != entryA;
+    std::tie(entryAgain, std::ignore) = fileCache.get("FileCache_test_b.txt");
+    bool bEvicted = entryAgain != entryB;
+
+    std::remove("FileCache_test_a.txt");
+    std::remove("FileCache_test_b.txt");
+    std::remove("FileCache_test_c.txt");
+
+    if (!bEvicted) {
+        testf("Least recently used entry was not evicted");
+        return false;
+    }
+    if (aEvicted) {
+        testf("Recently used entry was evicted");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests changes on disk are picked up
+bool test_filecache_invalidation() {
+    if (!writeTestFile("FileCache_test_change.txt", "before")) {
+        testf("Failed to write test file");
+        return false;
+    }
+
+    FileCache fileCache;
+    fileCache.init(".");
+
+    std::shared_ptr<const FileCache::Entry> entry;
+    FileError err;
+    std::tie(entry, err) = fileCache.get("FileCache_test_change.txt");
+    if (err != FileError::Ok) {
+        std::remove("FileCache_test_change.txt");
+        testf("Failed to get entry with: %d", err);
+        return false;
+    }
+
+    // Explicit invalidation
+    fileCache.invalidate("FileCache_test_change.txt");
+    std::shared_ptr<const FileCache::Entry> reloaded;
+    std::tie(reloaded, std::ignore) = fileCache.get("FileCache_test_change.txt");
+    if (reloaded == entry) {
+        std::remove("FileCache_test_change.txt");
+        testf("Entry was not invalidated");
+        return false;
+    }
+
+    // Changes on disk, seen either through the watcher or by revalidation
+    writeTestFile("FileCache_test_change.txt", "after!!");
+    bool sawChange = false;
+    for (int i = 0; i < 30 && !sawChange; i++) {
+        std::tie(entry, err) = fileCache.get("FileCache_test_change.txt");
+        sawChange = err == FileError::Ok && entry->size == 7;
+        if (!sawChange) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    std::remove("FileCache_test_change.txt");
+
+    if (!sawChange) {
+        testf("Change on disk was not picked up");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,170 @@
+
+#include "unit/UnitTest.h"
+#include "unit/http/HandlerMap_test.h"
+
+#include "cupcake/internal/http/HandlerMap.h"
+#include "cupcake/internal/http/HttpRequestImpl.h"
+#include "cupcake/internal/http/HttpResponseImpl.h"
+#include "cupcake/internal/http/NullReader.h"
+
+#include <vector>
+
+using namespace Cupcake;
+
+#define METHOD_BIT(method) (1u << (uint32_t)HttpMethod::method)
+
+// Handlers record which one ran into a shared value, so lookups can be checked
+// without needing a request
+static HttpHandler makeHandler(int* ran, int id) {
+    return [ran, id](HttpRequest&, HttpResponse&) {
+        *ran = id;
+    };
+}
+
+static bool checkLookup(const HandlerMap& handlerMap, int* ran, HttpMethod method, const StringRef path,
+                        int expectedId, uint32_t expectedMask) {
+    const HttpHandler* handler;
+    uint32_t allowedMethods;
+    PathParams pathParams;
+    std::tie(handler, allowedMethods) = handlerMap.getHandler(method, path, pathParams);
+
+    if (allowedMethods != expectedMask) {
+        testf("Path %.*s (method %d) allowed 0x%x, expected 0x%x", (int)path.length(), path.data(),
+              (int)method, allowedMethods, expectedMask);
+        return false;
+    }
+
+    if (expectedId == 0) {
+        if (handler) {
+            testf("Path %.*s (method %d) unexpectedly had a handler", (int)path.length(), path.data(), (int)method);
+            return false;
+        }
+        return true;
+    }
+
+    if (!handler) {
+        testf("Path %.*s (method %d) had no handler", (int)path.length(), path.data(), (int)method);
+        return false;
+    }
+
+    // The handlers never touch the request or response, so they can be empty
+    RequestData requestData;
+    NullReader nullReader;
+    HttpRequestImpl request(requestData, pathParams, nullReader);
+    HttpResponseImpl response(HttpVersion::Http1_1, nullptr);
+
+    *ran = 0;
+    (*handler)(request, response);
+    if (*ran != expectedId) {
+        testf("Path %.*s (method %d) ran handler %d, expected %d", (int)path.length(), path.data(),
+              (int)method, *ran, expectedId);
+        return false;
+    }
+    return true;
+}
+
+static bool addMethodHandlers(HandlerMap& handlerMap, int* ran) {
+    bool added = handlerMap.addHandler(HttpMethod::Get, "/users/{id:int}", makeHandler(ran, 1)) &&
+        handlerMap.addHandler(HttpMethod::Put, "/users/{id:int}", makeHandler(ran, 2)) &&
+        handlerMap.addHandler(HttpMethod::Delete, "/users/{id:int}", makeHandler(ran, 3)) &&
+        handlerMap.addHandler(HttpMethod::Post, "/users", makeHandler(ran, 4)) &&
+        handlerMap.addHandler(HttpMethod::Get, "/files/*", makeHandler(ran, 5));
+    if (!added) {
+        testf("Failed to add method handlers");
+        return false;
+    }
+    return true;
+}
+
+static bool checkMethodHandlers(const HandlerMap& handlerMap, int* ran) {
+    const uint32_t userMask = METHOD_BIT(Get) | METHOD_BIT(Put) | METHOD_BIT(Delete);
+
+    return checkLookup(handlerMap, ran, HttpMethod::Get, "/users/42", 1, userMask) &&
+        checkLookup(handlerMap, ran, HttpMethod::Put, "/users/42", 2, userMask) &&
+        checkLookup(handlerMap, ran, HttpMethod::Delete, "/users/42", 3, userMask) &&
+        checkLookup(handlerMap, ran, HttpMethod::Post, "/users/42", 0, userMask) &&
+        checkLookup(handlerMap, ran, HttpMethod::Options, "/users/42", 0, userMask) &&
+        checkLookup(handlerMap, ran, HttpMethod::Post, "/users", 4, METHOD_BIT(Post)) &&
+        checkLookup(handlerMap, ran, HttpMethod::Get, "/users", 0, METHOD_BIT(Post)) &&
+        checkLookup(handlerMap, ran, HttpMethod::Get, "/files/a/b.txt", 5, METHOD_BIT(Get)) &&
+        checkLookup(handlerMap, ran, HttpMethod::Head, "/files/a/b.txt", 0, METHOD_BIT(Get)) &&
+        checkLookup(handlerMap, ran, HttpMethod::Get, "/users/abc", 0, 0) &&
+        checkLookup(handlerMap, ran, HttpMethod::Get, "/nothing", 0, 0);
+}
+
+bool test_handlermap_methods() {
+    int ran = 0;
+    HandlerMap handlerMap;
+    if (!addMethodHandlers(handlerMap, &ran) || !checkMethodHandlers(handlerMap, &ran)) {
+        return false;
+    }
+
+    // The same method can't be registered twice for a path, even with different parameter names
+    if (handlerMap.addHandler(HttpMethod::Get, "/users/{id:int}", makeHandler(&ran, 6))) {
+        testf("Added a duplicate handler");
+        return false;
+    }
+    if (handlerMap.addHandler(HttpMethod::Post, "/users/{userId:int}", makeHandler(&ran, 6))) {
+        testf("Added a handler with conflicting parameter names");
+        return false;
+    }
+    if (handlerMap.addHandler(HttpMethod::Get, "/users/{id:bad}", makeHandler(&ran, 6))) {
+        testf("Added a handler with an invalid path");
+        return false;
+    }
+
+    return checkMethodHandlers(handlerMap, &ran);
+}
+
+bool test_handlermap_all_methods() {
+    int ran = 0;
+    HandlerMap handlerMap;
+    if (!handlerMap.addHandler("/any", makeHandler(&ran, 1))) {
+        testf("Failed to add handler for all methods");
+        return false;
+    }
+
+    const uint32_t allMask = (1u << HandlerMap::METHOD_COUNT) - 1;
+    for (uint32_t i = 0; i < HandlerMap::METHOD_COUNT; i++) {
+        if (!checkLookup(handlerMap, &ran, (HttpMethod)i, "/any", 1, allMask)) {
+            return false;
+        }
+    }
+
+    // Every method is taken, so nothing more can be added
+    if (handlerMap.addHandler(HttpMethod::Get, "/any", makeHandler(&ran, 2)) ||
+        handlerMap.addHandler("/any", makeHandler(&ran, 2))) {
+        testf("Added a handler over an all methods handler");
+        return false;
+    }
+
+    // And an all methods handler can't take over a path with some methods already set
+    if (!handlerMap.addHandler(HttpMethod::Get, "/some", makeHandler(&ran, 3))) {
+        testf("Failed to add a GET handler");
+        return false;
+    }
+    if (handlerMap.addHandler("/some", makeHandler(&ran, 4))) {
+        testf("Added an all methods handler over a GET handler");
+        return false;
+    }
+    return checkLookup(handlerMap, &ran, HttpMethod::Get, "/some", 3, METHOD_BIT(Get));
+}
+
+bool test_handlermap_frozen() {
+    int ran = 0;
+    HandlerMap handlerMap;
+    if (!addMethodHandlers(handlerMap, &ran)) {
+        return false;
+    }
+
+    handlerMap.freeze();
+    if (!checkMethodHandlers(handlerMap, &ran)) {
+        return false;
+    }
+
+    if (handlerMap.addHandler(HttpMethod::Post, "/users/{id:int}", makeHandler(&ran, 6))) {
+        testf("Added a handler after freezing");
+        return false;
+    }
+    return true;
+}
@@ -255,10 +255,8 @@ bool test_http1_1_chunked_response() {
         "HTTP/1.1 200 OK\r\n"
         "Transfer-Encoding: Chunked\r\n"
         "\r\n"
-        "A\r\n"
-        "0123456789\r\n"
-        "3\r\n"
-        "abc\r\n"
+        "D\r\n"
+        "0123456789abc\r\n"
         "0\r\n"
         "\r\n";
     char responseBuffer[1024];
@@ -357,10 +355,8 @@ bool test_http1_1_auto_chunked_response() {
         "HTTP/1.1 200 OK\r\n"
         "Transfer-Encoding: chunked\r\n"
         "\r\n"
-        "A\r\n"
-        "0123456789\r\n"
-        "3\r\n"
-        "abc\r\n"
+        "D\r\n"
+        "0123456789abc\r\n"
         "0\r\n"
         "\r\n";
     char responseBuffer[1024];
@@ -0,0 +1,209 @@
+
+#include "unit/http/HttpConnection_test.h"
+#include "unit/UnitTest.h"
+
+#include "cupcake/internal/http/HttpConnection.h"
+#include "cupcake/internal/http/RouteTable.h"
+#include "cupcake/internal/http/StreamSource.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+using namespace Cupcake;
+
+// Serves the requests from memory and keeps what was written back
+class ConnectionTestSource : public StreamSource {
+public:
+    ConnectionTestSource(const StringRef requests) :
+        sourceData(requests.data()),
+        dataLen(requests.length())
+    {}
+
+    std::tuple<StreamSource*, HttpError> accept() override {
+        return std::make_tuple(nullptr, HttpError::Ok);
+    }
+    std::tuple<uint32_t, HttpError> read(char* buffer, uint32_t bufferLen) override {
+        if (dataLen == 0) {
+            return std::make_tuple(0, HttpError::Eof);
+        }
+
+        uint32_t copyLen = (uint32_t)std::min(dataLen, (size_t)bufferLen);
+        std::memcpy(buffer, sourceData, copyLen);
+        sourceData += copyLen;
+        dataLen -= copyLen;
+        return std::make_tuple(copyLen, HttpError::Ok);
+    }
+    std::tuple<uint32_t, HttpError> readv(INet::IoBuffer* buffers, uint32_t bufferCount) override {
+        return read(buffers[0].buffer, buffers[0].bufferLen);
+    }
+    HttpError write(const char* buffer, uint32_t bufferLen) override {
+        std::copy_n(buffer, bufferLen, std::back_inserter(dataWritten));
+        return HttpError::Ok;
+    }
+    HttpError writev(const INet::IoBuffer* buffers, uint32_t bufferCount) override {
+        for (uint32_t i = 0; i < bufferCount; i++) {
+            std::copy_n(buffers[i].buffer, buffers[i].bufferLen, std::back_inserter(dataWritten));
+        }
+        return HttpError::Ok;
+    }
+    HttpError close() override {
+        return HttpError::Ok;
+    }
+
+    StringRef getData() const {
+        return dataWritten.empty() ? StringRef("", 0) : StringRef(&dataWritten[0], dataWritten.size());
+    }
+
+private:
+    const char* sourceData;
+    size_t dataLen;
+    std::vector<char> dataWritten;
+};
+
+// Counts the requests it sees, without reading their bodies
+static
+bool runIgnoringBodies(const StringRef requests, uint32_t expectedRequests, const StringRef expectedResponse) {
+    uint32_t requestCount = 0;
+    RouteTable routeTable;
+    routeTable.addHandler("/a", [&requestCount](HttpRequest&, HttpResponse& response) {
+        requestCount++;
+        response.setStatus(200, "OK");
+        response.addHeader("Content-Length", "0");
+    });
+    routeTable.addHandler("/b", [&requestCount](HttpRequest&, HttpResponse& response) {
+        requestCount++;
+        response.setStatus(200, "OK");
+        response.addHeader("Content-Length", "0");
+    });
+
+    ConnectionTestSource streamSource(requests);
+    BufferedReader bufReader;
+    bufReader.init(&streamSource, 1024);
+    HttpConnection connection(&streamSource, bufReader, &routeTable, nullptr);
+    connection.run();
+
+    if (requestCount != expectedRequests) {
+        testf("Expected %u requests to reach a handler, saw %u", expectedRequests, requestCount);
+        return false;
+    }
+    if (streamSource.getData() != expectedResponse) {
+        testf("Did not see the expected responses");
+        return false;
+    }
+    return true;
+}
+
+// Tests a body the handler didn't read is skipped, not run as the next request
+bool test_httpconnection_unread_body() {
+    const StringRef contentLengthRequests(
+        "POST /a HTTP/1.1\r\n"
+        "Host: a\r\n"
+        "Content-Length: 38\r\n"
+        "\r\n"
+        "GET /b HTTP/1.1\r\n"
+        "Host: a\r\n"
+        "Extra: x\r\n"
+        "\r\n"
+        "GET /a HTTP/1.1\r\n"
+        "Host: a\r\n"
+        "Connection: close\r\n"
+        "\r\n");
+    const StringRef chunkedRequests(
+        "POST /a HTTP/1.1\r\n"
+        "Host: a\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "1c\r\n"
+        "GET /b HTTP/1.1\r\n"
+        "Host: a\r\n\r\n"
+        "\r\n"
+        "0\r\n"
+        "\r\n"
+        "GET /a HTTP/1.1\r\n"
+        "Host: a\r\n"
+        "Connection: close\r\n"
+        "\r\n");
+    const StringRef expectedResponse(
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n"
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n");
+
+    if (!runIgnoringBodies(contentLengthRequests, 2, expectedResponse)) {
+        testf("Content-Length body was not skipped");
+        return false;
+    }
+    if (!runIgnoringBodies(chunkedRequests, 2, expectedResponse)) {
+        testf("Chunked body was not skipped");
+        return false;
+    }
+
+    // A body that can't be read past ends the connection
+    const StringRef badChunkedRequests(
+        "POST /a HTTP/1.1\r\n"
+        "Host: a\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "zz\r\n"
+        "GET /b HTTP/1.1\r\n"
+        "Host: a\r\n"
+        "\r\n");
+    if (!runIgnoringBodies(badChunkedRequests, 1,
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n")) {
+        testf("Connection was kept after a bad body");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests the body of a request with no handler is skipped too
+bool test_httpconnection_unread_body_no_handler() {
+    const StringRef requests(
+        "POST /missing HTTP/1.1\r\n"
+        "Host: a\r\n"
+        "Content-Length: 19\r\n"
+        "\r\n"
+        "GET /b HTTP/1.1\r\n"
+        "\r\n"
+        "GET /a HTTP/1.1\r\n"
+        "Host: a\r\n"
+        "Connection: close\r\n"
+        "\r\n");
+
+    uint32_t requestCount = 0;
+    RouteTable routeTable;
+    routeTable.addHandler("/a", [&requestCount](HttpRequest&, HttpResponse& response) {
+        requestCount++;
+        response.setStatus(200, "OK");
+        response.addHeader("Content-Length", "0");
+    });
+    routeTable.addHandler("/b", [&requestCount](HttpRequest&, HttpResponse& response) {
+        requestCount += 100;
+        response.setStatus(200, "OK");
+        response.addHeader("Content-Length", "0");
+    });
+
+    ConnectionTestSource streamSource(requests);
+    BufferedReader bufReader;
+    bufReader.init(&streamSource, 1024);
+    HttpConnection connection(&streamSource, bufReader, &routeTable, nullptr);
+    connection.run();
+
+    if (requestCount != 1) {
+        testf("Expected only /a to be handled, count was %u", requestCount);
+        return false;
+    }
+    if (!streamSource.getData().startsWith("HTTP/1.1 404 ")) {
+        testf("Expected a 404 for the missing handler");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,344 @@
+
+#include "unit/http/HttpResponseImpl_test.h"
+#include "unit/UnitTest.h"
+
+#include "cupcake/internal/http/HttpResponseImpl.h"
+#include "cupcake/internal/http/StreamSource.h"
+#include "cupcake/internal/text/String.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+using namespace Cupcake;
+
+class ResponseTestSource : public StreamSource {
+public:
+    ResponseTestSource() :
+        writeCount(0)
+    {}
+
+    std::tuple<StreamSource*, HttpError> accept() override {
+        return std::make_tuple(nullptr, HttpError::Ok);
+    }
+    std::tuple<uint32_t, HttpError> read(char* buffer, uint32_t bufferLen) override {
+        return std::make_tuple(0, HttpError::Ok);
+    }
+    std::tuple<uint32_t, HttpError> readv(INet::IoBuffer* buffers, uint32_t bufferCount) override {
+        return std::make_tuple(0, HttpError::Ok);
+    }
+    HttpError write(const char* buffer, uint32_t bufferLen) override {
+        writeCount++;
+        std::copy_n(buffer, bufferLen, std::back_inserter(dataWritten));
+        return HttpError::Ok;
+    }
+    HttpError writev(const INet::IoBuffer* buffers, uint32_t bufferCount) override {
+        writeCount++;
+        for (uint32_t i = 0; i < bufferCount; i++) {
+            const INet::IoBuffer& bufferIter = buffers[i];
+            std::copy_n(bufferIter.buffer, bufferIter.bufferLen, std::back_inserter(dataWritten));
+        }
+        return HttpError::Ok;
+    }
+    HttpError close() override {
+        return HttpError::Ok;
+    }
+
+    StringRef getData() const {
+        return dataWritten.empty() ? StringRef("", 0) : StringRef(&dataWritten[0], dataWritten.size());
+    }
+
+    std::vector<char> dataWritten;
+    uint32_t writeCount;
+};
+
+// Tests the headers go out in the same write as a Content-Length body
+bool test_httpresponseimpl_corked_content_length() {
+    ResponseTestSource streamSource;
+    HttpResponseImpl response(HttpVersion::Http1_1, &streamSource);
+    response.setStatus(200, "OK");
+    response.addHeader("Content-Length", "5");
+
+    HttpOutputStream* outputStream;
+    HttpError err;
+    std::tie(outputStream, err) = response.getOutputStream();
+    if (err != HttpError::Ok) {
+        testf("Failed to get output stream with: %d", err);
+        return false;
+    }
+    if (streamSource.writeCount != 0) {
+        testf("Headers were written before the body");
+        return false;
+    }
+
+    err = outputStream->write("hello", 5);
+    if (err != HttpError::Ok) {
+        testf("Write failed with: %d", err);
+        return false;
+    }
+    err = response.close();
+    if (err != HttpError::Ok) {
+        testf("Close failed with: %d", err);
+        return false;
+    }
+
+    const StringRef expected =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "hello";
+    if (streamSource.getData() != expected || streamSource.writeCount != 1) {
+        testf("Expected a single write of the response, got %u writes", streamSource.writeCount);
+        return false;
+    }
+
+    return true;
+}
+
+// Tests a small chunked response, terminator included, is a single write
+bool test_httpresponseimpl_corked_chunked() {
+    ResponseTestSource streamSource;
+    HttpResponseImpl response(HttpVersion::Http1_1, &streamSource);
+    response.setStatus(200, "OK");
+
+    HttpOutputStream* outputStream;
+    HttpError err;
+    std::tie(outputStream, err) = response.getOutputStream();
+    if (err != HttpError::Ok) {
+        testf("Failed to get output stream with: %d", err);
+        return false;
+    }
+    outputStream->write("{\"a\":", 5);
+    outputStream->write("1}", 2);
+
+    // The connection closes the response if the handler doesn't
+    err = response.close();
+    if (err != HttpError::Ok) {
+        testf("Close failed with: %d", err);
+        return false;
+    }
+
+    const StringRef expected =
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "7\r\n"
+        "{\"a\":1}\r\n"
+        "0\r\n"
+        "\r\n";
+    if (streamSource.getData() != expected || streamSource.writeCount != 1) {
+        testf("Expected a single write of the response, got %u writes", streamSource.writeCount);
+        return false;
+    }
+
+    return true;
+}
+
+// Tests responses without a body still get their headers sent on close
+bool test_httpresponseimpl_headers_only() {
+    ResponseTestSource streamSource;
+    HttpResponseImpl response(HttpVersion::Http1_1, &streamSource);
+    response.setStatus(204, "No Content");
+
+    HttpError err = response.close();
+    if (err != HttpError::Ok) {
+        testf("Close failed with: %d", err);
+        return false;
+    }
+    if (streamSource.getData() != "HTTP/1.1 204 No Content\r\n\r\n" || streamSource.writeCount != 1) {
+        testf("Headers were not written on close");
+        return false;
+    }
+
+    // Closing twice is harmless
+    err = response.close();
+    if (err != HttpError::Ok || streamSource.writeCount != 1) {
+        testf("Second close wrote data");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests flushing sends the headers before any body has been written
+bool test_httpresponseimpl_flush() {
+    ResponseTestSource streamSource;
+    HttpResponseImpl response(HttpVersion::Http1_1, &streamSource);
+    response.setStatus(200, "OK");
+    response.addHeader("Content-Length", "2");
+
+    HttpOutputStream* outputStream;
+    HttpError err;
+    std::tie(outputStream, err) = response.getOutputStream();
+    if (err != HttpError::Ok) {
+        testf("Failed to get output stream with: %d", err);
+        return false;
+    }
+
+    err = outputStream->flush();
+    if (err != HttpError::Ok) {
+        testf("Flush failed with: %d", err);
+        return false;
+    }
+    if (streamSource.getData() != "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n") {
+        testf("Flush did not send the headers");
+        return false;
+    }
+
+    outputStream->write("ok", 2);
+    response.close();
+    if (streamSource.getData() != "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok" || streamSource.writeCount != 2) {
+        testf("Did not write expected data");
+        return false;
+    }
+
+    return true;
+}
+
+static
+String makeBody(size_t len) {
+    String body;
+    for (size_t i = 0; i < len; i++) {
+        char c = (char)('a' + (i % 26));
+        body += StringRef(&c, 1);
+    }
+    return body;
+}
+
+// Tests an HTTP1.0 response without a length is buffered and sent in one write
+bool test_httpresponseimpl_buffered_length() {
+    ResponseTestSource streamSource;
+    HttpResponseImpl response(HttpVersion::Http1_0, &streamSource);
+    response.setStatus(200, "OK");
+
+    HttpOutputStream* outputStream;
+    HttpError err;
+    std::tie(outputStream, err) = response.getOutputStream();
+    if (err != HttpError::Ok) {
+        testf("Failed to get output stream with: %d", err);
+        return false;
+    }
+
+    // Spans a few of the internal blocks
+    String body = makeBody(10000);
+    for (size_t i = 0; i < body.length(); i += 1000) {
+        err = outputStream->write(body.data() + i, 1000);
+        if (err != HttpError::Ok) {
+            testf("Write failed with: %d", err);
+            return false;
+        }
+    }
+    if (streamSource.writeCount != 0) {
+        testf("Data written before the length was known");
+        return false;
+    }
+
+    err = response.close();
+    if (err != HttpError::Ok) {
+        testf("Close failed with: %d", err);
+        return false;
+    }
+
+    String expected = "HTTP/1.0 200 OK\r\nContent-Length: 10000\r\n\r\n";
+    expected += body;
+    if (streamSource.getData() != expected || streamSource.writeCount != 1) {
+        testf("Expected a single write of the response, got %u writes", streamSource.writeCount);
+        return false;
+    }
+    if (response.isCloseDelimited()) {
+        testf("Response should not need the connection closed");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests a large HTTP1.0 response without a length streams until connection close
+bool test_httpresponseimpl_buffered_spill() {
+    ResponseTestSource streamSource;
+    HttpResponseImpl response(HttpVersion::Http1_0, &streamSource);
+    response.setStatus(200, "OK");
+
+    HttpOutputStream* outputStream;
+    HttpError err;
+    std::tie(outputStream, err) = response.getOutputStream();
+    if (err != HttpError::Ok) {
+        testf("Failed to get output stream with: %d", err);
+        return false;
+    }
+
+    String body = makeBody(200 * 1024);
+    for (size_t i = 0; i < body.length(); i += 1024) {
+        err = outputStream->write(body.data() + i, 1024);
+        if (err != HttpError::Ok) {
+            testf("Write failed with: %d", err);
+            return false;
+        }
+    }
+    err = response.close();
+    if (err != HttpError::Ok) {
+        testf("Close failed with: %d", err);
+        return false;
+    }
+
+    String expected = "HTTP/1.0 200 OK\r\nConnection: close\r\n\r\n";
+    expected += body;
+    if (streamSource.getData() != expected) {
+        testf("Did not write expected data");
+        return false;
+    }
+    if (!response.isCloseDelimited()) {
+        testf("Response should need the connection closed");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests headers added after the output stream is taken are ignored, rather
+// than moving the strings the corked headers point at
+bool test_httpresponseimpl_late_header() {
+    ResponseTestSource streamSource;
+    HttpResponseImpl response(HttpVersion::Http1_1, &streamSource);
+    response.setStatus(200, "OK");
+
+    HttpOutputStream* outputStream;
+    HttpError err;
+    std::tie(outputStream, err) = response.getOutputStream();
+    if (err != HttpError::Ok) {
+        testf("Failed to get output stream with: %d", err);
+        return false;
+    }
+
+    // Enough to have grown the header vectors
+    for (int i = 0; i < 20; i++) {
+        response.addHeader("X-Late-Header-With-A-Long-Name", "some value that is not short");
+    }
+    response.setStatus(500, "Internal Server Error");
+
+    err = outputStream->write("hello", 5);
+    if (err != HttpError::Ok) {
+        testf("Write failed with: %d", err);
+        return false;
+    }
+    err = response.close();
+    if (err != HttpError::Ok) {
+        testf("Close failed with: %d", err);
+        return false;
+    }
+
+    const StringRef expected =
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5\r\n"
+        "hello\r\n"
+        "0\r\n"
+        "\r\n";
+    if (streamSource.getData() != expected) {
+        testf("Late headers changed the response");
+        return false;
+    }
+
+    return true;
+}
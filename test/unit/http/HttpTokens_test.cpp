@@ -0,0 +1,175 @@
+
+#include "unit/UnitTest.h"
+#include "unit/http/HttpTokens_test.h"
+
+#include "cupcake/internal/http/HttpTokens.h"
+#include "cupcake/internal/http/RequestParser.h"
+
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Cupcake;
+
+bool test_httptokens_methods() {
+    const std::vector<std::tuple<StringRef, HttpMethod>> known = {
+        std::make_tuple("GET", HttpMethod::Get),
+        std::make_tuple("HEAD", HttpMethod::Head),
+        std::make_tuple("POST", HttpMethod::Post),
+        std::make_tuple("PUT", HttpMethod::Put),
+        std::make_tuple("PATCH", HttpMethod::Patch),
+        std::make_tuple("DELETE", HttpMethod::Delete),
+        std::make_tuple("TRACE", HttpMethod::Trace),
+        std::make_tuple("OPTIONS", HttpMethod::Options),
+        std::make_tuple("CONNECT", HttpMethod::Connect),
+    };
+
+    for (const auto& test : known) {
+        HttpMethod method;
+        bool found;
+        std::tie(method, found) = HttpTokens::lookupMethod(std::get<0>(test));
+        if (!found || method != std::get<1>(test)) {
+            testf("Failed to look up method %s", std::get<0>(test).data());
+            return false;
+        }
+    }
+
+    // Methods are case sensitive
+    const std::vector<StringRef> unknown = {"", "get", "GETS", "GE", "BREW", "CONNECTS", "OPTION"};
+    for (StringRef test : unknown) {
+        bool found;
+        std::tie(std::ignore, found) = HttpTokens::lookupMethod(test);
+        if (found) {
+            testf("Unexpectedly found a method for: %.*s", (int)test.length(), test.data());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool test_httptokens_headers() {
+    for (uint32_t i = 1; i < (uint32_t)HttpHeader::Count; i++) {
+        HttpHeader header = (HttpHeader)i;
+        StringRef name = HttpTokens::getHeaderName(header);
+        if (name.length() == 0) {
+            testf("No name for header %d", i);
+            return false;
+        }
+
+        if (HttpTokens::lookupHeader(name) != header) {
+            testf("Failed to look up %.*s", (int)name.length(), name.data());
+            return false;
+        }
+
+        // Case is ignored
+        std::string lower(name.data(), name.length());
+        std::string upper(lower);
+        for (size_t j = 0; j < lower.length(); j++) {
+            lower[j] = (char)std::tolower(lower[j]);
+            upper[j] = (char)std::toupper(upper[j]);
+        }
+        if (HttpTokens::lookupHeader(StringRef(lower.data(), lower.length())) != header ||
+            HttpTokens::lookupHeader(StringRef(upper.data(), upper.length())) != header) {
+            testf("Failed to look up %.*s ignoring case", (int)name.length(), name.data());
+            return false;
+        }
+    }
+
+    const std::vector<StringRef> unknown = {"", "X-Custom", "Hosts", "Hos", "Content_Length", "Content-Lengti"};
+    for (StringRef test : unknown) {
+        if (HttpTokens::lookupHeader(test) != HttpHeader::Unknown) {
+            testf("Unexpectedly found a header for: %.*s", (int)test.length(), test.data());
+            return false;
+        }
+    }
+
+    if (HttpTokens::getHeaderName(HttpHeader::Unknown).length() != 0) {
+        testf("Unknown header has a name");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_httptokens_parser_headers() {
+    const char* request =
+        "GET / HTTP/1.1\r\n"
+        "host: localhost\r\n"
+        "X-Custom: 1\r\n"
+        "CONTENT-LENGTH : 0\r\n"
+        " folded\r\n"
+        "\r\n";
+    const std::vector<HttpHeader> expected = {
+        HttpHeader::Host,
+        HttpHeader::Unknown,
+        HttpHeader::ContentLength,
+        HttpHeader::Unknown,
+    };
+
+    RequestParser parser(64, 256);
+    if (parser.parse(request, std::strlen(request)) != RequestParser::Result::Complete) {
+        testf("Failed to parse request");
+        return false;
+    }
+    if (parser.getHeaderCount() != expected.size()) {
+        testf("Expected %d headers, got %d", (int)expected.size(), (int)parser.getHeaderCount());
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); i++) {
+        if (parser.getHeader(i) != expected[i]) {
+            testf("Header %d not recognized as expected", (int)i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool test_httptokens_header_name_chars() {
+    // Worked out at compile time
+    static_assert(HttpTokens::canonicalHeaderChar('A') == 'a' && HttpTokens::canonicalHeaderChar(':') == '\0',
+                  "Header name chars not constexpr");
+
+    const char* symbols = "!#$%&'*+-.^_`|~";
+    for (int c = 0; c < 256; c++) {
+        char expected = '\0';
+        if (c < 0x80 && (std::isalnum(c) || (c != 0 && std::strchr(symbols, c) != nullptr))) {
+            expected = (char)std::tolower(c);
+        }
+        if (HttpTokens::canonicalHeaderChar((char)c) != expected) {
+            testf("Wrong canonical char for byte %d", c);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 1; i < (uint32_t)HttpHeader::Count; i++) {
+        HttpHeader header = (HttpHeader)i;
+        StringRef name = HttpTokens::getHeaderName(header);
+        StringRef lowercase = HttpTokens::getLowercaseHeaderName(header);
+
+        std::string expected(name.data(), name.length());
+        for (char& c : expected) {
+            c = (char)std::tolower(c);
+        }
+        if (!lowercase.equals(StringRef(expected.data(), expected.length())) ||
+            lowercase.data()[lowercase.length()] != '\0') {
+            testf("Wrong lowercase name for %.*s", (int)name.length(), name.data());
+            return false;
+        }
+        // The same copy every time
+        if (HttpTokens::getLowercaseHeaderName(header).data() != lowercase.data() ||
+            HttpTokens::lookupHeader(lowercase) != header) {
+            testf("Lowercase name for %.*s not interned", (int)name.length(), name.data());
+            return false;
+        }
+    }
+
+    if (HttpTokens::getLowercaseHeaderName(HttpHeader::Unknown).length() != 0) {
+        testf("Unknown header has a lowercase name");
+        return false;
+    }
+
+    return true;
+}
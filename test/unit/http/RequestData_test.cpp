@@ -0,0 +1,225 @@
+
+#include "unit/UnitTest.h"
+#include "unit/http/RequestData_test.h"
+
+#include "cupcake/internal/http/HttpTokens.h"
+#include "cupcake/internal/http/RequestData.h"
+#include "cupcake/internal/text/Strconv.h"
+
+#include <vector>
+
+using namespace Cupcake;
+
+static
+void addHeader(RequestData& requestData, const StringRef name, const StringRef value) {
+    requestData.addHeaderName(name);
+    requestData.addHeaderValue(value);
+}
+
+bool test_requestdata_find_header() {
+    RequestData requestData;
+    addHeader(requestData, "Host", "localhost");
+    addHeader(requestData, "x-custom", "custom");
+    addHeader(requestData, "ACCEPT-ENCODING", "gzip");
+
+    if (requestData.findHeader("host") != 0 ||
+        requestData.findHeader("X-Custom") != 1 ||
+        requestData.findHeader("Accept-Encoding") != 2) {
+        testf("Failed to find headers by name");
+        return false;
+    }
+    if (requestData.findHeader(HttpHeader::Host) != 0 ||
+        requestData.findHeader(HttpHeader::AcceptEncoding) != 2) {
+        testf("Failed to find known headers");
+        return false;
+    }
+    if (requestData.findHeader("X-Missing") != -1 ||
+        requestData.findHeader(HttpHeader::ContentLength) != -1 ||
+        requestData.findHeader(HttpHeader::Unknown) != -1) {
+        testf("Found a header that was never added");
+        return false;
+    }
+
+    // Nothing survives a reset
+    requestData.reset();
+    addHeader(requestData, "X-Custom", "again");
+    if (requestData.findHeader("Host") != -1 ||
+        requestData.findHeader(HttpHeader::Host) != -1 ||
+        requestData.findHeader("x-custom") != 0) {
+        testf("Index not cleared on reset");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_requestdata_repeated_headers() {
+    RequestData requestData;
+    addHeader(requestData, "Cookie", "a=1");
+    addHeader(requestData, "Host", "localhost");
+    addHeader(requestData, "cookie", "b=2");
+    addHeader(requestData, "X-Other", "");
+    addHeader(requestData, "COOKIE", "c=3");
+
+    const std::vector<StringRef> expected = {"a=1", "b=2", "c=3"};
+    size_t found = 0;
+    for (ptrdiff_t i = requestData.findHeader(HttpHeader::Cookie); i != -1; i = requestData.findNextHeader(i)) {
+        if (found == expected.size() || !requestData.getHeaderValue(i).equals(expected[found])) {
+            testf("Unexpected value for repeated header %d", (int)found);
+            return false;
+        }
+        found++;
+    }
+    if (found != expected.size()) {
+        testf("Expected %d repeated headers, found %d", (int)expected.size(), (int)found);
+        return false;
+    }
+
+    if (requestData.findNextHeader(1) != -1) {
+        testf("Header without repeats had a next header");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_requestdata_many_headers() {
+    // Enough distinct names to grow the index a few times
+    RequestData requestData;
+    std::vector<String> names;
+    for (uint32_t i = 0; i < 500; i++) {
+        char numBuffer[16];
+        size_t numLen = Strconv::uint32ToStr(i, numBuffer, sizeof(numBuffer));
+        String name("X-Header-");
+        name.append(StringRef(numBuffer, numLen));
+        names.push_back(name);
+        addHeader(requestData, name, name);
+    }
+
+    for (uint32_t i = 0; i < names.size(); i++) {
+        if (requestData.findHeader(names[i]) != (ptrdiff_t)i) {
+            testf("Failed to find header %d after growing", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool test_requestdata_lowercase_names() {
+    RequestData requestData;
+    addHeader(requestData, "Content-TYPE", "text/plain");
+    addHeader(requestData, "X-Custom-Header", "1");
+    addHeader(requestData, "x-custom-HEADER", "2");
+    addHeader(requestData, "X-A-Much-Longer-Custom-Header-Name-Than-Fits-In-A-Short-String-Or-One-Chunk", "3");
+    addHeader(requestData, ":Authority", "localhost");
+
+    const std::vector<StringRef> expected = {
+        "content-type", "x-custom-header", "x-custom-header",
+        "x-a-much-longer-custom-header-name-than-fits-in-a-short-string-or-one-chunk", ":authority"
+    };
+    for (size_t i = 0; i < expected.size(); i++) {
+        if (!requestData.getHeaderName(i).equals(expected[i])) {
+            testf("Header %d not lowercased", (int)i);
+            return false;
+        }
+    }
+
+    // Known names are the one shared copy
+    if (requestData.getHeaderName(0).data() != HttpTokens::getLowercaseHeaderName(HttpHeader::ContentType).data()) {
+        testf("Known header name not interned");
+        return false;
+    }
+
+    if (requestData.findHeader("x-Custom-header") != 1 || requestData.findNextHeader(1) != 2 ||
+        requestData.findHeader("CONTENT-type") != 0 || requestData.findHeader(":authority") != 4 ||
+        requestData.findHeader("X-A-MUCH-LONGER-CUSTOM-HEADER-NAME-THAN-FITS-IN-A-SHORT-STRING-OR-ONE-CHUNK") != 3) {
+        testf("Failed to find lowercased headers");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_requestdata_url() {
+    struct UrlTest {
+        const char* url;
+        const char* path; // Null if the URL should be rejected
+        const char* query;
+    };
+
+    const UrlTest tests[] = {
+        {"/a/b?x=1", "/a/b", "x=1"},
+        {"/a/./b/../c#frag", "/a/c", ""},
+        {"/a%2Fb/%2e%2E/c", "/a/c", ""},
+        {"/files/my%20file.txt?v=%20", "/files/my file.txt", "v=%20"},
+        {"/%2e%2e/%2e%2e/etc/passwd", "/etc/passwd", ""},
+        {"http://example.com/x/../y?q", "/y", "q"},
+        {"/bad%zzescape", nullptr, ""},
+        {"/nul%00byte", nullptr, ""},
+    };
+
+    RequestData requestData;
+    for (const UrlTest& test : tests) {
+        requestData.reset();
+        bool valid = requestData.setUrl(test.url);
+        if (!test.path) {
+            if (valid) {
+                testf("Accepted bad URL %s", test.url);
+                return false;
+            }
+            continue;
+        }
+
+        if (!valid || !requestData.getUrl().equals(test.url) || !requestData.getPath().equals(test.path) ||
+            !requestData.getQuery().equals(test.query)) {
+            testf("Bad split of %s: %.*s", test.url, (int)requestData.getPath().length(),
+                  requestData.getPath().data());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool test_requestdata_query() {
+    RequestData requestData;
+    requestData.setUrl("/search?q=hello+world&&lang=en&flag&empty=&q=%26more&bad=%zz&x%3Dy=1");
+
+    const std::vector<std::tuple<StringRef, StringRef>> expected = {
+        std::make_tuple("q", "hello world"),
+        std::make_tuple("lang", "en"),
+        std::make_tuple("flag", ""),
+        std::make_tuple("empty", ""),
+        std::make_tuple("q", "&more"),
+        std::make_tuple("x=y", "1"),
+    };
+
+    if (requestData.getQueryParamCount() != expected.size()) {
+        testf("Expected %d query params, got %d", (int)expected.size(), (int)requestData.getQueryParamCount());
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); i++) {
+        if (!requestData.getQueryParamName(i).equals(std::get<0>(expected[i])) ||
+            !requestData.getQueryParamValue(i).equals(std::get<1>(expected[i]))) {
+            testf("Query param %d was wrong", (int)i);
+            return false;
+        }
+    }
+
+    if (requestData.findQueryParam("q") != 0 || requestData.findQueryParam("flag") != 2 ||
+        requestData.findQueryParam("bad") != -1 || requestData.findQueryParam("Q") != -1) {
+        testf("Failed to find query params");
+        return false;
+    }
+
+    // A new URL replaces them
+    requestData.reset();
+    requestData.setUrl("/other?only=1");
+    if (requestData.getQueryParamCount() != 1 || requestData.findQueryParam("q") != -1) {
+        testf("Query params not reset");
+        return false;
+    }
+
+    return true;
+}
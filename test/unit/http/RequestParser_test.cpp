@@ -0,0 +1,275 @@
+
+#include "unit/UnitTest.h"
+#include "unit/http/RequestParser_test.h"
+
+#include "cupcake/internal/http/RequestParser.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace Cupcake;
+
+#define TEST_URL_LIMIT 64
+#define TEST_HEAD_LIMIT 256
+
+static
+bool checkHeader(const RequestParser& parser, const char* data, size_t index,
+                 const StringRef name, const StringRef value) {
+    if (index >= parser.getHeaderCount()) {
+        testf("Expected at least %d headers, got %d", (int)index + 1, (int)parser.getHeaderCount());
+        return false;
+    }
+    if (!parser.getHeaderName(data, index).equals(name)) {
+        testf("Header %d did not have the expected name", (int)index);
+        return false;
+    }
+    if (!parser.getHeaderValue(data, index).equals(value)) {
+        testf("Header %d did not have the expected value", (int)index);
+        return false;
+    }
+    return true;
+}
+
+bool test_requestparser_basic() {
+    const char* request =
+        "POST /upload?a=b HTTP/1.0\r\n"
+        "Host: localhost\r\n"
+        "Content-Length :  5 \t\r\n"
+        "X-Empty:\r\n"
+        "\r\n"
+        "hello";
+
+    RequestParser parser(TEST_URL_LIMIT, TEST_HEAD_LIMIT);
+    RequestParser::Result res = parser.parse(request, std::strlen(request));
+    if (res != RequestParser::Result::Complete) {
+        testf("Expected complete request, got %d", (int)res);
+        return false;
+    }
+
+    if (parser.getMethod() != HttpMethod::Post) {
+        testf("Did not parse the method");
+        return false;
+    }
+    if (parser.getVersion() != HttpVersion::Http1_0) {
+        testf("Did not parse the version");
+        return false;
+    }
+    if (!parser.getUrl(request).equals("/upload?a=b")) {
+        testf("Did not parse the URL");
+        return false;
+    }
+    if (parser.getHeaderCount() != 3) {
+        testf("Expected 3 headers, got %d", (int)parser.getHeaderCount());
+        return false;
+    }
+    if (!checkHeader(parser, request, 0, "Host", "localhost") ||
+        !checkHeader(parser, request, 1, "Content-Length", "5") ||
+        !checkHeader(parser, request, 2, "X-Empty", "")) {
+        return false;
+    }
+
+    // The body is left alone
+    if (parser.getHeadLength() != std::strlen(request) - 5) {
+        testf("Head length did not stop at the body");
+        return false;
+    }
+
+    // Can be reused
+    parser.reset();
+    const char* second = "GET / HTTP/1.1\r\n\r\n";
+    res = parser.parse(second, std::strlen(second));
+    if (res != RequestParser::Result::Complete || parser.getHeaderCount() != 0 ||
+        parser.getMethod() != HttpMethod::Get || parser.getVersion() != HttpVersion::Http1_1) {
+        testf("Failed to parse a second request after reset");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_requestparser_byte_at_a_time() {
+    const char* request =
+        "GET /index.html HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Accept: */*\r\n"
+        "\r\n";
+    size_t requestLen = std::strlen(request);
+
+    // Every call gets a fresh copy at a new address, as happens when the read
+    // buffer is compacted or grown
+    RequestParser parser(TEST_URL_LIMIT, TEST_HEAD_LIMIT);
+    std::vector<char> received;
+    RequestParser::Result res = RequestParser::Result::Incomplete;
+    for (size_t i = 0; i < requestLen; i++) {
+        if (res != RequestParser::Result::Incomplete) {
+            testf("Parser finished early at byte %d with %d", (int)i, (int)res);
+            return false;
+        }
+        received.push_back(request[i]);
+        std::vector<char> moved(received);
+        res = parser.parse(moved.data(), moved.size());
+    }
+
+    if (res != RequestParser::Result::Complete) {
+        testf("Expected complete request, got %d", (int)res);
+        return false;
+    }
+    if (!parser.getUrl(received.data()).equals("/index.html")) {
+        testf("Did not parse the URL");
+        return false;
+    }
+    if (parser.getHeaderCount() != 2 ||
+        !checkHeader(parser, received.data(), 0, "Host", "localhost") ||
+        !checkHeader(parser, received.data(), 1, "Accept", "*/*")) {
+        return false;
+    }
+    if (parser.getHeadLength() != requestLen) {
+        testf("Head length did not match request");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_requestparser_continuation() {
+    const char* request =
+        "GET / HTTP/1.1\r\n"
+        "X-Folded: one\r\n"
+        " \ttwo \r\n"
+        "Host: localhost\r\n"
+        "\r\n";
+
+    RequestParser parser(TEST_URL_LIMIT, TEST_HEAD_LIMIT);
+    if (parser.parse(request, std::strlen(request)) != RequestParser::Result::Complete) {
+        testf("Failed to parse request with a continuation line");
+        return false;
+    }
+    if (parser.getHeaderCount() != 3) {
+        testf("Expected 3 header lines, got %d", (int)parser.getHeaderCount());
+        return false;
+    }
+    if (parser.isContinuation(0) || !parser.isContinuation(1) || parser.isContinuation(2)) {
+        testf("Continuation line not flagged");
+        return false;
+    }
+    if (!parser.getHeaderValue(request, 1).equals("two")) {
+        testf("Continuation value not trimmed");
+        return false;
+    }
+
+    // Nothing to continue
+    parser.reset();
+    const char* bad = "GET / HTTP/1.1\r\n two\r\n\r\n";
+    if (parser.parse(bad, std::strlen(bad)) != RequestParser::Result::BadRequest) {
+        testf("Accepted continuation line without a header");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_requestparser_line_endings() {
+    // Bare LF line endings, with empty lines before the request line
+    const char* request =
+        "\r\n\n"
+        "HEAD /a HTTP/1.1\n"
+        "Host: localhost\n"
+        "\n";
+
+    RequestParser parser(TEST_URL_LIMIT, TEST_HEAD_LIMIT);
+    if (parser.parse(request, std::strlen(request)) != RequestParser::Result::Complete) {
+        testf("Failed to parse request with bare LF line endings");
+        return false;
+    }
+    if (parser.getMethod() != HttpMethod::Head || !parser.getUrl(request).equals("/a")) {
+        testf("Did not parse the request line");
+        return false;
+    }
+    if (!checkHeader(parser, request, 0, "Host", "localhost")) {
+        return false;
+    }
+    if (parser.getHeadLength() != std::strlen(request)) {
+        testf("Head length did not match request");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_requestparser_errors() {
+    struct ErrorCase {
+        const char* request;
+        RequestParser::Result expected;
+    };
+    const std::vector<ErrorCase> cases = {
+        {"BREW / HTTP/1.1\r\n\r\n", RequestParser::Result::UnknownMethod},
+        {"GET / HTTP/2.0\r\n\r\n", RequestParser::Result::UnsupportedVersion},
+        {"GET / HTCPCP/1.0\r\n\r\n", RequestParser::Result::BadRequest},
+        {"GET  HTTP/1.1\r\n\r\n", RequestParser::Result::BadRequest},
+        {"GET /\r\n\r\n", RequestParser::Result::BadRequest},
+        {"GET / HTTP/1.1\rX\n\r\n", RequestParser::Result::BadRequest},
+        {"GET / HTTP/1.1\r\nNoColon\r\n\r\n", RequestParser::Result::BadRequest},
+        {"GET / HTTP/1.1\r\n: value\r\n\r\n", RequestParser::Result::BadRequest},
+        {"GET / HTTP/1.1\r\nBad Name: value\r\n\r\n", RequestParser::Result::BadRequest},
+        {"GET / HTTP/1.1\r\nBad\"Name: value\r\n\r\n", RequestParser::Result::BadRequest},
+        {"GET / HTTP/1.1\r\nBad(Name): value\r\n\r\n", RequestParser::Result::BadRequest},
+        {"GET / HTTP/1.1\r\n@Host: value\r\n\r\n", RequestParser::Result::BadRequest},
+        {"GET / HTTP/1.1\r\nX-Caf\xc3\xa9: value\r\n\r\n", RequestParser::Result::BadRequest},
+        {"GET / HTTP/1.1\r\nX-\x01: value\r\n\r\n", RequestParser::Result::BadRequest},
+        {"GET / HTTP/1.1\r\nHost: a\r\n\rX", RequestParser::Result::BadRequest},
+    };
+
+    for (const ErrorCase& errorCase : cases) {
+        RequestParser parser(TEST_URL_LIMIT, TEST_HEAD_LIMIT);
+        RequestParser::Result res = parser.parse(errorCase.request, std::strlen(errorCase.request));
+        if (res != errorCase.expected) {
+            testf("Expected %d, got %d for: %s", (int)errorCase.expected, (int)res, errorCase.request);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool test_requestparser_limits() {
+    // URL over the limit, even before the rest of the line has arrived
+    std::vector<char> longUrl;
+    const char* method = "GET /";
+    longUrl.insert(longUrl.end(), method, method + std::strlen(method));
+    longUrl.insert(longUrl.end(), TEST_URL_LIMIT, 'a');
+
+    RequestParser parser(TEST_URL_LIMIT, TEST_HEAD_LIMIT);
+    RequestParser::Result res = parser.parse(longUrl.data(), longUrl.size());
+    if (res != RequestParser::Result::UriTooLong) {
+        testf("Expected URI too long, got %d", (int)res);
+        return false;
+    }
+
+    // Head over the limit without an end in sight
+    std::vector<char> longHead;
+    const char* requestLine = "GET / HTTP/1.1\r\nX-Big: ";
+    longHead.insert(longHead.end(), requestLine, requestLine + std::strlen(requestLine));
+    longHead.insert(longHead.end(), TEST_HEAD_LIMIT, 'a');
+
+    parser.reset();
+    res = parser.parse(longHead.data(), longHead.size());
+    if (res != RequestParser::Result::HeadTooLarge) {
+        testf("Expected head too large, got %d", (int)res);
+        return false;
+    }
+
+    // A complete head followed by a lot of body is fine
+    std::vector<char> bigBody;
+    const char* head = "POST / HTTP/1.1\r\nHost: a\r\n\r\n";
+    bigBody.insert(bigBody.end(), head, head + std::strlen(head));
+    bigBody.insert(bigBody.end(), TEST_HEAD_LIMIT * 2, 'a');
+
+    parser.reset();
+    res = parser.parse(bigBody.data(), bigBody.size());
+    if (res != RequestParser::Result::Complete) {
+        testf("Body counted against head limit, got %d", (int)res);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,109 @@
+
+#include "unit/UnitTest.h"
+#include "unit/http/RouteTable_test.h"
+
+#include "cupcake/internal/http/RouteTable.h"
+
+using namespace Cupcake;
+
+static void emptyHandler(HttpRequest&, HttpResponse&) {}
+
+static uint32_t getAllowed(const RouteTable& routeTable, HttpMethod method, const StringRef path) {
+    RouteTable::Snapshot routes = routeTable.getSnapshot();
+    PathParams pathParams;
+    uint32_t allowedMethods;
+    std::tie(std::ignore, allowedMethods) = routes->getHandler(method, path, pathParams);
+    return allowedMethods;
+}
+
+#define METHOD_BIT(method) (1u << (uint32_t)HttpMethod::method)
+
+bool test_routetable_add_remove() {
+    RouteTable routeTable;
+    if (!routeTable.addHandler(HttpMethod::Get, "/users/{id}", emptyHandler) ||
+        !routeTable.addHandler(HttpMethod::Put, "/users/{id}", emptyHandler) ||
+        !routeTable.addHandler("/health", emptyHandler)) {
+        testf("Failed to add handlers");
+        return false;
+    }
+    if (getAllowed(routeTable, HttpMethod::Get, "/users/1") != (METHOD_BIT(Get) | METHOD_BIT(Put))) {
+        testf("Handlers not visible after adding");
+        return false;
+    }
+
+    // A failed add leaves the routes as they were
+    if (routeTable.addHandler(HttpMethod::Get, "/users/{id}", emptyHandler) ||
+        routeTable.addHandler(HttpMethod::Post, "/users/{userId}", emptyHandler)) {
+        testf("Added a conflicting handler");
+        return false;
+    }
+    if (getAllowed(routeTable, HttpMethod::Get, "/users/1") != (METHOD_BIT(Get) | METHOD_BIT(Put))) {
+        testf("Failed add changed the routes");
+        return false;
+    }
+
+    if (!routeTable.removeHandler(HttpMethod::Put, "/users/{id}") ||
+        getAllowed(routeTable, HttpMethod::Get, "/users/1") != METHOD_BIT(Get)) {
+        testf("Failed to remove one method");
+        return false;
+    }
+
+    // Removing one method of an all methods handler keeps the rest
+    if (!routeTable.removeHandler(HttpMethod::Delete, "/health") ||
+        getAllowed(routeTable, HttpMethod::Get, "/health") != (HandlerMap::ALL_METHODS & ~METHOD_BIT(Delete))) {
+        testf("Failed to remove one method of an all methods handler");
+        return false;
+    }
+
+    if (!routeTable.removeHandler("/users/{id}") || getAllowed(routeTable, HttpMethod::Get, "/users/1") != 0) {
+        testf("Failed to remove a path");
+        return false;
+    }
+    if (routeTable.removeHandler("/users/{id}") || routeTable.removeHandler(HttpMethod::Delete, "/health")) {
+        testf("Removed a handler that wasn't there");
+        return false;
+    }
+
+    // And the path can be used again, even with different names
+    if (!routeTable.addHandler(HttpMethod::Post, "/users/{userId}", emptyHandler) ||
+        getAllowed(routeTable, HttpMethod::Get, "/users/1") != METHOD_BIT(Post)) {
+        testf("Failed to add a handler to a removed path");
+        return false;
+    }
+    return true;
+}
+
+// A request keeps the routes it started with
+bool test_routetable_snapshot() {
+    RouteTable routeTable;
+    if (!routeTable.addHandler(HttpMethod::Get, "/flag", emptyHandler)) {
+        testf("Failed to add handler");
+        return false;
+    }
+
+    RouteTable::Snapshot before = routeTable.getSnapshot();
+    if (!routeTable.removeHandler("/flag") || !routeTable.addHandler(HttpMethod::Post, "/canary", emptyHandler)) {
+        testf("Failed to change routes");
+        return false;
+    }
+
+    PathParams pathParams;
+    const HttpHandler* handler;
+    std::tie(handler, std::ignore) = before->getHandler(HttpMethod::Get, "/flag", pathParams);
+    if (!handler) {
+        testf("Snapshot lost a removed handler");
+        return false;
+    }
+    std::tie(handler, std::ignore) = before->getHandler(HttpMethod::Post, "/canary", pathParams);
+    if (handler) {
+        testf("Snapshot saw a handler added after it");
+        return false;
+    }
+
+    if (getAllowed(routeTable, HttpMethod::Get, "/flag") != 0 ||
+        getAllowed(routeTable, HttpMethod::Post, "/canary") != METHOD_BIT(Post)) {
+        testf("New snapshot doesn't have the changes");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,362 @@
+
+#include "unit/http/StaticFileHandler_test.h"
+#include "unit/UnitTest.h"
+
+#include "cupcake/internal/http/HttpResponseImpl.h"
+#include "cupcake/internal/http/NullReader.h"
+#include "cupcake/internal/http/RequestData.h"
+#include "cupcake/internal/http/StaticFileHandler.h"
+#include "cupcake/internal/http/StreamSource.h"
+#include "cupcake/internal/text/String.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+using namespace Cupcake;
+
+#define TEST_FILE_NAME "StaticFileHandler_test.txt"
+#define TEST_FILE_CONTENT "Some static content"
+
+class StaticTestSource : public StreamSource {
+public:
+    StaticTestSource() {}
+
+    std::tuple<StreamSource*, HttpError> accept() override {
+        return std::make_tuple(nullptr, HttpError::Ok);
+    }
+    std::tuple<uint32_t, HttpError> read(char* buffer, uint32_t bufferLen) override {
+        return std::make_tuple(0, HttpError::Ok);
+    }
+    std::tuple<uint32_t, HttpError> readv(INet::IoBuffer* buffers, uint32_t bufferCount) override {
+        return std::make_tuple(0, HttpError::Ok);
+    }
+    HttpError write(const char* buffer, uint32_t bufferLen) override {
+        std::copy_n(buffer, bufferLen, std::back_inserter(dataWritten));
+        return HttpError::Ok;
+    }
+    HttpError writev(const INet::IoBuffer* buffers, uint32_t bufferCount) override {
+        for (uint32_t i = 0; i < bufferCount; i++) {
+            const INet::IoBuffer& bufferIter = buffers[i];
+            std::copy_n(bufferIter.buffer, bufferIter.bufferLen, std::back_inserter(dataWritten));
+        }
+        return HttpError::Ok;
+    }
+    HttpError close() override {
+        return HttpError::Ok;
+    }
+
+    StringRef getData() const {
+        return dataWritten.empty() ? StringRef("", 0) : StringRef(&dataWritten[0], dataWritten.size());
+    }
+
+    std::vector<char> dataWritten;
+};
+
+class StaticTestRequest : public HttpRequest {
+public:
+    StaticTestRequest(HttpMethod method, const StringRef url) :
+        method(method)
+    {
+        headerData.setUrl(url);
+    }
+
+    const HttpMethod getMethod() const override {
+        return method;
+    }
+    const StringRef getUrl() const override {
+        return headerData.getUrl();
+    }
+    const StringRef getPath() const override {
+        return headerData.getPath();
+    }
+    const StringRef getQuery() const override {
+        return headerData.getQuery();
+    }
+    uint32_t getQueryParamCount() const override {
+        return 0;
+    }
+    std::tuple<StringRef, StringRef> getQueryParam(uint32_t index) const override {
+        return std::make_tuple(StringRef(), StringRef());
+    }
+    std::tuple<StringRef, bool> getQueryParam(const StringRef name) const override {
+        return std::make_tuple(StringRef(), false);
+    }
+    uint32_t getHeaderCount() const override {
+        return (uint32_t)headerData.getHeaderCount();
+    }
+    std::tuple<StringRef, StringRef> getHeader(uint32_t index) const override {
+        return std::make_tuple(headerData.getHeaderName(index), headerData.getHeaderValue(index));
+    }
+    std::tuple<StringRef, bool> getHeader(const StringRef headerName) const override {
+        return getIndexedHeader(headerData.findHeader(headerName));
+    }
+    std::tuple<StringRef, bool> getHeader(HttpHeader header) const override {
+        return getIndexedHeader(headerData.findHeader(header));
+    }
+    ptrdiff_t findHeader(const StringRef headerName) const override {
+        return headerData.findHeader(headerName);
+    }
+    ptrdiff_t findHeader(HttpHeader header) const override {
+        return headerData.findHeader(header);
+    }
+    ptrdiff_t findNextHeader(uint32_t index) const override {
+        return headerData.findNextHeader(index);
+    }
+    uint32_t getPathParamCount() const override {
+        return 0;
+    }
+    std::tuple<StringRef, StringRef> getPathParam(uint32_t index) const override {
+        return std::make_tuple(StringRef(), StringRef());
+    }
+    std::tuple<StringRef, bool> getPathParam(const StringRef name) const override {
+        return std::make_tuple(StringRef(), false);
+    }
+    HttpInputStream& getInputStream() override {
+        return nullReader;
+    }
+
+    void addHeader(const StringRef name, const StringRef value) {
+        headerData.addHeaderName(name);
+        headerData.addHeaderValue(value);
+    }
+
+private:
+    std::tuple<StringRef, bool> getIndexedHeader(ptrdiff_t index) const {
+        if (index == -1) {
+            return std::make_tuple(StringRef(), false);
+        }
+        return std::make_tuple(headerData.getHeaderValue(index), true);
+    }
+
+    HttpMethod method;
+    RequestData headerData;
+    NullReader nullReader;
+};
+
+static
+bool writeTestFile(const char* name, const StringRef content) {
+    FILE* file = std::fopen(name, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool res = std::fwrite(content.data(), 1, content.length(), file) == content.length();
+    return (std::fclose(file) == 0) && res;
+}
+
+static
+bool writeTestFile() {
+    return writeTestFile(TEST_FILE_NAME, TEST_FILE_CONTENT);
+}
+
+static
+StringRef runHandler(StaticTestRequest& request, StaticTestSource& streamSource) {
+    std::shared_ptr<FileCache> fileCache(new FileCache());
+    fileCache->init(".");
+    StaticFileHandler handler("/static/", fileCache);
+    HttpResponseImpl response(HttpVersion::Http1_1, &streamSource);
+    handler(request, response);
+    response.close();
+    return streamSource.getData();
+}
+
+// Tests a file is served with its metadata headers and content
+bool test_staticfilehandler_basic() {
+    if (!writeTestFile()) {
+        testf("Failed to write test file");
+        return false;
+    }
+
+    StaticTestRequest request(HttpMethod::Get, "/static/" TEST_FILE_NAME "?cache=bust");
+    StaticTestSource streamSource;
+    const StringRef output = runHandler(request, streamSource);
+    std::remove(TEST_FILE_NAME);
+
+    if (!output.startsWith("HTTP/1.1 200 OK\r\n")) {
+        testf("Did not get 200 response");
+        return false;
+    }
+    if (output.indexOf("\r\nContent-Length: 19\r\n") == -1 ||
+        output.indexOf("\r\nContent-Type: text/plain\r\n") == -1 ||
+        output.indexOf("\r\nLast-Modified: ") == -1 ||
+        output.indexOf("\r\nETag: \"") == -1) {
+        testf("Missing expected headers");
+        return false;
+    }
+    if (!output.endsWith("\r\n\r\n" TEST_FILE_CONTENT)) {
+        testf("Did not write file content");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests HEAD gets the headers with no body
+bool test_staticfilehandler_head() {
+    if (!writeTestFile()) {
+        testf("Failed to write test file");
+        return false;
+    }
+
+    StaticTestRequest request(HttpMethod::Head, "/static/" TEST_FILE_NAME);
+    StaticTestSource streamSource;
+    const StringRef output = runHandler(request, streamSource);
+    std::remove(TEST_FILE_NAME);
+
+    if (!output.startsWith("HTTP/1.1 200 OK\r\n")) {
+        testf("Did not get 200 response");
+        return false;
+    }
+    if (output.indexOf("\r\nContent-Length: 19\r\n") == -1) {
+        testf("Missing Content-Length");
+        return false;
+    }
+    if (!output.endsWith("\r\n\r\n")) {
+        testf("Unexpected body for HEAD");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests conditional requests get a 304 when the validators match
+bool test_staticfilehandler_not_modified() {
+    if (!writeTestFile()) {
+        testf("Failed to write test file");
+        return false;
+    }
+
+    StaticTestRequest request(HttpMethod::Get, "/static/" TEST_FILE_NAME);
+    StaticTestSource streamSource;
+    const StringRef output = runHandler(request, streamSource);
+
+    // Echo back the validators from the first response
+    ptrdiff_t etagStart = output.indexOf("ETag: ");
+    ptrdiff_t dateStart = output.indexOf("Last-Modified: ");
+    if (etagStart == -1 || dateStart == -1) {
+        std::remove(TEST_FILE_NAME);
+        testf("Missing validators");
+        return false;
+    }
+    etagStart += 6;
+    dateStart += 15;
+    String etag = output.substring(etagStart, output.indexOf("\r\n", etagStart));
+    String date = output.substring(dateStart, output.indexOf("\r\n", dateStart));
+
+    StaticTestRequest etagRequest(HttpMethod::Get, "/static/" TEST_FILE_NAME);
+    etagRequest.addHeader("If-None-Match", String("\"nope\", ") + etag);
+    StaticTestSource etagSource;
+    const StringRef etagOutput = runHandler(etagRequest, etagSource);
+
+    StaticTestRequest dateRequest(HttpMethod::Get, "/static/" TEST_FILE_NAME);
+    dateRequest.addHeader("If-Modified-Since", date);
+    StaticTestSource dateSource;
+    const StringRef dateOutput = runHandler(dateRequest, dateSource);
+    std::remove(TEST_FILE_NAME);
+
+    if (!etagOutput.startsWith("HTTP/1.1 304 Not Modified\r\n") ||
+        !etagOutput.endsWith("\r\n\r\n")) {
+        testf("Did not get 304 for If-None-Match");
+        return false;
+    }
+    if (!dateOutput.startsWith("HTTP/1.1 304 Not Modified\r\n")) {
+        testf("Did not get 304 for If-Modified-Since");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests traversal, missing files and other methods are refused
+bool test_staticfilehandler_rejected() {
+    const char* notFoundUrls[] = {
+        "/static/../" TEST_FILE_NAME,
+        "/static/%2e%2e/" TEST_FILE_NAME,
+        "/static/..%2f" TEST_FILE_NAME,
+        "/static//" TEST_FILE_NAME,
+        "/static/a\\..\\" TEST_FILE_NAME,
+        "/static/does_not_exist.txt",
+        "/static/",
+    };
+
+    for (const char* url : notFoundUrls) {
+        StaticTestRequest request(HttpMethod::Get, url);
+        StaticTestSource streamSource;
+        const StringRef output = runHandler(request, streamSource);
+        if (!output.startsWith("HTTP/1.1 404 Not Found\r\n")) {
+            testf("Did not get 404 for %s", url);
+            return false;
+        }
+    }
+
+    StaticTestRequest request(HttpMethod::Post, "/static/" TEST_FILE_NAME);
+    StaticTestSource streamSource;
+    const StringRef output = runHandler(request, streamSource);
+    if (!output.startsWith("HTTP/1.1 405 Method Not Allowed\r\n") ||
+        output.indexOf("\r\nAllow: GET, HEAD\r\n") == -1) {
+        testf("Did not get 405 for POST");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests precompressed siblings are picked based on Accept-Encoding
+bool test_staticfilehandler_precompressed() {
+    if (!writeTestFile() ||
+        !writeTestFile(TEST_FILE_NAME ".gz", "gzipped") ||
+        !writeTestFile(TEST_FILE_NAME ".br", "brotli")) {
+        std::remove(TEST_FILE_NAME);
+        std::remove(TEST_FILE_NAME ".gz");
+        testf("Failed to write test files");
+        return false;
+    }
+
+    const char* acceptEncodings[] = {
+        "gzip, deflate, br",
+        "gzip;q=1.0, br;q=0.5",
+        "br;q=0",
+        "*;q=0.5, identity",
+    };
+    const char* expectedBodies[] = {
+        "\r\n\r\nbrotli",
+        "\r\n\r\ngzipped",
+        "\r\n\r\n" TEST_FILE_CONTENT,
+        "\r\n\r\n" TEST_FILE_CONTENT,
+    };
+    const char* expectedEncodings[] = {
+        "\r\nContent-Encoding: br\r\n",
+        "\r\nContent-Encoding: gzip\r\n",
+        nullptr,
+        nullptr,
+    };
+
+    bool success = true;
+    for (size_t i = 0; i < 4 && success; i++) {
+        StaticTestRequest request(HttpMethod::Get, "/static/" TEST_FILE_NAME);
+        request.addHeader("Accept-Encoding", acceptEncodings[i]);
+        StaticTestSource streamSource;
+        const StringRef output = runHandler(request, streamSource);
+
+        if (!output.endsWith(expectedBodies[i])) {
+            testf("Unexpected body for: %s", acceptEncodings[i]);
+            success = false;
+        } else if (expectedEncodings[i] != nullptr && output.indexOf(expectedEncodings[i]) == -1) {
+            testf("Missing Content-Encoding for: %s", acceptEncodings[i]);
+            success = false;
+        } else if (expectedEncodings[i] == nullptr && output.indexOf("Content-Encoding") != -1) {
+            testf("Unexpected Content-Encoding for: %s", acceptEncodings[i]);
+            success = false;
+        } else if (output.indexOf("\r\nContent-Type: text/plain\r\n") == -1 ||
+                   output.indexOf("\r\nVary: Accept-Encoding\r\n") == -1) {
+            testf("Missing Content-Type or Vary for: %s", acceptEncodings[i]);
+            success = false;
+        }
+    }
+
+    std::remove(TEST_FILE_NAME);
+    std::remove(TEST_FILE_NAME ".gz");
+    std::remove(TEST_FILE_NAME ".br");
+    return success;
+}
@@ -0,0 +1,134 @@
+
+#include "unit/UnitTest.h"
+#include "unit/http/UrlParser_test.h"
+
+#include "cupcake/internal/http/UrlParser.h"
+
+#include <string>
+#include <vector>
+
+using namespace Cupcake;
+
+bool test_urlparser_split() {
+    struct SplitTest {
+        const char* target;
+        const char* path;
+        const char* query;
+        const char* fragment;
+        bool hasEscapes;
+        bool hasDotSegments;
+    };
+
+    // Long enough targets to go through the word at a time loop too
+    const SplitTest tests[] = {
+        {"/", "/", "", "", false, false},
+        {"/a?x=1", "/a", "x=1", "", false, false},
+        {"/a#top", "/a", "", "top", false, false},
+        {"/a?x=1#top", "/a", "x=1", "top", false, false},
+        {"/a?x=1?y#top#2", "/a", "x=1?y", "top#2", false, false},
+        {"/some/longer/path/to/index.html?query=string", "/some/longer/path/to/index.html", "query=string", "",
+            false, false},
+        {"/some/longer/path/with%20space", "/some/longer/path/with%20space", "", "", true, false},
+        {"/some/longer/path/../up", "/some/longer/path/../up", "", "", false, true},
+        {"/some/longer/path/.", "/some/longer/path/.", "", "", false, true},
+        {"/some/longer/path/...", "/some/longer/path/...", "", "", false, false},
+        {"/some/longer/path/.hidden", "/some/longer/path/.hidden", "", "", false, false},
+        {"/some/longer/path?../%", "/some/longer/path", "../%", "", false, false},
+        {"http://example.com/a/b?c", "/a/b", "c", "", false, false},
+        {"http://example.com:8080?c", "/", "c", "", false, false},
+        {"http://example.com", "/", "", "", false, false},
+        {"*", "*", "", "", false, false},
+        {"", "", "", "", false, false},
+    };
+
+    for (const SplitTest& test : tests) {
+        UrlParser::UrlParts parts = UrlParser::split(test.target);
+        if (!parts.path.equals(test.path) || !parts.query.equals(test.query) ||
+            !parts.fragment.equals(test.fragment)) {
+            testf("Bad split of %s: %.*s %.*s %.*s", test.target, (int)parts.path.length(), parts.path.data(),
+                  (int)parts.query.length(), parts.query.data(), (int)parts.fragment.length(), parts.fragment.data());
+            return false;
+        }
+        if (parts.hasEscapes != test.hasEscapes || parts.hasDotSegments != test.hasDotSegments) {
+            testf("Bad flags for %s", test.target);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool test_urlparser_decode() {
+    struct DecodeTest {
+        const char* input;
+        bool plusIsSpace;
+        const char* expected; // Null if it should fail
+    };
+
+    const DecodeTest tests[] = {
+        {"plain", false, "plain"},
+        {"a%20b", false, "a b"},
+        {"%2F%2f", false, "//"},
+        {"%e2%82%AC", false, "\xe2\x82\xac"},
+        {"a+b", false, "a+b"},
+        {"a+b", true, "a b"},
+        {"%2B", true, "+"},
+        {"%", false, nullptr},
+        {"%2", false, nullptr},
+        {"a%2", false, nullptr},
+        {"%zz", false, nullptr},
+        {"%00", false, nullptr},
+    };
+
+    for (const DecodeTest& test : tests) {
+        const StringRef input(test.input);
+        std::vector<char> output(input.length() + 1);
+        size_t outputLen;
+        bool valid;
+        std::tie(outputLen, valid) = UrlParser::percentDecode(input, test.plusIsSpace, output.data());
+        if (!test.expected) {
+            if (valid) {
+                testf("Decoded invalid %s", test.input);
+                return false;
+            }
+            continue;
+        }
+        if (!valid || !StringRef(output.data(), outputLen).equals(test.expected)) {
+            testf("Bad decode of %s", test.input);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool test_urlparser_dot_segments() {
+    // Mostly from RFC 3986 section 5.4
+    const std::vector<std::tuple<const char*, const char*>> tests = {
+        std::make_tuple("/", "/"),
+        std::make_tuple("/a/b/c", "/a/b/c"),
+        std::make_tuple("/a/b/c/./../../g", "/a/g"),
+        std::make_tuple("/a/./b", "/a/b"),
+        std::make_tuple("/a/b/..", "/a/"),
+        std::make_tuple("/a/b/.", "/a/b/"),
+        std::make_tuple("/a/b/../../..", "/"),
+        std::make_tuple("/../../g", "/g"),
+        std::make_tuple("/..", "/"),
+        std::make_tuple("/.", "/"),
+        std::make_tuple("/a/..b/c.", "/a/..b/c."),
+        std::make_tuple("/a//../b", "/a/b"),
+        std::make_tuple("relative/../x", "relative/../x"),
+    };
+
+    for (const auto& test : tests) {
+        std::string path(std::get<0>(test));
+        size_t pathLen = UrlParser::removeDotSegments(&path[0], path.length());
+        if (!StringRef(path.data(), pathLen).equals(std::get<1>(test))) {
+            testf("Normalized %s to %.*s, expected %s", std::get<0>(test), (int)pathLen, path.data(),
+                  std::get<1>(test));
+            return false;
+        }
+    }
+
+    return true;
+}
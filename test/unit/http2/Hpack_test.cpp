@@ -58,7 +58,7 @@ bool test_hpack_indexed_header() {
             return false;
         }
         if (requestData.getHeaderCount() != 3 ||
-            !requestData.getHeaderName(2).equals("testName") ||
+            !requestData.getHeaderName(2).equals("testname") ||
             !requestData.getHeaderValue(2).equals("testValue")) {
             testf("Indexed header entry did not cause expected request data update");
             return false;
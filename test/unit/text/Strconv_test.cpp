@@ -1,9 +1,15 @@
 
 #include "unit/text/Strconv_test.h"
+#include "unit/Benchmark.h"
 #include "unit/UnitTest.h"
 
 #include "cupcake/internal/text/Strconv.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <limits>
 #include <string>
 #include <sstream>
@@ -301,3 +307,574 @@ bool test_strconv_parseUint64() {
     }
     return true;
 }
+
+// The one char at a time way, to check the SWAR paths against
+template<typename T>
+static
+bool referenceParse(const std::string& str, uint32_t radix, T& result) {
+    size_t i = 0;
+    bool negative = false;
+    if (std::numeric_limits<T>::is_signed && !str.empty() && str[0] == '-') {
+        negative = true;
+        i++;
+    }
+    if (i == str.size()) {
+        return false;
+    }
+
+    // Accumulate as unsigned and compare against the limit at each step
+    uint64_t max = (uint64_t)std::numeric_limits<T>::max() + (negative ? 1 : 0);
+    uint64_t value = 0;
+    for (; i < str.size(); i++) {
+        char c = str[i];
+        uint64_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = (uint64_t)(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = (uint64_t)(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            digit = (uint64_t)(c - 'A' + 10);
+        } else {
+            return false;
+        }
+        if (digit >= radix || value > (max - digit) / radix) {
+            return false;
+        }
+        value = value * radix + digit;
+    }
+    result = negative ? (T)(0 - value) : (T)value;
+    return true;
+}
+
+template<typename T, typename Parse>
+static
+bool checkParse(const std::string& str, uint32_t radix, Parse parse) {
+    T expected = 0;
+    bool expectSuccess = referenceParse(str, radix, expected);
+
+    T resVal;
+    bool parsed;
+    std::tie(resVal, parsed) = parse(StringRef(str.data(), str.length()), radix);
+    if (parsed != expectSuccess || (parsed && resVal != expected)) {
+        testf("Radix %d parse of \"%s\" gave %s, expected %s", (int)radix, str.c_str(),
+              parsed ? asString(resVal).c_str() : "failure",
+              expectSuccess ? asString(expected).c_str() : "failure");
+        return false;
+    }
+    return true;
+}
+
+template<typename T, typename Parse>
+static
+bool checkParseAll(const std::vector<std::string>& strs, uint32_t radix, Parse parse) {
+    for (const std::string& str : strs) {
+        if (!checkParse<T>(str, radix, parse)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_strconv_parse_swar() {
+    std::vector<std::string> decimal;
+    std::vector<std::string> hex;
+
+    // Runs of each length around the 8 digit word boundaries, with a bad
+    // char in every position
+    for (size_t len = 1; len <= 24; len++) {
+        std::string digits;
+        std::string hexDigits;
+        for (size_t i = 0; i < len; i++) {
+            digits += (char)('1' + i % 9);
+            hexDigits += "9aF0bE1c"[i % 8];
+        }
+        decimal.push_back(digits);
+        hex.push_back(hexDigits);
+        decimal.push_back("-" + digits);
+        hex.push_back("-" + hexDigits);
+        decimal.push_back(std::string(len, '0') + "7");
+        hex.push_back(std::string(len, '0') + "d");
+
+        for (size_t i = 0; i < len; i++) {
+            for (char bad : {'/', ':', ' ', 'a', '-', '\0', '\x80', '\xb0'}) {
+                std::string badDigits = digits;
+                badDigits[i] = bad;
+                decimal.push_back(badDigits);
+            }
+            for (char bad : {'/', ':', '@', 'G', '`', 'g', '\x10', '\x90', '\xc1', '\xe1'}) {
+                std::string badHex = hexDigits;
+                badHex[i] = bad;
+                hex.push_back(badHex);
+            }
+        }
+    }
+
+    // Either side of every limit
+    for (const char* str : {"2147483647", "2147483648", "-2147483648", "-2147483649",
+                            "4294967295", "4294967296", "9223372036854775807", "9223372036854775808",
+                            "-9223372036854775808", "-9223372036854775809", "18446744073709551615",
+                            "18446744073709551616", "18446744073709551620", "19999999999999999999",
+                            "99999999999999999999", "100000000000000000000", "0000000000000000000018446744073709551615"}) {
+        decimal.push_back(str);
+    }
+    for (const char* str : {"7fffffff", "80000000", "-80000000", "-80000001", "ffffffff", "100000000",
+                            "7FFFFFFFFFFFFFFF", "8000000000000000", "-8000000000000000", "-8000000000000001",
+                            "FFFFFFFFFFFFFFFF", "10000000000000000", "00000000000000000000fFfFfFfFfFfFfFfF",
+                            "aBcDeF", "AbCdEf01", "deadBEEFcafeF00D"}) {
+        hex.push_back(str);
+    }
+
+    auto parseInt32 = [](const StringRef str, uint32_t radix) {return Strconv::parseInt32(str, radix);};
+    auto parseInt64 = [](const StringRef str, uint32_t radix) {return Strconv::parseInt64(str, radix);};
+    auto parseUint32 = [](const StringRef str, uint32_t radix) {return Strconv::parseUint32(str, radix);};
+    auto parseUint64 = [](const StringRef str, uint32_t radix) {return Strconv::parseUint64(str, radix);};
+
+    return checkParseAll<int32_t>(decimal, 10, parseInt32) &&
+        checkParseAll<int64_t>(decimal, 10, parseInt64) &&
+        checkParseAll<uint32_t>(decimal, 10, parseUint32) &&
+        checkParseAll<uint64_t>(decimal, 10, parseUint64) &&
+        checkParseAll<int32_t>(hex, 16, parseInt32) &&
+        checkParseAll<int64_t>(hex, 16, parseInt64) &&
+        checkParseAll<uint32_t>(hex, 16, parseUint32) &&
+        checkParseAll<uint64_t>(hex, 16, parseUint64);
+}
+
+bool test_strconv_radixToStr() {
+    // Every radix at and around the powers of each, which is where the
+    // digit count changes
+    char buffer[70];
+    char expected[70];
+    for (uint32_t radix = 2; radix <= 16; radix++) {
+        std::vector<uint64_t> values{0, 1, std::numeric_limits<uint64_t>::max()};
+        for (uint64_t power = radix; ; power *= radix) {
+            values.push_back(power - 1);
+            values.push_back(power);
+            values.push_back(power + 1);
+            if (power > std::numeric_limits<uint64_t>::max() / radix) {
+                break;
+            }
+        }
+
+        for (uint64_t value : values) {
+            size_t expectedLen = 0;
+            uint64_t rest = value;
+            do {
+                expected[expectedLen++] = "0123456789ABCDEF"[rest % radix];
+                rest /= radix;
+            } while (rest > 0);
+            std::reverse(expected, expected + expectedLen);
+            expected[expectedLen] = '\0';
+
+            size_t len = Strconv::uint64ToStr(value, radix, buffer, sizeof(buffer));
+            if (!checkString(expected, buffer, len)) {
+                testf("Radix %d: expected %s, got %.*s", (int)radix, expected, (int)len, buffer);
+                return false;
+            }
+            if (value <= std::numeric_limits<uint32_t>::max()) {
+                len = Strconv::uint32ToStr((uint32_t)value, radix, buffer, sizeof(buffer));
+                if (!checkString(expected, buffer, len)) {
+                    testf("Radix %d: expected %s, got %.*s", (int)radix, expected, (int)len, buffer);
+                    return false;
+                }
+            }
+        }
+    }
+
+    // Decimal either side of where uint64ToStr switches to 32 bit division
+    for (uint64_t value : {4294967295ULL, 4294967296ULL, 99999999999ULL, 100000000000ULL,
+                           10000000000000000ULL, 9999999999999999999ULL, 10000000000000000000ULL,
+                           1000000000000000001ULL}) {
+        size_t len = Strconv::uint64ToStr(value, buffer, sizeof(buffer));
+        if (!checkString(asString(value).c_str(), buffer, len)) {
+            testf("Expected %s, got %.*s", asString(value).c_str(), (int)len, buffer);
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+static
+bool sameBits(T a, T b) {
+    return ::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+// Significant digits in a formatted value, ignoring the exponent and the
+// zeros that only place the decimal point
+static
+int32_t countDigits(const char* str, size_t len) {
+    const char* end = std::find(str, str + len, 'e');
+    int32_t digits = 0;
+    int32_t trailingZeros = 0;
+    bool started = false;
+    for (const char* c = str; c < end; c++) {
+        if (*c >= '1' && *c <= '9') {
+            started = true;
+            digits += trailingZeros + 1;
+            trailingZeros = 0;
+        } else if (*c == '0' && started) {
+            trailingZeros++;
+        }
+    }
+    return digits;
+}
+
+// Formats with the given function, then checks it parses back exactly and
+// that no shorter %e has the same value
+template<typename T, typename ToStr, typename Parse, typename LibcParse>
+static
+bool checkRoundTrip(T value, ToStr toStr, Parse parse, LibcParse libcParse, int32_t maxDigits, size_t maxLen) {
+    char buffer[64];
+    size_t len = toStr(value, buffer, sizeof(buffer));
+    if (len > maxLen) {
+        testf("%.17g formatted as %.*s, longer than %d", (double)value, (int)len, buffer, (int)maxLen);
+        return false;
+    }
+
+    T parsed;
+    bool success;
+    std::tie(parsed, success) = parse(StringRef(buffer, len));
+    if (!success || !sameBits(value, parsed)) {
+        testf("%.17g formatted as %.*s, which parsed back as %.17g", (double)value, (int)len, buffer, (double)parsed);
+        return false;
+    }
+
+    int32_t digits = countDigits(buffer, len);
+    for (int32_t precision = 1; precision < digits && precision <= maxDigits; precision++) {
+        char shorter[64];
+        snprintf(shorter, sizeof(shorter), "%.*e", (int)precision - 1, (double)value);
+        if (sameBits(libcParse(shorter), value)) {
+            testf("%.17g formatted as %.*s, but %s is shorter", (double)value, (int)len, buffer, shorter);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_strconv_doubleToStr() {
+    std::vector<ToStrTestData<double>> testData{
+        ToStrTestData<double>(0.0, 10, "0"),
+        ToStrTestData<double>(-0.0, 10, "-0"),
+        ToStrTestData<double>(1.0, 10, "1"),
+        ToStrTestData<double>(-1.5, 10, "-1.5"),
+        ToStrTestData<double>(0.1, 10, "0.1"),
+        ToStrTestData<double>(0.3, 10, "0.3"),
+        ToStrTestData<double>(0.1 + 0.2, 10, "0.30000000000000004"),
+        ToStrTestData<double>(123456.789, 10, "123456.789"),
+        ToStrTestData<double>(1e21, 10, "1e+21"),
+        ToStrTestData<double>(1e20, 10, "100000000000000000000"),
+        ToStrTestData<double>(123e18, 10, "123000000000000000000"),
+        ToStrTestData<double>(1.5e300, 10, "1.5e+300"),
+        ToStrTestData<double>(0.000001, 10, "0.000001"),
+        ToStrTestData<double>(0.0000012345, 10, "0.0000012345"),
+        ToStrTestData<double>(1e-7, 10, "1e-7"),
+        ToStrTestData<double>(-1.25e-7, 10, "-1.25e-7"),
+        ToStrTestData<double>(9007199254740993.0, 10, "9007199254740992"),
+        ToStrTestData<double>(5e-324, 10, "5e-324"),
+        ToStrTestData<double>(1e-323, 10, "1e-323"),
+        ToStrTestData<double>(2.2250738585072014e-308, 10, "2.2250738585072014e-308"),
+        ToStrTestData<double>(1.7976931348623157e308, 10, "1.7976931348623157e+308"),
+        ToStrTestData<double>(-std::numeric_limits<double>::max(), 10, "-1.7976931348623157e+308"),
+        ToStrTestData<double>(std::numeric_limits<double>::infinity(), 10, "Infinity"),
+        ToStrTestData<double>(-std::numeric_limits<double>::infinity(), 10, "-Infinity"),
+        ToStrTestData<double>(std::numeric_limits<double>::quiet_NaN(), 10, "NaN")
+    };
+
+    for (auto& data : testData) {
+        char buffer[64];
+        size_t len = Strconv::doubleToStr(data.val, buffer, sizeof(buffer));
+        if (!checkString(data.expected.c_str(), buffer, len)) {
+            testf("Expected %s, got %.*s", data.expected.c_str(), (int)len, buffer);
+            return false;
+        }
+    }
+
+    // Too small a buffer gets what fits, and the length it needed
+    char small[4];
+    if (Strconv::doubleToStr(-0.125, small, sizeof(small)) != 6 || !checkString("-0.1", small, sizeof(small))) {
+        testf("Small buffer not handled");
+        return false;
+    }
+
+    auto toStr = [](double value, char* buffer, size_t bufferLen) {
+        return Strconv::doubleToStr(value, buffer, bufferLen);
+    };
+    auto parse = [](const StringRef str) {return Strconv::parseDouble(str);};
+    auto libcParse = [](const char* str) {return strtod(str, nullptr);};
+
+    // Random bit patterns, and the ends of every binade
+    uint64_t seed = 1;
+    for (int i = 0; i < 100000; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        double value;
+        uint64_t bits = seed ^ (seed >> 29);
+        ::memcpy(&value, &bits, sizeof(value));
+        if ((bits & 0x7FF0000000000000ULL) != 0x7FF0000000000000ULL &&
+            !checkRoundTrip(value, toStr, parse, libcParse, 17, 25)) {
+            return false;
+        }
+    }
+    for (int32_t exponent = -1074; exponent < 1024; exponent++) {
+        double power = std::ldexp(1.0, exponent);
+        for (double value : {power, std::nextafter(power, 0.0), std::nextafter(power, 2 * power)}) {
+            if (!checkRoundTrip(value, toStr, parse, libcParse, 17, 25)) {
+                return false;
+            }
+        }
+    }
+    for (uint64_t bits = 1; bits < 1000; bits++) {
+        double value;
+        ::memcpy(&value, &bits, sizeof(value));
+        if (!checkRoundTrip(value, toStr, parse, libcParse, 17, 25)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_strconv_floatToStr() {
+    std::vector<ToStrTestData<float>> testData{
+        ToStrTestData<float>(0.0f, 10, "0"),
+        ToStrTestData<float>(-0.0f, 10, "-0"),
+        ToStrTestData<float>(0.1f, 10, "0.1"),
+        ToStrTestData<float>(0.3f, 10, "0.3"),
+        ToStrTestData<float>(16777217.0f, 10, "16777216"),
+        ToStrTestData<float>(1.17549435e-38f, 10, "1.1754944e-38"),
+        ToStrTestData<float>(3.4028235e38f, 10, "3.4028235e+38"),
+        ToStrTestData<float>(-3.4028235e38f, 10, "-3.4028235e+38"),
+        ToStrTestData<float>(1e21f, 10, "1e+21"),
+        ToStrTestData<float>(1.4e-45f, 10, "1e-45"),
+        ToStrTestData<float>(std::numeric_limits<float>::infinity(), 10, "Infinity"),
+        ToStrTestData<float>(std::numeric_limits<float>::quiet_NaN(), 10, "NaN")
+    };
+
+    for (auto& data : testData) {
+        char buffer[64];
+        size_t len = Strconv::floatToStr(data.val, buffer, sizeof(buffer));
+        if (!checkString(data.expected.c_str(), buffer, len)) {
+            testf("Expected %s, got %.*s", data.expected.c_str(), (int)len, buffer);
+            return false;
+        }
+    }
+
+    auto toStr = [](float value, char* buffer, size_t bufferLen) {
+        return Strconv::floatToStr(value, buffer, bufferLen);
+    };
+    auto parse = [](const StringRef str) {return Strconv::parseFloat(str);};
+    auto libcParse = [](const char* str) {return strtof(str, nullptr);};
+
+    // A spread across every exponent, including all the subnormals near zero
+    for (uint32_t bits = 0; bits < 0x7F800000; bits += (bits < 100000 ? 1 : 9973)) {
+        float value;
+        ::memcpy(&value, &bits, sizeof(value));
+        if (!checkRoundTrip(value, toStr, parse, libcParse, 9, 22) ||
+            !checkRoundTrip(-value, toStr, parse, libcParse, 9, 22)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Parses with both and expects the same bits, or a failure for anything
+// that isn't a number
+template<typename T, typename Parse, typename LibcParse>
+static
+bool checkParseFloat(const std::string& str, Parse parse, LibcParse libcParse) {
+    T parsed;
+    bool success;
+    std::tie(parsed, success) = parse(StringRef(str.data(), str.length()));
+
+    const char* end = str.c_str();
+    T expected = libcParse(str.c_str(), &end);
+    bool expectSuccess = !str.empty() && end == str.c_str() + str.length() && str[0] != '+' &&
+        str[0] != ' ' && str.find_first_of("xXiInN") == std::string::npos;
+    if (success != expectSuccess || (success && !sameBits(parsed, expected))) {
+        testf("Parsing %.60s gave %.17g (%d), expected %.17g (%d)", str.c_str(),
+              (double)parsed, (int)success, (double)expected, (int)expectSuccess);
+        return false;
+    }
+    return true;
+}
+
+static
+std::vector<std::string> floatParseStrings() {
+    std::vector<std::string> strs{
+        "0", "-0", "0.0", "00.000", "1", "-1", ".5", "5.", "1e5", "1E5", "1e+5", "1e-5", "1.5e0",
+        "0.1", "0.30000000000000004", "123456.789", "9007199254740993", "9007199254740992.5",
+        "9007199254740993.0000000000000000001", "123456789012345678901234567890",
+        "2.2250738585072011e-308", "2.2250738585072012e-308", "4.9406564584124654e-324",
+        "2.4703282292062327e-324", "2.4703282292062328e-324", "1e-400", "1e400", "1e-99999999999",
+        "1e99999999999", "1.7976931348623157e308", "1.7976931348623158e308", "1.7976931348623159e308",
+        "3.4028235e38", "3.4028236e38", "1.4e-45", "7e-46", "7.00000000000000000001e-46", "1.17549435e-38",
+        "0.000000000000000000000000000000000000000000001", "16777217", "16777217.000000001",
+        "", "-", ".", "-.", "e5", ".e5", "1e", "1e+", "1e-", "+1", " 1", "1 ", "1..2", "1.2.3", "--1",
+        "1e5.5", "0x10", "1f", "inf", "nan", "infinity", "-nan"
+    };
+
+    // The halfway points between doubles and floats written out in full.
+    // Where long double is no wider than double these are just doubles.
+    uint64_t seed = 7;
+    for (int i = 0; i < 2000; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t bits = (seed >> 1) & 0x7FEFFFFFFFFFFFFFULL;
+        double value;
+        ::memcpy(&value, &bits, sizeof(value));
+        double next = std::nextafter(value, 2 * value + 1);
+        char buffer[1200];
+        snprintf(buffer, sizeof(buffer), "%.767Le", (long double)value + ((long double)next - value) / 2);
+        strs.push_back(buffer);
+        float single = (float)value;
+        float nextSingle = std::nextafter(single, 2 * single + 1);
+        snprintf(buffer, sizeof(buffer), "%.120e", (double)single + ((double)nextSingle - single) / 2);
+        strs.push_back(buffer);
+    }
+
+    // Random runs of digits, some past what a 64 bit mantissa holds
+    for (int i = 0; i < 20000; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t digits = 1 + (seed >> 40) % (i % 10 == 0 ? 900 : 40);
+        size_t point = (seed >> 20) % (digits + 1);
+        std::string str = (seed & 1) ? "-" : "";
+        uint64_t digitSeed = seed;
+        for (size_t j = 0; j < digits; j++) {
+            if (j == point && j > 0) {
+                str += '.';
+            }
+            digitSeed = digitSeed * 6364136223846793005ULL + 1442695040888963407ULL;
+            str += (char)('0' + (digitSeed >> 33) % 10);
+        }
+        if (seed & 2) {
+            str += "e" + asString((int32_t)((seed >> 8) % 700) - 350);
+        }
+        strs.push_back(str);
+    }
+    return strs;
+}
+
+bool test_strconv_parseDouble() {
+    auto parse = [](const StringRef str) {return Strconv::parseDouble(str);};
+    auto libcParse = [](const char* str, const char** end) {
+        char* parsedEnd;
+        double value = strtod(str, &parsedEnd);
+        *end = parsedEnd;
+        return value;
+    };
+    for (const std::string& str : floatParseStrings()) {
+        if (!checkParseFloat<double>(str, parse, libcParse)) {
+            return false;
+        }
+    }
+
+    double value;
+    bool success;
+    std::tie(value, success) = Strconv::parseDouble("-Infinity");
+    if (!success || value != -std::numeric_limits<double>::infinity()) {
+        testf("-Infinity not parsed");
+        return false;
+    }
+    std::tie(value, success) = Strconv::parseDouble("NaN");
+    if (!success || value == value) {
+        testf("NaN not parsed");
+        return false;
+    }
+    return true;
+}
+
+bool test_strconv_parseFloat() {
+    auto parse = [](const StringRef str) {return Strconv::parseFloat(str);};
+    auto libcParse = [](const char* str, const char** end) {
+        char* parsedEnd;
+        float value = strtof(str, &parsedEnd);
+        *end = parsedEnd;
+        return value;
+    };
+    for (const std::string& str : floatParseStrings()) {
+        if (!checkParseFloat<float>(str, parse, libcParse)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Only reports timings, there's nothing to fail on
+bool test_strconv_benchmark() {
+    const char* decimals[] = {"0", "1234", "65536", "1073741824", "18446744073709551615"};
+    const char* hexes[] = {"0", "1f40", "10000", "40000000", "FFFFFFFFFFFFFFFF"};
+
+    for (size_t i = 0; i < sizeof(decimals) / sizeof(decimals[0]); i++) {
+        StringRef decimal(decimals[i]);
+        StringRef hex(hexes[i]);
+        double decimalNanos = benchmarkNanos([decimal] {
+            return std::get<0>(Strconv::parseUint64(decimal));
+        });
+        double strtoullNanos = benchmarkNanos([decimal] {
+            return strtoull(decimal.data(), nullptr, 10);
+        });
+        double hexNanos = benchmarkNanos([hex] {
+            return std::get<0>(Strconv::parseUint64(hex, 16));
+        });
+        double strtoullHexNanos = benchmarkNanos([hex] {
+            return strtoull(hex.data(), nullptr, 16);
+        });
+        printf("  parse %-20s: %6.1fns (strtoull %6.1fns)  hex %-16s: %6.1fns (strtoull %6.1fns)\n",
+               decimals[i], decimalNanos, strtoullNanos, hexes[i], hexNanos, strtoullHexNanos);
+    }
+
+    const uint64_t values[] = {7, 404, 1048576, 4294967296ULL, 18446744073709551615ULL};
+    for (uint64_t value : values) {
+        double decimalNanos = benchmarkNanos([value] {
+            char buffer[32];
+            return Strconv::uint64ToStr(value, buffer, sizeof(buffer)) + buffer[0];
+        });
+        double snprintfNanos = benchmarkNanos([value] {
+            char buffer[32];
+            return snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)value) + buffer[0];
+        });
+        double hexNanos = benchmarkNanos([value] {
+            char buffer[32];
+            return Strconv::uint64ToStr(value, 16, buffer, sizeof(buffer)) + buffer[0];
+        });
+        printf("  format %20llu: %6.1fns (snprintf %6.1fns)  hex %6.1fns\n",
+               (unsigned long long)value, decimalNanos, snprintfNanos, hexNanos);
+    }
+    return true;
+}
+
+bool test_strconv_float_benchmark() {
+    const double values[] = {0.1, 123456.789, 1.7976931348623157e308, 5e-324, 0.30000000000000004, 3.0};
+    for (double value : values) {
+        double formatNanos = benchmarkNanos([value] {
+            char buffer[32];
+            return Strconv::doubleToStr(value, buffer, sizeof(buffer)) + buffer[0];
+        });
+        double snprintfNanos = benchmarkNanos([value] {
+            char buffer[32];
+            return snprintf(buffer, sizeof(buffer), "%.17g", value) + buffer[0];
+        });
+
+        char str[32];
+        size_t len = Strconv::doubleToStr(value, str, sizeof(str));
+        str[len] = '\0';
+        StringRef ref(str, len);
+        double parseNanos = benchmarkNanos([ref] {
+            return std::get<0>(Strconv::parseDouble(ref)) > 1;
+        });
+        double strtodNanos = benchmarkNanos([&str] {
+            return strtod(str, nullptr) > 1;
+        });
+        printf("  %-23s: format %6.1fns (snprintf %6.1fns)  parse %6.1fns (strtod %6.1fns)\n",
+               str, formatNanos, snprintfNanos, parseNanos, strtodNanos);
+    }
+
+    // Too many digits for the fast path, so each one is compared exactly
+    std::string longStr = "2." + std::string(100, '2') + "e-308";
+    StringRef longRef(longStr.data(), longStr.length());
+    double parseNanos = benchmarkNanos([longRef] {
+        return std::get<0>(Strconv::parseDouble(longRef)) > 1;
+    });
+    double strtodNanos = benchmarkNanos([&longStr] {
+        return strtod(longStr.c_str(), nullptr) > 1;
+    });
+    printf("  %d digits: parse %6.1fns (strtod %6.1fns)\n", (int)longStr.length() - 6, parseNanos, strtodNanos);
+    return true;
+}
@@ -0,0 +1,58 @@
+
+#include "unit/text/StringBuilder_test.h"
+
+#include "unit/UnitTest.h"
+
+#include "cupcake/internal/text/StringBuilder.h"
+#include "cupcake/internal/util/Arena.h"
+
+using namespace Cupcake;
+
+bool test_stringbuilder_build() {
+    StringBuilder builder;
+    if (builder.build() != "") {
+        testf("Empty builder built text");
+        return false;
+    }
+
+    builder.append("GET").append(", ").append(StringRef("HEAD, POST", 4)).append(' ').append("");
+    if (builder.length() != 10 || builder.build() != "GET, HEAD ") {
+        testf("Built \"%s\"", builder.build().c_str());
+        return false;
+    }
+
+    // Past the pieces kept inline
+    builder.clear();
+    String expected;
+    for (int i = 0; i < 50; i++) {
+        builder.append("piece").append((char)('a' + i % 26));
+        expected += "piece";
+        expected += (char)('a' + i % 26);
+    }
+    if (builder.length() != expected.length() || builder.build() != expected) {
+        testf("Many pieces built \"%s\"", builder.build().c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool test_stringbuilder_arena() {
+    Arena arena;
+    const StringRef value("\"0123456789abcdef0123456789abcdef\"");
+
+    // Exactly one allocation, of just enough
+    StringBuilder builder;
+    builder.append("W/").append(value);
+    String built = builder.build(&arena);
+    if (built.getArena() != &arena || built != "W/\"0123456789abcdef0123456789abcdef\"") {
+        testf("Built \"%s\" outside the arena", built.c_str());
+        return false;
+    }
+    if (arena.getAllocatedSize() != 40) {
+        testf("Allocated %d bytes for 36 characters", (int)arena.getAllocatedSize());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,144 @@
+
+#include "unit/Benchmark.h"
+#include "unit/UnitTest.h"
+#include "unit/text/StringHash_test.h"
+
+#include "cupcake/internal/text/String.h"
+#include "cupcake/internal/text/StringHash.h"
+
+#include <cctype>
+#include <cstdio>
+#include <unordered_set>
+#include <vector>
+
+using namespace Cupcake;
+
+#define TEST_KEY0 0x0706050403020100ULL
+#define TEST_KEY1 0x0f0e0d0c0b0a0908ULL
+
+bool test_stringhash_basic() {
+    std::vector<char> data(256);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (char)i;
+    }
+
+    // Every length, so each tail size and word count is covered
+    std::unordered_set<uint64_t> seen;
+    for (size_t len = 0; len <= data.size(); len++) {
+        uint64_t hash = StringHash::hash(data.data(), len, TEST_KEY0, TEST_KEY1);
+        if (!seen.insert(hash).second) {
+            testf("Prefixes collided at length %d", (int)len);
+            return false;
+        }
+        if (hash != StringHash::hash(data.data(), len, TEST_KEY0, TEST_KEY1)) {
+            testf("Hash not repeatable at length %d", (int)len);
+            return false;
+        }
+        if (len != 0 && hash == StringHash::hash(data.data(), len, TEST_KEY0 + 1, TEST_KEY1)) {
+            testf("Key did not change the hash at length %d", (int)len);
+            return false;
+        }
+    }
+
+    // Trailing NULs are part of the text
+    if (StringHash::hash("ab\0", 3, TEST_KEY0, TEST_KEY1) == StringHash::hash("ab", 2, TEST_KEY0, TEST_KEY1)) {
+        testf("Trailing NUL ignored");
+        return false;
+    }
+
+    const StringRef text("/some/path/to/a/file.txt");
+    if (text.hash() != String(text).hash() || text.hash() != StringRef(String(text)).hash()) {
+        testf("String and StringRef hashes differ");
+        return false;
+    }
+    if (text.hash() == StringRef("/some/path/to/a/file.txT").hash()) {
+        testf("Last byte did not change the hash");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_stringhash_ignore_case() {
+    const StringRef sameNames[] = {"content-type", "Content-Type", "CONTENT-TYPE", "cOnTeNt-TyPe"};
+    for (const StringRef& name : sameNames) {
+        if (name.engHashIgnoreCase() != sameNames[0].engHashIgnoreCase()) {
+            testf("Case changed the hash of %s", name.data());
+            return false;
+        }
+    }
+    if (String("X-Custom-Header").engHashIgnoreCase() != StringRef("x-custom-header").engHashIgnoreCase()) {
+        testf("String and StringRef ignore case hashes differ");
+        return false;
+    }
+
+    // Only letters fold: '@' and '`', '[' and '{', and bytes with the high bit set
+    // are 0x20 apart too
+    const char* differentPairs[][2] = {
+        {"@", "`"},
+        {"[", "{"},
+        {"\xc1", "\xe1"},
+        {"abcdefg@", "abcdefg`"},
+    };
+    for (const auto& pair : differentPairs) {
+        if (StringRef(pair[0]).engHashIgnoreCase() == StringRef(pair[1]).engHashIgnoreCase()) {
+            testf("Folded %s and %s together", pair[0], pair[1]);
+            return false;
+        }
+    }
+
+    // Matches hashing the lowercased text, for every byte value
+    std::vector<char> data(256);
+    std::vector<char> lower(256);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (char)(255 - i);
+        lower[i] = (data[i] >= 'A' && data[i] <= 'Z') ? (char)(data[i] + 0x20) : data[i];
+    }
+    for (size_t start = 0; start < data.size(); start += 7) {
+        size_t len = data.size() - start;
+        if (StringHash::hashIgnoreCase(&data[start], len, TEST_KEY0, TEST_KEY1) !=
+            StringHash::hash(&lower[start], len, TEST_KEY0, TEST_KEY1)) {
+            testf("Ignore case hash differs from hash of lowercase at %d", (int)start);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// The sdbm style loop the hash replaced, for comparison
+static
+size_t oldHash(const char* data, size_t dataLen) {
+    size_t hash = 0;
+    for (size_t i = 0; i < dataLen; i++) {
+        size_t c = data[i];
+        hash = c + (hash << 6) + (hash << 16) - hash;
+    }
+    return hash;
+}
+
+// Only reports timings, there's nothing to fail on
+bool test_stringhash_benchmark() {
+    std::vector<char> data(4096);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = "abcdefghijklmnopqrstuvwxyz-ABCDEFGHIJKLMNOPQRSTUVWXYZ/0123456789"[i % 64];
+    }
+
+    const size_t lengths[] = {8, 16, 32, 64, 256, 4096};
+    for (size_t len : lengths) {
+        const char* text = data.data();
+        double oldNanos = benchmarkNanos([text, len] {
+            return oldHash(text, len);
+        });
+        double newNanos = benchmarkNanos([text, len] {
+            return StringHash::hash(text, len);
+        });
+        double ignoreCaseNanos = benchmarkNanos([text, len] {
+            return StringHash::hashIgnoreCase(text, len);
+        });
+        printf("  hash %4d bytes: old %8.1fns  new %8.1fns  ignore case %8.1fns\n",
+               (int)len, oldNanos, newNanos, ignoreCaseNanos);
+    }
+
+    return true;
+}
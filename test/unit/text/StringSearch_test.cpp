@@ -0,0 +1,281 @@
+
+#include "unit/Benchmark.h"
+#include "unit/UnitTest.h"
+#include "unit/text/StringSearch_test.h"
+
+#include "cupcake/internal/text/StringSearch.h"
+#include "cupcake/text/StringRef.h"
+
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+using namespace Cupcake;
+
+static const char* levelNames[] = {"scalar", "sse2", "avx2"};
+
+// Few distinct bytes so needles turn up often, including ones with the
+// high bit set
+static
+std::vector<char> makeText(size_t len, uint32_t seed) {
+    static const char alphabet[] = {'a', 'b', 'A', 'B', ',', '\xc1', '\xe1', '\0'};
+    std::vector<char> text(len);
+    for (size_t i = 0; i < len; i++) {
+        seed = seed * 1103515245 + 12345;
+        text[i] = alphabet[(seed >> 16) % sizeof(alphabet)];
+    }
+    return text;
+}
+
+static
+const char* naiveFind(const char* data, size_t dataLen, const char* needle, size_t needleLen, bool last) {
+    if (needleLen > dataLen) {
+        return nullptr;
+    }
+    const char* found = nullptr;
+    for (size_t i = 0; i + needleLen <= dataLen; i++) {
+        if (std::memcmp(data + i, needle, needleLen) == 0) {
+            found = data + i;
+            if (!last) {
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+static
+char naiveLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+// Runs check at every level this CPU has, leaving the best one selected
+template <typename Check>
+static
+bool forEachLevel(Check check) {
+    StringSearch::Level supported = StringSearch::getSupportedLevel();
+    bool passed = true;
+    for (int level = 0; passed && level <= (int)supported; level++) {
+        StringSearch::setLevel((StringSearch::Level)level);
+        if ((int)StringSearch::getLevel() != level) {
+            testf("Level %s not selected", levelNames[level]);
+            passed = false;
+        } else {
+            passed = check(levelNames[level]);
+        }
+    }
+    StringSearch::setLevel(supported);
+    return passed;
+}
+
+bool test_stringsearch_find() {
+    return forEachLevel([](const char* levelName) {
+        // Lengths around each block size, and needles that cross them
+        for (size_t len = 0; len <= 100; len++) {
+            std::vector<char> text = makeText(len, (uint32_t)len);
+            for (size_t needleLen = 1; needleLen <= 6 && needleLen <= len; needleLen++) {
+                for (size_t start = 0; start + needleLen <= len; start += 3) {
+                    const char* needle = &text[start];
+                    const char* expected = naiveFind(text.data(), len, needle, needleLen, false);
+                    if (StringSearch::find(text.data(), len, needle, needleLen) != expected) {
+                        testf("%s: find wrong for length %d needle %d at %d", levelName,
+                              (int)len, (int)needleLen, (int)start);
+                        return false;
+                    }
+                    expected = naiveFind(text.data(), len, needle, needleLen, true);
+                    if (StringSearch::findLast(text.data(), len, needle, needleLen) != expected) {
+                        testf("%s: findLast wrong for length %d needle %d at %d", levelName,
+                              (int)len, (int)needleLen, (int)start);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        // Only the first and last chars match everywhere
+        std::vector<char> text(300, 'x');
+        text[250] = 'y';
+        if (StringSearch::find(text.data(), text.size(), "xyx", 3) != &text[249] ||
+            StringSearch::find(text.data(), text.size(), "xzx", 3) != nullptr ||
+            StringSearch::findLast(text.data(), text.size(), "xzx", 3) != nullptr ||
+            StringSearch::findLast(text.data(), text.size(), "xyx", 3) != &text[249]) {
+            testf("%s: wrong match with only the ends matching", levelName);
+            return false;
+        }
+
+        // A long needle in long text, which used to be where indexOf and
+        // lastIndexOf switched algorithms
+        std::vector<char> longText = makeText(5000, 7);
+        for (size_t start : {0, 1, 255, 256, 1000, 4900}) {
+            StringRef haystack(longText.data(), longText.size());
+            StringRef needle(&longText[start], 100);
+            if (haystack.indexOf(needle) != (ptrdiff_t)start || haystack.lastIndexOf(needle) != (ptrdiff_t)start) {
+                testf("%s: long needle at %d not found", levelName, (int)start);
+                return false;
+            }
+        }
+
+        // Bytes with the high bit set in the needle
+        StringRef highText("abc\xff\xfe" "def\xff\xfe");
+        if (highText.lastIndexOf("\xff\xfe") != 8 || highText.indexOf("\xfe" "d") != 4 ||
+            highText.lastIndexOf('\xff') != 8 || highText.lastIndexOf('\xff', 8) != 3) {
+            testf("%s: high bytes not found", levelName);
+            return false;
+        }
+
+        return true;
+    });
+}
+
+bool test_stringsearch_find_any() {
+    return forEachLevel([](const char* levelName) {
+        const char* sets[] = {",", ",\xc1", "\0B", ";=&?#", "0123456789,;", "\xe1\xc1" "bB"};
+        const size_t setLens[] = {1, 2, 2, 5, 12, 4};
+
+        for (size_t len = 0; len <= 100; len++) {
+            std::vector<char> text = makeText(len, (uint32_t)len + 1000);
+            for (size_t setIndex = 0; setIndex < sizeof(setLens) / sizeof(setLens[0]); setIndex++) {
+                const char* set = sets[setIndex];
+                size_t setLen = setLens[setIndex];
+                for (size_t start = 0; start <= len; start += 5) {
+                    const char* expected = nullptr;
+                    for (size_t i = start; expected == nullptr && i < len; i++) {
+                        if (std::memchr(set, text[i], setLen) != nullptr) {
+                            expected = &text[i];
+                        }
+                    }
+                    const char* found = StringSearch::findAny(text.data() + start, len - start, set, setLen);
+                    if (found != expected) {
+                        testf("%s: findAny wrong for length %d set %d from %d", levelName,
+                              (int)len, (int)setIndex, (int)start);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        StringRef text("name=value; other=thing, last");
+        if (text.indexOfAny(";,") != 10 || text.indexOfAny(";,", 11) != 23 ||
+            text.indexOfAny("!") != -1 || text.indexOfAny("") != -1) {
+            testf("%s: indexOfAny wrong", levelName);
+            return false;
+        }
+
+        return true;
+    });
+}
+
+bool test_stringsearch_ignore_case() {
+    return forEachLevel([](const char* levelName) {
+        // Every byte value against itself, its other case and something else,
+        // at positions in each block and the tail
+        std::vector<char> base(70);
+        for (size_t i = 0; i < base.size(); i++) {
+            base[i] = "Content-Type: Text/HTML; charset=UTF-8"[i % 38];
+        }
+        for (size_t len = 1; len <= base.size(); len += 23) {
+            for (size_t pos = 0; pos < len; pos += (len > 40 ? 13 : 1)) {
+                for (int a = 0; a < 256; a++) {
+                    for (int b : {a, a ^ 0x20, (a + 37) & 0xff}) {
+                        std::vector<char> textA(base.begin(), base.begin() + len);
+                        std::vector<char> textB(base.begin(), base.begin() + len);
+                        textA[pos] = (char)a;
+                        textB[pos] = (char)b;
+
+                        int32_t expected = (int32_t)(unsigned char)naiveLower((char)a) -
+                            (int32_t)(unsigned char)naiveLower((char)b);
+                        int32_t compared = StringSearch::compareIgnoreCase(textA.data(), textB.data(), len);
+                        bool equal = StringSearch::equalsIgnoreCase(textA.data(), textB.data(), len);
+                        if (compared != expected || equal != (expected == 0)) {
+                            testf("%s: bytes %d and %d at %d of %d compared %d, expected %d", levelName,
+                                  a, b, (int)pos, (int)len, (int)compared, (int)expected);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (!StringRef("Transfer-Encoding").engEqualsIgnoreCase("transfer-ENCODING") ||
+            StringRef("chunked").engEqualsIgnoreCase("chunkeD ") ||
+            StringRef("[").engEqualsIgnoreCase("{")) {
+            testf("%s: engEqualsIgnoreCase wrong", levelName);
+            return false;
+        }
+
+        // Shorter sorts first, then case doesn't matter. It used to fold
+        // every character, so "a" and "A" differed.
+        if (StringRef("abc").engCompareIgnoreCase("ABCD") >= 0 ||
+            StringRef("abcd").engCompareIgnoreCase("ABC") <= 0 ||
+            StringRef("a").engCompareIgnoreCase("A") != 0 ||
+            StringRef("apple").engCompareIgnoreCase("BANANA") >= 0 ||
+            StringRef("Zebra").engCompareIgnoreCase("apple") <= 0) {
+            testf("%s: engCompareIgnoreCase wrong", levelName);
+            return false;
+        }
+
+        return true;
+    });
+}
+
+// Only reports timings, there's nothing to fail on
+bool test_stringsearch_benchmark() {
+    // Header-ish text ending in a blank line, so every search has to look
+    // at all of it
+    const size_t lengths[] = {16, 64, 256, 1024, 4096};
+    static const char header[] = "Accept-Language: en-US;q=0.9 fr-FR;q=0.8 de-DE;q=0.7 x-custom-value ";
+    std::vector<char> data(4096);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = header[i % (sizeof(header) - 1)];
+    }
+    std::vector<char> upper(data);
+    for (char& c : upper) {
+        if (c >= 'a' && c <= 'z') {
+            c -= 'a' - 'A';
+        }
+    }
+
+    StringSearch::Level supported = StringSearch::getSupportedLevel();
+    for (size_t len : lengths) {
+        char saved[4];
+        std::memcpy(saved, &data[len - 4], 4);
+        std::memcpy(&data[len - 4], "\r\n\r\n", 4);
+        std::memcpy(&upper[len - 4], "\r\n\r\n", 4);
+
+        for (int level = 0; level <= (int)supported; level++) {
+            StringSearch::setLevel((StringSearch::Level)level);
+            const char* text = data.data();
+            const char* upperText = upper.data();
+
+            double findNanos = benchmarkNanos([text, len] {
+                return (uintptr_t)StringSearch::find(text, len, "\r\n\r\n", 4);
+            });
+            // Starts with a char that's all over the text
+            double findCommonNanos = benchmarkNanos([text, len] {
+                return (uintptr_t)StringSearch::find(text, len, "e-DE;q=0.1", 10);
+            });
+            double findLastNanos = benchmarkNanos([text, len] {
+                return (uintptr_t)StringSearch::findLast(text, len - 4, "\r\n\r\n", 4);
+            });
+            double findAnyNanos = benchmarkNanos([text, len] {
+                return (uintptr_t)StringSearch::findAny(text, len, "\r\n\t", 3);
+            });
+            double equalsNanos = benchmarkNanos([text, upperText, len] {
+                return StringSearch::equalsIgnoreCase(text, upperText, len);
+            });
+            printf("  search %4d bytes %-6s: find %7.1fns  find common %7.1fns  findLast %7.1fns  "
+                   "findAny %7.1fns  equalsIgnoreCase %7.1fns\n",
+                   (int)len, levelNames[level], findNanos, findCommonNanos, findLastNanos, findAnyNanos, equalsNanos);
+        }
+
+        std::memcpy(&data[len - 4], saved, 4);
+        for (size_t i = len - 4; i < len; i++) {
+            upper[i] = (saved[i - len + 4] >= 'a' && saved[i - len + 4] <= 'z') ?
+                (char)(saved[i - len + 4] - ('a' - 'A')) : saved[i - len + 4];
+        }
+    }
+    StringSearch::setLevel(supported);
+
+    return true;
+}
@@ -10,15 +10,33 @@
 #include "unit/http/ChunkedReader_test.h"
 #include "unit/http/ChunkedWriter_test.h"
 #include "unit/http/CommaListIterator_test.h"
+#include "unit/http/Compression_test.h"
+#include "unit/http/ContentLengthReader_test.h"
+#include "unit/http/FileCache_test.h"
+#include "unit/http/HandlerMap_test.h"
 #include "unit/http/Http1_test.h"
 #include "unit/http/Http1_1_test.h"
+#include "unit/http/HttpConnection_test.h"
+#include "unit/http/HttpResponseImpl_test.h"
+#include "unit/http/HttpTokens_test.h"
+#include "unit/http/RequestData_test.h"
+#include "unit/http/RequestParser_test.h"
+#include "unit/http/RouteTable_test.h"
+#include "unit/http/StaticFileHandler_test.h"
+#include "unit/http/UrlParser_test.h"
 #include "unit/http2/Huffman_test.h"
 #include "unit/http2/Hpack_test.h"
 #include "unit/text/String_test.h"
 #include "unit/text/Strconv_test.h"
+#include "unit/text/StringBuilder_test.h"
+#include "unit/text/StringHash_test.h"
+#include "unit/text/StringSearch_test.h"
 #include "unit/net/AddrInfo_test.h"
 #include "unit/net/Socket_test.h"
+#include "unit/util/Arena_test.h"
+#include "unit/util/BufferPool_test.h"
 #include "unit/util/PathTrie_test.h"
+#include "unit/util/RcuPointer_test.h"
 
 #include <stdio.h>
 #include <stdarg.h>
@@ -58,6 +76,13 @@ int testf(const char* fmt, ...) {
 int main(int argc, const char** argv) {
     testRes = 0;
 
+    bool runBenchmarks = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--benchmark") == 0) {
+            runBenchmarks = true;
+        }
+    }
+
     // Text
     RUN_TEST(test_string_create);
     RUN_TEST(test_string_append);
@@ -66,6 +91,14 @@ int main(int argc, const char** argv) {
     RUN_TEST(test_string_startsWith);
     RUN_TEST(test_string_endsWith);
     RUN_TEST(test_string_substring);
+    RUN_TEST(test_stringbuilder_build);
+    RUN_TEST(test_stringbuilder_arena);
+
+    RUN_TEST(test_stringhash_basic);
+    RUN_TEST(test_stringhash_ignore_case);
+    RUN_TEST(test_stringsearch_find);
+    RUN_TEST(test_stringsearch_find_any);
+    RUN_TEST(test_stringsearch_ignore_case);
 
     RUN_TEST(test_strconv_int32ToStr);
     RUN_TEST(test_strconv_int64ToStr);
@@ -75,11 +108,31 @@ int main(int argc, const char** argv) {
     RUN_TEST(test_strconv_parseInt64);
     RUN_TEST(test_strconv_parseUint32);
     RUN_TEST(test_strconv_parseUint64);
+    RUN_TEST(test_strconv_parse_swar);
+    RUN_TEST(test_strconv_radixToStr);
+    RUN_TEST(test_strconv_doubleToStr);
+    RUN_TEST(test_strconv_floatToStr);
+    RUN_TEST(test_strconv_parseDouble);
+    RUN_TEST(test_strconv_parseFloat);
 
     // Util
+    RUN_TEST(test_bufferpool_size_classes);
+    RUN_TEST(test_bufferpool_reuse);
+    RUN_TEST(test_bufferpool_threads);
+    RUN_TEST(test_arena_allocate);
+    RUN_TEST(test_arena_reset);
+    RUN_TEST(test_arena_strings);
+
     RUN_TEST(test_pathtrie_exactmatch);
     RUN_TEST(test_pathtrie_regex);
     RUN_TEST(test_pathtrie_collision);
+    RUN_TEST(test_pathtrie_frozen);
+    RUN_TEST(test_pathtrie_params);
+    RUN_TEST(test_pathtrie_bad_params);
+    RUN_TEST(test_pathtrie_deep_params);
+
+    RUN_TEST(test_rcupointer_reclaim);
+    RUN_TEST(test_rcupointer_threads);
 
     // Socket functionality
     RUN_TEST(test_addrinfo_addrlookup);
@@ -95,16 +148,57 @@ int main(int argc, const char** argv) {
     RUN_TEST(test_bufferedreader_readline);
     RUN_TEST(test_bufferedreader_readfixed);
     RUN_TEST(test_bufferedreader_peekfixed);
+    RUN_TEST(test_bufferedreader_release);
+    RUN_TEST(test_bufferedreader_wait);
+    RUN_TEST(test_bufferedreader_fill);
+    RUN_TEST(test_bufferedreader_read_view);
+    RUN_TEST(test_bufferedreader_readfixed_large);
     RUN_TEST(test_bufferedwriter_basic);
     RUN_TEST(test_bufferedwriter_flush);
 
+    RUN_TEST(test_httptokens_methods);
+    RUN_TEST(test_httptokens_headers);
+    RUN_TEST(test_httptokens_parser_headers);
+    RUN_TEST(test_httptokens_header_name_chars);
+
+    RUN_TEST(test_requestdata_find_header);
+    RUN_TEST(test_requestdata_repeated_headers);
+    RUN_TEST(test_requestdata_many_headers);
+    RUN_TEST(test_requestdata_lowercase_names);
+    RUN_TEST(test_requestdata_url);
+    RUN_TEST(test_requestdata_query);
+
+    RUN_TEST(test_urlparser_split);
+    RUN_TEST(test_urlparser_decode);
+    RUN_TEST(test_urlparser_dot_segments);
+
+    RUN_TEST(test_handlermap_methods);
+    RUN_TEST(test_handlermap_all_methods);
+    RUN_TEST(test_handlermap_frozen);
+
+    RUN_TEST(test_routetable_add_remove);
+    RUN_TEST(test_routetable_snapshot);
+
+    RUN_TEST(test_requestparser_basic);
+    RUN_TEST(test_requestparser_byte_at_a_time);
+    RUN_TEST(test_requestparser_continuation);
+    RUN_TEST(test_requestparser_line_endings);
+    RUN_TEST(test_requestparser_errors);
+    RUN_TEST(test_requestparser_limits);
+
     RUN_TEST(test_chunkedreader_basic);
     RUN_TEST(test_chunkedreader_empty);
     RUN_TEST(test_chunkedreader_bad_data_line);
     RUN_TEST(test_chunkedreader_extension);
     RUN_TEST(test_chunkedreader_trailing_headers);
+    RUN_TEST(test_chunkedreader_read_view);
+    RUN_TEST(test_chunkedreader_close);
+    RUN_TEST(test_chunkedreader_read_fully);
+    RUN_TEST(test_chunkedreader_read_fully_error);
     RUN_TEST(test_chunkedwriter_basic);
     RUN_TEST(test_chunkedwriter_empty);
+    RUN_TEST(test_chunkedwriter_flush);
+    RUN_TEST(test_chunkedwriter_large_write);
 
     RUN_TEST(test_commalistiterator_next);
     RUN_TEST(test_commalistiterator_getLast);
@@ -121,6 +215,38 @@ int main(int argc, const char** argv) {
     RUN_TEST(test_http1_1_auto_chunked_response);
     RUN_TEST(test_http1_1_keepalive);
 
+    RUN_TEST(test_httpconnection_unread_body);
+    RUN_TEST(test_httpconnection_unread_body_no_handler);
+
+    RUN_TEST(test_httpresponseimpl_corked_content_length);
+    RUN_TEST(test_httpresponseimpl_corked_chunked);
+    RUN_TEST(test_httpresponseimpl_headers_only);
+    RUN_TEST(test_httpresponseimpl_flush);
+    RUN_TEST(test_httpresponseimpl_buffered_length);
+    RUN_TEST(test_httpresponseimpl_buffered_spill);
+    RUN_TEST(test_httpresponseimpl_late_header);
+
+    RUN_TEST(test_compression_accept_encoding);
+    RUN_TEST(test_compression_gzip_response);
+    RUN_TEST(test_compression_below_min_size);
+    RUN_TEST(test_compression_content_type);
+    RUN_TEST(test_compression_vary);
+    RUN_TEST(test_contentlengthreader_read_view);
+    RUN_TEST(test_contentlengthreader_close);
+    RUN_TEST(test_contentlengthreader_read_fully);
+    RUN_TEST(test_contentlengthreader_read_fully_truncated);
+
+    RUN_TEST(test_filecache_basic);
+    RUN_TEST(test_filecache_large_file);
+    RUN_TEST(test_filecache_eviction);
+    RUN_TEST(test_filecache_invalidation);
+
+    RUN_TEST(test_staticfilehandler_basic);
+    RUN_TEST(test_staticfilehandler_head);
+    RUN_TEST(test_staticfilehandler_not_modified);
+    RUN_TEST(test_staticfilehandler_rejected);
+    RUN_TEST(test_staticfilehandler_precompressed);
+
     // Http2 functionality
     RUN_TEST(test_hpack_huffman_encode);
     RUN_TEST(test_hpack_huffman_decode);
@@ -133,6 +259,14 @@ int main(int argc, const char** argv) {
     RUN_TEST(test_hpack_without_indexing_invalid);
     RUN_TEST(test_hpack_table_size_change);
 
+    // Only report timings, so they're left out of normal runs
+    if (runBenchmarks) {
+        RUN_TEST(test_stringhash_benchmark);
+        RUN_TEST(test_stringsearch_benchmark);
+        RUN_TEST(test_strconv_benchmark);
+        RUN_TEST(test_strconv_float_benchmark);
+    }
+
     if (testRes) {
         printf("FAILURE: Not all tests passed.\n");
     } else {
@@ -0,0 +1,148 @@
+
+#include "unit/util/Arena_test.h"
+
+#include "unit/UnitTest.h"
+
+#include "cupcake/internal/text/String.h"
+#include "cupcake/internal/util/Arena.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+using namespace Cupcake;
+
+bool test_arena_allocate() {
+    Arena arena;
+    if (arena.getBlockCount() != 0) {
+        testf("New arena already has %d blocks", (int)arena.getBlockCount());
+        return false;
+    }
+
+    // Small allocations share a block, aligned and not overlapping
+    std::vector<char*> allocations;
+    for (size_t size = 1; size <= 100; size++) {
+        char* data = arena.allocate(size);
+        if (((uintptr_t)data & 7) != 0) {
+            testf("Allocation of %d not aligned", (int)size);
+            return false;
+        }
+        std::memset(data, (int)size, size);
+        allocations.push_back(data);
+    }
+    for (size_t size = 1; size <= 100; size++) {
+        const char* data = allocations[size - 1];
+        for (size_t i = 0; i < size; i++) {
+            if (data[i] != (char)size) {
+                testf("Allocation of %d overwritten", (int)size);
+                return false;
+            }
+        }
+    }
+
+    // 100 allocations of up to 104 bytes need two 4KB blocks
+    if (arena.getBlockCount() != 2) {
+        testf("Expected 2 blocks, got %d", (int)arena.getBlockCount());
+        return false;
+    }
+
+    // A big one gets its own block, without wasting the current one
+    char* big = arena.allocate(100000);
+    std::memset(big, 0, 100000);
+    char* afterBig = arena.allocate(8);
+    if (arena.getBlockCount() != 3 || afterBig != allocations.back() + 104) {
+        testf("Big allocation disturbed the current block");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_arena_reset() {
+    Arena arena;
+    char* first = arena.allocate(16);
+    for (int i = 0; i < 100; i++) {
+        arena.allocate(1000);
+    }
+    arena.allocate(1 << 20);
+    if (arena.getAllocatedSize() != 16 + 100 * 1000 + (1 << 20)) {
+        testf("Allocated size %d", (int)arena.getAllocatedSize());
+        return false;
+    }
+
+    // Only the first block is kept, and reused from the start
+    arena.reset();
+    if (arena.getBlockCount() != 1 || arena.getAllocatedSize() != 0) {
+        testf("Reset left %d blocks", (int)arena.getBlockCount());
+        return false;
+    }
+    if (arena.allocate(16) != first) {
+        testf("First block not reused after reset");
+        return false;
+    }
+
+    return true;
+}
+
+bool test_arena_strings() {
+    Arena arena;
+    const char* longText = "A header value well past the short string length";
+
+    String str(&arena);
+    str = longText;
+    if (str.getArena() != &arena || arena.getAllocatedSize() == 0 || str != longText) {
+        testf("Long string not put in the arena");
+        return false;
+    }
+
+    // Appends grow within the arena
+    size_t before = arena.getAllocatedSize();
+    str.append(", and then some more text");
+    if (arena.getAllocatedSize() <= before || !str.endsWith("more text") || !str.startsWith("A header")) {
+        testf("Append didn't grow in the arena");
+        return false;
+    }
+
+    // Copies go to the heap, since they may outlive the arena
+    String copy(str);
+    if (copy.getArena() != nullptr || copy != str) {
+        testf("Copy went to the arena");
+        return false;
+    }
+
+    // Moves on the same arena take the memory, across arenas they copy
+    const char* data = str.data();
+    String moved(std::move(str));
+    if (moved.getArena() != &arena || moved.data() != data || str.length() != 0) {
+        testf("Move didn't take the arena memory");
+        return false;
+    }
+
+    String heapStr(longText);
+    heapStr = std::move(moved);
+    if (heapStr.getArena() != nullptr || heapStr.data() == data || heapStr != StringRef(data)) {
+        testf("Move onto a heap string took arena memory");
+        return false;
+    }
+
+    String arenaStr(StringRef("short"), &arena);
+    arenaStr = std::move(heapStr);
+    if (arenaStr.getArena() != &arena || !arenaStr.startsWith("A header")) {
+        testf("Move onto an arena string didn't copy into the arena");
+        return false;
+    }
+
+    // Strings in vectors keep their arena as the vector grows
+    std::vector<String> strings;
+    for (int i = 0; i < 20; i++) {
+        strings.emplace_back(StringRef(longText), &arena);
+    }
+    for (const String& element : strings) {
+        if (element.getArena() != &arena || element != longText) {
+            testf("String in vector lost its arena");
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,132 @@
+
+#include "unit/util/BufferPool_test.h"
+
+#include "unit/UnitTest.h"
+
+#include "cupcake/internal/util/BufferPool.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace Cupcake;
+
+bool test_bufferpool_size_classes() {
+    struct ClassTest {
+        uint32_t minSize;
+        uint32_t expected;
+    };
+
+    const ClassTest tests[] = {
+        {0, 1024},
+        {1, 1024},
+        {1024, 1024},
+        {1025, 2048},
+        {2048, 2048},
+        {3000, 4096},
+        {1024 * 1024, 1024 * 1024},
+        {1024 * 1024 + 1, 1024 * 1024 + 1}, // Too big to pool
+    };
+
+    for (const ClassTest& test : tests) {
+        PooledBuffer buffer = BufferPool::allocate(test.minSize);
+        if (!buffer || buffer.size() != test.expected) {
+            testf("Expected size %u for %u, got %u", test.expected, test.minSize, buffer.size());
+            return false;
+        }
+        std::memset(buffer.get(), 0, buffer.size());
+    }
+
+    return true;
+}
+
+bool test_bufferpool_reuse() {
+    BufferPool::trim();
+
+    PooledBuffer buffer = BufferPool::allocate(4000);
+    char* data = buffer.get();
+
+    // Moving hands over ownership without touching the pool
+    PooledBuffer moved(std::move(buffer));
+    if (buffer || moved.get() != data) {
+        testf("Move did not transfer the buffer");
+        return false;
+    }
+
+    moved.reset();
+    if (moved) {
+        testf("Reset did not release the buffer");
+        return false;
+    }
+
+    // Same thread, same class, so the cached buffer comes straight back
+    PooledBuffer again = BufferPool::allocate(3000);
+    if (again.get() != data || again.size() != 4096) {
+        testf("Released buffer was not reused");
+        return false;
+    }
+
+    // Different class doesn't get it
+    PooledBuffer other = BufferPool::allocate(8192);
+    if (other.get() == data) {
+        testf("Buffer reused for the wrong class");
+        return false;
+    }
+
+    again.swap(other);
+    if (other.get() != data || other.size() != 4096 || again.size() != 8192) {
+        testf("Swap did not exchange buffers");
+        return false;
+    }
+
+    return true;
+}
+
+// Buffers freed on other threads end up shared rather than lost
+bool test_bufferpool_threads() {
+    BufferPool::trim();
+
+    std::vector<PooledBuffer> buffers;
+    for (int i = 0; i < 64; i++) {
+        buffers.push_back(BufferPool::allocate(64 * 1024));
+        std::memset(buffers.back().get(), i, buffers.back().size());
+    }
+
+    std::thread releaser([&buffers] {
+        buffers.clear();
+    });
+    releaser.join();
+
+    // The thread's cache went to the shared lists when it exited
+    PooledBuffer buffer = BufferPool::allocate(64 * 1024);
+    if (buffer.size() != 64 * 1024) {
+        testf("Failed to allocate after threads released buffers");
+        return false;
+    }
+
+    std::vector<std::thread> threads;
+    std::atomic<bool> failed(false);
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&failed, i] {
+            for (int j = 0; j < 1000; j++) {
+                PooledBuffer threadBuffer = BufferPool::allocate(1024 << (j % 6));
+                threadBuffer.get()[0] = (char)i;
+                threadBuffer.get()[threadBuffer.size() - 1] = (char)j;
+                if (threadBuffer.get()[0] != (char)i) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (failed) {
+        testf("Buffer shared between threads");
+        return false;
+    }
+
+    BufferPool::trim();
+    return true;
+}
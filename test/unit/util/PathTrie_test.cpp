@@ -6,6 +6,7 @@
 #include "cupcake/internal/util/PathTrie.h"
 
 #include <array>
+#include <string>
 #include <vector>
 
 using namespace Cupcake;
@@ -114,3 +115,255 @@ bool test_pathtrie_collision() {
 
     return true;
 }
+
+bool test_pathtrie_frozen() {
+    PathTrie<int> trie;
+
+    // Mix of short and long prefixes, exact and '*' paths
+    std::vector<std::string> paths;
+    for (int i = 0; i < 1000; i++) {
+        std::string path = "/api/v1/some/fairly/long/resource/name/" + std::to_string(i);
+        if (i % 3 == 0) {
+            path += "/details";
+        } else if (i % 3 == 1) {
+            path += "/files/*";
+        }
+        paths.push_back(path);
+        if (!trie.addNode(StringRef(path.data(), path.length()), i + 1)) {
+            testf("Failed to add %s", path.c_str());
+            return false;
+        }
+    }
+    trie.addNode("/", 10000);
+    trie.addNode("/a", 10001);
+
+    trie.freeze();
+    if (!trie.isFrozen() || trie.addNode("/late", 1)) {
+        testf("Trie still accepted nodes after freeze");
+        return false;
+    }
+
+    for (int i = 0; i < 1000; i++) {
+        std::string path = paths[i];
+        if (path.back() == '*') {
+            path.back() = 'x';
+        }
+
+        int val;
+        bool found;
+        std::tie(val, found) = trie.find(StringRef(path.data(), path.length()));
+        if (!found || val != i + 1) {
+            testf("Failed to find frozen value for %s", path.c_str());
+            return false;
+        }
+    }
+
+    const std::vector<std::tuple<StringRef, int>> checks = {
+        std::make_tuple("/", 10000),
+        std::make_tuple("/a", 10001),
+        std::make_tuple("/b", 0),
+        std::make_tuple("/api/v1/some/fairly/long/resource/name/0", 0),
+        std::make_tuple("/api/v1/some/fairly/long/resource/name/1/files/", 2),
+        std::make_tuple("/api/v1/some/fairly/long/resource/name/1/file", 0),
+        std::make_tuple("/api/v1/some/fairly/long/resource/name/2/details", 0),
+        std::make_tuple("/api/v1/some/fairly/long/resource/nam", 0),
+    };
+    for (const auto& check : checks) {
+        int val;
+        bool found;
+        std::tie(val, found) = trie.find(std::get<0>(check));
+        int expected = std::get<1>(check);
+        if (found != (expected != 0) || (found && val != expected)) {
+            testf("Unexpected frozen lookup result for %s", std::get<0>(check).data());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static
+bool checkParamLookups(const PathTrie<int>& trie, const char* state) {
+    const std::vector<std::tuple<StringRef, int, std::vector<StringRef>>> checks = {
+        std::make_tuple("/users/me", 1, std::vector<StringRef>{}),
+        std::make_tuple("/users/42", 2, std::vector<StringRef>{"42"}),
+        std::make_tuple("/users/bob", 3, std::vector<StringRef>{"bob"}),
+        std::make_tuple("/users/42/orders/7", 4, std::vector<StringRef>{"42", "7"}),
+        std::make_tuple("/users/bob/orders/7", 4, std::vector<StringRef>{"bob", "7"}),
+        std::make_tuple("/users/123e4567-e89b-12d3-a456-426614174000", 5,
+                        std::vector<StringRef>{"123e4567-e89b-12d3-a456-426614174000"}),
+        std::make_tuple("/users/42/files/a/b", 6, std::vector<StringRef>{"42"}),
+        std::make_tuple("/users/42/files", 7, std::vector<StringRef>{}),
+        std::make_tuple("/users/", 7, std::vector<StringRef>{}),
+        std::make_tuple("/users/bob/other", 7, std::vector<StringRef>{}),
+        // Static wins even when only the parameter leads to a full match
+        std::make_tuple("/users/me/orders/1", 4, std::vector<StringRef>{"me", "1"}),
+    };
+
+    for (const auto& check : checks) {
+        PathParams params;
+        int val;
+        bool found;
+        std::tie(val, found) = trie.find(std::get<0>(check), params);
+
+        int expected = std::get<1>(check);
+        if (found != (expected != 0) || (found && val != expected)) {
+            testf("Unexpected %s lookup result %d for %s", state, val, std::get<0>(check).data());
+            return false;
+        }
+
+        const std::vector<StringRef>& expectedParams = std::get<2>(check);
+        if (params.getCount() != expectedParams.size()) {
+            testf("Expected %d %s params for %s, got %d", (int)expectedParams.size(), state,
+                  std::get<0>(check).data(), (int)params.getCount());
+            return false;
+        }
+        for (size_t i = 0; i < expectedParams.size(); i++) {
+            if (!params.getValue(i).equals(expectedParams[i])) {
+                testf("Wrong %s param %d for %s", state, (int)i, std::get<0>(check).data());
+                return false;
+            }
+        }
+    }
+
+    // Values are looked up by the names of the path that matched
+    PathParams params;
+    trie.find("/users/bob/orders/7", params);
+    StringRef value;
+    bool found;
+    std::tie(value, found) = params.get("orderId");
+    if (!found || !value.equals("7") || !params.getName(0).equals("id")) {
+        testf("Failed to get %s param by name", state);
+        return false;
+    }
+
+    return true;
+}
+
+bool test_pathtrie_params() {
+    PathTrie<int> trie;
+
+    const std::vector<StringRef> paths = {
+        "/users/me",
+        "/users/{id:int}",
+        "/users/{name}",
+        "/users/{id}/orders/{orderId}",
+        "/users/{id:uuid}",
+        "/users/{id:int}/files/*",
+        "/users/*",
+    };
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (!trie.addNode(paths[i], (int)i + 1)) {
+            testf("Failed to add %s", paths[i].data());
+            return false;
+        }
+    }
+
+    if (!checkParamLookups(trie, "unfrozen")) {
+        return false;
+    }
+    trie.freeze();
+    return checkParamLookups(trie, "frozen");
+}
+
+bool test_pathtrie_bad_params() {
+    const std::vector<StringRef> paths = {
+        "/users/{}",
+        "/users/{id",
+        "/users/x{id}",
+        "/users/{id}x",
+        "/users/{id:float}",
+        "/{a}/{b}/{c}/{d}/{e}/{f}/{g}/{h}/{i}",
+    };
+
+    for (StringRef path : paths) {
+        PathTrie<int> trie;
+        if (trie.addNode(path, 1)) {
+            testf("Accepted bad parameter path %s", path.data());
+            return false;
+        }
+    }
+
+    // Same parameter position twice is a duplicate, whatever the names
+    PathTrie<int> trie;
+    if (!trie.addNode("/users/{id}", 1) || trie.addNode("/users/{name}", 2)) {
+        testf("Duplicate parameter path not rejected");
+        return false;
+    }
+
+    return true;
+}
+
+// Tests frozen lookups that have to back out of more parameters than fit on
+// the stack still agree with the unfrozen ones
+bool test_pathtrie_deep_params() {
+    PathTrie<int> unfrozen;
+    PathTrie<int> frozen;
+
+    // A parameter hanging off every level of a long static chain
+    std::string prefix;
+    for (int i = 0; i < 40; i++) {
+        std::string path = prefix + "/{p}/end";
+        unfrozen.addNode(StringRef(path.data(), path.length()), i + 1);
+        frozen.addNode(StringRef(path.data(), path.length()), i + 1);
+        prefix += "/d";
+    }
+    std::string chain;
+    for (int i = 0; i < 45; i++) {
+        chain += "/d";
+    }
+    unfrozen.addNode(StringRef(chain.data(), chain.length()), 1000);
+    frozen.addNode(StringRef(chain.data(), chain.length()), 1000);
+    frozen.freeze();
+
+    std::string path;
+    for (int depth = 0; depth <= 50; depth++) {
+        for (const char* suffix : {"/end", "/x/end", "/d/end", ""}) {
+            std::string lookup = path + suffix;
+            StringRef lookupRef(lookup.data(), lookup.length());
+
+            PathParams unfrozenParams;
+            PathParams frozenParams;
+            int unfrozenVal;
+            int frozenVal;
+            bool unfrozenFound;
+            bool frozenFound;
+            std::tie(unfrozenVal, unfrozenFound) = unfrozen.find(lookupRef, unfrozenParams);
+            std::tie(frozenVal, frozenFound) = frozen.find(lookupRef, frozenParams);
+
+            if (frozenFound != unfrozenFound || (frozenFound && frozenVal != unfrozenVal)) {
+                testf("Frozen lookup of %s found %d, unfrozen found %d", lookup.c_str(),
+                      frozenFound ? frozenVal : 0, unfrozenFound ? unfrozenVal : 0);
+                return false;
+            }
+            if (frozenParams.getCount() != unfrozenParams.getCount()) {
+                testf("Frozen lookup of %s had %d params, unfrozen had %d", lookup.c_str(),
+                      (int)frozenParams.getCount(), (int)unfrozenParams.getCount());
+                return false;
+            }
+            for (size_t i = 0; i < frozenParams.getCount(); i++) {
+                if (!frozenParams.getValue(i).equals(unfrozenParams.getValue(i))) {
+                    testf("Frozen lookup of %s had the wrong param %d", lookup.c_str(), (int)i);
+                    return false;
+                }
+            }
+        }
+        path += "/d";
+    }
+
+    // The case that used to run out of room
+    std::string deep;
+    for (int i = 0; i < 36; i++) {
+        deep += "/d";
+    }
+    deep += "/end";
+    int val;
+    bool found;
+    std::tie(val, found) = frozen.find(StringRef(deep.data(), deep.length()));
+    if (!found || val != 36) {
+        testf("Failed to find the deep parameter route");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,122 @@
+
+#include "unit/UnitTest.h"
+#include "unit/util/RcuPointer_test.h"
+
+#include "cupcake/internal/util/RcuPointer.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Cupcake;
+
+// Counts live instances, and notices being read after it's freed
+class RcuValue {
+public:
+    RcuValue(int value, std::atomic<int>* liveCount) :
+        value(value),
+        check(value),
+        liveCount(liveCount)
+    {
+        liveCount->fetch_add(1);
+    }
+
+    ~RcuValue() {
+        check = -1;
+        liveCount->fetch_sub(1);
+    }
+
+    bool valid() const {return check == value;}
+
+    int value;
+    volatile int check;
+    std::atomic<int>* liveCount;
+};
+
+bool test_rcupointer_reclaim() {
+    std::atomic<int> liveCount(0);
+    {
+        RcuPointer<RcuValue> pointer(std::unique_ptr<RcuValue>(new RcuValue(1, &liveCount)));
+
+        // Nobody reading, so the old value goes straight away
+        pointer.publish(std::unique_ptr<RcuValue>(new RcuValue(2, &liveCount)));
+        if (liveCount != 1 || pointer.getRetiredCount() != 0 || pointer.read()->value != 2) {
+            testf("Unread value was not reclaimed, %d live", liveCount.load());
+            return false;
+        }
+
+        {
+            RcuPointer<RcuValue>::ReadGuard guard = pointer.read();
+            pointer.publish(std::unique_ptr<RcuValue>(new RcuValue(3, &liveCount)));
+            pointer.publish(std::unique_ptr<RcuValue>(new RcuValue(4, &liveCount)));
+
+            // The guard still sees what it started with, and a new read sees the latest
+            if (guard->value != 2 || !guard->valid() || pointer.read()->value != 4) {
+                testf("Guard did not keep its value");
+                return false;
+            }
+            if (pointer.getRetiredCount() == 0) {
+                testf("Value was reclaimed while being read");
+                return false;
+            }
+        }
+
+        // Dropping the guard lets the next publish clean up everything
+        pointer.publish(std::unique_ptr<RcuValue>(new RcuValue(5, &liveCount)));
+        if (liveCount != 1 || pointer.getRetiredCount() != 0) {
+            testf("Values were not reclaimed after reading, %d live", liveCount.load());
+            return false;
+        }
+    }
+
+    if (liveCount != 0) {
+        testf("Values leaked, %d live", liveCount.load());
+        return false;
+    }
+    return true;
+}
+
+// Readers never see a freed value while a writer keeps replacing it
+bool test_rcupointer_threads() {
+    std::atomic<int> liveCount(0);
+    std::atomic<bool> failed(false);
+    {
+        RcuPointer<RcuValue> pointer(std::unique_ptr<RcuValue>(new RcuValue(0, &liveCount)));
+        std::atomic<bool> done(false);
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; i++) {
+            readers.emplace_back([&pointer, &done, &failed] {
+                int lastValue = 0;
+                while (!done) {
+                    RcuPointer<RcuValue>::ReadGuard guard = pointer.read();
+                    if (!guard->valid() || guard->value < lastValue) {
+                        failed = true;
+                    }
+                    lastValue = guard->value;
+                }
+            });
+        }
+
+        for (int i = 1; i <= 20000; i++) {
+            pointer.publish(std::unique_ptr<RcuValue>(new RcuValue(i, &liveCount)));
+        }
+        done = true;
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+
+        // With the readers gone, one more publish reclaims the backlog
+        pointer.publish(std::unique_ptr<RcuValue>(new RcuValue(20001, &liveCount)));
+        if (liveCount != 1) {
+            testf("Values were not reclaimed, %d live", liveCount.load());
+            return false;
+        }
+    }
+
+    if (failed) {
+        testf("A reader saw a reclaimed or stale value");
+        return false;
+    }
+    return liveCount == 0;
+}
@@ -0,0 +1,29 @@
+
+#ifndef CUPCAKE_BENCHMARK_H
+#define CUPCAKE_BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+
+// Calls func in batches until at least minMillis have passed, and returns the
+// average nanoseconds per call. What func returns is kept so the work it did
+// can't be optimized away.
+template <typename Func>
+double benchmarkNanos(Func func, uint32_t minMillis = 50) {
+    volatile uint64_t sink = 0;
+    uint64_t calls = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration elapsed;
+    do {
+        for (int i = 0; i < 1000; i++) {
+            sink = sink + (uint64_t)func();
+        }
+        calls += 1000;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds(minMillis));
+
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / calls;
+}
+
+#endif // CUPCAKE_BENCHMARK_H
@@ -6,5 +6,10 @@ bool test_bufferedreader_basic();
 bool test_bufferedreader_readline();
 bool test_bufferedreader_readfixed();
 bool test_bufferedreader_peekfixed();
+bool test_bufferedreader_release();
+bool test_bufferedreader_wait();
+bool test_bufferedreader_fill();
+bool test_bufferedreader_read_view();
+bool test_bufferedreader_readfixed_large();
 
 #endif // CUPCAKE_BUFFERED_READER_TEST_H
@@ -7,5 +7,9 @@ bool test_chunkedreader_empty();
 bool test_chunkedreader_bad_data_line();
 bool test_chunkedreader_extension();
 bool test_chunkedreader_trailing_headers();
+bool test_chunkedreader_read_view();
+bool test_chunkedreader_close();
+bool test_chunkedreader_read_fully();
+bool test_chunkedreader_read_fully_error();
 
 #endif // CUPCAKE_CHUNKED_READER_TEST_H
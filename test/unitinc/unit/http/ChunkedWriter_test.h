@@ -4,5 +4,7 @@
 
 bool test_chunkedwriter_basic();
 bool test_chunkedwriter_empty();
+bool test_chunkedwriter_flush();
+bool test_chunkedwriter_large_write();
 
 #endif // CUPCAKE_CHUNKED_WRITER_TEST_H
@@ -0,0 +1,11 @@
+
+#ifndef CUPCAKE_COMPRESSION_TEST_H
+#define CUPCAKE_COMPRESSION_TEST_H
+
+bool test_compression_accept_encoding();
+bool test_compression_gzip_response();
+bool test_compression_below_min_size();
+bool test_compression_content_type();
+bool test_compression_vary();
+
+#endif // CUPCAKE_COMPRESSION_TEST_H
@@ -0,0 +1,10 @@
+
+#ifndef CUPCAKE_CONTENT_LENGTH_READER_TEST_H
+#define CUPCAKE_CONTENT_LENGTH_READER_TEST_H
+
+bool test_contentlengthreader_read_view();
+bool test_contentlengthreader_close();
+bool test_contentlengthreader_read_fully();
+bool test_contentlengthreader_read_fully_truncated();
+
+#endif // CUPCAKE_CONTENT_LENGTH_READER_TEST_H
@@ -0,0 +1,10 @@
+
+#ifndef CUPCAKE_FILE_CACHE_TEST_H
+#define CUPCAKE_FILE_CACHE_TEST_H
+
+bool test_filecache_basic();
+bool test_filecache_large_file();
+bool test_filecache_eviction();
+bool test_filecache_invalidation();
+
+#endif // CUPCAKE_FILE_CACHE_TEST_H
@@ -0,0 +1,9 @@
+
+#ifndef CUPCAKE_HANDLER_MAP_TEST_H
+#define CUPCAKE_HANDLER_MAP_TEST_H
+
+bool test_handlermap_methods();
+bool test_handlermap_all_methods();
+bool test_handlermap_frozen();
+
+#endif // CUPCAKE_HANDLER_MAP_TEST_H
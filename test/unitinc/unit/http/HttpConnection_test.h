@@ -0,0 +1,8 @@
+
+#ifndef CUPCAKE_HTTP_CONNECTION_TEST_H
+#define CUPCAKE_HTTP_CONNECTION_TEST_H
+
+bool test_httpconnection_unread_body();
+bool test_httpconnection_unread_body_no_handler();
+
+#endif // CUPCAKE_HTTP_CONNECTION_TEST_H
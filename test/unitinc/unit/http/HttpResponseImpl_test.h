@@ -0,0 +1,13 @@
+
+#ifndef CUPCAKE_HTTP_RESPONSE_IMPL_TEST_H
+#define CUPCAKE_HTTP_RESPONSE_IMPL_TEST_H
+
+bool test_httpresponseimpl_corked_content_length();
+bool test_httpresponseimpl_corked_chunked();
+bool test_httpresponseimpl_headers_only();
+bool test_httpresponseimpl_flush();
+bool test_httpresponseimpl_buffered_length();
+bool test_httpresponseimpl_buffered_spill();
+bool test_httpresponseimpl_late_header();
+
+#endif // CUPCAKE_HTTP_RESPONSE_IMPL_TEST_H
@@ -0,0 +1,10 @@
+
+#ifndef CUPCAKE_HTTP_TOKENS_TEST_H
+#define CUPCAKE_HTTP_TOKENS_TEST_H
+
+bool test_httptokens_methods();
+bool test_httptokens_headers();
+bool test_httptokens_parser_headers();
+bool test_httptokens_header_name_chars();
+
+#endif // CUPCAKE_HTTP_TOKENS_TEST_H
@@ -0,0 +1,12 @@
+
+#ifndef CUPCAKE_REQUEST_DATA_TEST_H
+#define CUPCAKE_REQUEST_DATA_TEST_H
+
+bool test_requestdata_find_header();
+bool test_requestdata_repeated_headers();
+bool test_requestdata_many_headers();
+bool test_requestdata_lowercase_names();
+bool test_requestdata_url();
+bool test_requestdata_query();
+
+#endif // CUPCAKE_REQUEST_DATA_TEST_H
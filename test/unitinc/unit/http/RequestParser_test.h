@@ -0,0 +1,12 @@
+
+#ifndef CUPCAKE_REQUEST_PARSER_TEST_H
+#define CUPCAKE_REQUEST_PARSER_TEST_H
+
+bool test_requestparser_basic();
+bool test_requestparser_byte_at_a_time();
+bool test_requestparser_continuation();
+bool test_requestparser_line_endings();
+bool test_requestparser_errors();
+bool test_requestparser_limits();
+
+#endif // CUPCAKE_REQUEST_PARSER_TEST_H
@@ -0,0 +1,8 @@
+
+#ifndef CUPCAKE_ROUTE_TABLE_TEST_H
+#define CUPCAKE_ROUTE_TABLE_TEST_H
+
+bool test_routetable_add_remove();
+bool test_routetable_snapshot();
+
+#endif // CUPCAKE_ROUTE_TABLE_TEST_H
@@ -0,0 +1,11 @@
+
+#ifndef CUPCAKE_STATIC_FILE_HANDLER_TEST_H
+#define CUPCAKE_STATIC_FILE_HANDLER_TEST_H
+
+bool test_staticfilehandler_basic();
+bool test_staticfilehandler_head();
+bool test_staticfilehandler_not_modified();
+bool test_staticfilehandler_rejected();
+bool test_staticfilehandler_precompressed();
+
+#endif // CUPCAKE_STATIC_FILE_HANDLER_TEST_H
@@ -0,0 +1,9 @@
+
+#ifndef CUPCAKE_URL_PARSER_TEST_H
+#define CUPCAKE_URL_PARSER_TEST_H
+
+bool test_urlparser_split();
+bool test_urlparser_decode();
+bool test_urlparser_dot_segments();
+
+#endif // CUPCAKE_URL_PARSER_TEST_H
@@ -11,5 +11,15 @@ bool test_strconv_parseInt32();
 bool test_strconv_parseInt64();
 bool test_strconv_parseUint32();
 bool test_strconv_parseUint64();
+bool test_strconv_parse_swar();
+bool test_strconv_radixToStr();
+
+bool test_strconv_doubleToStr();
+bool test_strconv_floatToStr();
+bool test_strconv_parseDouble();
+bool test_strconv_parseFloat();
+
+bool test_strconv_benchmark();
+bool test_strconv_float_benchmark();
 
 #endif // CUPCAKE_STRCONV_TEST_H
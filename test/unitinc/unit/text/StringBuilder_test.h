@@ -0,0 +1,8 @@
+
+#ifndef CUPCAKE_STRING_BUILDER_TEST_H
+#define CUPCAKE_STRING_BUILDER_TEST_H
+
+bool test_stringbuilder_build();
+bool test_stringbuilder_arena();
+
+#endif // CUPCAKE_STRING_BUILDER_TEST_H
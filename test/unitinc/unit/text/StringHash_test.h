@@ -0,0 +1,9 @@
+
+#ifndef CUPCAKE_STRING_HASH_TEST_H
+#define CUPCAKE_STRING_HASH_TEST_H
+
+bool test_stringhash_basic();
+bool test_stringhash_ignore_case();
+bool test_stringhash_benchmark();
+
+#endif // CUPCAKE_STRING_HASH_TEST_H
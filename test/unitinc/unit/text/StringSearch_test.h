@@ -0,0 +1,10 @@
+
+#ifndef CUPCAKE_STRING_SEARCH_TEST_H
+#define CUPCAKE_STRING_SEARCH_TEST_H
+
+bool test_stringsearch_find();
+bool test_stringsearch_find_any();
+bool test_stringsearch_ignore_case();
+bool test_stringsearch_benchmark();
+
+#endif // CUPCAKE_STRING_SEARCH_TEST_H
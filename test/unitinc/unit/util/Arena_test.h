@@ -0,0 +1,9 @@
+
+#ifndef CUPCAKE_ARENA_TEST_H
+#define CUPCAKE_ARENA_TEST_H
+
+bool test_arena_allocate();
+bool test_arena_reset();
+bool test_arena_strings();
+
+#endif // CUPCAKE_ARENA_TEST_H
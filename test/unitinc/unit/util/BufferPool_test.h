@@ -0,0 +1,9 @@
+
+#ifndef CUPCAKE_BUFFERPOOL_TEST_H
+#define CUPCAKE_BUFFERPOOL_TEST_H
+
+bool test_bufferpool_size_classes();
+bool test_bufferpool_reuse();
+bool test_bufferpool_threads();
+
+#endif // CUPCAKE_BUFFERPOOL_TEST_H
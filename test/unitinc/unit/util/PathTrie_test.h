@@ -5,5 +5,9 @@
 bool test_pathtrie_exactmatch();
 bool test_pathtrie_regex();
 bool test_pathtrie_collision();
+bool test_pathtrie_frozen();
+bool test_pathtrie_params();
+bool test_pathtrie_bad_params();
+bool test_pathtrie_deep_params();
 
 #endif // CUPCAKE_PATHTRIE_TEST_H
@@ -0,0 +1,8 @@
+
+#ifndef CUPCAKE_RCU_POINTER_TEST_H
+#define CUPCAKE_RCU_POINTER_TEST_H
+
+bool test_rcupointer_reclaim();
+bool test_rcupointer_threads();
+
+#endif // CUPCAKE_RCU_POINTER_TEST_H